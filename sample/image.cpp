@@ -51,6 +51,10 @@ void Image::write(int x, int y, unsigned width, unsigned height, const void* dat
 	glTextureSubImage2D(m_handle, 0, x, y, width, height, m_format, m_type, data);
 }
 
+void Image::clear() {
+	glClearTexImage(m_handle, 0, m_format, m_type, nullptr);
+}
+
 void Image::bind(unsigned unit) const {
 	glActiveTexture(GL_TEXTURE0 + unit);
 	glBindTexture(GL_TEXTURE_2D, m_handle);
@@ -14,6 +14,7 @@ class Image final {
 		void operator=(const Image&) = delete;
 
 		void write(int x, int y, unsigned width, unsigned height, const void*);
+		void clear();
 
 		void bind(unsigned unit = 0) const;
 
@@ -113,6 +113,8 @@ int main() {
 		auto deltaTime = currTime - lastTime;
 		lastTime = currTime;
 
+		g_textAtlas->begin_frame();
+		g_msdfTextAtlas->begin_frame();
 		container->update(static_cast<float>(deltaTime));
 		render(*container);
 		glfwSwapBuffers(window);
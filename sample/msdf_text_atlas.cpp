@@ -11,6 +11,7 @@
 
 #include <glad/glad.h>
 
+#include <algorithm>
 #include <cstring>
 
 static constexpr bool USE_MSDF_ERROR_CORRECTION = false;
@@ -22,6 +23,8 @@ static constexpr const size_t HASH_MULTIPLIER = 0x100000001B3ull;
 static constexpr uint32_t TEXTURE_EXTENT = 2048u;
 static constexpr uint32_t TEXTURE_PADDING = 2u;
 
+static constexpr const char* CACHE_FILE_NAME = "msdf_glyph_cache.bin";
+
 namespace {
 
 struct OutlineContext {
@@ -42,6 +45,50 @@ static Bitmap load_msdf_shape(msdfgen::Shape& shape, FT_Outline& outline, float*
 
 // MSDFTextAtlas
 
+MSDFTextAtlas::MSDFTextAtlas() {
+	m_diskCache.open(CACHE_FILE_NAME);
+
+	auto workerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1u;
+
+	for (uint32_t i = 0; i < workerCount; ++i) {
+		m_workers.emplace_back([this] { worker_main(); });
+	}
+}
+
+MSDFTextAtlas::~MSDFTextAtlas() {
+	{
+		std::scoped_lock lock(m_jobMutex);
+		m_stopping = true;
+	}
+
+	m_jobSignal.notify_all();
+
+	for (auto& worker : m_workers) {
+		worker.join();
+	}
+
+	m_diskCache.close();
+}
+
+void MSDFTextAtlas::begin_frame() {
+	std::vector<GenerateJob> completedJobs;
+
+	{
+		std::scoped_lock lock(m_jobMutex);
+		completedJobs.swap(m_completedJobs);
+	}
+
+	for (auto& job : completedJobs) {
+		auto* pInfo = job.isStroke ? &m_strokes[job.strokeKey] : &m_glyphs[job.glyphKey];
+		Text::GlyphDiskCacheEntry entry;
+		pInfo->pending = false;
+
+		if (m_diskCache.find(job.diskKey, entry)) {
+			resolve_glyph(*pInfo, entry);
+		}
+	}
+}
+
 Image* MSDFTextAtlas::get_glyph_info(Text::SingleScriptFont font, uint32_t glyphIndex,
 		float* texCoordExtentsOut, float* sizeOut, float* offsetOut, bool& hasColorOut) {
 	GlyphKey key{glyphIndex, font.face.handle};
@@ -50,76 +97,172 @@ Image* MSDFTextAtlas::get_glyph_info(Text::SingleScriptFont font, uint32_t glyph
 	auto scaleX = static_cast<float>(metrics.x_ppem) / static_cast<float>(MSDF_PIXELS_PER_EM);
 	auto scaleY = static_cast<float>(metrics.y_ppem) / static_cast<float>(MSDF_PIXELS_PER_EM);
 
-	if (auto it = m_glyphs.find(key); it != m_glyphs.end()) {
-		std::memcpy(texCoordExtentsOut, it->second.texCoordExtents, 4 * sizeof(float));
-		std::memcpy(sizeOut, it->second.bitmapSize, 2 * sizeof(float));
-		std::memcpy(offsetOut, it->second.offset, 2 * sizeof(float));
-		offsetOut[0] *= scaleX;
-		offsetOut[1] *= scaleY;
-		sizeOut[0] *= scaleX;
-		sizeOut[1] *= scaleY;
-		hasColorOut = it->second.pPage ? it->second.pPage->hasColor : false;
-		return &it->second.pPage->image;
+	auto it = m_glyphs.find(key);
+
+	if (it == m_glyphs.end()) {
+		// Fill distance fields are generated at a fixed resolution and scaled, so the size is not part of the key
+		it = m_glyphs.emplace(key, load_or_enqueue({
+			.font = font,
+			.diskKey = {
+				.fontHash = get_font_hash(font),
+				.glyphID = glyphIndex,
+				.size = 0,
+				.pixelsPerEm = static_cast<uint32_t>(MSDF_PIXELS_PER_EM),
+				.strokeThickness = 0,
+				.strokeJoins = Text::StrokeType::NONE,
+			},
+			.glyphKey = key,
+			.strokeKey = {},
+			.isStroke = false,
+		})).first;
 	}
 
-	GlyphInfo info{};
-	bool hasColor = false;
-
-	fontData.load_glyph_curve(glyphIndex, [&](auto& outline) {
-		handle_rasterization(outline, info, hasColor, fontData.get_upem());
-	});
-
-	auto* result = info.pPage ? &info.pPage->image : nullptr;
-	std::memcpy(texCoordExtentsOut, info.texCoordExtents, 4 * sizeof(float));
-	std::memcpy(sizeOut, info.bitmapSize, 2 * sizeof(float));
-	std::memcpy(offsetOut, info.offset, 2 * sizeof(float));
-	hasColorOut = hasColor;
+	auto* result = write_glyph_info(it->second, texCoordExtentsOut, sizeOut, offsetOut, hasColorOut);
 
 	offsetOut[0] *= scaleX;
 	offsetOut[1] *= scaleY;
 	sizeOut[0] *= scaleX;
 	sizeOut[1] *= scaleY;
 
-	m_glyphs.emplace(std::make_pair(std::move(key), std::move(info)));
-
 	return result;
 }
 
 Image* MSDFTextAtlas::get_stroke_info(Text::SingleScriptFont font, uint32_t glyphIndex, uint8_t thickness,
 		Text::StrokeType type, float* texCoordExtentsOut, float* sizeOut, float* offsetOut, bool& hasColorOut) {
 	StrokeKey key{font.size, glyphIndex, font.face.handle, thickness, type};
-
-	if (auto it = m_strokes.find(key); it != m_strokes.end()) {
-		std::memcpy(texCoordExtentsOut, it->second.texCoordExtents, 4 * sizeof(float));
-		std::memcpy(sizeOut, it->second.bitmapSize, 2 * sizeof(float));
-		std::memcpy(offsetOut, it->second.offset, 2 * sizeof(float));
-		hasColorOut = it->second.pPage ? it->second.pPage->hasColor : false;
-		return &it->second.pPage->image;
+	auto it = m_strokes.find(key);
+
+	if (it == m_strokes.end()) {
+		it = m_strokes.emplace(key, load_or_enqueue({
+			.font = font,
+			.diskKey = {
+				.fontHash = get_font_hash(font),
+				.glyphID = glyphIndex,
+				.size = font.size,
+				.pixelsPerEm = static_cast<uint32_t>(MSDF_PIXELS_PER_EM),
+				.strokeThickness = thickness,
+				.strokeJoins = type,
+			},
+			.glyphKey = {},
+			.strokeKey = key,
+			.isStroke = true,
+		})).first;
 	}
 
+	return write_glyph_info(it->second, texCoordExtentsOut, sizeOut, offsetOut, hasColorOut);
+}
+
+MSDFTextAtlas::GlyphInfo MSDFTextAtlas::load_or_enqueue(GenerateJob&& job) {
 	GlyphInfo info{};
-	auto fontData = Text::FontRegistry::get_font_data(font);
-	bool hasColor = false;
+	Text::GlyphDiskCacheEntry entry;
 
-	fontData.load_glyph_outline_curve(glyphIndex, thickness, type, [&](auto& outline) {
-		handle_rasterization(outline, info, hasColor, fontData.get_upem());
-	});
+	if (m_diskCache.find(job.diskKey, entry)) {
+		resolve_glyph(info, entry);
+		return info;
+	}
+
+	info.pending = true;
+
+	{
+		std::scoped_lock lock(m_jobMutex);
+		m_jobs.emplace_back(std::move(job));
+	}
 
-	auto* result = info.pPage ? &info.pPage->image : nullptr;
+	m_jobSignal.notify_one();
+
+	return info;
+}
+
+void MSDFTextAtlas::resolve_glyph(GlyphInfo& info, const Text::GlyphDiskCacheEntry& entry) {
+	std::memcpy(info.offset, entry.offset, 2 * sizeof(float));
+	std::memcpy(info.bitmapSize, entry.size, 2 * sizeof(float));
+
+	if (entry.width > 0 && entry.height > 0) {
+		info.pPage = upload_glyph(entry.width, entry.height, entry.pData, info.texCoordExtents, false);
+	}
+}
+
+Image* MSDFTextAtlas::write_glyph_info(const GlyphInfo& info, float* texCoordExtentsOut, float* sizeOut,
+		float* offsetOut, bool& hasColorOut) const {
 	std::memcpy(texCoordExtentsOut, info.texCoordExtents, 4 * sizeof(float));
 	std::memcpy(sizeOut, info.bitmapSize, 2 * sizeof(float));
 	std::memcpy(offsetOut, info.offset, 2 * sizeof(float));
-	hasColorOut = hasColor;
+	hasColorOut = info.pPage ? info.pPage->hasColor : false;
+	return info.pPage ? &info.pPage->image : nullptr;
+}
 
-	m_strokes.emplace(std::make_pair(std::move(key), std::move(info)));
+uint64_t MSDFTextAtlas::get_font_hash(const Text::SingleScriptFont& font) {
+	if (auto it = m_fontHashes.find(font.face.handle); it != m_fontHashes.end()) {
+		return it->second;
+	}
 
-	return result;
+	// Faces are loaded from memory, so the stream holds the entire font file
+	auto fontData = Text::FontRegistry::get_font_data(font);
+	auto* stream = fontData.ftFace->stream;
+	auto hash = Text::GlyphDiskCache::hash_font_data(stream->base, stream->size,
+			static_cast<uint32_t>(fontData.ftFace->face_index));
+
+	m_fontHashes.emplace(font.face.handle, hash);
+
+	return hash;
+}
+
+void MSDFTextAtlas::worker_main() {
+	for (;;) {
+		GenerateJob job;
+
+		{
+			std::unique_lock lock(m_jobMutex);
+			m_jobSignal.wait(lock, [&] { return m_stopping || !m_jobs.empty(); });
+
+			if (m_stopping) {
+				return;
+			}
+
+			job = std::move(m_jobs.front());
+			m_jobs.pop_front();
+		}
+
+		generate(job);
+
+		std::scoped_lock lock(m_jobMutex);
+		m_completedJobs.emplace_back(std::move(job));
+	}
 }
 
-MSDFTextAtlas::Page* MSDFTextAtlas::upload_glyph(const Bitmap& bitmap, float* texCoordExtentsOut,
-		bool hasColor) {
-	auto padWidth = bitmap.get_width() + TEXTURE_PADDING;
-	auto padHeight = bitmap.get_height() + TEXTURE_PADDING;
+void MSDFTextAtlas::generate(const GenerateJob& job) {
+	auto fontData = Text::FontRegistry::get_font_data(job.font);
+	msdfgen::Shape shape{};
+	Bitmap bitmap;
+	float offset[2]{};
+
+	auto func = [&](auto& outline) {
+		bitmap = load_msdf_shape(shape, outline, offset, fontData.get_upem());
+	};
+
+	if (job.isStroke) {
+		fontData.load_glyph_outline_curve(job.diskKey.glyphID, job.diskKey.strokeThickness,
+				job.diskKey.strokeJoins, func);
+	}
+	else {
+		fontData.load_glyph_curve(job.diskKey.glyphID, func);
+	}
+
+	// Empty glyphs are stored too, so that later runs do not regenerate them
+	m_diskCache.insert(job.diskKey, {
+		.pData = reinterpret_cast<const std::byte*>(bitmap.data()),
+		.offset = {offset[0], offset[1]},
+		.size = {static_cast<float>(bitmap.get_width()), static_cast<float>(bitmap.get_height())},
+		.width = bitmap.get_width(),
+		.height = bitmap.get_height(),
+		.channels = sizeof(uint32_t),
+	});
+}
+
+MSDFTextAtlas::Page* MSDFTextAtlas::upload_glyph(uint32_t width, uint32_t height, const void* data,
+		float* texCoordExtentsOut, bool hasColor) {
+	auto padWidth = width + TEXTURE_PADDING;
+	auto padHeight = height + TEXTURE_PADDING;
 	auto* pPage = get_or_create_target_page(padWidth, padHeight, hasColor);
 
 	if (pPage->xOffset + padWidth > TEXTURE_EXTENT) {
@@ -128,13 +271,12 @@ MSDFTextAtlas::Page* MSDFTextAtlas::upload_glyph(const Bitmap& bitmap, float* te
 		pPage->lineHeight = padHeight;
 	}
 
-	pPage->image.write(static_cast<int>(pPage->xOffset), static_cast<int>(pPage->yOffset), bitmap.get_width(),
-			bitmap.get_height(), bitmap.data());
+	pPage->image.write(static_cast<int>(pPage->xOffset), static_cast<int>(pPage->yOffset), width, height, data);
 
 	texCoordExtentsOut[0] = static_cast<float>(pPage->xOffset) / static_cast<float>(TEXTURE_EXTENT);
 	texCoordExtentsOut[1] = static_cast<float>(pPage->yOffset) / static_cast<float>(TEXTURE_EXTENT);
-	texCoordExtentsOut[2] = static_cast<float>(bitmap.get_width()) / static_cast<float>(TEXTURE_EXTENT);
-	texCoordExtentsOut[3] = static_cast<float>(bitmap.get_height()) / static_cast<float>(TEXTURE_EXTENT);
+	texCoordExtentsOut[2] = static_cast<float>(width) / static_cast<float>(TEXTURE_EXTENT);
+	texCoordExtentsOut[3] = static_cast<float>(height) / static_cast<float>(TEXTURE_EXTENT);
 
 	pPage->xOffset += padWidth;
 
@@ -145,18 +287,6 @@ MSDFTextAtlas::Page* MSDFTextAtlas::upload_glyph(const Bitmap& bitmap, float* te
 	return pPage;
 }
 
-void MSDFTextAtlas::handle_rasterization(FT_Outline& outline, GlyphInfo& info, bool& hasColor, int32_t upem) {
-	msdfgen::Shape shape{};
-	auto bitmap = load_msdf_shape(shape, outline, info.offset, upem);
-	info.bitmapSize[0] = static_cast<float>(bitmap.get_width());
-	info.bitmapSize[1] = static_cast<float>(bitmap.get_height());
-	hasColor = false;
-
-	if (bitmap.get_width() > 0 && bitmap.get_height() > 0) {
-		info.pPage = upload_glyph(bitmap, info.texCoordExtents, hasColor);
-	}
-}
-
 MSDFTextAtlas::Page* MSDFTextAtlas::get_or_create_target_page(uint32_t width, uint32_t height, bool hasColor) {
 	for (auto& pPage : m_pages) {
 		if (pPage->hasColor == hasColor && page_can_fit_glyph(*pPage, width, height)) {
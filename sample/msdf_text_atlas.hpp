@@ -1,18 +1,38 @@
 #pragma once
 
 #include "font.hpp"
+#include "glyph_disk_cache.hpp"
 #include "image.hpp"
 #include "stroke_type.hpp"
 
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include <unordered_map>
 
-class Bitmap;
-struct FT_Outline_;
-
+/**
+ * Distance field glyphs are persisted to a cache file between runs. Glyphs missing from the file are generated
+ * on background threads, and are drawn from the frame after they finish.
+ */
 class MSDFTextAtlas final {
 	public:
+		explicit MSDFTextAtlas();
+		~MSDFTextAtlas();
+
+		MSDFTextAtlas(MSDFTextAtlas&&) = delete;
+		void operator=(MSDFTextAtlas&&) = delete;
+
+		MSDFTextAtlas(const MSDFTextAtlas&) = delete;
+		void operator=(const MSDFTextAtlas&) = delete;
+
+		/**
+		 * Uploads glyphs whose generation finished since the previous frame.
+		 */
+		void begin_frame();
+
 		Image* get_glyph_info(Text::SingleScriptFont, uint32_t glyphIndex, float* texCoordExtentsOut,
 				float* sizeOut, float* offsetOut, bool& hasColorOut);
 		Image* get_stroke_info(Text::SingleScriptFont, uint32_t glyphIndex, uint8_t thickness,
@@ -37,6 +57,8 @@ class MSDFTextAtlas final {
 			float offset[2];
 			uint32_t pageIndex;
 			Page* pPage;
+			// Set while the glyph is being generated in the background
+			bool pending;
 		};
 
 		struct GlyphKey {
@@ -64,15 +86,41 @@ class MSDFTextAtlas final {
 			size_t operator()(const StrokeKey&) const;
 		};
 
+		struct GenerateJob {
+			Text::SingleScriptFont font;
+			Text::GlyphDiskCacheKey diskKey;
+			GlyphKey glyphKey;
+			StrokeKey strokeKey;
+			bool isStroke;
+		};
+
 		std::vector<std::unique_ptr<Page>> m_pages;
 		std::unordered_map<GlyphKey, GlyphInfo, GlyphKeyHash> m_glyphs;
 		std::unordered_map<StrokeKey, GlyphInfo, StrokeKeyHash> m_strokes;
+		std::unordered_map<Text::FaceIndex_T, uint64_t> m_fontHashes;
+
+		Text::GlyphDiskCache m_diskCache;
+
+		std::vector<std::thread> m_workers;
+		std::mutex m_jobMutex;
+		std::condition_variable m_jobSignal;
+		std::deque<GenerateJob> m_jobs;
+		std::vector<GenerateJob> m_completedJobs;
+		bool m_stopping{};
 
 		Image m_defaultImage;
 
-		void handle_rasterization(FT_Outline_&, GlyphInfo&, bool& hasColor, int32_t upem);
+		GlyphInfo load_or_enqueue(GenerateJob&&);
+		void resolve_glyph(GlyphInfo&, const Text::GlyphDiskCacheEntry&);
+		Image* write_glyph_info(const GlyphInfo&, float* texCoordExtentsOut, float* sizeOut, float* offsetOut,
+				bool& hasColorOut) const;
+		uint64_t get_font_hash(const Text::SingleScriptFont&);
+
+		void worker_main();
+		void generate(const GenerateJob&);
 
-		Page* upload_glyph(const Bitmap&, float* texCoordExtentsOut, bool hasColor);
+		Page* upload_glyph(uint32_t width, uint32_t height, const void* data, float* texCoordExtentsOut,
+				bool hasColor);
 		Page* get_or_create_target_page(uint32_t width, uint32_t height, bool hasColor);
 
 		static bool page_can_fit_glyph(Page&, uint32_t width, uint32_t height);
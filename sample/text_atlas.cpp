@@ -7,97 +7,117 @@
 
 #include <cstring>
 
-static constexpr const size_t HASH_BASE = 0xCBF29CE484222325ull;
-static constexpr const size_t HASH_MULTIPLIER = 0x100000001B3ull;
-
 static constexpr uint32_t TEXTURE_EXTENT = 2048u;
 static constexpr uint32_t TEXTURE_PADDING = 1u;
+// Bounds GPU memory at 64 MiB of RGBA8 pages; beyond this, the least recently used page is recycled
+static constexpr uint32_t MAX_PAGE_COUNT = 4u;
+// Pages unused for this many frames are recycled before a new page is created
+static constexpr uint32_t IDLE_FRAME_LIMIT = 600u;
+
+static constexpr uint32_t PAGE_CLASS_MONO = 0u;
+static constexpr uint32_t PAGE_CLASS_COLOR = 1u;
 
 // TextAtlas
 
-TextAtlas::TextAtlas() {
+TextAtlas::TextAtlas()
+		: m_packer({
+			.pageWidth = TEXTURE_EXTENT,
+			.pageHeight = TEXTURE_EXTENT,
+			.padding = TEXTURE_PADDING,
+			.maxPageCount = MAX_PAGE_COUNT,
+			.idleFrameLimit = IDLE_FRAME_LIMIT,
+			.pfnEvict = on_evict,
+			.pfnPageReset = on_page_reset,
+			.pUserData = this,
+		}) {
 	uint8_t imageData[8 * 8 * 4];
 	std::memset(imageData, 0xFF, 8 * 8 * 4);
 	m_defaultImage = Image(GL_RGBA8, GL_RGBA, 8, 8, GL_UNSIGNED_BYTE, imageData);
 }
 
+void TextAtlas::begin_frame() {
+	m_packer.begin_frame();
+}
+
 Image* TextAtlas::get_glyph_info(Text::SingleScriptFont font, uint32_t glyphIndex, float* texCoordExtentsOut,
 		float* sizeOut, float* offsetOut, bool& hasColorOut) {
-	GlyphKey key{font.get_effective_size(), glyphIndex, font.face.handle, font.weight, font.style};
-
-	if (auto it = m_glyphs.find(key); it != m_glyphs.end()) {
-		std::memcpy(texCoordExtentsOut, it->second.texCoordExtents, 4 * sizeof(float));
-		std::memcpy(sizeOut, it->second.bitmapSize, 2 * sizeof(float));
-		std::memcpy(offsetOut, it->second.offset, 2 * sizeof(float));
-		hasColorOut = it->second.pPage ? it->second.pPage->hasColor : false;
-		offsetOut[1] += font.get_baseline_offset();
-		return &it->second.pPage->image;
-	}
-
-	GlyphInfo info{};
-	auto fontData = Text::FontRegistry::get_font_data(font);
-	bool hasColor = false;
+	return get_or_rasterize(font, Text::GlyphCacheKey::make(font, glyphIndex), texCoordExtentsOut, sizeOut,
+			offsetOut, hasColorOut, [&](const auto& fontData, auto&& func) {
+		fontData.rasterize_glyph(glyphIndex, func);
+	});
+}
 
-	fontData.rasterize_glyph(glyphIndex, [&](const auto& rasterInfo) {
-		handle_rasterization(rasterInfo, info, hasColor);
+Image* TextAtlas::get_stroke_info(Text::SingleScriptFont font, uint32_t glyphIndex, uint8_t thickness,
+		Text::StrokeType type, float* texCoordExtentsOut, float* sizeOut, float* offsetOut, bool& hasColorOut) {
+	return get_or_rasterize(font, Text::GlyphCacheKey::make(font, glyphIndex, thickness, type),
+			texCoordExtentsOut, sizeOut, offsetOut, hasColorOut, [&](const auto& fontData, auto&& func) {
+		fontData.rasterize_glyph_outline(glyphIndex, thickness, type, func);
 	});
+}
 
-	auto* result = info.pPage ? &info.pPage->image : nullptr;
-	std::memcpy(texCoordExtentsOut, info.texCoordExtents, 4 * sizeof(float));
-	std::memcpy(sizeOut, info.bitmapSize, 2 * sizeof(float));
-	std::memcpy(offsetOut, info.offset, 2 * sizeof(float));
-	hasColorOut = hasColor;
+Image* TextAtlas::get_default_texture() {
+	return &m_defaultImage;
+}
 
-	m_glyphs.emplace(std::make_pair(std::move(key), std::move(info)));
+template <typename Functor>
+Image* TextAtlas::get_or_rasterize(const Text::SingleScriptFont& font, const Text::GlyphCacheKey& key,
+		float* texCoordExtentsOut, float* sizeOut, float* offsetOut, bool& hasColorOut, Functor&& rasterize) {
+	auto it = m_glyphs.find(key);
+	GlyphInfo uncachedInfo{};
+	GlyphInfo* pInfo;
 
-	offsetOut[1] += font.get_baseline_offset();
-	return result;
-}
+	if (it == m_glyphs.end()) {
+		uncachedInfo.allocationID = Text::AtlasPacker::INVALID_ALLOCATION;
+		auto fontData = Text::FontRegistry::get_font_data(font);
 
-Image* TextAtlas::get_stroke_info(Text::SingleScriptFont font, uint32_t glyphIndex, uint8_t thickness,
-		Text::StrokeType type, float* texCoordExtentsOut, float* sizeOut, float* offsetOut, bool& hasColorOut) {
-	StrokeKey key{font.get_effective_size(), glyphIndex, font.face.handle, thickness, type};
-
-	if (auto it = m_strokes.find(key); it != m_strokes.end()) {
-		std::memcpy(texCoordExtentsOut, it->second.texCoordExtents, 4 * sizeof(float));
-		std::memcpy(sizeOut, it->second.bitmapSize, 2 * sizeof(float));
-		std::memcpy(offsetOut, it->second.offset, 2 * sizeof(float));
-		hasColorOut = it->second.pPage ? it->second.pPage->hasColor : false;
-		offsetOut[1] += font.get_baseline_offset();
-		return &it->second.pPage->image;
-	}
+		rasterize(fontData, [&](const auto& rasterInfo) {
+			handle_rasterization(rasterInfo, key, uncachedInfo);
+		});
 
-	GlyphInfo info{};
-	bool hasColor = false;
-	auto fontData = Text::FontRegistry::get_font_data(font);
+		// A glyph with a bitmap but no allocation found every page in use this frame. It is left uncached so
+		// that it is retried once pages can be recycled again.
+		bool isEmpty = uncachedInfo.bitmapSize[0] == 0.f || uncachedInfo.bitmapSize[1] == 0.f;
 
-	fontData.rasterize_glyph_outline(glyphIndex, thickness, type, [&](const auto& rasterInfo) {
-		handle_rasterization(rasterInfo, info, hasColor);
-	});
+		if (uncachedInfo.allocationID != Text::AtlasPacker::INVALID_ALLOCATION || isEmpty) {
+			pInfo = &m_glyphs.emplace(key, uncachedInfo).first->second;
+		}
+		else {
+			pInfo = &uncachedInfo;
+		}
+	}
+	else {
+		pInfo = &it->second;
 
-	auto* result = info.pPage ? &info.pPage->image : nullptr;
+		if (pInfo->allocationID != Text::AtlasPacker::INVALID_ALLOCATION) {
+			m_packer.touch(pInfo->allocationID);
+		}
+	}
+
+	auto& info = *pInfo;
 	std::memcpy(texCoordExtentsOut, info.texCoordExtents, 4 * sizeof(float));
 	std::memcpy(sizeOut, info.bitmapSize, 2 * sizeof(float));
 	std::memcpy(offsetOut, info.offset, 2 * sizeof(float));
-	hasColorOut = hasColor;
-
-	m_strokes.emplace(std::make_pair(std::move(key), std::move(info)));
-
+	hasColorOut = info.hasColor;
 	offsetOut[1] += font.get_baseline_offset();
-	return result;
-}
 
-Image* TextAtlas::get_default_texture() {
-	return &m_defaultImage;
+	if (info.allocationID == Text::AtlasPacker::INVALID_ALLOCATION) {
+		return nullptr;
+	}
+
+	return m_pages[m_packer.get_rect(info.allocationID).page].get();
 }
 
-void TextAtlas::handle_rasterization(const Text::FontRasterizeInfo& rasterInfo, GlyphInfo& info,
-		bool& hasColor) {
+void TextAtlas::handle_rasterization(const Text::FontRasterizeInfo& rasterInfo, const Text::GlyphCacheKey& key,
+		GlyphInfo& info) {
 	info.bitmapSize[0] = static_cast<float>(rasterInfo.width);
 	info.bitmapSize[1] = static_cast<float>(rasterInfo.height);
 	info.offset[0] = rasterInfo.offsetX;
 	info.offset[1] = rasterInfo.offsetY;
-	hasColor = rasterInfo.format == Text::FontRasterFormat::BGRA8;
+	info.hasColor = rasterInfo.format == Text::FontRasterFormat::BGRA8;
+
+	if (rasterInfo.width == 0 || rasterInfo.height == 0) {
+		return;
+	}
 
 	Bitmap bitmap(rasterInfo.width, rasterInfo.height);
 
@@ -121,101 +141,43 @@ void TextAtlas::handle_rasterization(const Text::FontRasterizeInfo& rasterInfo,
 		}
 	}
 
-	if (rasterInfo.width > 0 && rasterInfo.height > 0) {
-		info.pPage = upload_glyph(bitmap, info.texCoordExtents, hasColor);
-	}
-}
+	Text::AtlasRect rect;
+	auto allocationID = m_packer.allocate(rasterInfo.width, rasterInfo.height,
+			info.hasColor ? PAGE_CLASS_COLOR : PAGE_CLASS_MONO, rect);
 
-TextAtlas::Page* TextAtlas::upload_glyph(const Bitmap& bitmap, float* texCoordExtentsOut, bool hasColor) {
-	auto padWidth = bitmap.get_width() + TEXTURE_PADDING;
-	auto padHeight = bitmap.get_height() + TEXTURE_PADDING;
-	auto* pPage = get_or_create_target_page(padWidth, padHeight, hasColor);
-
-	if (pPage->xOffset + padWidth > TEXTURE_EXTENT) {
-		pPage->xOffset = 0;
-		pPage->yOffset += pPage->lineHeight;
-		pPage->lineHeight = padHeight;
+	if (allocationID == Text::AtlasPacker::INVALID_ALLOCATION) {
+		return;
 	}
 
-	pPage->image.write(static_cast<int>(pPage->xOffset), static_cast<int>(pPage->yOffset), bitmap.get_width(),
-			bitmap.get_height(), bitmap.data());
-
-	texCoordExtentsOut[0] = static_cast<float>(pPage->xOffset) / static_cast<float>(TEXTURE_EXTENT);
-	texCoordExtentsOut[1] = static_cast<float>(pPage->yOffset) / static_cast<float>(TEXTURE_EXTENT);
-	texCoordExtentsOut[2] = static_cast<float>(bitmap.get_width()) / static_cast<float>(TEXTURE_EXTENT);
-	texCoordExtentsOut[3] = static_cast<float>(bitmap.get_height()) / static_cast<float>(TEXTURE_EXTENT);
-
-	pPage->xOffset += padWidth;
-
-	if (pPage->lineHeight < padHeight) {
-		pPage->lineHeight = padHeight;
+	if (allocationID >= m_allocationKeys.size()) {
+		m_allocationKeys.resize(allocationID + 1);
 	}
 
-	return pPage;
-}
-
-TextAtlas::Page* TextAtlas::get_or_create_target_page(uint32_t width, uint32_t height, bool hasColor) {
-	for (auto& pPage : m_pages) {
-		if (pPage->hasColor == hasColor && page_can_fit_glyph(*pPage, width, height)) {
-			return pPage.get();
-		}
-	}
-
-	auto page = std::make_unique<Page>();
-	page->image = Image(GL_RGBA8, GL_RGBA, TEXTURE_EXTENT, TEXTURE_EXTENT, GL_UNSIGNED_BYTE);
-	page->xOffset = 0;
-	page->yOffset = 0;
-	page->lineHeight = 0;
-	page->hasColor = hasColor;
-
-	auto* pPage = page.get();
-	m_pages.emplace_back(std::move(page));
-
-	return pPage;
-}
-
-bool TextAtlas::page_can_fit_glyph(Page& page, uint32_t width, uint32_t height) {
-	return (page.xOffset + width <= TEXTURE_EXTENT && page.yOffset + height <= TEXTURE_EXTENT)
-		|| (width <= TEXTURE_EXTENT && page.yOffset + page.lineHeight + height <= TEXTURE_EXTENT);
-}
+	m_allocationKeys[allocationID] = key;
+	info.allocationID = allocationID;
 
-// TextAtlas::GlyphKey
+	m_pages[rect.page]->write(static_cast<int>(rect.x), static_cast<int>(rect.y), bitmap.get_width(),
+			bitmap.get_height(), bitmap.data());
 
-bool TextAtlas::GlyphKey::operator==(const GlyphKey& o) const {
-	return size == o.size && glyphIndex == o.glyphIndex && face == o.face && weight == o.weight
-			&& style == o.style;
+	info.texCoordExtents[0] = static_cast<float>(rect.x) / static_cast<float>(TEXTURE_EXTENT);
+	info.texCoordExtents[1] = static_cast<float>(rect.y) / static_cast<float>(TEXTURE_EXTENT);
+	info.texCoordExtents[2] = static_cast<float>(rect.width) / static_cast<float>(TEXTURE_EXTENT);
+	info.texCoordExtents[3] = static_cast<float>(rect.height) / static_cast<float>(TEXTURE_EXTENT);
 }
 
-// TextAtlas::GlyphKeyHash
-
-size_t TextAtlas::GlyphKeyHash::operator()(const GlyphKey& k) const {
-	// FNV-11a
-	size_t hash = HASH_BASE;
-	hash = static_cast<size_t>(hash * HASH_MULTIPLIER) ^ static_cast<size_t>(k.size);
-	hash = static_cast<size_t>(hash * HASH_MULTIPLIER) ^ static_cast<size_t>(k.glyphIndex);
-	hash = static_cast<size_t>(hash * HASH_MULTIPLIER) ^ static_cast<size_t>(k.face);
-	hash = static_cast<size_t>(hash * HASH_MULTIPLIER) ^ static_cast<size_t>(k.weight);
-	hash = static_cast<size_t>(hash * HASH_MULTIPLIER) ^ static_cast<size_t>(k.style);
-	return hash;
+void TextAtlas::on_evict(uint32_t allocationID, void* pUserData) {
+	auto& atlas = *static_cast<TextAtlas*>(pUserData);
+	atlas.m_glyphs.erase(atlas.m_allocationKeys[allocationID]);
 }
 
-// TextAtlas::StrokeKey
+void TextAtlas::on_page_reset(uint32_t page, uint32_t, void* pUserData) {
+	auto& atlas = *static_cast<TextAtlas*>(pUserData);
 
-bool TextAtlas::StrokeKey::operator==(const StrokeKey& o) const {
-	return glyphSize == o.glyphSize && glyphIndex == o.glyphIndex && face == o.face
-			&& strokeSize == o.strokeSize && type == o.type;
-}
+	if (page >= atlas.m_pages.size()) {
+		atlas.m_pages.emplace_back(std::make_unique<Image>(GL_RGBA8, GL_RGBA, TEXTURE_EXTENT, TEXTURE_EXTENT,
+				GL_UNSIGNED_BYTE));
+	}
 
-// TextAtlas::StrokeKeyHash
-
-size_t TextAtlas::StrokeKeyHash::operator()(const StrokeKey& k) const {
-	// FNV-11a
-	size_t hash = HASH_BASE;
-	hash = static_cast<size_t>(hash * HASH_MULTIPLIER) ^ static_cast<size_t>(k.glyphSize);
-	hash = static_cast<size_t>(hash * HASH_MULTIPLIER) ^ static_cast<size_t>(k.glyphIndex);
-	hash = static_cast<size_t>(hash * HASH_MULTIPLIER) ^ static_cast<size_t>(k.face);
-	hash = static_cast<size_t>(hash * HASH_MULTIPLIER) ^ static_cast<size_t>(k.strokeSize);
-	hash = static_cast<size_t>(hash * HASH_MULTIPLIER) ^ static_cast<size_t>(k.type);
-	return hash;
+	// Recycled pages are cleared so that stale texels never bleed into the padding of new glyphs
+	atlas.m_pages[page]->clear();
 }
-
@@ -1,6 +1,8 @@
 #pragma once
 
+#include "atlas_packer.hpp"
 #include "font.hpp"
+#include "glyph_cache.hpp"
 #include "image.hpp"
 #include "stroke_type.hpp"
 
@@ -15,6 +17,12 @@ class TextAtlas final {
 	public:
 		explicit TextAtlas();
 
+		/**
+		 * Marks the start of a frame. Glyphs not requested since the previous frame become candidates for
+		 * eviction.
+		 */
+		void begin_frame();
+
 		Image* get_glyph_info(Text::SingleScriptFont, uint32_t glyphIndex, float* texCoordExtentsOut,
 				float* sizeOut, float* offsetOut, bool& hasColorOut);
 		Image* get_stroke_info(Text::SingleScriptFont, uint32_t glyphIndex, uint8_t thickness,
@@ -23,62 +31,31 @@ class TextAtlas final {
 
 		Image* get_default_texture();
 	private:
-		struct Page {
-			Image image;
-			uint32_t xOffset;
-			uint32_t yOffset;
-			uint32_t lineHeight;
-			bool hasColor;
-		};
-
 		struct GlyphInfo {
 			float texCoordExtents[4];
 			float bitmapSize[2];
 			float offset[2];
-			uint32_t pageIndex;
-			Page* pPage;
-		};
-
-		struct GlyphKey {
-			uint32_t size;
-			uint32_t glyphIndex;
-			Text::FaceIndex_T face;
-			Text::FontWeight weight;
-			Text::FontStyle style;
-
-			bool operator==(const GlyphKey&) const;
-		};
-
-		struct GlyphKeyHash {
-			size_t operator()(const GlyphKey&) const;
-		};
-
-		struct StrokeKey {
-			uint32_t glyphSize;
-			uint32_t glyphIndex;
-			Text::FaceIndex_T face;
-			uint8_t strokeSize;
-			Text::StrokeType type;
-
-			bool operator==(const StrokeKey&) const;
-		};
-
-		struct StrokeKeyHash {
-			size_t operator()(const StrokeKey&) const;
+			// `Text::AtlasPacker::INVALID_ALLOCATION` for glyphs with no bitmap
+			uint32_t allocationID;
+			bool hasColor;
 		};
 
-		std::vector<std::unique_ptr<Page>> m_pages;
-		std::unordered_map<GlyphKey, GlyphInfo, GlyphKeyHash> m_glyphs;
-		std::unordered_map<StrokeKey, GlyphInfo, StrokeKeyHash> m_strokes;
+		Text::AtlasPacker m_packer;
+		std::vector<std::unique_ptr<Image>> m_pages;
+		std::unordered_map<Text::GlyphCacheKey, GlyphInfo, Text::GlyphCacheKeyHash> m_glyphs;
+		// Key owning each packer allocation, so that evicted allocations can be dropped from `m_glyphs`
+		std::vector<Text::GlyphCacheKey> m_allocationKeys;
 
 		Image m_defaultImage;
 
-		void handle_rasterization(const Text::FontRasterizeInfo&, GlyphInfo&, bool& hasColor);
+		template <typename Functor>
+		Image* get_or_rasterize(const Text::SingleScriptFont&, const Text::GlyphCacheKey&, float* texCoordExtentsOut,
+				float* sizeOut, float* offsetOut, bool& hasColorOut, Functor&& rasterize);
 
-		Page* upload_glyph(const Bitmap&, float* texCoordExtentsOut, bool hasColor);
-		Page* get_or_create_target_page(uint32_t width, uint32_t height, bool hasColor);
+		void handle_rasterization(const Text::FontRasterizeInfo&, const Text::GlyphCacheKey&, GlyphInfo&);
 
-		static bool page_can_fit_glyph(Page&, uint32_t width, uint32_t height);
+		static void on_evict(uint32_t allocationID, void* pUserData);
+		static void on_page_reset(uint32_t page, uint32_t pageClass, void* pUserData);
 };
 
 inline TextAtlas* g_textAtlas{};
@@ -10,6 +10,14 @@ std::shared_ptr<TextBox> TextBox::create() {
 	return std::make_shared<TextBox>();
 }
 
+TextBox::TextBox() {
+	m_document.add_listener(on_document_changed, this);
+}
+
+TextBox::~TextBox() {
+	m_document.remove_listener(on_document_changed, this);
+}
+
 bool TextBox::handle_mouse_button(UIContainer& container, int button, int action, int mods, double mouseX,
 		double mouseY) {
 	if (button != GLFW_MOUSE_BUTTON_1) {
@@ -304,7 +312,7 @@ void TextBox::handle_key_delete(bool ctrl) {
 	if (m_selectionStart.is_valid()) {
 		remove_highlighted_text();
 	}
-	else if (m_cursorPosition.get_position() < m_text.size()) {
+	else if (m_cursorPosition.get_position() < m_document.get_length()) {
 		auto startPos = m_cursorPosition;
 
 		if (ctrl) {
@@ -358,7 +366,8 @@ void TextBox::clipboard_copy_text() {
 		std::swap(startPos, endPos);
 	}
 
-	auto str = m_text.substr(startPos, endPos - startPos);
+	std::string str;
+	m_document.get_text(startPos, endPos - startPos, str);
 	glfwSetClipboardString(NULL, str.c_str());
 }
 
@@ -385,20 +394,11 @@ void TextBox::insert_typed_character(unsigned codepoint) {
 void TextBox::insert_text(const std::string& text, uint32_t startIndex) {
 	m_cursorPosition = {static_cast<uint32_t>(m_cursorPosition.get_position() + text.size())};
 
-	if (startIndex < m_text.size()) {
-		auto before = m_text.substr(0, startIndex);
-		auto after = m_text.substr(startIndex);
-		set_text(before + text + after);
-	}
-	else {
-		set_text(m_text + text);
-	}
+	m_document.insert(startIndex, text);
 }
 
 void TextBox::remove_text(uint32_t startIndex, uint32_t endIndex) {
-	auto before = m_text.substr(0, startIndex);
-	auto after = m_text.substr(endIndex);
-	set_text(before + after);
+	m_document.erase(startIndex, endIndex - startIndex);
 }
 
 void TextBox::remove_highlighted_text() {
@@ -418,20 +418,31 @@ void TextBox::remove_highlighted_text() {
 }
 
 void TextBox::recalc_text() {
-	bool richText = is_focused() ? should_focused_use_rich_text() : m_richText;
-
-	m_visualCursorInfo = {};
+	m_formattedAsRichText = is_focused() ? should_focused_use_rich_text() : m_richText;
 
 	if (!m_font) {
+		m_visualCursorInfo = {};
 		return;
 	}
 
 	Text::StrokeState strokeState{};
-	m_formatting = richText
-			? Text::parse_inline_formatting(m_text, m_contentText, m_font, m_textColor, strokeState)
-			: Text::make_default_formatting_runs(m_text, m_contentText, m_font, m_textColor, strokeState);
 
-	auto& text = richText ? m_contentText : m_text;
+	if (m_formattedAsRichText) {
+		m_formattingParser.parse(m_text, m_contentText, m_formatting, m_sourceMap, m_font, m_textColor,
+				strokeState);
+	}
+	else {
+		m_formatting = Text::make_default_formatting_runs(static_cast<int32_t>(m_text.size()), m_font,
+				m_textColor, strokeState);
+	}
+
+	recalc_layout();
+}
+
+void TextBox::recalc_layout() {
+	m_visualCursorInfo = {};
+
+	std::string_view text = m_formattedAsRichText ? m_contentText : m_text;
 	m_cursorCtrl.set_text(text);
 
 	if (text.empty()) {
@@ -451,11 +462,44 @@ void TextBox::recalc_text() {
 		.pSubscriptRuns = &m_formatting.subscriptRuns,
 		.pSuperscriptRuns = &m_formatting.superscriptRuns,
 	};
-	builder.build_layout_info(m_layout, text.data(), text.size(), m_formatting.fontRuns, params);
+
+	if (m_formattedAsRichText) {
+		builder.build_layout_info(m_layout, text.data(), text.size(), m_formatting.fontRuns, params);
+	}
+	else {
+		// Plain text is the document itself, so it is laid out from its pieces without flattening it again
+		m_document.get_chunks(m_chunks);
+		builder.build_layout_info(m_layout, m_chunks, m_formatting.fontRuns, params);
+	}
 
 	m_visualCursorInfo = m_layout.calc_cursor_pixel_pos(get_size()[0], m_textXAlignment, m_cursorPosition);
 }
 
+void TextBox::on_document_changed(const Text::TextDocument& document, const Text::SourceEdit& edit,
+		void* pUserData) {
+	auto& textBox = *static_cast<TextBox*>(pUserData);
+
+	std::string insertedText;
+	document.get_text(edit.start, edit.insertedLength, insertedText);
+	textBox.m_text.replace(edit.start, edit.removedLength, insertedText);
+
+	bool richText = textBox.is_focused() ? textBox.should_focused_use_rich_text() : textBox.m_richText;
+
+	// Rich text is only shown while the text box is not being edited, so its edits come from `set_text`, which
+	// replaces the whole text and needs a full parse anyway
+	if (!textBox.m_font || richText || textBox.m_formattedAsRichText) {
+		textBox.recalc_text();
+		return;
+	}
+
+	// Plain text skips parsing and copying the text into the runs, but the cursor controller and the layout
+	// are still rebuilt over the whole text
+	Text::StrokeState strokeState{};
+	textBox.m_formatting = Text::make_default_formatting_runs(static_cast<int32_t>(textBox.m_text.size()),
+			textBox.m_font, textBox.m_textColor, strokeState);
+	textBox.recalc_layout();
+}
+
 // Setters
 
 void TextBox::set_font(Text::Font font) {
@@ -464,8 +508,7 @@ void TextBox::set_font(Text::Font font) {
 }
 
 void TextBox::set_text(std::string text) {
-	m_text = std::move(text);
-	recalc_text();
+	m_document.set_text(std::move(text));
 }
 
 void TextBox::set_text_x_alignment(Text::XAlignment align) {
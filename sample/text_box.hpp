@@ -3,12 +3,16 @@
 #include "cursor_controller.hpp"
 #include "layout_info.hpp"
 #include "formatting.hpp"
+#include "text_document.hpp"
 #include "ui_object.hpp"
 
 class TextBox final : public UIObject {
 	public:
 		static std::shared_ptr<TextBox> create();
 
+		TextBox();
+		~TextBox();
+
 		bool handle_mouse_button(UIContainer&, int button, int action, int mods, double mouseX,
 				double mouseY) override;
 		bool handle_key_press(UIContainer&, int key, int action, int mods) override;
@@ -34,8 +38,12 @@ class TextBox final : public UIObject {
 		void set_selectable(bool);
 	private:
 		Text::Font m_font{};
+		Text::TextDocument m_document;
+		// Flattened copy of `m_document`, kept in step with each edit by `on_document_changed`
 		std::string m_text{};
 		std::string m_contentText{};
+		// Pieces of `m_document`, from which plain text is laid out
+		std::vector<std::string_view> m_chunks;
 		Text::Color m_textColor{0.f, 0.f, 0.f, 1.f};
 		Text::CursorPosition m_cursorPosition{};
 		Text::CursorPosition m_selectionStart{Text::CursorPosition::INVALID_VALUE};
@@ -47,9 +55,13 @@ class TextBox final : public UIObject {
 		bool m_editable = true;
 		bool m_selectable = true;
 		bool m_dragSelecting = false;
+		// Whether `m_formatting` was last built by parsing `m_text` as rich text
+		bool m_formattedAsRichText = false;
 
 		Text::LayoutInfo m_layout;
 		Text::FormattingRuns m_formatting;
+		Text::FormattingParser m_formattingParser;
+		Text::FormattingSourceMap m_sourceMap;
 		Text::VisualCursorInfo m_visualCursorInfo;
 		Text::CursorController m_cursorCtrl;
 
@@ -92,5 +104,8 @@ class TextBox final : public UIObject {
 		void remove_highlighted_text();
 
 		void recalc_text();
+		void recalc_layout();
+
+		static void on_document_changed(const Text::TextDocument&, const Text::SourceEdit&, void* pUserData);
 };
 
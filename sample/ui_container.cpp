@@ -112,17 +112,12 @@ void UIContainer::draw_text(const Text::LayoutInfo& layout, const Text::Formatti
 			std::swap(selectionStart, selectionEnd);
 		}
 
-		layout.for_each_run(textAreaWidth, textXAlignment, [&](auto lineIndex, auto runIndex,
-				auto lineX, auto lineY) {
-			if (layout.run_contains_char_range(runIndex, selectionStart, selectionEnd)) {
-				auto [minPos, maxPos] = layout.get_position_range_in_run(runIndex, selectionStart,
-						selectionEnd);
-				
-				emit_rect(positionX + lineX + minPos, positionY + lineY
-						- layout.get_line_ascent(lineIndex), maxPos - minPos, layout.get_line_height(lineIndex),
-						Text::Color::from_rgb(0, 120, 215), PipelineIndex::RECT);
-			}
-		});
+		layout.get_selection_rects(selectionStart, selectionEnd, textAreaWidth, textXAlignment, m_selectionRects);
+
+		for (auto& rect : m_selectionRects) {
+			emit_rect(positionX + rect.x, positionY + rect.y, rect.width, rect.height,
+					Text::Color::from_rgb(0, 120, 215), PipelineIndex::RECT);
+		}
 	}
 
 	// Draw main text rects
@@ -5,17 +5,18 @@
 #include "color.hpp"
 #include "cursor_position.hpp"
 #include "font.hpp"
+#include "layout_info.hpp"
 #include "pair.hpp"
 #include "pipeline.hpp"
 #include "text_alignment.hpp"
 #include "ui_object.hpp"
 
 #include <bitset>
+#include <vector>
 
 class TextBox;
 
 namespace Text { struct FormattingRuns; }
-namespace Text { class LayoutInfo; }
 
 class UIContainer final : public UIObject {
 	public:
@@ -79,6 +80,7 @@ class UIContainer final : public UIObject {
 		Text::CursorPosition m_lastClickPos{Text::CursorPosition::INVALID_VALUE};
 
 		Text::LayoutBuilder m_layoutBuilder;
+		std::vector<Text::SelectionRect> m_selectionRects;
 
 		void draw_rect_internal(float x, float y, float width, float height, const float* texCoords,
 				Image* texture, const Text::Color& color, PipelineIndex pipeline);
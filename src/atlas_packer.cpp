@@ -0,0 +1,309 @@
+#include "atlas_packer.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace Text;
+
+static constexpr const uint32_t INVALID_PAGE = ~0u;
+
+// Public Functions
+
+AtlasPacker::AtlasPacker(const AtlasPackerCreateInfo& createInfo)
+		: m_pageWidth(createInfo.pageWidth)
+		, m_pageHeight(createInfo.pageHeight)
+		, m_padding(createInfo.padding)
+		, m_maxPageCount(createInfo.maxPageCount)
+		, m_idleFrameLimit(createInfo.idleFrameLimit)
+		, m_pfnEvict(createInfo.pfnEvict)
+		, m_pfnPageReset(createInfo.pfnPageReset)
+		, m_pUserData(createInfo.pUserData) {}
+
+uint32_t AtlasPacker::allocate(uint32_t width, uint32_t height, uint32_t pageClass, AtlasRect& outRect) {
+	auto padWidth = width + m_padding;
+	auto padHeight = height + m_padding;
+
+	if (padWidth > m_pageWidth || padHeight > m_pageHeight) [[unlikely]] {
+		return INVALID_ALLOCATION;
+	}
+
+	auto& classData = get_page_class_data(pageClass);
+
+	// Consecutive glyphs usually land on the same page, so try the most recent page before searching
+	if (classData.lastPage != INVALID_PAGE
+			&& try_allocate_on_page(classData.lastPage, padWidth, padHeight, outRect)) [[likely]] {
+		return add_allocation(outRect);
+	}
+
+	for (auto page : classData.pages) {
+		if (page != classData.lastPage && m_pages[page].maxFreeHeight >= padHeight
+				&& try_allocate_on_page(page, padWidth, padHeight, outRect)) {
+			classData.lastPage = page;
+			return add_allocation(outRect);
+		}
+	}
+
+	// No page of this class has room. Prefer reusing an idle page, then a new page, then the coldest page.
+	auto targetPage = find_page_to_reclaim(true);
+
+	if (targetPage == INVALID_PAGE && (m_maxPageCount == 0 || m_pages.size() < m_maxPageCount)) {
+		targetPage = static_cast<uint32_t>(m_pages.size());
+		m_pages.push_back({
+			.skyline = {},
+			.allocations = {},
+			.lastUseFrame = 0,
+			.usedArea = 0,
+			.maxFreeHeight = 0,
+			.pageClass = INVALID_PAGE,
+		});
+	}
+
+	if (targetPage == INVALID_PAGE) {
+		targetPage = find_page_to_reclaim(false);
+	}
+
+	if (targetPage == INVALID_PAGE) {
+		return INVALID_ALLOCATION;
+	}
+
+	reset_page(targetPage, pageClass);
+
+	[[maybe_unused]] bool fits = try_allocate_on_page(targetPage, padWidth, padHeight, outRect);
+	assert(fits && "AtlasPacker::allocate(): Padded rect must fit on an empty page");
+
+	get_page_class_data(pageClass).lastPage = targetPage;
+	return add_allocation(outRect);
+}
+
+void AtlasPacker::touch(uint32_t allocationID) {
+	auto& allocation = m_allocations[allocationID];
+	allocation.lastUseFrame = m_currentFrame;
+	m_pages[allocation.rect.page].lastUseFrame = m_currentFrame;
+}
+
+void AtlasPacker::begin_frame() {
+	++m_currentFrame;
+}
+
+void AtlasPacker::clear() {
+	for (uint32_t i = 0; i < m_pages.size(); ++i) {
+		reset_page(i, m_pages[i].pageClass);
+	}
+}
+
+const AtlasRect& AtlasPacker::get_rect(uint32_t allocationID) const {
+	return m_allocations[allocationID].rect;
+}
+
+uint64_t AtlasPacker::get_last_use_frame(uint32_t allocationID) const {
+	return m_allocations[allocationID].lastUseFrame;
+}
+
+uint64_t AtlasPacker::get_current_frame() const {
+	return m_currentFrame;
+}
+
+uint32_t AtlasPacker::get_page_count() const {
+	return static_cast<uint32_t>(m_pages.size());
+}
+
+uint32_t AtlasPacker::get_page_class(uint32_t page) const {
+	return m_pages[page].pageClass;
+}
+
+float AtlasPacker::get_page_occupancy(uint32_t page) const {
+	return static_cast<float>(static_cast<double>(m_pages[page].usedArea)
+			/ (static_cast<double>(m_pageWidth) * static_cast<double>(m_pageHeight)));
+}
+
+uint32_t AtlasPacker::get_allocation_count() const {
+	return m_allocationCount;
+}
+
+bool AtlasPacker::try_allocate_on_page(uint32_t pageIndex, uint32_t width, uint32_t height, AtlasRect& outRect) {
+	auto& page = m_pages[pageIndex];
+	auto& skyline = page.skyline;
+
+	// Bottom-left: place the rect where its top edge is lowest, breaking ties by the narrowest node so that
+	// wide gaps are kept for wide glyphs
+	auto bestIndex = skyline.size();
+	uint32_t bestTop = ~0u;
+	uint32_t bestWidth = ~0u;
+	uint32_t bestY{};
+
+	for (size_t i = 0; i < skyline.size(); ++i) {
+		if (skyline[i].x + width > m_pageWidth) {
+			break;
+		}
+
+		uint32_t y{};
+		uint32_t widthLeft = width;
+
+		for (auto j = i; widthLeft > 0; ++j) {
+			y = std::max(y, skyline[j].y);
+			widthLeft -= std::min(widthLeft, skyline[j].width);
+		}
+
+		if (y + height > m_pageHeight) {
+			continue;
+		}
+
+		if (y + height < bestTop || (y + height == bestTop && skyline[i].width < bestWidth)) {
+			bestIndex = i;
+			bestTop = y + height;
+			bestWidth = skyline[i].width;
+			bestY = y;
+		}
+	}
+
+	if (bestIndex == skyline.size()) {
+		return false;
+	}
+
+	auto x = skyline[bestIndex].x;
+	skyline.insert(skyline.begin() + bestIndex, {x, bestTop, width});
+
+	// Trim the nodes now covered by the new node
+	for (auto i = bestIndex + 1; i < skyline.size();) {
+		auto coveredEnd = skyline[i - 1].x + skyline[i - 1].width;
+
+		if (skyline[i].x >= coveredEnd) {
+			break;
+		}
+
+		auto shrink = coveredEnd - skyline[i].x;
+
+		if (skyline[i].width <= shrink) {
+			skyline.erase(skyline.begin() + i);
+			continue;
+		}
+
+		skyline[i].x += shrink;
+		skyline[i].width -= shrink;
+		break;
+	}
+
+	// Merge neighbours at the same height
+	for (size_t i = 1; i < skyline.size();) {
+		if (skyline[i - 1].y == skyline[i].y) {
+			skyline[i - 1].width += skyline[i].width;
+			skyline.erase(skyline.begin() + i);
+		}
+		else {
+			++i;
+		}
+	}
+
+	uint32_t minY = m_pageHeight;
+
+	for (auto& node : skyline) {
+		minY = std::min(minY, node.y);
+	}
+
+	page.maxFreeHeight = m_pageHeight - minY;
+	page.usedArea += static_cast<uint64_t>(width) * height;
+	page.lastUseFrame = m_currentFrame;
+
+	outRect = {
+		.x = x,
+		.y = bestY,
+		.width = width - m_padding,
+		.height = height - m_padding,
+		.page = pageIndex,
+	};
+
+	return true;
+}
+
+uint32_t AtlasPacker::find_page_to_reclaim(bool idleOnly) const {
+	auto result = INVALID_PAGE;
+	uint64_t oldestFrame = m_currentFrame;
+
+	for (uint32_t i = 0; i < m_pages.size(); ++i) {
+		auto& page = m_pages[i];
+
+		// Empty pages are free to take regardless of when they were last used
+		if (page.allocations.empty()) {
+			return i;
+		}
+
+		if (page.lastUseFrame < oldestFrame
+				&& (!idleOnly || (m_idleFrameLimit > 0 && m_currentFrame - page.lastUseFrame >= m_idleFrameLimit))) {
+			result = i;
+			oldestFrame = page.lastUseFrame;
+		}
+	}
+
+	return result;
+}
+
+void AtlasPacker::reset_page(uint32_t pageIndex, uint32_t pageClass) {
+	auto& page = m_pages[pageIndex];
+
+	for (auto allocationID : page.allocations) {
+		m_allocations[allocationID].nextFree = m_firstFreeAllocation;
+		m_firstFreeAllocation = allocationID;
+		--m_allocationCount;
+
+		if (m_pfnEvict) {
+			m_pfnEvict(allocationID, m_pUserData);
+		}
+	}
+
+	if (page.pageClass != pageClass) {
+		if (page.pageClass != INVALID_PAGE) {
+			auto& oldClass = get_page_class_data(page.pageClass);
+			std::erase(oldClass.pages, pageIndex);
+
+			if (oldClass.lastPage == pageIndex) {
+				oldClass.lastPage = INVALID_PAGE;
+			}
+		}
+
+		get_page_class_data(pageClass).pages.push_back(pageIndex);
+		page.pageClass = pageClass;
+	}
+
+	page.skyline.clear();
+	page.skyline.push_back({0, 0, m_pageWidth});
+	page.allocations.clear();
+	page.lastUseFrame = 0;
+	page.usedArea = 0;
+	page.maxFreeHeight = m_pageHeight;
+
+	if (m_pfnPageReset) {
+		m_pfnPageReset(pageIndex, pageClass, m_pUserData);
+	}
+}
+
+AtlasPacker::PageClass& AtlasPacker::get_page_class_data(uint32_t pageClass) {
+	if (pageClass >= m_pageClasses.size()) [[unlikely]] {
+		m_pageClasses.resize(pageClass + 1, {{}, INVALID_PAGE});
+	}
+
+	return m_pageClasses[pageClass];
+}
+
+uint32_t AtlasPacker::add_allocation(const AtlasRect& rect) {
+	uint32_t allocationID;
+
+	if (m_firstFreeAllocation != INVALID_ALLOCATION) {
+		allocationID = m_firstFreeAllocation;
+		m_firstFreeAllocation = m_allocations[allocationID].nextFree;
+	}
+	else {
+		allocationID = static_cast<uint32_t>(m_allocations.size());
+		m_allocations.emplace_back();
+	}
+
+	m_allocations[allocationID] = {
+		.rect = rect,
+		.lastUseFrame = m_currentFrame,
+		.nextFree = INVALID_ALLOCATION,
+	};
+
+	m_pages[rect.page].allocations.push_back(allocationID);
+	++m_allocationCount;
+
+	return allocationID;
+}
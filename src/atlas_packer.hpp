@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Text {
+
+/**
+ * Notifies the owner of an `AtlasPacker` that an allocation was evicted and its ID may be reused.
+ */
+using PFN_AtlasEvict = void (*)(uint32_t allocationID, void* pUserData);
+/**
+ * Notifies the owner of an `AtlasPacker` that `page` was created or reclaimed for `pageClass`, and its previous
+ * contents should be cleared.
+ */
+using PFN_AtlasPageReset = void (*)(uint32_t page, uint32_t pageClass, void* pUserData);
+
+/**
+ * `padding` is the number of empty texels kept to the right of and below every allocation.
+ *
+ * If `maxPageCount` is 0, the page count is unbounded. Pages unused for at least `idleFrameLimit` frames are
+ * reclaimed before a new page is created; an `idleFrameLimit` of 0 only reclaims pages once `maxPageCount` is
+ * reached.
+ */
+struct AtlasPackerCreateInfo {
+	uint32_t pageWidth;
+	uint32_t pageHeight;
+	uint32_t padding;
+	uint32_t maxPageCount;
+	uint32_t idleFrameLimit;
+	PFN_AtlasEvict pfnEvict;
+	PFN_AtlasPageReset pfnPageReset;
+	void* pUserData;
+};
+
+struct AtlasRect {
+	uint32_t x;
+	uint32_t y;
+	uint32_t width;
+	uint32_t height;
+	uint32_t page;
+};
+
+/**
+ * Packs rectangles into fixed-size texture pages with a bottom-left skyline, independent of any graphics API.
+ *
+ * Each page holds allocations of a single caller-defined class, such as R8 versus color glyphs. Page classes
+ * index an internal table and should be small integers.
+ *
+ * Allocations record the last frame they were used in. Since a skyline cannot return individual rectangles to
+ * free space, space is reclaimed a page at a time by evicting the page whose most recent use is the oldest.
+ * Pages used in the current frame are never reclaimed, so that quads already emitted this frame remain valid.
+ *
+ * @thread_safety This class must be externally synchronized.
+ */
+class AtlasPacker {
+	public:
+		static constexpr const uint32_t INVALID_ALLOCATION = ~0u;
+
+		explicit AtlasPacker(const AtlasPackerCreateInfo& createInfo);
+
+		/**
+		 * Allocates a `width` by `height` rectangle on a page of `pageClass`, marking it as used in the current
+		 * frame. Returns `INVALID_ALLOCATION` if the rectangle cannot fit on any page without exceeding
+		 * `maxPageCount` or reclaiming a page in use this frame.
+		 */
+		uint32_t allocate(uint32_t width, uint32_t height, uint32_t pageClass, AtlasRect& outRect);
+		/**
+		 * Marks `allocationID` as used in the current frame.
+		 */
+		void touch(uint32_t allocationID);
+		/**
+		 * Advances the current frame. Allocations not touched after this call become candidates for eviction.
+		 */
+		void begin_frame();
+		/**
+		 * Evicts every allocation and empties every page, without destroying pages.
+		 */
+		void clear();
+
+		const AtlasRect& get_rect(uint32_t allocationID) const;
+		uint64_t get_last_use_frame(uint32_t allocationID) const;
+		uint64_t get_current_frame() const;
+
+		uint32_t get_page_count() const;
+		uint32_t get_page_class(uint32_t page) const;
+		/**
+		 * Fraction of the page's area covered by live allocations, including padding.
+		 */
+		float get_page_occupancy(uint32_t page) const;
+		uint32_t get_allocation_count() const;
+	private:
+		struct SkylineNode {
+			uint32_t x;
+			uint32_t y;
+			uint32_t width;
+		};
+
+		struct Page {
+			std::vector<SkylineNode> skyline;
+			std::vector<uint32_t> allocations;
+			uint64_t lastUseFrame;
+			uint64_t usedArea;
+			// Height of the tallest rectangle that could still fit, for skipping full pages without a search
+			uint32_t maxFreeHeight;
+			uint32_t pageClass;
+		};
+
+		struct Allocation {
+			AtlasRect rect;
+			uint64_t lastUseFrame;
+			uint32_t nextFree;
+		};
+
+		struct PageClass {
+			std::vector<uint32_t> pages;
+			// The page that most recently satisfied an allocation, tried before any other
+			uint32_t lastPage;
+		};
+
+		std::vector<Page> m_pages;
+		std::vector<Allocation> m_allocations;
+		std::vector<PageClass> m_pageClasses;
+		uint64_t m_currentFrame{};
+		uint32_t m_firstFreeAllocation{INVALID_ALLOCATION};
+		uint32_t m_allocationCount{};
+
+		uint32_t m_pageWidth;
+		uint32_t m_pageHeight;
+		uint32_t m_padding;
+		uint32_t m_maxPageCount;
+		uint32_t m_idleFrameLimit;
+		PFN_AtlasEvict m_pfnEvict;
+		PFN_AtlasPageReset m_pfnPageReset;
+		void* m_pUserData;
+
+		bool try_allocate_on_page(uint32_t page, uint32_t width, uint32_t height, AtlasRect& outRect);
+		uint32_t find_page_to_reclaim(bool idleOnly) const;
+		void reset_page(uint32_t page, uint32_t pageClass);
+		PageClass& get_page_class_data(uint32_t pageClass);
+		uint32_t add_allocation(const AtlasRect& rect);
+};
+
+}
@@ -5,6 +5,8 @@
 #include <unicode/brkiter.h>
 #include <unicode/utext.h>
 
+#include <algorithm>
+
 using namespace Text;
 
 static constexpr const UChar32 CH_LF = 0x000A;
@@ -12,17 +14,27 @@ static constexpr const UChar32 CH_CR = 0x000D;
 static constexpr const UChar32 CH_LSEP = 0x2028;
 static constexpr const UChar32 CH_PSEP = 0x2029;
 
+// Maximum number of word boundaries found at a time after, and before, the offset being looked up
+static constexpr const int32_t WORD_SPAN_BOUNDARY_COUNT = 64;
+static constexpr const int32_t WORD_SPAN_LOOKBEHIND_COUNT = 16;
+
 static bool is_line_break(UChar32 c);
+static bool is_punctuation_segment(UChar32 firstChar, int32_t ruleStatus);
 
 CursorController::CursorController() {
 	UErrorCode errc{};
 	m_iter = icu::BreakIterator::createCharacterInstance(icu::Locale::getDefault(), errc);
+	m_wordIter = icu::BreakIterator::createWordInstance(icu::Locale::getDefault(), errc);
 }
 
 CursorController::~CursorController() {
 	if (m_iter) {
 		delete m_iter;
 	}
+
+	if (m_wordIter) {
+		delete m_wordIter;
+	}
 }
 
 CursorController::CursorController(CursorController&& other) noexcept {
@@ -31,6 +43,10 @@ CursorController::CursorController(CursorController&& other) noexcept {
 
 CursorController& CursorController::operator=(CursorController&& other) noexcept {
 	std::swap(m_iter, other.m_iter);
+	std::swap(m_wordIter, other.m_wordIter);
+	std::swap(m_text, other.m_text);
+	std::swap(m_wordSpans, other.m_wordSpans);
+	std::swap(m_wordStops, other.m_wordStops);
 	return *this;
 }
 
@@ -39,7 +55,12 @@ void CursorController::set_text(std::string_view str) {
 	UText uText UTEXT_INITIALIZER;
 	utext_openUTF8(&uText, str.data(), str.size(), &errc);
 	m_iter->setText(&uText, errc);
+	m_wordIter->setText(&uText, errc);
+	utext_close(&uText);
 	m_text = std::move(str);
+
+	m_wordSpans.clear();
+	m_wordStops.clear();
 }
 
 CursorPosition CursorController::next_character(CursorPosition cursor) {
@@ -59,60 +80,40 @@ CursorPosition CursorController::prev_character(CursorPosition cursor) {
 }
 
 CursorPosition CursorController::next_word(CursorPosition cursor) {
-	UChar32 c;
-	U8_GET((const uint8_t*)m_text.data(), 0, cursor.get_position(), m_text.size(), c);
-	bool lastWhitespace = u_isWhitespace(c);
+	auto textLength = static_cast<uint32_t>(m_text.size());
+	auto start = static_cast<uint32_t>(cursor.get_position());
 
-	for (;;) {
-		auto nextIndex = m_iter->following(cursor.get_position());
+	for (auto position = start; position < textLength;) {
+		auto& span = get_word_span(position);
+		auto* pStopsBegin = m_wordStops.data() + span.firstStop;
+		auto* pStopsEnd = pStopsBegin + span.stopCount;
 
-		if (nextIndex == icu::BreakIterator::DONE) {
-			break;
-		}
-
-		cursor = {static_cast<uint32_t>(nextIndex)};
-
-		U8_GET((const uint8_t*)m_text.data(), 0, nextIndex, m_text.size(), c);
-		bool whitespace = u_isWhitespace(c);
-
-		if (!whitespace && lastWhitespace || is_line_break(c)) {
-			break;
+		if (auto it = std::upper_bound(pStopsBegin, pStopsEnd, start); it != pStopsEnd) {
+			return {*it};
 		}
 
-		lastWhitespace = whitespace;
+		position = span.end;
 	}
 
-	return cursor;
+	return {std::max(start, textLength)};
 }
 
 CursorPosition CursorController::prev_word(CursorPosition cursor) {
-	UChar32 c;
-	bool lastWhitespace = true;
+	auto start = std::min<uint32_t>(cursor.get_position(), static_cast<uint32_t>(m_text.size()));
 
-	for (;;) {
-		auto nextIndex = m_iter->preceding(cursor.get_position());
+	for (auto position = start; position > 0;) {
+		auto& span = get_word_span(position - 1);
+		auto* pStopsBegin = m_wordStops.data() + span.firstStop;
+		auto* pStopsEnd = pStopsBegin + span.stopCount;
 
-		if (nextIndex == icu::BreakIterator::DONE) {
-			break;
+		if (auto it = std::lower_bound(pStopsBegin, pStopsEnd, start); it != pStopsBegin) {
+			return {*(it - 1)};
 		}
 
-		U8_GET((const uint8_t*)m_text.data(), 0, nextIndex, m_text.size(), c);
-
-		bool whitespace = u_isWhitespace(c);
-
-		if (whitespace && !lastWhitespace) {
-			break;
-		}
-
-		if (is_line_break(c)) {
-			return {static_cast<uint32_t>(nextIndex)};
-		}
-
-		cursor = {static_cast<uint32_t>(nextIndex)};
-		lastWhitespace = whitespace;
+		position = span.start;
 	}
 
-	return cursor;
+	return {0u};
 }
 
 CursorPosition CursorController::closest_in_line(const LayoutInfo& layout, float textAreaWidth,
@@ -131,9 +132,78 @@ CursorPosition CursorController::closest_to_position(const LayoutInfo& layout, f
 	return layout.find_closest_cursor_position(textAreaWidth, textXAlignment, *m_iter, lineIndex, posX);
 }
 
+const CursorController::WordSpan& CursorController::get_word_span(uint32_t position) {
+	auto it = std::upper_bound(m_wordSpans.begin(), m_wordSpans.end(), position,
+			[](auto position, auto& span) { return position < span.start; });
+
+	if (it != m_wordSpans.begin() && position < (it - 1)->end) {
+		return *(it - 1);
+	}
+
+	// Cached spans end and begin on boundaries, so the new span fits exactly between its neighbours
+	auto textLength = static_cast<uint32_t>(m_text.size());
+	auto prevEnd = it != m_wordSpans.begin() ? (it - 1)->end : 0u;
+	auto nextStart = it != m_wordSpans.end() ? it->start : textLength;
+
+	// The boundary before the one following `position`, as `preceding` snaps offsets within code points backwards
+	m_wordIter->following(static_cast<int32_t>(position));
+	auto start = m_wordIter->previous();
+
+	for (int32_t i = 0; i < WORD_SPAN_LOOKBEHIND_COUNT && static_cast<uint32_t>(start) > prevEnd; ++i) {
+		start = m_wordIter->previous();
+	}
+
+	auto* pText = reinterpret_cast<const uint8_t*>(m_text.data());
+	auto firstStop = static_cast<uint32_t>(m_wordStops.size());
+	auto boundary = start;
+
+	// The rule status describes the segment before the current boundary, so a run of punctuation that crosses
+	// the start of the span is not split by it
+	bool prevPunctuation{};
+
+	if (start > 0) {
+		UChar32 c;
+		auto prevIndex = start;
+		U8_PREV(pText, 0, prevIndex, c);
+		prevPunctuation = is_punctuation_segment(c, m_wordIter->getRuleStatus());
+	}
+
+	// Stop at the start of every word, run of punctuation and line break, skipping over other whitespace
+	for (int32_t i = 0; i < WORD_SPAN_BOUNDARY_COUNT || static_cast<uint32_t>(boundary) <= position; ++i) {
+		UChar32 c;
+		U8_GET(pText, 0, boundary, textLength, c);
+
+		auto segmentEnd = i == 0 ? m_wordIter->following(start) : m_wordIter->next();
+		bool punctuation = is_punctuation_segment(c, m_wordIter->getRuleStatus());
+
+		if ((!u_isWhitespace(c) || is_line_break(c)) && !(punctuation && prevPunctuation)) {
+			m_wordStops.emplace_back(static_cast<uint32_t>(boundary));
+		}
+
+		prevPunctuation = punctuation;
+		boundary = segmentEnd;
+
+		if (boundary == icu::BreakIterator::DONE || static_cast<uint32_t>(boundary) >= nextStart) {
+			boundary = static_cast<int32_t>(nextStart);
+			break;
+		}
+	}
+
+	return *m_wordSpans.insert(it, {
+		.start = static_cast<uint32_t>(start),
+		.end = static_cast<uint32_t>(boundary),
+		.firstStop = firstStop,
+		.stopCount = static_cast<uint32_t>(m_wordStops.size()) - firstStop,
+	});
+}
+
 // Static Functions
 
 static bool is_line_break(UChar32 c) {
 	return c == CH_LF || c == CH_CR || c == CH_LSEP || c == CH_PSEP;
 }
 
+// Segments that are neither words, numbers nor whitespace, such as punctuation and symbols
+static bool is_punctuation_segment(UChar32 firstChar, int32_t ruleStatus) {
+	return ruleStatus < UBRK_WORD_NONE_LIMIT && !u_isWhitespace(firstChar);
+}
@@ -6,6 +6,7 @@
 #include <unicode/uversion.h>
 
 #include <string_view>
+#include <vector>
 
 U_NAMESPACE_BEGIN
 
@@ -33,7 +34,16 @@ class CursorController {
 		CursorPosition next_character(CursorPosition);
 		CursorPosition prev_character(CursorPosition);
 
+		/**
+		 * Moves to the start of the next word or run of punctuation, stopping before hard line breaks and at the
+		 * end of the text. Word boundaries are found in spans around the cursor and cached until the next
+		 * `set_text`, so repeated jumps are binary searches over the cached stops.
+		 */
 		CursorPosition next_word(CursorPosition);
+		/**
+		 * Moves to the start of the current or previous word or run of punctuation, stopping before hard line
+		 * breaks.
+		 */
 		CursorPosition prev_word(CursorPosition);
 
 		CursorPosition closest_in_line(const LayoutInfo&, float textAreaWidth, XAlignment, size_t lineIndex,
@@ -45,8 +55,24 @@ class CursorController {
 			return m_text;
 		}
 	private:
-		icu::BreakIterator* m_iter;
+		// Span of text [`start`, `end`) between two word boundaries, and the word stops within it,
+		// `m_wordStops[firstStop, firstStop + stopCount)`
+		struct WordSpan {
+			uint32_t start;
+			uint32_t end;
+			uint32_t firstStop;
+			uint32_t stopCount;
+		};
+
+		icu::BreakIterator* m_iter{};
+		icu::BreakIterator* m_wordIter{};
 		std::string_view m_text;
+
+		// Cached spans, ordered by start and not overlapping
+		std::vector<WordSpan> m_wordSpans;
+		std::vector<uint32_t> m_wordStops;
+
+		const WordSpan& get_word_span(uint32_t position);
 };
 
 }
@@ -0,0 +1,384 @@
+#pragma once
+
+#include "implicit_treap.hpp"
+#include "value_runs.hpp"
+#include "value_runs_iterator.hpp"
+
+#include <algorithm>
+#include <concepts>
+#include <utility>
+#include <vector>
+
+namespace Text {
+
+/**
+ * Holds the same runs as `ValueRuns`, stored as run lengths in a treap rather than as absolute limits, so that
+ * characters can be inserted or erased and ranges given a new value in O(log n), without rewriting the limits of
+ * every run after the edit.
+ *
+ * Runs are never empty, and adjacent runs with equal values are merged when `T` is equality comparable.
+ *
+ * The indexed accessors are O(log n), which keeps `iterate_run_intersections` working as is. Walking the runs in
+ * order is cheaper through `ValueRunsIterator`, which visits each run in amortized O(1).
+ *
+ * @thread_safety Const member functions may be called concurrently, provided no thread modifies the runs.
+ */
+template <typename T>
+class EditableValueRuns : public Internal::ValueRunsMixin<EditableValueRuns<T>>,
+		public Internal::ImplicitTreap<EditableValueRuns<T>> {
+	public:
+		using value_type = T;
+
+		EditableValueRuns() = default;
+		template <typename U>
+		explicit EditableValueRuns(U&& value, int32_t limit) {
+			add(limit, std::forward<U>(value));
+		}
+		explicit EditableValueRuns(const ValueRuns<T>& runs) {
+			for (size_t i = 0; i < runs.get_run_count(); ++i) {
+				add(runs.get_run_limit(i), runs.get_run_value(i));
+			}
+		}
+
+		EditableValueRuns(EditableValueRuns&&) noexcept = default;
+		EditableValueRuns& operator=(EditableValueRuns&&) noexcept = default;
+
+		EditableValueRuns(const EditableValueRuns&) = delete;
+		void operator=(const EditableValueRuns&) = delete;
+
+		/**
+		 * Appends a run up to `limit`. Limits not past the current limit are ignored.
+		 */
+		template <typename... Args>
+		void add(int32_t limit, Args&&... args) {
+			if (auto length = limit - get_limit(); length > 0) {
+				auto node = alloc_node(length, std::forward<Args>(args)...);
+				m_root = join(m_root, node);
+			}
+		}
+
+		/**
+		 * Inserts `length` characters at `index`, extending the run of the character before them, or the first run
+		 * when inserting at the start.
+		 */
+		void insert(int32_t index, int32_t length) {
+			if (length <= 0 || m_root == INVALID_NODE) {
+				return;
+			}
+
+			auto position = std::clamp(index - 1, 0, get_limit() - 1);
+			auto node = m_root;
+
+			for (;;) {
+				auto& n = m_nodes[node];
+				auto leftLength = get_subtree_length(n.left);
+				n.subtreeLength += length;
+
+				if (position < leftLength) {
+					node = n.left;
+				}
+				else if (position < leftLength + n.length) {
+					n.length += length;
+					return;
+				}
+				else {
+					position -= leftLength + n.length;
+					node = n.right;
+				}
+			}
+		}
+
+		/**
+		 * Inserts `length` characters with `value` at `index`.
+		 */
+		template <typename U>
+		void insert(int32_t index, int32_t length, U&& value) {
+			if (length <= 0) {
+				return;
+			}
+
+			uint32_t left;
+			uint32_t right;
+			split(m_root, std::clamp(index, 0, get_limit()), left, right);
+
+			auto node = alloc_node(length, std::forward<U>(value));
+			m_root = join(join(left, node), right);
+		}
+
+		/**
+		 * Removes the characters [`index`, `index + length`), shifting the runs after them back.
+		 */
+		void erase(int32_t index, int32_t length) {
+			uint32_t left;
+			uint32_t middle;
+			uint32_t right;
+
+			if (!split_range(index, length, left, middle, right)) {
+				return;
+			}
+
+			free_subtree(middle);
+			m_root = join(left, right);
+		}
+
+		/**
+		 * Gives the characters [`index`, `index + length`) a single run of `value`.
+		 */
+		template <typename U>
+		void set_value(int32_t index, int32_t length, U&& value) {
+			uint32_t left;
+			uint32_t middle;
+			uint32_t right;
+
+			if (!split_range(index, length, left, middle, right)) {
+				return;
+			}
+
+			auto rangeLength = get_subtree_length(middle);
+			free_subtree(middle);
+
+			auto node = alloc_node(rangeLength, std::forward<U>(value));
+			m_root = join(join(left, node), right);
+		}
+
+		void clear() {
+			clear_nodes();
+		}
+
+		const T& get_run_value(size_t runIndex) const {
+			int32_t runStart;
+			return m_nodes[find_run(runIndex, runStart)].value;
+		}
+
+		int32_t get_run_limit(size_t runIndex) const {
+			int32_t runStart;
+			auto node = find_run(runIndex, runStart);
+			return runStart + m_nodes[node].length;
+		}
+
+		size_t get_run_containing_index(int32_t index) const {
+			if (index < 0) {
+				return 0;
+			}
+
+			size_t runIndex{};
+			auto node = m_root;
+
+			while (node != INVALID_NODE) {
+				auto& n = m_nodes[node];
+				auto leftLength = get_subtree_length(n.left);
+
+				if (index < leftLength) {
+					node = n.left;
+				}
+				else if (index < leftLength + n.length) {
+					return runIndex + get_subtree_count(n.left);
+				}
+				else {
+					index -= leftLength + n.length;
+					runIndex += get_subtree_count(n.left) + 1;
+					node = n.right;
+				}
+			}
+
+			return runIndex;
+		}
+
+		const T& get_value(int32_t index) const {
+			return get_run_value(get_run_containing_index(index));
+		}
+
+		bool empty() const {
+			return m_root == INVALID_NODE;
+		}
+
+		size_t get_run_count() const {
+			return get_subtree_count(m_root);
+		}
+
+		int32_t get_limit() const {
+			return get_subtree_length(m_root);
+		}
+	private:
+		using Base = Internal::ImplicitTreap<EditableValueRuns<T>>;
+		using Base::INVALID_NODE;
+		using Base::m_freeNodes;
+		using Base::m_root;
+		using Base::emplace_node;
+		using Base::free_subtree;
+		using Base::clear_nodes;
+		using Base::get_subtree_length;
+		using Base::get_subtree_count;
+		using Base::update;
+		using Base::split;
+		using Base::merge;
+
+		// Fields past `length` are filled in by `emplace_node` and `update`
+		struct Node {
+			T value;
+			int32_t length;
+			int32_t subtreeLength{};
+			uint32_t subtreeCount{};
+			uint32_t priority{};
+			uint32_t left{};
+			uint32_t right{};
+		};
+
+		std::vector<Node> m_nodes;
+
+		friend Base;
+		friend class ValueRunsIterator<T, EditableValueRuns<T>>;
+
+		template <typename... Args>
+		uint32_t alloc_node(int32_t length, Args&&... args) {
+			return emplace_node(Node{
+				.value = T(std::forward<Args>(args)...),
+				.length = length,
+			});
+		}
+
+		uint32_t split_node(uint32_t node, int32_t offset) {
+			auto tail = alloc_node(m_nodes[node].length - offset, m_nodes[node].value);
+			m_nodes[node].length = offset;
+			return tail;
+		}
+
+		uint32_t find_run(size_t runIndex, int32_t& runStart) const {
+			auto node = m_root;
+			runStart = 0;
+
+			for (;;) {
+				auto& n = m_nodes[node];
+				auto leftCount = get_subtree_count(n.left);
+
+				if (runIndex < leftCount) {
+					node = n.left;
+				}
+				else if (runIndex == leftCount) {
+					runStart += get_subtree_length(n.left);
+					return node;
+				}
+				else {
+					runIndex -= leftCount + 1;
+					runStart += get_subtree_length(n.left) + n.length;
+					node = n.right;
+				}
+			}
+		}
+
+		bool split_range(int32_t index, int32_t length, uint32_t& left, uint32_t& middle, uint32_t& right) {
+			auto start = std::clamp(index, 0, get_limit());
+			auto end = std::clamp(index + length, start, get_limit());
+
+			if (start == end) {
+				return false;
+			}
+
+			split(m_root, start, left, middle);
+			split(middle, end - start, middle, right);
+			return true;
+		}
+
+		// Merges two trees, combining the last run of `left` with the first of `right` if their values match
+		uint32_t join(uint32_t left, uint32_t right) {
+			if (left == INVALID_NODE || right == INVALID_NODE) {
+				return merge(left, right);
+			}
+
+			if constexpr (std::equality_comparable<T>) {
+				auto first = right;
+
+				while (m_nodes[first].left != INVALID_NODE) {
+					first = m_nodes[first].left;
+				}
+
+				auto last = left;
+
+				while (m_nodes[last].right != INVALID_NODE) {
+					last = m_nodes[last].right;
+				}
+
+				if (m_nodes[first].value == m_nodes[last].value) {
+					auto length = m_nodes[first].length;
+					right = remove_first(right);
+
+					for (auto node = left; node != INVALID_NODE; node = m_nodes[node].right) {
+						m_nodes[node].subtreeLength += length;
+					}
+
+					m_nodes[last].length += length;
+				}
+			}
+
+			return merge(left, right);
+		}
+
+		uint32_t remove_first(uint32_t node) {
+			if (m_nodes[node].left == INVALID_NODE) {
+				auto right = m_nodes[node].right;
+				m_freeNodes.emplace_back(node);
+				return right;
+			}
+
+			m_nodes[node].left = remove_first(m_nodes[node].left);
+			update(node);
+			return node;
+		}
+};
+
+/**
+ * Walks the runs of an `EditableValueRuns` in order, keeping the path to the current run.
+ */
+template <typename T>
+class ValueRunsIterator<T, EditableValueRuns<T>> {
+	public:
+		explicit ValueRunsIterator(const EditableValueRuns<T>& runs)
+				: m_runs(&runs) {
+			push_left_spine(runs.m_root);
+
+			if (!m_path.empty()) {
+				m_limit = runs.m_nodes[m_path.back()].length;
+			}
+		}
+
+		T get_value() const {
+			return m_runs->m_nodes[m_path.back()].value;
+		}
+
+		int32_t get_limit() const {
+			return m_limit;
+		}
+
+		void advance_to(int32_t index) {
+			while (m_limit <= index && next_run()) {}
+		}
+	private:
+		const EditableValueRuns<T>* m_runs;
+		// The current run, preceded by the ancestors whose runs come after it
+		std::vector<uint32_t> m_path;
+		int32_t m_limit{};
+
+		void push_left_spine(uint32_t node) {
+			for (; node != EditableValueRuns<T>::INVALID_NODE; node = m_runs->m_nodes[node].left) {
+				m_path.emplace_back(node);
+			}
+		}
+
+		bool next_run() {
+			auto right = m_runs->m_nodes[m_path.back()].right;
+
+			if (right == EditableValueRuns<T>::INVALID_NODE && m_path.size() == 1) {
+				return false;
+			}
+
+			m_path.pop_back();
+			push_left_spine(right);
+			m_limit += m_runs->m_nodes[m_path.back()].length;
+			return true;
+		}
+};
+
+template <typename T>
+ValueRunsIterator(const EditableValueRuns<T>&) -> ValueRunsIterator<T, EditableValueRuns<T>>;
+
+}
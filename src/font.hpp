@@ -36,6 +36,8 @@ class FontFace {
 		constexpr operator bool() const {
 			return valid();
 		}
+
+		constexpr bool operator==(const FontFace&) const = default;
 	private:
 		uint32_t m_handle{make_handle(FontFamily{}, FontWeight::REGULAR, FontStyle::NORMAL)};
 
@@ -68,6 +70,8 @@ class Font final : public FontFace {
 		constexpr uint32_t get_size() const {
 			return m_size;
 		}
+
+		constexpr bool operator==(const Font&) const = default;
 	private:
 		uint32_t m_size;
 };
@@ -23,6 +23,16 @@ enum class FontWeight : uint8_t {
 	COUNT
 };
 
+/**
+ * Selects the source of glyph lookups and metrics used by HarfBuzz while shaping.
+ */
+enum class HarfbuzzFontFuncs : uint8_t {
+	// Glyph lookups and metrics are loaded through FreeType, matching rasterized glyphs exactly
+	FREETYPE,
+	// Glyph lookups and metrics are read directly from the font tables by HarfBuzz. Advances are unhinted.
+	NATIVE,
+};
+
 using FamilyIndex_T = uint16_t;
 using FaceIndex_T = uint16_t;
 
@@ -84,6 +94,23 @@ struct SyntheticFontInfo {
 	bool syntheticSmallCaps: 1;
 };
 
+// Fraction of the em size by which glyphs are emboldened when synthesizing each target weight
+constexpr const float SYNTHETIC_BOLD_SCALE[] = {
+	-1.f / 14.f, // Thin
+	-1.f / 18.f, // Extra Light
+	-1.f / 32.f, // Light
+	0.f, // Regular
+	1.f / 32.f, // Medium
+	1.f / 18.f, // Semi Bold
+	1.f / 14.f, // Bold
+	1.f / 11.f, // Extra Bold
+	1.f / 9.f, // Black
+};
+
+constexpr const float SYNTHETIC_BOLD_SCALE_Y = 0.4f;
+
+constexpr const double SYNTHETIC_ITALIC_ANGLE = 12.0 * 3.14159265358979323846 / 180.0;
+
 constexpr const float GLYPH_SUB_SUPER_SCALE = 0.7f;
 constexpr const float GLYPH_SMALL_CAPS_SCALE = 0.8f;
 
@@ -92,6 +119,21 @@ constexpr const float SUBSCRIPT_OFFSET_RATIO = 0.2f;
 constexpr const float SUPERSCRIPT_OFFSET_RATIO = 0.34f;
 
 
+/**
+ * Vertical metrics of a sized font in pixels. Ascent and descent follow the font convention of positive values
+ * above the baseline, while the decoration positions are offsets to add to the baseline Y when drawing.
+ */
+struct FontMetrics {
+	float ascent;
+	float descent;
+	float underlinePosition;
+	float underlineThickness;
+	float strikethroughPosition;
+	float strikethroughThickness;
+
+	constexpr bool operator==(const FontMetrics&) const = default;
+};
+
 constexpr float calc_font_scale_modifier(bool syntheticSmallCaps, bool syntheticSubSuper) {
 	float sizeModifier = 1.f;
 	sizeModifier *= syntheticSubSuper ? GLYPH_SUB_SUPER_SCALE : 1.f;
@@ -7,27 +7,42 @@
 #include <hb.h>
 
 #include <cmath>
+#include <type_traits>
+#include <vector>
 
 using namespace Text;
 
-static constexpr float BOLD_SCALE[] = {
-	-1.f / 14.f, // Thin
-	-1.f / 18.f, // Extra Light
-	-1.f / 32.f, // Light
-	0.f, // Regular
-	1.f / 32.f, // Medium
-	1.f / 18.f, // Semi Bold
-	1.f / 14.f, // Bold
-	1.f / 11.f, // Extra Bold
-	1.f / 9.f, // Black
+namespace {
+
+struct PooledStroker {
+	FT_Library library;
+	FT_Stroker stroker;
+	uint8_t thickness;
+	StrokeType strokeType;
 };
 
-static constexpr float BOLD_SCALE_Y = 0.4f;
+/**
+ * Per-thread stroking state. The stroked outline and rasterized bitmap are written into buffers that only ever
+ * grow, so that stroking a glyph does not allocate once the buffers have warmed up.
+ */
+struct StrokeContext {
+	std::vector<PooledStroker> strokers;
+	std::vector<FT_Vector> points;
+	std::vector<std::remove_pointer_t<decltype(FT_Outline::tags)>> tags;
+	std::vector<std::remove_pointer_t<decltype(FT_Outline::contours)>> contours;
+	std::vector<unsigned char> bitmapData;
+	FT_Outline outline{};
+
+	~StrokeContext();
+};
 
-#ifndef M_PI
-static constexpr const double M_PI = 3.14159265358979323846;
-#endif
-static constexpr const double ITALIC_SHEAR = 12.0  * M_PI / 180.0;
+}
+
+// Strokers belong to a FreeType library, which lives in the font context of the same thread. The stroke
+// context is first used after the font context, so it is destroyed first.
+static thread_local StrokeContext t_strokeContext;
+
+static FT_Outline& stroke_glyph_slot(FT_GlyphSlot slot, FT_Stroker stroker);
 
 static void try_apply_synthetics(FT_Face face, FT_Outline& outline, SyntheticFontInfo synthInfo);
 
@@ -103,6 +118,17 @@ float FontData::get_strikethrough_thickness() const {
 	return get_scale_y() * static_cast<float>(strikethroughThickness);
 }
 
+FontMetrics FontData::get_metrics() const {
+	return {
+		.ascent = get_ascent(),
+		.descent = get_descent(),
+		.underlinePosition = get_underline_position(),
+		.underlineThickness = get_underline_thickness(),
+		.strikethroughPosition = get_strikethrough_position(),
+		.strikethroughThickness = get_strikethrough_thickness(),
+	};
+}
+
 FontRasterizeInfo FontData::rasterize_glyph_internal(uint32_t glyph) const {
 	FT_Load_Glyph(ftFace, glyph, FT_LOAD_NO_BITMAP | FT_LOAD_COLOR);
 
@@ -137,77 +163,89 @@ FontRasterizeInfo FontData::rasterize_glyph_internal(uint32_t glyph) const {
 	};
 }
 
-FontRasterizeInfo FontData::rasterize_outline_internal(uint32_t glyphIndex, uint8_t thickness,
-		StrokeType strokeType, FT_Stroker& outStroker, FT_Glyph& outGlyph) const {
+FontRasterizeInfo FontData::rasterize_outline_internal(uint32_t glyphIndex, FT_Stroker stroker) const {
 	FT_Load_Glyph(ftFace, glyphIndex, FT_LOAD_NO_BITMAP);
 
-	FT_Glyph glyph;
-	FT_Get_Glyph(ftFace->glyph, &glyph);
-	glyph->format = FT_GLYPH_FORMAT_OUTLINE;
-
-	FT_Stroker_LineJoin lineJoin = FT_STROKER_LINEJOIN_ROUND;
-
-	switch (strokeType) {
-		case StrokeType::BEVEL:
-			lineJoin = FT_STROKER_LINEJOIN_BEVEL;
-			break;
-		case StrokeType::MITER:
-			lineJoin = FT_STROKER_LINEJOIN_MITER;
-			break;
-		default:
-			break;
+	auto& outline = stroke_glyph_slot(ftFace->glyph, stroker);
+	try_apply_synthetics(ftFace, outline, synthInfo);
+
+	// Equivalent to the smooth renderer's placement of the bitmap, without allocating an FT_Glyph for it
+	FT_BBox cbox;
+	FT_Outline_Get_CBox(&outline, &cbox);
+	cbox.xMin = cbox.xMin & ~63;
+	cbox.yMin = cbox.yMin & ~63;
+	cbox.xMax = (cbox.xMax + 63) & ~63;
+	cbox.yMax = (cbox.yMax + 63) & ~63;
+
+	auto width = static_cast<uint32_t>((cbox.xMax - cbox.xMin) >> 6);
+	auto height = static_cast<uint32_t>((cbox.yMax - cbox.yMin) >> 6);
+
+	if (outline.n_points == 0 || width == 0 || height == 0) {
+		return {
+			.pData = nullptr,
+			.offsetX = 0.f,
+			.offsetY = 0.f,
+			.width = 0,
+			.height = 0,
+			.format = FontRasterFormat::R8,
+		};
 	}
 
-	FT_Stroker stroker;
-	FT_Stroker_New(glyph->library, &stroker);
-	FT_Stroker_Set(stroker, static_cast<FT_Fixed>(thickness) * 64, FT_STROKER_LINECAP_ROUND, lineJoin, 0);
-
-	FT_Glyph_Stroke(&glyph, stroker, false);
-
-	try_apply_synthetics(ftFace, reinterpret_cast<FT_OutlineGlyph>(glyph)->outline, synthInfo);
-
-	FT_Glyph_To_Bitmap(&glyph, FT_RENDER_MODE_NORMAL, nullptr, true);
-
-	auto bmpGlyph = reinterpret_cast<FT_BitmapGlyph>(glyph);
-	auto uWidth = static_cast<uint32_t>(bmpGlyph->bitmap.width);
-	auto uHeight = static_cast<uint32_t>(bmpGlyph->bitmap.rows);
-	auto* buffer = bmpGlyph->bitmap.buffer;
+	auto& bitmapData = t_strokeContext.bitmapData;
+	bitmapData.clear();
+	bitmapData.resize(static_cast<size_t>(width) * height);
+
+	FT_Bitmap bitmap{
+		.rows = height,
+		.width = width,
+		.pitch = static_cast<int>(width),
+		.buffer = bitmapData.data(),
+		.num_grays = 256,
+		.pixel_mode = FT_PIXEL_MODE_GRAY,
+		.palette_mode = 0,
+		.palette = nullptr,
+	};
 
-	outStroker = stroker;
-	outGlyph = glyph;
+	FT_Outline_Translate(&outline, -cbox.xMin, -cbox.yMin);
+	FT_Outline_Get_Bitmap(ftFace->glyph->library, &outline, &bitmap);
 
 	return {
-		.pData = reinterpret_cast<const std::byte*>(buffer),
-		.offsetX = static_cast<float>(bmpGlyph->left),
-		.offsetY = static_cast<float>(-bmpGlyph->top),
-		.width = uWidth,
-		.height = uHeight,
+		.pData = reinterpret_cast<const std::byte*>(bitmapData.data()),
+		.offsetX = static_cast<float>(cbox.xMin >> 6),
+		.offsetY = static_cast<float>(-(cbox.yMax >> 6)),
+		.width = width,
+		.height = height,
 		.format = FontRasterFormat::R8,
 	};
 }
 
-void FontData::rasterize_outline_finish(FT_Stroker stroker, FT_Glyph glyph) const {
-	FT_Stroker_Done(stroker);
-	FT_Done_Glyph(glyph);
-}
-
 FT_Outline* FontData::load_glyph_curve_internal(uint32_t glyphIndex) const {
 	FT_Load_Glyph(ftFace, glyphIndex, FT_LOAD_NO_BITMAP | FT_LOAD_NO_SCALE);
 	try_apply_synthetics(ftFace, ftFace->glyph->outline, synthInfo);
 	return &ftFace->glyph->outline;
 }
 
-FT_Outline* FontData::load_outline_curve_internal(uint32_t glyphIndex, uint8_t thickness,
-		StrokeType type, FT_Stroker& outStroker, FT_Glyph& outGlyph) const {
+FT_Outline* FontData::load_outline_curve_internal(uint32_t glyphIndex, FT_Stroker stroker) const {
 	FT_Load_Glyph(ftFace, glyphIndex, FT_LOAD_NO_BITMAP | FT_LOAD_NO_SCALE);
 
-	FT_Glyph glyph;
-	FT_Get_Glyph(ftFace->glyph, &glyph);
-	glyph->format = FT_GLYPH_FORMAT_OUTLINE;
+	auto& outline = stroke_glyph_slot(ftFace->glyph, stroker);
+	try_apply_synthetics(ftFace, outline, synthInfo);
+
+	return &outline;
+}
+
+FT_Stroker FontData::get_stroker(uint8_t thickness, StrokeType strokeType) const {
+	auto* library = ftFace->glyph->library;
+
+	for (auto& pooled : t_strokeContext.strokers) {
+		if (pooled.library == library && pooled.thickness == thickness && pooled.strokeType == strokeType) {
+			return pooled.stroker;
+		}
+	}
 
 	FT_Stroker_LineJoin lineJoin = FT_STROKER_LINEJOIN_ROUND;
 
-	switch (type) {
+	switch (strokeType) {
 		case StrokeType::BEVEL:
 			lineJoin = FT_STROKER_LINEJOIN_BEVEL;
 			break;
@@ -218,37 +256,62 @@ FT_Outline* FontData::load_outline_curve_internal(uint32_t glyphIndex, uint8_t t
 			break;
 	}
 
-	FT_UInt points, contours;
 	FT_Stroker stroker;
-	FT_Stroker_New(glyph->library, &stroker);
+	FT_Stroker_New(library, &stroker);
 	FT_Stroker_Set(stroker, static_cast<FT_Fixed>(thickness) * 64, FT_STROKER_LINECAP_ROUND, lineJoin, 0);
 
-	FT_Glyph_Stroke(&glyph, stroker, false);
-	FT_Stroker_GetCounts(stroker, &points, &contours);
+	t_strokeContext.strokers.push_back({
+		.library = library,
+		.stroker = stroker,
+		.thickness = thickness,
+		.strokeType = strokeType,
+	});
+
+	return stroker;
+}
+
+// StrokeContext
 
-	FT_Outline* pOutline = (FT_Outline*)malloc(sizeof(FT_Outline));
-	FT_Outline_New(glyph->library, points, contours, pOutline);
-	pOutline->n_points = 0;
-	pOutline->n_contours = 0;
+StrokeContext::~StrokeContext() {
+	for (auto& pooled : strokers) {
+		FT_Stroker_Done(pooled.stroker);
+	}
+}
 
-	FT_Stroker_Export(stroker, pOutline);
+// Static Functions
 
-	try_apply_synthetics(ftFace, *pOutline, synthInfo);
+static FT_Outline& stroke_glyph_slot(FT_GlyphSlot slot, FT_Stroker stroker) {
+	auto& ctx = t_strokeContext;
+	auto& outline = ctx.outline;
+	outline.n_points = 0;
+	outline.n_contours = 0;
+	outline.flags = 0;
 
-	outStroker = stroker;
-	outGlyph = glyph;
+	if (slot->format != FT_GLYPH_FORMAT_OUTLINE
+			|| FT_Stroker_ParseOutline(stroker, &slot->outline, false) != FT_Err_Ok) {
+		return outline;
+	}
 
-	return pOutline;
-}
+	FT_UInt pointCount, contourCount;
+	FT_Stroker_GetCounts(stroker, &pointCount, &contourCount);
 
-void FontData::outline_curve_finish(FT_Outline* outline, FT_Stroker stroker, FT_Glyph glyph) const {
-	FT_Outline_Done(glyph->library, outline);
-	FT_Stroker_Done(stroker);
-	FT_Done_Glyph(glyph);
-	free(outline);
-}
+	if (pointCount > ctx.points.size()) {
+		ctx.points.resize(pointCount);
+		ctx.tags.resize(pointCount);
+	}
 
-// Static Functions
+	if (contourCount > ctx.contours.size()) {
+		ctx.contours.resize(contourCount);
+	}
+
+	outline.points = ctx.points.data();
+	outline.tags = ctx.tags.data();
+	outline.contours = ctx.contours.data();
+
+	FT_Stroker_Export(stroker, &outline);
+
+	return outline;
+}
 
 static void try_apply_synthetics(FT_Face face, FT_Outline& outline, SyntheticFontInfo synthInfo) {
 	if (synthInfo.srcStyle != synthInfo.dstStyle) {
@@ -265,9 +328,10 @@ static void apply_synthetic_bold(FT_Face face, FT_Outline& outline, FontWeight /
 	// FIXME: Create an effective scaling based on srcWeight
 	auto dstWeightIndex = static_cast<size_t>(dstWeight);
 
-	auto extraX = FT_MulFix(face->units_per_EM, face->size->metrics.x_scale) * BOLD_SCALE[dstWeightIndex];
+	auto extraX = FT_MulFix(face->units_per_EM, face->size->metrics.x_scale)
+			* SYNTHETIC_BOLD_SCALE[dstWeightIndex];
 	auto extraY = FT_MulFix(face->units_per_EM, face->size->metrics.y_scale)
-			* BOLD_SCALE[dstWeightIndex] * BOLD_SCALE_Y;
+			* SYNTHETIC_BOLD_SCALE[dstWeightIndex] * SYNTHETIC_BOLD_SCALE_Y;
 
 	FT_Outline_EmboldenXY(&face->glyph->outline, extraX, extraY);
 
@@ -278,7 +342,7 @@ static void apply_synthetic_bold(FT_Face face, FT_Outline& outline, FontWeight /
 
 static void apply_synthetic_italic(FT_Face face, FT_Outline& outline, FontStyle /*srcStyle*/,
 		FontStyle dstStyle) {
-	auto shearAngle = dstStyle == FontStyle::ITALIC ? ITALIC_SHEAR : -ITALIC_SHEAR;
+	auto shearAngle = dstStyle == FontStyle::ITALIC ? SYNTHETIC_ITALIC_ANGLE : -SYNTHETIC_ITALIC_ANGLE;
 
 	FT_Matrix shearMatrix{
 		.xx = 1L << 16,
@@ -4,9 +4,9 @@
 #include "stroke_type.hpp"
 
 #include <cstddef>
+#include <span>
 
 struct FT_FaceRec_;
-struct FT_GlyphRec_;
 struct FT_Outline_;
 struct FT_StrokerRec_;
 struct hb_font_t;
@@ -84,6 +84,8 @@ struct FontData {
 	float get_strikethrough_position() const;
 	float get_strikethrough_thickness() const;
 
+	FontMetrics get_metrics() const;
+
 	/**
 	 * Rasterizes the given glyph and passes the relevant data to the functor `func`. The `pData` member
 	 * of the `FontRasterizeInfo` is only valid for the duration of the call to `func` and is freed
@@ -96,16 +98,27 @@ struct FontData {
 
 	/**
 	 * Rasterizes the given glyph outline and passes the relevant data to the functor `func`. The `pData` member
-	 * of the `FontRasterizeInfo` is only valid for the duration of the call to `func` and is freed
-	 * immediately after execution is complete.
+	 * of the `FontRasterizeInfo` is only valid for the duration of the call to `func`, and is overwritten by the
+	 * next outline rasterized on the same thread.
 	 */
 	template <typename Functor>
 	void rasterize_glyph_outline(uint32_t glyph, uint8_t thickness, StrokeType strokeType,
 			Functor&& func) const {
-		FT_StrokerRec_* pStroker;
-		FT_GlyphRec_* pGlyph;
-		func(rasterize_outline_internal(glyph, thickness, strokeType, pStroker, pGlyph));
-		rasterize_outline_finish(pStroker, pGlyph);
+		func(rasterize_outline_internal(glyph, get_stroker(thickness, strokeType)));
+	}
+
+	/**
+	 * Rasterizes the outline of each glyph in `glyphs` with the same stroke, calling `func(index, rasterInfo)`
+	 * for each one in order. The lifetime of `pData` is the same as in `rasterize_glyph_outline`.
+	 */
+	template <typename Functor>
+	void rasterize_glyph_outlines(std::span<const uint32_t> glyphs, uint8_t thickness, StrokeType strokeType,
+			Functor&& func) const {
+		auto* pStroker = get_stroker(thickness, strokeType);
+
+		for (size_t i = 0; i < glyphs.size(); ++i) {
+			func(i, rasterize_outline_internal(glyphs[i], pStroker));
+		}
 	}
 
 	template <typename Functor>
@@ -113,27 +126,43 @@ struct FontData {
 		func(*load_glyph_curve_internal(glyphIndex));
 	}
 
+	/**
+	 * Strokes the unscaled outline of the given glyph and passes it to the functor `func`. The outline is only
+	 * valid for the duration of the call to `func`, and is overwritten by the next outline stroked on the same
+	 * thread.
+	 */
 	template <typename Functor>
 	void load_glyph_outline_curve(uint32_t glyphIndex, uint8_t thickness, StrokeType strokeType,
 			Functor&& func) const {
-		FT_StrokerRec_* pStroker;
-		FT_GlyphRec_* pGlyph;
-		FT_Outline_* pOutline = load_outline_curve_internal(glyphIndex, thickness, strokeType, pStroker,
-				pGlyph);
-		func(*pOutline);
-		outline_curve_finish(pOutline, pStroker, pGlyph);
+		func(*load_outline_curve_internal(glyphIndex, get_stroker(thickness, strokeType)));
+	}
+
+	/**
+	 * Strokes the unscaled outline of each glyph in `glyphs`, calling `func(index, outline)` for each one in
+	 * order. The lifetime of the outline is the same as in `load_glyph_outline_curve`.
+	 */
+	template <typename Functor>
+	void load_glyph_outline_curves(std::span<const uint32_t> glyphs, uint8_t thickness, StrokeType strokeType,
+			Functor&& func) const {
+		auto* pStroker = get_stroker(thickness, strokeType);
+
+		for (size_t i = 0; i < glyphs.size(); ++i) {
+			func(i, *load_outline_curve_internal(glyphs[i], pStroker));
+		}
 	}
 
 	private:
 		FontRasterizeInfo rasterize_glyph_internal(uint32_t glyph) const;
-		FontRasterizeInfo rasterize_outline_internal(uint32_t glyph, uint8_t thickness, StrokeType,
-				FT_StrokerRec_*& outStroker, FT_GlyphRec_*& outGlyph) const;
-		void rasterize_outline_finish(FT_StrokerRec_*, FT_GlyphRec_*) const;
+		FontRasterizeInfo rasterize_outline_internal(uint32_t glyph, FT_StrokerRec_*) const;
 
 		FT_Outline_* load_glyph_curve_internal(uint32_t glyphIndex) const;
-		FT_Outline_* load_outline_curve_internal(uint32_t glyphIndex, uint8_t thickness, StrokeType,
-				FT_StrokerRec_*&, FT_GlyphRec_*&) const;
-		void outline_curve_finish(FT_Outline_*, FT_StrokerRec_*, FT_GlyphRec_*) const;
+		FT_Outline_* load_outline_curve_internal(uint32_t glyphIndex, FT_StrokerRec_*) const;
+
+		/**
+		 * Returns a stroker configured for `thickness` and `strokeType`. Strokers are pooled per thread and
+		 * reused across glyphs and faces sharing a FreeType library.
+		 */
+		FT_StrokerRec_* get_stroker(uint8_t thickness, StrokeType strokeType) const;
 };
 
 }
@@ -26,32 +26,62 @@ static constexpr const size_t STYLE_COUNT = static_cast<size_t>(FontStyle::COUNT
 
 namespace {
 
-struct FaceData {
-	std::string name;
+struct FontSource {
 	FileMapping mapping{};
-
-	FaceData() = default;
-	FaceData(std::string&& nameIn, FileMapping&& mappingIn)
-			: name(nameIn)
-			, mapping(mappingIn) {}
-
-	FaceData(FaceData&& other) noexcept {
+	hb_blob_t* blob{};
+	PFN_FontDataRelease pfnRelease{};
+	void* pReleaseUserData{};
+	bool fileMapped{};
+
+	FontSource() = default;
+	explicit FontSource(FileMapping&& mappingIn)
+			: mapping(mappingIn)
+			, blob(create_blob())
+			, fileMapped(true) {}
+	explicit FontSource(std::span<const std::byte> data, PFN_FontDataRelease pfnReleaseIn,
+				void* pReleaseUserDataIn)
+			: mapping{.mapping = data.data(), .size = data.size()}
+			, blob(create_blob())
+			, pfnRelease(pfnReleaseIn)
+			, pReleaseUserData(pReleaseUserDataIn) {}
+
+	FontSource(FontSource&& other) noexcept {
 		*this = std::move(other);
 	}
 
-	FaceData& operator=(FaceData&& other) noexcept {
-		std::swap(name, other.name);
+	FontSource& operator=(FontSource&& other) noexcept {
 		std::swap(mapping, other.mapping);
+		std::swap(blob, other.blob);
+		std::swap(pfnRelease, other.pfnRelease);
+		std::swap(pReleaseUserData, other.pReleaseUserData);
+		std::swap(fileMapped, other.fileMapped);
 		return *this;
 	}
 
-	FaceData(const FaceData&) = delete;
-	void operator=(const FaceData&) = delete;
+	FontSource(const FontSource&) = delete;
+	void operator=(const FontSource&) = delete;
+
+	~FontSource();
 
-	~FaceData();
+	hb_blob_t* create_blob() const {
+		if (!mapping.mapping) {
+			return nullptr;
+		}
+
+		return hb_blob_create(reinterpret_cast<const char*>(mapping.mapping), static_cast<unsigned>(mapping.size),
+				HB_MEMORY_MODE_READONLY, nullptr, nullptr);
+	}
+};
+
+struct FaceData {
+	std::string name;
+	uint32_t sourceIndex;
+	uint32_t faceIndex;
 };
 
 struct FamilyData {
+	// Refers to the key of g_familiesByName, whose nodes are never removed
+	std::string_view name;
 	FaceDataHandle lookup[WEIGHT_COUNT][STYLE_COUNT]{};
 	std::vector<FontFamily> linkedFamilies;
 	std::vector<FontFamily> fallbackFamilies;
@@ -134,6 +164,10 @@ struct FontDataOwner {
 		};
 	}
 
+	void set_synthetics(const SyntheticFontInfo& synthInfo) {
+		harfbuzz_font_set_synthetics(hbFont, synthInfo);
+	}
+
 	void resize(uint32_t newSize) {
 		if (size == newSize) {
 			return;
@@ -170,6 +204,9 @@ thread_local FontContext t_fontContext;
 
 static std::shared_mutex g_mutex;
 
+static std::vector<FontSource> g_sources;
+static std::unordered_map<std::string, uint32_t, StringHash, std::equal_to<>> g_sourcesByURI;
+
 static std::vector<FaceData> g_faces;
 static std::unordered_map<std::string, FaceDataHandle, StringHash, std::equal_to<>> g_facesByName;
 
@@ -181,6 +218,8 @@ static FileMappingFunctions g_fileFuncs {
 	.pfnUnmapFile = unmap_file_default,
 };
 
+static HarfbuzzFontFuncs g_shapingFontFuncs{HarfbuzzFontFuncs::FREETYPE};
+
 static bool family_is_initialized(FontFamily family);
 static std::bitset<USCRIPT_CODE_LIMIT>& family_get_scripts(FontFamily family);
 static std::vector<FontFamily>& family_get_linked(FontFamily family);
@@ -192,6 +231,7 @@ static SingleScriptFont get_sub_font(Text::Font font, UText& iter, int32_t& offs
 
 static FontFamily get_or_add_family(const std::string_view& name);
 static FaceDataHandle get_or_add_face(const FontFaceCreateInfo& faceInfo);
+static uint32_t get_or_add_source(const FontFaceCreateInfo& faceInfo);
 
 static FaceDataHandle get_font_for_script(FontFamily family, FontWeight weight, FontStyle style,
 		UScriptCode script);
@@ -210,6 +250,16 @@ FontFamily FontRegistry::get_family(std::string_view name) {
 	return {};
 }
 
+std::string_view FontRegistry::get_family_name(FontFamily family) {
+	std::shared_lock lock(g_mutex);
+
+	if (!family || family.handle >= g_familyData.size()) {
+		return {};
+	}
+
+	return g_familyData[family.handle].name;
+}
+
 FontFace FontRegistry::get_face(std::string_view familyName, FontWeight weight, FontStyle style) {
 	return FontFace(get_family(familyName), weight, style);
 }
@@ -253,8 +303,10 @@ FontData FontRegistry::get_font_data(FaceDataHandle face, uint32_t size, FontWei
 
 	if (auto it = t_fontContext.cache.find(face.handle); it != t_fontContext.cache.end()) {
 		it->second.resize(effectiveSize);
-		return it->second.get_font_data(face.sourceWeight, face.sourceStyle, targetWeight, targetStyle,
+		auto fontData = it->second.get_font_data(face.sourceWeight, face.sourceStyle, targetWeight, targetStyle,
 				syntheticSmallCaps, syntheticSubscript, syntheticSuperscript);
+		it->second.set_synthetics(fontData.synthInfo);
+		return fontData;
 	}
 
 	assert(face.valid() && "get_font_data(): Must pass valid face");
@@ -275,8 +327,11 @@ FontData FontRegistry::get_font_data(FaceDataHandle face, uint32_t size, FontWei
 	g_mutex.lock_shared();
 
 	auto& faceData = g_faces[face.handle];
-	auto* fileData = faceData.mapping.mapping;
-	auto fileSize = faceData.mapping.size;
+	auto& source = g_sources[faceData.sourceIndex];
+	auto* fileData = source.mapping.mapping;
+	auto fileSize = source.mapping.size;
+	auto* blob = source.blob;
+	auto faceIndex = faceData.faceIndex;
 
 	g_mutex.unlock_shared();
 
@@ -284,12 +339,12 @@ FontData FontRegistry::get_font_data(FaceDataHandle face, uint32_t size, FontWei
 		return {};
 	}
 
-	if (FT_New_Memory_Face(t_fontContext.lib, reinterpret_cast<const FT_Byte*>(fileData), fileSize, 0,
-			&fontData.ftFace) != 0) {
+	if (FT_New_Memory_Face(t_fontContext.lib, reinterpret_cast<const FT_Byte*>(fileData), fileSize,
+			static_cast<FT_Long>(faceIndex), &fontData.ftFace) != 0) {
 		return {};
 	}
 
-	fontData.hbFont = harfbuzz_font_create(fontData.ftFace);
+	fontData.hbFont = harfbuzz_font_create(fontData.ftFace, blob, g_shapingFontFuncs);
 
 	if (!fontData.hbFont) {
 		return {};
@@ -300,6 +355,8 @@ FontData FontRegistry::get_font_data(FaceDataHandle face, uint32_t size, FontWei
 		.height = static_cast<FT_Long>(effectiveSize) * 64,
 	};
 	FT_Request_Size(fontData.ftFace, &sr);
+	harfbuzz_font_mark_changed(fontData.hbFont);
+	harfbuzz_font_set_synthetics(fontData.hbFont, fontData.synthInfo);
 
 	if (auto* pOS2Table = reinterpret_cast<TT_OS2*>(FT_Get_Sfnt_Table(fontData.ftFace, FT_SFNT_OS2))) {
 		fontData.strikethroughPosition = -pOS2Table->yStrikeoutPosition;
@@ -309,7 +366,7 @@ FontData FontRegistry::get_font_data(FaceDataHandle face, uint32_t size, FontWei
 	fontData.spaceGlyphIndex = FT_Get_Char_Index(fontData.ftFace, ' ');
 	fontData.spaceAdvance = hb_font_get_glyph_h_advance(fontData.hbFont, fontData.spaceGlyphIndex);
 
-	t_fontContext.cache.emplace(std::make_pair(face.handle, FontDataOwner(fontData, size)));
+	t_fontContext.cache.emplace(std::make_pair(face.handle, FontDataOwner(fontData, effectiveSize)));
 
 	return fontData;
 }
@@ -406,6 +463,10 @@ void FontRegistry::set_file_mapping_functions(const FileMappingFunctions& funcs)
 	g_fileFuncs = funcs;
 }
 
+void FontRegistry::set_shaping_font_funcs(HarfbuzzFontFuncs funcs) {
+	g_shapingFontFuncs = funcs;
+}
+
 // Static Functions
 
 static bool family_is_initialized(FontFamily family) {
@@ -553,14 +614,19 @@ static FontFamily get_or_add_family(const std::string_view& name) {
 	}
 
 	FontFamily result{static_cast<FamilyIndex_T>(g_familyData.size())};
-	g_familiesByName.emplace(std::make_pair(std::string(name), result));
+	auto [it, _] = g_familiesByName.emplace(std::make_pair(std::string(name), result));
 	g_familyData.emplace_back();
+	g_familyData.back().name = it->first;
 
 	return result;
 }
 
 static FaceDataHandle get_or_add_face(const FontFaceCreateInfo& faceInfo) {
 	if (auto it = g_facesByName.find(faceInfo.name); it != g_facesByName.end()) {
+		if (faceInfo.pfnRelease) {
+			faceInfo.pfnRelease(faceInfo.data, faceInfo.pReleaseUserData);
+		}
+
 		return it->second;
 	}
 
@@ -571,7 +637,30 @@ static FaceDataHandle get_or_add_face(const FontFaceCreateInfo& faceInfo) {
 	};
 	g_facesByName.emplace(std::make_pair(std::string(faceInfo.name), result));
 
-	g_faces.emplace_back(std::string(faceInfo.name), g_fileFuncs.pfnMapFile(faceInfo.uri));
+	g_faces.push_back({
+		.name = std::string(faceInfo.name),
+		.sourceIndex = get_or_add_source(faceInfo),
+		.faceIndex = faceInfo.faceIndex,
+	});
+
+	return result;
+}
+
+static uint32_t get_or_add_source(const FontFaceCreateInfo& faceInfo) {
+	auto result = static_cast<uint32_t>(g_sources.size());
+
+	// In-memory sources are never deduplicated, each owns its own release callback
+	if (!faceInfo.data.empty()) {
+		g_sources.emplace_back(faceInfo.data, faceInfo.pfnRelease, faceInfo.pReleaseUserData);
+		return result;
+	}
+
+	if (auto it = g_sourcesByURI.find(faceInfo.uri); it != g_sourcesByURI.end()) {
+		return it->second;
+	}
+
+	g_sourcesByURI.emplace(std::make_pair(std::string(faceInfo.uri), result));
+	g_sources.emplace_back(g_fileFuncs.pfnMapFile(faceInfo.uri));
 
 	return result;
 }
@@ -631,9 +720,17 @@ static FaceDataHandle find_compatible_font(Text::Font font, uint32_t codepoint,
 	return FaceDataHandle{};
 }
 
-FaceData::~FaceData() {
-	if (mapping.mapping) {
-		g_fileFuncs.pfnUnmapFile(mapping);
+FontSource::~FontSource() {
+	if (blob) {
+		hb_blob_destroy(blob);
 	}
-}
 
+	if (fileMapped) {
+		if (mapping.mapping) {
+			g_fileFuncs.pfnUnmapFile(mapping);
+		}
+	}
+	else if (pfnRelease) {
+		pfnRelease({reinterpret_cast<const std::byte*>(mapping.mapping), mapping.size}, pReleaseUserData);
+	}
+}
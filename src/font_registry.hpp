@@ -6,11 +6,31 @@
 
 #include <unicode/uscript.h>
 
+#include <cstddef>
+#include <span>
+
 namespace Text {
 
+/**
+ * Callback notifying the owner of in-memory font data that the registry no longer references it.
+ */
+using PFN_FontDataRelease = void (*)(std::span<const std::byte> data, void* pUserData);
+
+/**
+ * Describes a single font face. If `data` is non-empty, the face is loaded directly from the provided memory
+ * and `uri` is ignored; no copy of the data is made. The memory must remain valid and unmodified until
+ * `pfnRelease` is invoked, or until program termination if `pfnRelease` is null.
+ *
+ * `faceIndex` selects the face within a font collection (.ttc/.otc), and should be 0 for single-face files.
+ * Faces sharing the same `uri` share a single file mapping.
+ */
 struct FontFaceCreateInfo {
 	std::string_view name;
 	std::string_view uri;
+	std::span<const std::byte> data;
+	PFN_FontDataRelease pfnRelease;
+	void* pReleaseUserData;
+	uint32_t faceIndex;
 	FontWeight weight: 4;
 	FontStyle style: 2;
 };
@@ -46,6 +66,14 @@ namespace Text::FontRegistry {
  */
 [[nodiscard]] FontFamily get_family(std::string_view name);
 
+/**
+ * Gets the name the given family was registered or referenced under. Returns an empty string if the handle is
+ * invalid. The returned view remains valid until program termination.
+ *
+ * @thread_safety Thread safe, may block internally.
+ */
+[[nodiscard]] std::string_view get_family_name(FontFamily family);
+
 /**
  * Gets a handle for a face of the given family, weight, and style. Equivalent to constructing the FontFace
  * from the results of `get_family(familyName)`.
@@ -93,7 +121,9 @@ namespace Text::FontRegistry {
  * `pFaces` *must* not be null and contain at least one face.
  * All faces must have a globally unique name across all families.
  * Each face provided for a single family must have a unique weight and style.
- * Faces *may* share the same URI.
+ * Faces *may* share the same URI, in which case the file is only mapped once.
+ * If a face's name was already registered, its `pfnRelease` callback (if any) is invoked immediately, as the
+ * registry will not reference its data.
  *
  * @thread_safety Thread safe, may block internally.
  */
@@ -140,5 +170,14 @@ namespace Text::FontRegistry {
  */
 void set_file_mapping_functions(const FileMappingFunctions& funcs);
 
+/**
+ * Sets the font functions HarfBuzz uses to look up glyphs and metrics while shaping. Defaults to
+ * `HarfbuzzFontFuncs::FREETYPE`. As with `set_file_mapping_functions`, this function can only be called before
+ * the `FontRegistry` has begun to be used to load fonts.
+ *
+ * @thread_safety This function must be externally synchronized.
+ */
+void set_shaping_font_funcs(HarfbuzzFontFuncs funcs);
+
 }
 
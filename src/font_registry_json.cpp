@@ -148,6 +148,18 @@ FontRegistryError FontRegistry::register_family_from_json_data(std::string_view
 		}
 
 		face.style = style.compare("italic") == 0 ? FontStyle::ITALIC : FontStyle::NORMAL;
+
+		int64_t faceIndex;
+		if (auto err = faceObject["index"].get(faceIndex); err == 0) {
+			if (faceIndex < 0 || faceIndex > 0xFFFF) {
+				return FontRegistryError::INVALID_JSON;
+			}
+
+			face.faceIndex = static_cast<uint32_t>(faceIndex);
+		}
+		else if (err != simdjson::NO_SUCH_FIELD) {
+			return FontRegistryError::INVALID_JSON;
+		}
 	}
 
 	std::vector<UScriptCode> scriptCodes;
@@ -1,10 +1,10 @@
 #include "formatting.hpp"
 
 #include "font_registry.hpp"
-#include "value_run_builder.hpp"
 
+#include <algorithm>
 #include <charconv>
-#include <sstream>
+#include <iterator>
 #include <string_view>
 #include <type_traits>
 
@@ -18,9 +18,10 @@ static constexpr bool is_space(char c) {
 	return c == ' ' || c == '\t' || c == '\r' || c == '\n';
 }
 
-namespace {
+static void set_default_formatting_runs(FormattingRuns& result, int32_t length, Font baseFont, Color baseColor,
+		const StrokeState& baseStroke);
 
-struct FontAttributes {
+struct FormattingParser::FontAttributes {
 	FontFamily family{}; 
 	uint32_t size{};
 	Color color;
@@ -30,87 +31,17 @@ struct FontAttributes {
 	bool weightChange{false};
 };
 
-class FormattingParser {
-	public:
-		explicit FormattingParser(const std::string& text, Font baseFont, Color&& baseColor,
-				const StrokeState& baseStroke);
-
-		void parse();
-
-		FormattingRuns get_result(std::string& contentText);
-		bool has_error() const;
-	private:
-		const char* m_iter;
-		const char* m_end;
-		std::ostringstream m_output;
-		bool m_error{false};
-
-		const std::string& m_text;
-		
-		ValueRunBuilder<Font> m_fontRuns;
-		ValueRunBuilder<Color> m_colorRuns;
-		ValueRunBuilder<StrokeState> m_strokeRuns;
-		ValueRunBuilder<bool> m_strikethroughRuns;
-		ValueRunBuilder<bool> m_underlineRuns;
-		ValueRunBuilder<bool> m_smallcapsRuns;
-		ValueRunBuilder<bool> m_subscriptRuns;
-		ValueRunBuilder<bool> m_superscriptRuns;
-
-		void parse_content(std::string_view expectedClose);
-		bool parse_open_bracket(std::string_view expectedClose);
-
-		void parse_comment();
-
-		void parse_b_tag();
-		void parse_s_tag();
-		void parse_u_tag();
-
-		void parse_su_tag();
-
-		void parse_font();
-		[[nodiscard]] FontAttributes parse_font_attributes();
-		void parse_font_face(FontAttributes&);
-
-		void parse_bool_tag(ValueRunBuilder<bool>& builder, std::string_view closingTag);
-
-		void parse_italic();
-		void parse_smallcaps(std::string_view closingTag);
-		void parse_subscript();
-
-		void parse_stroke();
-		[[nodiscard]] StrokeState parse_stroke_attributes();
-		void parse_stroke_joins(StrokeState&);
-
-		std::string_view parse_attribute(std::string_view name);
-		template <typename T> requires std::is_arithmetic_v<T>
-		void parse_attribute(std::string_view name, T& value);
-		void parse_attribute(std::string_view name, Color& value);
-		void parse_attribute(std::string_view name, FontWeight& value);
-
-		void parse_line_break();
-
-		bool parse_color(uint32_t&);
-		bool parse_color_hex(uint32_t&);
-		bool parse_color_rgb(uint32_t&);
-
-		bool consume_char(char);
-		bool consume_word(std::string_view);
-		char next_char();
-		int32_t get_current_string_index() const;
-		void raise_error();
-
-		void finalize_runs();
-};
-
-}
-
 // RichText API
 
 FormattingRuns Text::make_default_formatting_runs(const std::string& text, std::string& contentText,
 		Font baseFont, Color baseColor, const StrokeState& baseStroke) {
 	contentText = text;
-	auto length = static_cast<int32_t>(text.size());
+	return make_default_formatting_runs(static_cast<int32_t>(text.size()), std::move(baseFont),
+			std::move(baseColor), baseStroke);
+}
 
+FormattingRuns Text::make_default_formatting_runs(int32_t length, Font baseFont, Color baseColor,
+		const StrokeState& baseStroke) {
 	return {
 		.fontRuns{baseFont, length},
 		.colorRuns{std::move(baseColor), length},
@@ -125,82 +56,272 @@ FormattingRuns Text::make_default_formatting_runs(const std::string& text, std::
 
 FormattingRuns Text::parse_inline_formatting(const std::string& text, std::string& contentText,
 		Font baseFont, Color baseColor, const StrokeState& baseStroke) {
-	FormattingParser parser(text, baseFont, std::move(baseColor), baseStroke);
-	parser.parse();
-	return parser.get_result(contentText);
+	FormattingParser parser;
+	FormattingRuns result;
+	contentText = parser.parse(text, result, baseFont, std::move(baseColor), baseStroke);
+	return result;
 }
 
 // FormattingParser
 
-FormattingParser::FormattingParser(const std::string& text, Font baseFont, Color&& baseColor,
-			const StrokeState& baseStroke)
-		: m_iter(text.data())
-		, m_end(text.data() + text.size())
-		, m_text(text)
-		, m_fontRuns{baseFont}
-		, m_colorRuns{std::move(baseColor)}
-		, m_strokeRuns{baseStroke}
-		, m_strikethroughRuns{false}
-		, m_underlineRuns{false}
-		, m_smallcapsRuns{false}
-		, m_subscriptRuns{false}
-		, m_superscriptRuns{false} {}
-
-FormattingRuns FormattingParser::get_result(std::string& contentText) {
+std::string_view FormattingParser::parse(std::string_view text, FormattingRuns& result, Font baseFont,
+		Color baseColor, const StrokeState& baseStroke) {
+	m_error = false;
+	std::fill(std::begin(m_finalRunCounts), std::end(m_finalRunCounts), 0);
+
+	auto length = static_cast<int32_t>(text.size());
+
+	// Text without any tags is its own content, no need to copy it
+	if (text.empty() || !std::memchr(text.data(), '<', text.size())) {
+		set_default_formatting_runs(result, length, baseFont, std::move(baseColor), baseStroke);
+		return text;
+	}
+
+	reset(text, 0, 0, baseFont, baseColor, baseStroke);
+	std::fill(std::begin(m_runCountOffsets), std::end(m_runCountOffsets), 0);
+	m_output.reserve(text.size());
+
+	parse_top_level({}, 0);
+
 	if (m_error) {
-		return make_default_formatting_runs(m_text, contentText, m_fontRuns.get_base_value(),
-				m_colorRuns.get_base_value(), m_strokeRuns.get_base_value());
+		set_default_formatting_runs(result, length, baseFont, std::move(baseColor), baseStroke);
+		return text;
+	}
+
+	get_run_counts(m_finalRunCounts);
+	finalize_runs();
+
+	m_fontRuns.get(result.fontRuns);
+	m_colorRuns.get(result.colorRuns);
+	m_strokeRuns.get(result.strokeRuns);
+	m_strikethroughRuns.get(result.strikethroughRuns);
+	m_underlineRuns.get(result.underlineRuns);
+	m_smallcapsRuns.get(result.smallcapsRuns);
+	m_subscriptRuns.get(result.subscriptRuns);
+	m_superscriptRuns.get(result.superscriptRuns);
+
+	return m_output;
+}
+
+void FormattingParser::parse(std::string_view text, std::string& contentText, FormattingRuns& result,
+		FormattingSourceMap& sourceMap, Font baseFont, Color baseColor, const StrokeState& baseStroke) {
+	sourceMap.elements.clear();
+
+	m_pElements = &sourceMap.elements;
+	contentText = parse(text, result, baseFont, std::move(baseColor), baseStroke);
+	m_pElements = nullptr;
+
+	if (m_error) {
+		sourceMap.elements.clear();
+	}
+
+	std::copy(std::begin(m_finalRunCounts), std::end(m_finalRunCounts), sourceMap.finalRunCounts);
+	sourceMap.sourceLength = static_cast<int32_t>(text.size());
+	sourceMap.valid = !m_error;
+}
+
+void FormattingParser::reparse(std::string_view text, const SourceEdit& edit, std::string& contentText,
+		FormattingRuns& result, FormattingSourceMap& sourceMap, Font baseFont, Color baseColor,
+		const StrokeState& baseStroke) {
+	auto sourceDelta = static_cast<int32_t>(edit.insertedLength) - static_cast<int32_t>(edit.removedLength);
+
+	if (!sourceMap.valid || static_cast<int32_t>(text.size()) != sourceMap.sourceLength + sourceDelta
+			|| edit.start + edit.insertedLength > text.size()) {
+		parse(text, contentText, result, sourceMap, baseFont, std::move(baseColor), baseStroke);
+		return;
+	}
+
+	auto& elements = sourceMap.elements;
+	auto editStart = static_cast<int32_t>(edit.start);
+	auto oldEditEnd = static_cast<int32_t>(edit.start + edit.removedLength);
+
+	// The first top-level tag not entirely before the edit, from which on the old results are replaced
+	auto firstIndex = static_cast<size_t>(std::partition_point(elements.begin(), elements.end(),
+			[&](const auto& elem) { return elem.sourceEnd <= editStart; }) - elements.begin());
+	// The first top-level tag entirely after the edit, the earliest point at which re-parsing may stop
+	auto syncIndex = static_cast<size_t>(std::partition_point(elements.begin() + firstIndex, elements.end(),
+			[&](const auto& elem) { return elem.sourceBegin < oldEditEnd; }) - elements.begin());
+
+	int32_t sourceBegin;
+	int32_t contentBegin;
+
+	if (firstIndex < elements.size() && elements[firstIndex].sourceBegin < editStart) {
+		sourceBegin = elements[firstIndex].sourceBegin;
+		contentBegin = elements[firstIndex].contentBegin;
 	}
 	else {
-		contentText = m_output.str();
-
-		FormattingRuns result{
-			.fontRuns = m_fontRuns.get(),
-			.colorRuns = m_colorRuns.get(),
-			.strokeRuns = m_strokeRuns.get(),
-			.strikethroughRuns = m_strikethroughRuns.get(),
-			.underlineRuns = m_underlineRuns.get(),
-			.smallcapsRuns = m_smallcapsRuns.get(),
-			.subscriptRuns = m_subscriptRuns.get(),
-			.superscriptRuns = m_superscriptRuns.get(),
-		};
+		sourceBegin = editStart;
+		contentBegin = firstIndex == 0 ? editStart
+				: elements[firstIndex - 1].contentEnd + (editStart - elements[firstIndex - 1].sourceEnd);
+	}
+
+	std::copy_n(firstIndex < elements.size() ? elements[firstIndex].runCounts : sourceMap.finalRunCounts,
+			FormattingSourceMap::RUN_TYPE_COUNT, m_runCountOffsets);
 
-		return result;
+	reset(text, sourceBegin, contentBegin, baseFont, baseColor, baseStroke);
+	m_elements.clear();
+	m_pElements = &m_elements;
+	auto lastIndex = syncIndex + parse_top_level(std::span(elements).subspan(syncIndex), sourceDelta);
+	m_pElements = nullptr;
+
+	if (m_error) {
+		contentText.assign(text);
+		set_default_formatting_runs(result, static_cast<int32_t>(text.size()), baseFont, std::move(baseColor),
+				baseStroke);
+		sourceMap.elements.clear();
+		std::fill(std::begin(sourceMap.finalRunCounts), std::end(sourceMap.finalRunCounts), 0);
+		sourceMap.sourceLength = static_cast<int32_t>(text.size());
+		sourceMap.valid = false;
+		return;
 	}
+
+	// Everything from `lastIndex` onwards is unchanged apart from its position
+	uint32_t oldRunCountEnds[FormattingSourceMap::RUN_TYPE_COUNT];
+	std::copy_n(lastIndex < elements.size() ? elements[lastIndex].runCounts : sourceMap.finalRunCounts,
+			FormattingSourceMap::RUN_TYPE_COUNT, oldRunCountEnds);
+
+	auto oldContentEnd = lastIndex < elements.size() ? elements[lastIndex].contentBegin
+			: static_cast<int32_t>(contentText.size());
+	auto contentDelta = static_cast<int32_t>(m_output.size()) - (oldContentEnd - contentBegin);
+
+	contentText.replace(contentBegin, oldContentEnd - contentBegin, m_output);
+	auto contentLength = static_cast<int32_t>(contentText.size());
+
+	int32_t runCountDeltas[FormattingSourceMap::RUN_TYPE_COUNT];
+
+	for_each_run_type(result, [&](auto& builder, auto& runs, size_t typeIndex) {
+		auto& newRuns = builder.get_runs();
+		runCountDeltas[typeIndex] = static_cast<int32_t>(newRuns.get_run_count())
+				- static_cast<int32_t>(oldRunCountEnds[typeIndex] - m_runCountOffsets[typeIndex]);
+
+		// The runs closed at the end of the text may change with the runs before them, so close them anew
+		runs.truncate(sourceMap.finalRunCounts[typeIndex]);
+		runs.replace_runs(m_runCountOffsets[typeIndex], oldRunCountEnds[typeIndex], newRuns, contentDelta);
+
+		if (runs.empty() || runs.get_limit() < contentLength) {
+			runs.add(contentLength, builder.get_base_value());
+		}
+
+		sourceMap.finalRunCounts[typeIndex] += runCountDeltas[typeIndex];
+	});
+
+	for (size_t i = lastIndex; i < elements.size(); ++i) {
+		auto& elem = elements[i];
+		elem.sourceBegin += sourceDelta;
+		elem.sourceEnd += sourceDelta;
+		elem.contentBegin += contentDelta;
+		elem.contentEnd += contentDelta;
+
+		for (size_t j = 0; j < FormattingSourceMap::RUN_TYPE_COUNT; ++j) {
+			elem.runCounts[j] += runCountDeltas[j];
+		}
+	}
+
+	elements.erase(elements.begin() + firstIndex, elements.begin() + lastIndex);
+	elements.insert(elements.begin() + firstIndex, m_elements.begin(), m_elements.end());
+	sourceMap.sourceLength = static_cast<int32_t>(text.size());
 }
 
 bool FormattingParser::has_error() const {
 	return m_error;
 }
 
-void FormattingParser::parse() {
-	parse_content("");
+void FormattingParser::reset(std::string_view text, int32_t sourceOffset, int32_t contentOffset, Font baseFont,
+		Color baseColor, const StrokeState& baseStroke) {
+	m_iter = text.data() + sourceOffset;
+	m_end = text.data() + text.size();
+	m_text = text;
+	m_error = false;
+	m_output.clear();
+	m_contentOffset = contentOffset;
+
+	m_fontRuns.reset(baseFont);
+	m_colorRuns.reset(std::move(baseColor));
+	m_strokeRuns.reset(baseStroke);
+	m_strikethroughRuns.reset(false);
+	m_underlineRuns.reset(false);
+	m_smallcapsRuns.reset(false);
+	m_subscriptRuns.reset(false);
+	m_superscriptRuns.reset(false);
 }
 
-void FormattingParser::parse_content(std::string_view expectedClose) {
+// Parses content outside of any tag up to the end of the text, or up to the first tag starting where one of
+// `syncElements`, shifted by `sourceDelta`, started before, returning the index of that element
+size_t FormattingParser::parse_top_level(std::span<const FormattingSourceMap::Element> syncElements,
+		int32_t sourceDelta) {
+	size_t syncIndex{};
+
 	for (;;) {
-		auto c = next_char();
+		// Copy everything up to the next tag in one go
+		auto* pTag = m_iter < m_end
+				? static_cast<const char*>(std::memchr(m_iter, '<', static_cast<size_t>(m_end - m_iter)))
+				: nullptr;
+		auto* pSpanEnd = pTag ? pTag : m_end;
 
-		if (c == SENTINEL) {
-			if (expectedClose.empty()) {
-				finalize_runs();
-			}
-			else {
-				raise_error();
-			}
+		m_output.append(m_iter, pSpanEnd);
+		m_iter = pSpanEnd;
 
-			return;
+		if (!pTag) {
+			return syncElements.size();
 		}
-		else if (c == '<') {
-			if (parse_open_bracket(expectedClose)) {
-				return;
-			}
+
+		auto sourceIndex = get_current_string_index();
+
+		while (syncIndex < syncElements.size() && syncElements[syncIndex].sourceBegin + sourceDelta < sourceIndex) {
+			++syncIndex;
 		}
-		else {
-			m_output.put(c);
+
+		if (syncIndex < syncElements.size() && syncElements[syncIndex].sourceBegin + sourceDelta == sourceIndex) {
+			return syncIndex;
 		}
 
+		FormattingSourceMap::Element elem{
+			.sourceBegin = sourceIndex,
+			.sourceEnd = sourceIndex,
+			.contentBegin = get_content_index(),
+			.contentEnd = get_content_index(),
+			.runCounts = {},
+		};
+
+		if (m_pElements) {
+			get_run_counts(elem.runCounts);
+		}
+
+		++m_iter;
+		parse_open_bracket("");
+
 		if (m_error) {
+			return syncElements.size();
+		}
+
+		if (m_pElements) {
+			elem.sourceEnd = get_current_string_index();
+			elem.contentEnd = get_content_index();
+			m_pElements->emplace_back(elem);
+		}
+	}
+}
+
+void FormattingParser::parse_content(std::string_view expectedClose) {
+	for (;;) {
+		// Copy everything up to the next tag in one go
+		auto* pTag = m_iter < m_end
+				? static_cast<const char*>(std::memchr(m_iter, '<', static_cast<size_t>(m_end - m_iter)))
+				: nullptr;
+		auto* pSpanEnd = pTag ? pTag : m_end;
+
+		m_output.append(m_iter, pSpanEnd);
+		m_iter = pSpanEnd;
+
+		// Reached the end of the text with the tag still open
+		if (!pTag) {
+			raise_error();
+			return;
+		}
+
+		++m_iter;
+
+		if (parse_open_bracket(expectedClose) || m_error) {
 			return;
 		}
 	}
@@ -359,25 +480,25 @@ void FormattingParser::parse_font() {
 		auto weight = fontAttribs.weightChange ? fontAttribs.weight : currFont.get_weight();
 		Font newFont(family, weight, currFont.get_style(), size);
 
-		m_fontRuns.push(m_output.view().size(), newFont);
+		m_fontRuns.push(get_content_index(), newFont);
 	}
 
 	if (fontAttribs.colorChange) {
-		m_colorRuns.push(m_output.view().size(), fontAttribs.color); 
+		m_colorRuns.push(get_content_index(), fontAttribs.color); 
 	}
 
 	parse_content("font>");
 
 	if (hasFontChange) {
-		m_fontRuns.pop(m_output.view().size());
+		m_fontRuns.pop(get_content_index());
 	}
 
 	if (fontAttribs.colorChange) {
-		m_colorRuns.pop(m_output.view().size());
+		m_colorRuns.pop(get_content_index());
 	}
 }
 
-FontAttributes FormattingParser::parse_font_attributes() {
+FormattingParser::FontAttributes FormattingParser::parse_font_attributes() {
 	FontAttributes result{};
 
 	for (;;) {
@@ -425,9 +546,9 @@ void FormattingParser::parse_font_face(FontAttributes& attribs) {
 }
 
 void FormattingParser::parse_bool_tag(ValueRunBuilder<bool>& builder, std::string_view closingTag) {
-	builder.push(m_output.view().size(), true);
+	builder.push(get_content_index(), true);
 	parse_content(closingTag);
-	builder.pop(m_output.view().size());
+	builder.pop(get_content_index());
 }
 
 void FormattingParser::parse_italic() {
@@ -440,13 +561,13 @@ void FormattingParser::parse_italic() {
 
 	if (hasFontChange) {
 		Font newFont(currFont.get_family(), currFont.get_weight(), FontStyle::ITALIC, currFont.get_size());
-		m_fontRuns.push(m_output.view().size(), newFont);
+		m_fontRuns.push(get_content_index(), newFont);
 	}
 
 	parse_content("i>");
 
 	if (hasFontChange) {
-		m_fontRuns.pop(m_output.view().size());
+		m_fontRuns.pop(get_content_index());
 	}
 }
 
@@ -466,11 +587,11 @@ void FormattingParser::parse_stroke() {
 
 	auto state = parse_stroke_attributes();
 
-	m_strokeRuns.push(m_output.view().size(), state); 
+	m_strokeRuns.push(get_content_index(), state); 
 
 	parse_content("stroke>");
 
-	m_strokeRuns.pop(m_output.view().size());
+	m_strokeRuns.pop(get_content_index());
 }
 
 StrokeState FormattingParser::parse_stroke_attributes() {
@@ -610,6 +731,7 @@ void FormattingParser::parse_attribute(std::string_view name, FontWeight& value)
 
 	if (attrib.size() >= 16) {
 		raise_error();
+		return;
 	}
 
 	// Naive ASCII-only lower, insufficient for actual language applications, but since all formatting
@@ -766,13 +888,13 @@ bool FormattingParser::consume_char(char c) {
 }
 
 bool FormattingParser::consume_word(std::string_view word) {
-	for (size_t i = 0; i < word.size(); ++i) {
-		if (!consume_char(word[i])) {
-			return false;
-		}
+	if (static_cast<size_t>(m_end - m_iter) >= word.size() && std::memcmp(m_iter, word.data(), word.size()) == 0) {
+		m_iter += word.size();
+		return true;
 	}
 
-	return true;
+	raise_error();
+	return false;
 }
 
 char FormattingParser::next_char() {
@@ -783,18 +905,67 @@ int32_t FormattingParser::get_current_string_index() const {
 	return static_cast<int32_t>(m_iter - m_text.data());
 }
 
+int32_t FormattingParser::get_content_index() const {
+	return m_contentOffset + static_cast<int32_t>(m_output.size());
+}
+
 void FormattingParser::raise_error() {
 	m_error = true;
 }
 
-void FormattingParser::finalize_runs() {
-	m_fontRuns.pop(m_output.view().size());
-	m_colorRuns.pop(m_output.view().size());
-	m_strokeRuns.pop(m_output.view().size());
-	m_strikethroughRuns.pop(m_output.view().size());
-	m_underlineRuns.pop(m_output.view().size());
-	m_smallcapsRuns.pop(m_output.view().size());
-	m_subscriptRuns.pop(m_output.view().size());
-	m_superscriptRuns.pop(m_output.view().size());
+void FormattingParser::get_run_counts(uint32_t* pRunCounts) const {
+	pRunCounts[0] = m_runCountOffsets[0] + static_cast<uint32_t>(m_fontRuns.get_runs().get_run_count());
+	pRunCounts[1] = m_runCountOffsets[1] + static_cast<uint32_t>(m_colorRuns.get_runs().get_run_count());
+	pRunCounts[2] = m_runCountOffsets[2] + static_cast<uint32_t>(m_strokeRuns.get_runs().get_run_count());
+	pRunCounts[3] = m_runCountOffsets[3] + static_cast<uint32_t>(m_strikethroughRuns.get_runs().get_run_count());
+	pRunCounts[4] = m_runCountOffsets[4] + static_cast<uint32_t>(m_underlineRuns.get_runs().get_run_count());
+	pRunCounts[5] = m_runCountOffsets[5] + static_cast<uint32_t>(m_smallcapsRuns.get_runs().get_run_count());
+	pRunCounts[6] = m_runCountOffsets[6] + static_cast<uint32_t>(m_subscriptRuns.get_runs().get_run_count());
+	pRunCounts[7] = m_runCountOffsets[7] + static_cast<uint32_t>(m_superscriptRuns.get_runs().get_run_count());
 }
 
+void FormattingParser::finalize_runs() {
+	m_fontRuns.pop(get_content_index());
+	m_colorRuns.pop(get_content_index());
+	m_strokeRuns.pop(get_content_index());
+	m_strikethroughRuns.pop(get_content_index());
+	m_underlineRuns.pop(get_content_index());
+	m_smallcapsRuns.pop(get_content_index());
+	m_subscriptRuns.pop(get_content_index());
+	m_superscriptRuns.pop(get_content_index());
+}
+
+
+template <typename Functor>
+void FormattingParser::for_each_run_type(FormattingRuns& runs, Functor&& func) {
+	func(m_fontRuns, runs.fontRuns, 0);
+	func(m_colorRuns, runs.colorRuns, 1);
+	func(m_strokeRuns, runs.strokeRuns, 2);
+	func(m_strikethroughRuns, runs.strikethroughRuns, 3);
+	func(m_underlineRuns, runs.underlineRuns, 4);
+	func(m_smallcapsRuns, runs.smallcapsRuns, 5);
+	func(m_subscriptRuns, runs.subscriptRuns, 6);
+	func(m_superscriptRuns, runs.superscriptRuns, 7);
+}
+
+// Static Functions
+
+static void set_default_formatting_runs(FormattingRuns& result, int32_t length, Font baseFont, Color baseColor,
+		const StrokeState& baseStroke) {
+	result.fontRuns.clear();
+	result.fontRuns.add(length, baseFont);
+	result.colorRuns.clear();
+	result.colorRuns.add(length, std::move(baseColor));
+	result.strokeRuns.clear();
+	result.strokeRuns.add(length, baseStroke);
+	result.strikethroughRuns.clear();
+	result.strikethroughRuns.add(length, false);
+	result.underlineRuns.clear();
+	result.underlineRuns.add(length, false);
+	result.smallcapsRuns.clear();
+	result.smallcapsRuns.add(length, false);
+	result.subscriptRuns.clear();
+	result.subscriptRuns.add(length, false);
+	result.superscriptRuns.clear();
+	result.superscriptRuns.add(length, false);
+}
@@ -2,10 +2,15 @@
 
 #include "color.hpp"
 #include "value_runs.hpp"
+#include "value_run_builder.hpp"
 #include "font.hpp"
 #include "stroke_type.hpp"
 
+#include <span>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
 
 namespace Text {
 
@@ -13,6 +18,8 @@ struct StrokeState {
 	Color color;
 	uint8_t thickness;
 	StrokeType joins;
+
+	constexpr bool operator==(const StrokeState&) const = default;
 };
 
 struct FormattingRuns {
@@ -26,8 +33,169 @@ struct FormattingRuns {
 	ValueRuns<bool> superscriptRuns;
 };
 
+/**
+ * Describes the replacement of `removedLength` bytes at `start` of a source text with `insertedLength` new bytes.
+ */
+struct SourceEdit {
+	uint32_t start;
+	uint32_t removedLength;
+	uint32_t insertedLength;
+};
+
+/**
+ * Records where the top-level tags of a parsed source text ended up in the content text and the runs, so that
+ * `FormattingParser::reparse` can re-parse only the part of the source affected by an edit.
+ */
+struct FormattingSourceMap {
+	static constexpr const size_t RUN_TYPE_COUNT = 8;
+
+	/**
+	 * A tag or comment outside of any other tag, from its opening `<` up to the end of its closing tag.
+	 */
+	struct Element {
+		int32_t sourceBegin;
+		int32_t sourceEnd;
+		int32_t contentBegin;
+		int32_t contentEnd;
+		// Number of runs of each `FormattingRuns` member, in declaration order, preceding the element
+		uint32_t runCounts[RUN_TYPE_COUNT];
+	};
+
+	std::vector<Element> elements;
+	// Number of runs of each `FormattingRuns` member preceding the runs closed at the end of the text
+	uint32_t finalRunCounts[RUN_TYPE_COUNT]{};
+	int32_t sourceLength{};
+	// False until a source has been parsed, or if it failed to parse and fell back to plain text
+	bool valid{false};
+};
+
+/**
+ * Parses inline formatting markup, such as `<font>`, `<i>` and `<stroke>` tags, into content text with the tags
+ * removed and the `FormattingRuns` describing it.
+ *
+ * Content between tags is located with a single `memchr` scan per span and appended in bulk. Text without any
+ * tags is not copied at all: `parse` returns a view of the input. A parser keeps its output buffer and run
+ * stacks between calls, so reusing one parser together with one `FormattingRuns` parses without reallocating
+ * once the buffers have grown to fit.
+ *
+ * On malformed markup, the whole input is treated as plain text with the base formatting.
+ *
+ * @thread_safety A single parser must not be used from multiple threads concurrently.
+ */
+class FormattingParser {
+	public:
+		/**
+		 * Parses `text` into `result`, replacing its previous contents, and returns the content text.
+		 *
+		 * The returned view points either into `text` or into the parser's own buffer, and is valid until the
+		 * next call to `parse` or until `text` is destroyed.
+		 */
+		std::string_view parse(std::string_view text, FormattingRuns& result, Font baseFont, Color baseColor,
+				const StrokeState& baseStroke);
+		/**
+		 * Parses `text` into `contentText` and `result`, also recording `sourceMap` for later calls to `reparse`.
+		 */
+		void parse(std::string_view text, std::string& contentText, FormattingRuns& result,
+				FormattingSourceMap& sourceMap, Font baseFont, Color baseColor, const StrokeState& baseStroke);
+		/**
+		 * Brings `contentText`, `result` and `sourceMap`, produced by parsing the source text as it was before
+		 * `edit`, up to date with `text`, the source text after `edit`.
+		 *
+		 * Parsing restarts at the top-level tag enclosing the start of the edit, or at the edit itself if it starts
+		 * between tags, and stops at the first top-level tag past the edit that was already parsed. The runs
+		 * produced in between are spliced into `result` and the limits of the runs after them shifted, so the cost
+		 * of parsing depends on the extent of the edit rather than on the length of the text.
+		 *
+		 * Falls back to a full parse if `sourceMap` is not valid or does not match the length of `text`.
+		 */
+		void reparse(std::string_view text, const SourceEdit& edit, std::string& contentText,
+				FormattingRuns& result, FormattingSourceMap& sourceMap, Font baseFont, Color baseColor,
+				const StrokeState& baseStroke);
+
+		bool has_error() const;
+	private:
+		struct FontAttributes;
+
+		const char* m_iter{};
+		const char* m_end{};
+		std::string m_output;
+		bool m_error{false};
+
+		std::string_view m_text;
+
+		// Offsets of the content index and run counts, when re-parsing from the middle of a text
+		int32_t m_contentOffset{};
+		uint32_t m_runCountOffsets[FormattingSourceMap::RUN_TYPE_COUNT]{};
+		uint32_t m_finalRunCounts[FormattingSourceMap::RUN_TYPE_COUNT]{};
+
+		// Top-level tags are recorded here while parsing with a source map
+		std::vector<FormattingSourceMap::Element>* m_pElements{};
+		std::vector<FormattingSourceMap::Element> m_elements;
+
+		ValueRunBuilder<Font> m_fontRuns;
+		ValueRunBuilder<Color> m_colorRuns;
+		ValueRunBuilder<StrokeState> m_strokeRuns;
+		ValueRunBuilder<bool> m_strikethroughRuns;
+		ValueRunBuilder<bool> m_underlineRuns;
+		ValueRunBuilder<bool> m_smallcapsRuns;
+		ValueRunBuilder<bool> m_subscriptRuns;
+		ValueRunBuilder<bool> m_superscriptRuns;
+
+		void reset(std::string_view text, int32_t sourceOffset, int32_t contentOffset, Font baseFont,
+				Color baseColor, const StrokeState& baseStroke);
+
+		size_t parse_top_level(std::span<const FormattingSourceMap::Element> syncElements, int32_t sourceDelta);
+		void parse_content(std::string_view expectedClose);
+		bool parse_open_bracket(std::string_view expectedClose);
+
+		void parse_comment();
+
+		void parse_s_tag();
+		void parse_u_tag();
+
+		void parse_su_tag();
+
+		void parse_font();
+		[[nodiscard]] FontAttributes parse_font_attributes();
+		void parse_font_face(FontAttributes&);
+
+		void parse_bool_tag(ValueRunBuilder<bool>& builder, std::string_view closingTag);
+
+		void parse_italic();
+		void parse_smallcaps(std::string_view closingTag);
+
+		void parse_stroke();
+		[[nodiscard]] StrokeState parse_stroke_attributes();
+		void parse_stroke_joins(StrokeState&);
+
+		std::string_view parse_attribute(std::string_view name);
+		template <typename T> requires std::is_arithmetic_v<T>
+		void parse_attribute(std::string_view name, T& value);
+		void parse_attribute(std::string_view name, Color& value);
+		void parse_attribute(std::string_view name, FontWeight& value);
+
+		bool parse_color(uint32_t&);
+		bool parse_color_hex(uint32_t&);
+		bool parse_color_rgb(uint32_t&);
+
+		bool consume_char(char);
+		bool consume_word(std::string_view);
+		char next_char();
+		int32_t get_current_string_index() const;
+		int32_t get_content_index() const;
+		void raise_error();
+
+		void get_run_counts(uint32_t* pRunCounts) const;
+		void finalize_runs();
+
+		template <typename Functor>
+		void for_each_run_type(FormattingRuns& runs, Functor&& func);
+};
+
 FormattingRuns make_default_formatting_runs(const std::string& text, std::string& contentText,
 		Font baseFont, Color baseColor, const StrokeState& baseStroke);
+FormattingRuns make_default_formatting_runs(int32_t length, Font baseFont, Color baseColor,
+		const StrokeState& baseStroke);
 FormattingRuns parse_inline_formatting(const std::string& text, std::string& contentText, 
 		Font baseFont, Color baseColor, const StrokeState& baseStroke);
 
@@ -0,0 +1,289 @@
+#include "formatting_binary.hpp"
+
+#include "font_registry.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace Text;
+
+static constexpr const uint32_t FILE_MAGIC = 0x42465452u; // "RTFB"
+static constexpr const uint32_t FILE_VERSION = 1;
+
+namespace {
+
+struct FileHeader {
+	uint32_t magic;
+	uint32_t version;
+};
+
+}
+
+template <typename T>
+static void write_value(std::vector<std::byte>& output, const T& value);
+static void write_bytes(std::vector<std::byte>& output, const void* data, size_t size);
+template <typename T, typename Encoder>
+static void write_runs(std::vector<std::byte>& output, const ValueRuns<T>& runs, Encoder&& encoder);
+
+// FormattingWriter
+
+FormattingWriter::FormattingWriter() {
+	clear();
+}
+
+void FormattingWriter::write(std::string_view contentText, const FormattingRuns& formatting) {
+	write_value(m_data, static_cast<uint32_t>(contentText.size()));
+	write_bytes(m_data, contentText.data(), contentText.size());
+
+	// Font table, referenced by index from the font runs
+	m_fonts.clear();
+
+	for (size_t i = 0; i < formatting.fontRuns.get_run_count(); ++i) {
+		auto font = formatting.fontRuns.get_run_value(i);
+
+		if (std::find(m_fonts.begin(), m_fonts.end(), font) == m_fonts.end()) {
+			m_fonts.emplace_back(font);
+		}
+	}
+
+	write_value(m_data, static_cast<uint16_t>(m_fonts.size()));
+
+	for (auto& font : m_fonts) {
+		auto name = font.get_family() ? FontRegistry::get_family_name(font.get_family()) : std::string_view{};
+		write_value(m_data, static_cast<uint16_t>(name.size()));
+		write_bytes(m_data, name.data(), name.size());
+		write_value(m_data, static_cast<uint8_t>(font.get_weight()));
+		write_value(m_data, static_cast<uint8_t>(font.get_style()));
+		write_value(m_data, font.get_size());
+	}
+
+	write_runs(m_data, formatting.fontRuns, [&](const Font& font) {
+		auto index = std::find(m_fonts.begin(), m_fonts.end(), font) - m_fonts.begin();
+		write_value(m_data, static_cast<uint16_t>(index));
+	});
+
+	write_runs(m_data, formatting.colorRuns, [&](const Color& color) {
+		write_value(m_data, color);
+	});
+
+	write_runs(m_data, formatting.strokeRuns, [&](const StrokeState& stroke) {
+		write_value(m_data, stroke.color);
+		write_value(m_data, stroke.thickness);
+		write_value(m_data, static_cast<uint8_t>(stroke.joins));
+	});
+
+	auto writeBool = [&](bool value) {
+		write_value(m_data, static_cast<uint8_t>(value));
+	};
+
+	write_runs(m_data, formatting.strikethroughRuns, writeBool);
+	write_runs(m_data, formatting.underlineRuns, writeBool);
+	write_runs(m_data, formatting.smallcapsRuns, writeBool);
+	write_runs(m_data, formatting.subscriptRuns, writeBool);
+	write_runs(m_data, formatting.superscriptRuns, writeBool);
+}
+
+void FormattingWriter::clear() {
+	m_data.clear();
+	write_value(m_data, FileHeader{
+		.magic = FILE_MAGIC,
+		.version = FILE_VERSION,
+	});
+}
+
+std::span<const std::byte> FormattingWriter::get_data() const {
+	return m_data;
+}
+
+// FormattingReader
+
+FormattingReader::FormattingReader(std::span<const std::byte> data)
+		: m_data(data) {
+	FileHeader header{};
+	m_error = !read_value(header) || header.magic != FILE_MAGIC || header.version != FILE_VERSION;
+}
+
+bool FormattingReader::read(std::string_view& contentText, FormattingRuns& result) {
+	if (m_error || m_offset == m_data.size()) {
+		return false;
+	}
+
+	uint32_t contentLength{};
+
+	if (!read_value(contentLength) || contentLength > INT32_MAX || m_data.size() - m_offset < contentLength) {
+		m_error = true;
+		return false;
+	}
+
+	contentText = {reinterpret_cast<const char*>(m_data.data() + m_offset), contentLength};
+	m_offset += contentLength;
+
+	auto limit = static_cast<int32_t>(contentLength);
+
+	auto readBool = [&](bool& value) {
+		uint8_t byte{};
+
+		if (!read_value(byte) || byte > 1) {
+			return false;
+		}
+
+		value = byte != 0;
+		return true;
+	};
+
+	m_error = !read_fonts()
+			|| !read_runs(result.fontRuns, limit, [&](Font& font) {
+				uint16_t index{};
+
+				if (!read_value(index) || index >= m_fonts.size()) {
+					return false;
+				}
+
+				font = m_fonts[index];
+				return true;
+			})
+			|| !read_runs(result.colorRuns, limit, [&](Color& color) {
+				return read_value(color);
+			})
+			|| !read_runs(result.strokeRuns, limit, [&](StrokeState& stroke) {
+				uint8_t joins{};
+
+				if (!read_value(stroke.color) || !read_value(stroke.thickness) || !read_value(joins)
+						|| joins > static_cast<uint8_t>(StrokeType::MITER)) {
+					return false;
+				}
+
+				stroke.joins = static_cast<StrokeType>(joins);
+				return true;
+			})
+			|| !read_runs(result.strikethroughRuns, limit, readBool)
+			|| !read_runs(result.underlineRuns, limit, readBool)
+			|| !read_runs(result.smallcapsRuns, limit, readBool)
+			|| !read_runs(result.subscriptRuns, limit, readBool)
+			|| !read_runs(result.superscriptRuns, limit, readBool);
+
+	return !m_error;
+}
+
+bool FormattingReader::has_error() const {
+	return m_error;
+}
+
+bool FormattingReader::read_fonts() {
+	uint16_t fontCount{};
+
+	if (!read_value(fontCount)) {
+		return false;
+	}
+
+	m_fonts.clear();
+
+	for (uint16_t i = 0; i < fontCount; ++i) {
+		uint16_t nameLength{};
+		uint8_t weight{};
+		uint8_t style{};
+		uint32_t size{};
+
+		if (!read_value(nameLength) || m_data.size() - m_offset < nameLength) {
+			return false;
+		}
+
+		std::string_view name(reinterpret_cast<const char*>(m_data.data() + m_offset), nameLength);
+		m_offset += nameLength;
+
+		if (!read_value(weight) || !read_value(style) || !read_value(size)
+				|| weight >= static_cast<uint8_t>(FontWeight::COUNT)
+				|| style >= static_cast<uint8_t>(FontStyle::COUNT)) {
+			return false;
+		}
+
+		m_fonts.emplace_back(get_family(name), static_cast<FontWeight>(weight), static_cast<FontStyle>(style),
+				size);
+	}
+
+	return true;
+}
+
+FontFamily FormattingReader::get_family(std::string_view name) {
+	if (name.empty()) {
+		return {};
+	}
+
+	if (auto it = m_families.find(name); it != m_families.end()) {
+		return it->second;
+	}
+
+	auto family = FontRegistry::get_family(name);
+	m_families.emplace(std::string(name), family);
+
+	return family;
+}
+
+template <typename T>
+bool FormattingReader::read_value(T& value) {
+	if (m_data.size() - m_offset < sizeof(T)) {
+		return false;
+	}
+
+	std::memcpy(&value, m_data.data() + m_offset, sizeof(T));
+	m_offset += sizeof(T);
+
+	return true;
+}
+
+template <typename T, typename Decoder>
+bool FormattingReader::read_runs(ValueRuns<T>& runs, int32_t limit, Decoder&& decoder) {
+	uint32_t runCount{};
+
+	// Each run takes at least 5 bytes, which bounds the reservation for malformed counts. Empty runs are only
+	// accepted over empty text, by the limit check below
+	if (!read_value(runCount) || (m_data.size() - m_offset) / 5 < runCount) {
+		return false;
+	}
+
+	runs.clear();
+	runs.reserve(runCount);
+
+	int32_t prevLimit{};
+
+	for (uint32_t i = 0; i < runCount; ++i) {
+		int32_t runLimit{};
+		T value{};
+
+		if (!read_value(runLimit) || runLimit < prevLimit || runLimit > limit || !decoder(value)) {
+			return false;
+		}
+
+		runs.add(runLimit, value);
+		prevLimit = runLimit;
+	}
+
+	return prevLimit == limit;
+}
+
+// Static Functions
+
+template <typename T>
+static void write_value(std::vector<std::byte>& output, const T& value) {
+	write_bytes(output, &value, sizeof(T));
+}
+
+static void write_bytes(std::vector<std::byte>& output, const void* data, size_t size) {
+	auto offset = output.size();
+	output.resize(offset + size);
+
+	if (size > 0) {
+		std::memcpy(output.data() + offset, data, size);
+	}
+}
+
+template <typename T, typename Encoder>
+static void write_runs(std::vector<std::byte>& output, const ValueRuns<T>& runs, Encoder&& encoder) {
+	write_value(output, static_cast<uint32_t>(runs.get_run_count()));
+
+	for (size_t i = 0; i < runs.get_run_count(); ++i) {
+		write_value(output, runs.get_run_limit(i));
+		encoder(runs.get_run_value(i));
+	}
+}
+
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "formatting.hpp"
+#include "string_hash.hpp"
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Text {
+
+/**
+ * Encodes pre-parsed rich text, as content text together with its `FormattingRuns`, into a sequence of binary
+ * records that `FormattingReader` can load without parsing markup.
+ *
+ * Fonts are stored by family name, weight, style and size, so that the encoding does not depend on the order in
+ * which families were registered. Values are stored in host byte order.
+ *
+ * @thread_safety Not thread safe.
+ */
+class FormattingWriter {
+	public:
+		explicit FormattingWriter();
+
+		/**
+		 * Appends a record for `contentText` formatted by `formatting`. Fonts with families not known to the
+		 * `FontRegistry` are stored without a family name.
+		 */
+		void write(std::string_view contentText, const FormattingRuns& formatting);
+		/**
+		 * Removes all records.
+		 */
+		void clear();
+
+		std::span<const std::byte> get_data() const;
+	private:
+		std::vector<std::byte> m_data;
+		std::vector<Font> m_fonts;
+};
+
+/**
+ * Reads the records produced by `FormattingWriter`, for example from a file mapped with `map_file_default`.
+ *
+ * The content text of each record is returned as a view into the data, so the data must outlive the views. Runs
+ * are decoded into the caller's `FormattingRuns`, reserving exactly the number of runs of each record, so reading
+ * many records into the same `FormattingRuns` in turn does not reallocate once it has grown to fit.
+ *
+ * Family names are resolved through `FontRegistry::get_family` once per reader and name.
+ *
+ * @thread_safety Not thread safe.
+ */
+class FormattingReader {
+	public:
+		/**
+		 * Begins reading `data`. Sets the error state if `data` does not start with a valid header.
+		 */
+		explicit FormattingReader(std::span<const std::byte> data);
+
+		/**
+		 * Decodes the next record into `contentText` and `result`. Returns false once all records have been
+		 * read, or if the record is malformed, in which case `has_error` is set and no further records are read.
+		 */
+		bool read(std::string_view& contentText, FormattingRuns& result);
+
+		bool has_error() const;
+	private:
+		std::span<const std::byte> m_data;
+		size_t m_offset{};
+		bool m_error{};
+
+		std::vector<Font> m_fonts;
+		std::unordered_map<std::string, FontFamily, StringHash, std::equal_to<>> m_families;
+
+		bool read_fonts();
+		FontFamily get_family(std::string_view name);
+
+		template <typename T>
+		bool read_value(T& value);
+		template <typename T, typename Decoder>
+		bool read_runs(ValueRuns<T>& runs, int32_t limit, Decoder&& decoder);
+};
+
+}
+
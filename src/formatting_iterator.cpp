@@ -1,10 +1,15 @@
 #include "formatting_iterator.hpp"
 #include "formatting.hpp"
+#include "style_table.hpp"
 
 using namespace Text;
 
 template <typename T>
 static uint32_t advance_run(const ValueRuns<T>& runs, uint32_t runIndex, uint32_t charIndex);
+static FormattingEvent make_event(bool strikethrough, bool underline, bool colorChanged, bool prevStrikethrough,
+		bool prevUnderline);
+
+// FormattingIterator
 
 FormattingIterator::FormattingIterator(const FormattingRuns& fmt, uint32_t charIndex)
 		: m_formatting(&fmt)
@@ -25,17 +30,7 @@ FormattingEvent FormattingIterator::advance_to(uint32_t charIndex) {
 	auto color = m_formatting->colorRuns.get_run_value(m_colorRunIndex);
 	bool strikethrough = m_formatting->strikethroughRuns.get_run_value(m_strikethroughRunIndex);
 	bool underline = m_formatting->underlineRuns.get_run_value(m_underlineRunIndex);
-	bool colorChanged = color != m_color;
-
-	auto event = static_cast<FormattingEvent>(
-			static_cast<uint32_t>(FormattingEvent::STRIKETHROUGH_BEGIN)
-					* (strikethrough && (!m_strikethrough || colorChanged))
-			| static_cast<uint32_t>(FormattingEvent::STRIKETHROUGH_END)
-					* ((!strikethrough && m_strikethrough) || (strikethrough && colorChanged))
-			| static_cast<uint32_t>(FormattingEvent::UNDERLINE_BEGIN)
-					* (underline && (!m_underline || colorChanged))
-			| static_cast<uint32_t>(FormattingEvent::UNDERLINE_END)
-					* ((!underline && m_underline) || (underline && colorChanged)));
+	auto event = make_event(strikethrough, underline, color != m_color, m_strikethrough, m_underline);
 
 	m_prevColor = m_color;
 	m_color = color;
@@ -65,6 +60,60 @@ bool FormattingIterator::has_underline() const {
 	return m_underline;
 }
 
+// CompactFormattingIterator
+
+CompactFormattingIterator::CompactFormattingIterator(const CompactFormattingRuns& fmt, uint32_t charIndex)
+		: m_formatting(&fmt)
+		, m_runIndex(static_cast<uint32_t>(fmt.styleRuns.get_run_containing_index(charIndex)))
+		, m_strikethrough{false}
+		, m_underline{false} {
+	m_style = &fmt.styles.get_style(fmt.styleRuns.get_run_value(m_runIndex));
+}
+
+FormattingEvent CompactFormattingIterator::advance_to(uint32_t charIndex) {
+	m_runIndex = advance_run(m_formatting->styleRuns, m_runIndex, charIndex);
+	auto& style = m_formatting->styles.get_style(m_formatting->styleRuns.get_run_value(m_runIndex));
+	bool strikethrough = style.has(StyleFlags::STRIKETHROUGH);
+	bool underline = style.has(StyleFlags::UNDERLINE);
+
+	m_prevColor = m_style->color;
+
+	if (&style == m_style && strikethrough == m_strikethrough && underline == m_underline) {
+		return FormattingEvent::NONE;
+	}
+
+	auto event = make_event(strikethrough, underline, style.color != m_style->color, m_strikethrough,
+			m_underline);
+
+	m_style = &style;
+	m_strikethrough = strikethrough;
+	m_underline = underline;
+
+	return event;
+}
+
+const Color& CompactFormattingIterator::get_color() const {
+	return m_style->color;
+}
+
+const Color& CompactFormattingIterator::get_prev_color() const {
+	return m_prevColor;
+}
+
+StrokeState CompactFormattingIterator::get_stroke_state() const {
+	return m_style->stroke;
+}
+
+bool CompactFormattingIterator::has_strikethrough() const {
+	return m_strikethrough;
+}
+
+bool CompactFormattingIterator::has_underline() const {
+	return m_underline;
+}
+
+// Static Functions
+
 template <typename T>
 static uint32_t advance_run(const ValueRuns<T>& runs, uint32_t runIndex, uint32_t charIndex) {
 	while (runIndex +  1 < runs.get_run_count() && charIndex >= runs.get_run_limit(runIndex)) {
@@ -78,3 +127,15 @@ static uint32_t advance_run(const ValueRuns<T>& runs, uint32_t runIndex, uint32_
 	return runIndex;
 }
 
+static FormattingEvent make_event(bool strikethrough, bool underline, bool colorChanged, bool prevStrikethrough,
+		bool prevUnderline) {
+	return static_cast<FormattingEvent>(
+			static_cast<uint32_t>(FormattingEvent::STRIKETHROUGH_BEGIN)
+					* (strikethrough && (!prevStrikethrough || colorChanged))
+			| static_cast<uint32_t>(FormattingEvent::STRIKETHROUGH_END)
+					* ((!strikethrough && prevStrikethrough) || (strikethrough && colorChanged))
+			| static_cast<uint32_t>(FormattingEvent::UNDERLINE_BEGIN)
+					* (underline && (!prevUnderline || colorChanged))
+			| static_cast<uint32_t>(FormattingEvent::UNDERLINE_END)
+					* ((!underline && prevUnderline) || (underline && colorChanged)));
+}
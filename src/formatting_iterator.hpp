@@ -5,7 +5,9 @@
 
 namespace Text {
 
+struct CompactFormattingRuns;
 struct FormattingRuns;
+struct TextStyle;
 
 enum class FormattingEvent : uint32_t {
 	NONE = 0,
@@ -40,5 +42,46 @@ class FormattingIterator {
 		bool m_underline;
 };
 
+/**
+ * Equivalent to `FormattingIterator` for `CompactFormattingRuns`, stepping a single run index per glyph. Glyphs
+ * sharing a style are recognized by comparing style table entries rather than each attribute.
+ */
+class CompactFormattingIterator {
+	public:
+		explicit CompactFormattingIterator(const CompactFormattingRuns&, uint32_t initialCharIndex);
+
+		FormattingEvent advance_to(uint32_t charIndex);
+
+		const Color& get_color() const;
+		const Color& get_prev_color() const;
+		StrokeState get_stroke_state() const;
+		bool has_strikethrough() const;
+		bool has_underline() const;
+	private:
+		const CompactFormattingRuns* m_formatting;
+		const TextStyle* m_style;
+		uint32_t m_runIndex;
+		Color m_prevColor;
+		bool m_strikethrough;
+		bool m_underline;
+};
+
+inline FormattingIterator make_formatting_iterator(const FormattingRuns& formatting, uint32_t initialCharIndex) {
+	return FormattingIterator(formatting, initialCharIndex);
+}
+
+inline CompactFormattingIterator make_formatting_iterator(const CompactFormattingRuns& formatting,
+		uint32_t initialCharIndex) {
+	return CompactFormattingIterator(formatting, initialCharIndex);
+}
+
+/**
+ * Either form of formatting runs accepted by the formatted `draw_text` overloads.
+ */
+template <typename T>
+concept FormattingSource = requires(const T& formatting) {
+	make_formatting_iterator(formatting, uint32_t{});
+};
+
 }
 
@@ -0,0 +1,152 @@
+#include "formatting_spans.hpp"
+
+#include "formatting_iterator.hpp"
+#include "layout_info.hpp"
+#include "style_table.hpp"
+
+using namespace Text;
+
+// Public Functions
+
+void FormattingSpans::build(const LayoutInfo& layout, const FormattingRuns& formatting) {
+	build_internal(layout, formatting);
+}
+
+void FormattingSpans::build(const LayoutInfo& layout, const CompactFormattingRuns& formatting) {
+	build_internal(layout, formatting);
+}
+
+void FormattingSpans::clear() {
+	m_runSpanEnds.clear();
+	m_runDecorationEnds.clear();
+	m_spans.clear();
+	m_decorations.clear();
+	m_colors.clear();
+	m_strokes.clear();
+}
+
+std::span<const FormattingSpan> FormattingSpans::get_run_spans(size_t runIndex) const {
+	auto first = runIndex == 0 ? 0 : m_runSpanEnds[runIndex - 1];
+	return {m_spans.data() + first, m_runSpanEnds[runIndex] - first};
+}
+
+std::span<const DecorationSpan> FormattingSpans::get_run_decorations(size_t runIndex) const {
+	auto first = runIndex == 0 ? 0 : m_runDecorationEnds[runIndex - 1];
+	return {m_decorations.data() + first, m_runDecorationEnds[runIndex] - first};
+}
+
+const Color& FormattingSpans::get_color(uint32_t colorIndex) const {
+	return m_colors[colorIndex];
+}
+
+const StrokeState& FormattingSpans::get_stroke(uint32_t strokeIndex) const {
+	return m_strokes[strokeIndex];
+}
+
+bool FormattingSpans::empty() const {
+	return m_runSpanEnds.empty();
+}
+
+/**
+ * Follows the same sequence of formatting events as the formatted `draw_text`, so that drawing from the spans
+ * produces the same glyphs, strokes and decorations.
+ */
+template <typename Formatting>
+void FormattingSpans::build_internal(const LayoutInfo& layout, const Formatting& formatting) {
+	clear();
+
+	auto* glyphPositions = layout.get_glyph_position_data();
+
+	for (size_t runIndex = 0; runIndex < layout.get_run_count(); ++runIndex) {
+		auto& metrics = layout.get_run_metrics(runIndex);
+		auto glyphPosIndex = layout.get_first_position_index(runIndex);
+		auto runSpanStart = m_spans.size();
+
+		auto iter = make_formatting_iterator(formatting, layout.is_run_rtl(runIndex)
+				? layout.get_run_char_end_index(runIndex) : layout.get_run_char_start_index(runIndex));
+		auto underlineStartPos = glyphPositions[glyphPosIndex];
+		auto strikethroughStartPos = underlineStartPos;
+
+		for (auto glyphIndex = layout.get_first_glyph_index(runIndex),
+				glyphEndIndex = layout.get_run_glyph_end_index(runIndex); glyphIndex < glyphEndIndex;
+				++glyphIndex, glyphPosIndex += 2) {
+			auto pX = glyphPositions[glyphPosIndex];
+			auto event = iter.advance_to(layout.get_char_index(glyphIndex));
+			auto stroke = iter.get_stroke_state();
+			auto colorIndex = get_color_index(iter.get_color());
+			auto strokeIndex = stroke.color.a > 0.f ? get_stroke_index(stroke) : NO_STROKE;
+
+			if (m_spans.size() > runSpanStart && m_spans.back().colorIndex == colorIndex
+					&& m_spans.back().strokeIndex == strokeIndex) {
+				m_spans.back().glyphEndIndex = glyphIndex + 1;
+			}
+			else {
+				m_spans.push_back({
+					.glyphEndIndex = glyphIndex + 1,
+					.colorIndex = colorIndex,
+					.strokeIndex = strokeIndex,
+				});
+			}
+
+			if ((event & FormattingEvent::UNDERLINE_END) != FormattingEvent::NONE) {
+				add_decoration(underlineStartPos, pX, metrics.underlinePosition, metrics.underlineThickness,
+						iter.get_prev_color());
+			}
+
+			if ((event & FormattingEvent::UNDERLINE_BEGIN) != FormattingEvent::NONE) {
+				underlineStartPos = pX;
+			}
+
+			if ((event & FormattingEvent::STRIKETHROUGH_END) != FormattingEvent::NONE) {
+				add_decoration(strikethroughStartPos, pX, metrics.strikethroughPosition,
+						metrics.strikethroughThickness, iter.get_prev_color());
+			}
+
+			if ((event & FormattingEvent::STRIKETHROUGH_BEGIN) != FormattingEvent::NONE) {
+				strikethroughStartPos = pX;
+			}
+		}
+
+		if (iter.has_strikethrough()) {
+			add_decoration(strikethroughStartPos, glyphPositions[glyphPosIndex], metrics.strikethroughPosition,
+					metrics.strikethroughThickness, iter.get_color());
+		}
+
+		if (iter.has_underline()) {
+			add_decoration(underlineStartPos, glyphPositions[glyphPosIndex], metrics.underlinePosition,
+					metrics.underlineThickness, iter.get_color());
+		}
+
+		m_runSpanEnds.emplace_back(static_cast<uint32_t>(m_spans.size()));
+		m_runDecorationEnds.emplace_back(static_cast<uint32_t>(m_decorations.size()));
+	}
+}
+
+// Colors and strokes change rarely between neighbouring glyphs, so only repeats of the last entry are shared
+uint32_t FormattingSpans::get_color_index(const Color& color) {
+	if (m_colors.empty() || m_colors.back() != color) {
+		m_colors.emplace_back(color);
+	}
+
+	return static_cast<uint32_t>(m_colors.size() - 1);
+}
+
+uint32_t FormattingSpans::get_stroke_index(const StrokeState& stroke) {
+	if (m_strokes.empty() || m_strokes.back() != stroke) {
+		m_strokes.emplace_back(stroke);
+	}
+
+	return static_cast<uint32_t>(m_strokes.size() - 1);
+}
+
+void FormattingSpans::add_decoration(float startPos, float endPos, float position, float thickness,
+		const Color& color) {
+	m_decorations.push_back({
+		.x = startPos,
+		.y = position,
+		.width = endPos - startPos,
+		.height = thickness + 0.5f,
+		.colorIndex = get_color_index(color),
+	});
+}
+
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "color.hpp"
+#include "formatting.hpp"
+
+#include <span>
+#include <vector>
+
+namespace Text {
+
+class LayoutInfo;
+
+struct CompactFormattingRuns;
+
+/**
+ * A range of glyphs within a visual run that share a color and stroke.
+ */
+struct FormattingSpan {
+	// One past the last glyph of the span, in the same numbering as `LayoutInfo::get_glyph_id`
+	uint32_t glyphEndIndex;
+	uint32_t colorIndex;
+	// `FormattingSpans::NO_STROKE` if the glyphs have no visible stroke
+	uint32_t strokeIndex;
+};
+
+/**
+ * An underline or strikethrough rectangle, positioned relative to the line origin passed to
+ * `LayoutInfo::for_each_run`.
+ */
+struct DecorationSpan {
+	float x;
+	float y;
+	float width;
+	float height;
+	uint32_t colorIndex;
+};
+
+/**
+ * `FormattingRuns` resolved against a `LayoutInfo` once, so that drawing the layout again walks flat arrays
+ * instead of searching the runs for every glyph.
+ *
+ * Spans are stored per visual run of the layout, and decorations with their extents already measured, so they
+ * remain valid for any text area width and alignment. They must be rebuilt when the layout or the formatting
+ * changes.
+ *
+ * The spans retain their storage across calls to `build`.
+ *
+ * @thread_safety Not thread safe.
+ */
+class FormattingSpans {
+	public:
+		static constexpr const uint32_t NO_STROKE = ~0u;
+
+		void build(const LayoutInfo& layout, const FormattingRuns& formatting);
+		void build(const LayoutInfo& layout, const CompactFormattingRuns& formatting);
+		void clear();
+
+		std::span<const FormattingSpan> get_run_spans(size_t runIndex) const;
+		std::span<const DecorationSpan> get_run_decorations(size_t runIndex) const;
+
+		const Color& get_color(uint32_t colorIndex) const;
+		const StrokeState& get_stroke(uint32_t strokeIndex) const;
+
+		bool empty() const;
+	private:
+		// Per visual run, one past the run's last entry in m_spans and m_decorations
+		std::vector<uint32_t> m_runSpanEnds;
+		std::vector<uint32_t> m_runDecorationEnds;
+		std::vector<FormattingSpan> m_spans;
+		std::vector<DecorationSpan> m_decorations;
+		std::vector<Color> m_colors;
+		std::vector<StrokeState> m_strokes;
+
+		template <typename Formatting>
+		void build_internal(const LayoutInfo& layout, const Formatting& formatting);
+		uint32_t get_color_index(const Color& color);
+		uint32_t get_stroke_index(const StrokeState& stroke);
+		void add_decoration(float startPos, float endPos, float position, float thickness, const Color& color);
+};
+
+}
+
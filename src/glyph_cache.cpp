@@ -0,0 +1,246 @@
+#include "glyph_cache.hpp"
+
+#include "font_registry.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <condition_variable>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+using namespace Text;
+
+// Approximate bookkeeping cost of an entry, so that caches of empty glyphs are still bounded by the budget
+static constexpr const size_t ENTRY_OVERHEAD = 128;
+
+static constexpr const uint64_t HASH_BASE = 0xCBF29CE484222325ull;
+static constexpr const uint64_t HASH_MULTIPLIER = 0x100000001B3ull;
+
+struct alignas(64) GlyphCache::Shard {
+	struct Entry {
+		// Null while the glyph is being rasterized by another thread
+		std::shared_ptr<const GlyphBitmap> bitmap;
+		std::list<GlyphCacheKey>::iterator lruIter;
+	};
+
+	std::mutex mutex;
+	std::condition_variable rasterized;
+	std::unordered_map<GlyphCacheKey, Entry, GlyphCacheKeyHash> entries;
+	// Completed entries only, most recently used first
+	std::list<GlyphCacheKey> lru;
+	size_t byteSize{};
+};
+
+static uint64_t hash_key(const GlyphCacheKey& key);
+static size_t calc_entry_cost(const GlyphBitmap& bitmap);
+
+static void rasterize_from_registry(const SingleScriptFont& font, const GlyphCacheKey& key, GlyphBitmap& bitmap,
+		void* pUserData);
+
+// Public Functions
+
+GlyphCache::GlyphCache(const GlyphCacheCreateInfo& createInfo)
+		: m_shards(std::make_unique<Shard[]>(std::bit_ceil(std::max(createInfo.shardCount, 1u))))
+		, m_shardMask(std::bit_ceil(std::max(createInfo.shardCount, 1u)) - 1)
+		, m_shardBudget(createInfo.byteBudget / (m_shardMask + 1))
+		, m_pfnRasterize(createInfo.pfnRasterize ? createInfo.pfnRasterize : rasterize_from_registry)
+		, m_pRasterizeUserData(createInfo.pRasterizeUserData) {}
+
+GlyphCache::~GlyphCache() = default;
+
+std::shared_ptr<const GlyphBitmap> GlyphCache::get_glyph(const SingleScriptFont& font, uint32_t glyphID) {
+	return get(font, GlyphCacheKey::make(font, glyphID));
+}
+
+std::shared_ptr<const GlyphBitmap> GlyphCache::get_stroke(const SingleScriptFont& font, uint32_t glyphID,
+		uint8_t thickness, StrokeType joins) {
+	return get(font, GlyphCacheKey::make(font, glyphID, thickness, joins));
+}
+
+std::shared_ptr<const GlyphBitmap> GlyphCache::get(const SingleScriptFont& font, const GlyphCacheKey& key) {
+	auto& shard = get_shard(key);
+	std::unique_lock lock(shard.mutex);
+
+	for (;;) {
+		auto it = shard.entries.find(key);
+
+		if (it == shard.entries.end()) {
+			break;
+		}
+
+		if (auto& entry = it->second; entry.bitmap) [[likely]] {
+			shard.lru.splice(shard.lru.begin(), shard.lru, entry.lruIter);
+			return entry.bitmap;
+		}
+
+		// Another thread is rasterizing this glyph. The entry may have been evicted by the time this thread
+		// wakes, in which case the lookup misses and this thread rasterizes it instead.
+		shard.rasterized.wait(lock);
+	}
+
+	// Claim the key so that concurrent misses wait on this rasterization rather than repeating it
+	shard.entries.emplace(key, Shard::Entry{});
+	lock.unlock();
+
+	auto bitmap = std::make_shared<GlyphBitmap>();
+
+	try {
+		m_pfnRasterize(font, key, *bitmap, m_pRasterizeUserData);
+	}
+	catch (...) {
+		// Release the claim so that waiting threads retry the rasterization rather than waiting forever
+		lock.lock();
+		shard.entries.erase(key);
+		lock.unlock();
+		shard.rasterized.notify_all();
+		throw;
+	}
+
+	lock.lock();
+
+	// In-flight entries are never evicted or cleared, so the claimed entry is still present
+	auto& entry = shard.entries.find(key)->second;
+	entry.bitmap = bitmap;
+	shard.lru.push_front(key);
+	entry.lruIter = shard.lru.begin();
+	shard.byteSize += calc_entry_cost(*bitmap);
+
+	// Evict down to budget, always retaining the bitmap just inserted
+	while (shard.byteSize > m_shardBudget && shard.lru.size() > 1) {
+		auto victim = shard.entries.find(shard.lru.back());
+		shard.byteSize -= calc_entry_cost(*victim->second.bitmap);
+		shard.entries.erase(victim);
+		shard.lru.pop_back();
+	}
+
+	lock.unlock();
+	shard.rasterized.notify_all();
+
+	return bitmap;
+}
+
+std::shared_ptr<const GlyphBitmap> GlyphCache::find(const GlyphCacheKey& key) {
+	auto& shard = get_shard(key);
+	std::scoped_lock lock(shard.mutex);
+
+	if (auto it = shard.entries.find(key); it != shard.entries.end() && it->second.bitmap) {
+		shard.lru.splice(shard.lru.begin(), shard.lru, it->second.lruIter);
+		return it->second.bitmap;
+	}
+
+	return {};
+}
+
+void GlyphCache::clear() {
+	for (uint32_t i = 0; i <= m_shardMask; ++i) {
+		auto& shard = m_shards[i];
+		std::scoped_lock lock(shard.mutex);
+
+		// Leave in-flight entries in place for the threads rasterizing them
+		for (auto& key : shard.lru) {
+			shard.entries.erase(key);
+		}
+
+		shard.lru.clear();
+		shard.byteSize = 0;
+	}
+}
+
+size_t GlyphCache::get_byte_size() const {
+	size_t result{};
+
+	for (uint32_t i = 0; i <= m_shardMask; ++i) {
+		std::scoped_lock lock(m_shards[i].mutex);
+		result += m_shards[i].byteSize;
+	}
+
+	return result;
+}
+
+size_t GlyphCache::get_entry_count() const {
+	size_t result{};
+
+	for (uint32_t i = 0; i <= m_shardMask; ++i) {
+		std::scoped_lock lock(m_shards[i].mutex);
+		result += m_shards[i].lru.size();
+	}
+
+	return result;
+}
+
+GlyphCache::Shard& GlyphCache::get_shard(const GlyphCacheKey& key) const {
+	// The map buckets on the low bits of the hash, so select shards with the high bits
+	return m_shards[static_cast<uint32_t>(hash_key(key) >> 32) & m_shardMask];
+}
+
+size_t GlyphCacheKeyHash::operator()(const GlyphCacheKey& key) const {
+	return static_cast<size_t>(hash_key(key));
+}
+
+// Static Functions
+
+static uint64_t hash_key(const GlyphCacheKey& key) {
+	uint64_t values[] = {
+		key.glyphID,
+		key.size,
+		key.face,
+		(static_cast<uint64_t>(key.weight) << 2) | static_cast<uint64_t>(key.style),
+		(static_cast<uint64_t>(key.strokeThickness) << 8) | static_cast<uint64_t>(key.strokeJoins),
+	};
+
+	auto hash = HASH_BASE;
+
+	for (auto value : values) {
+		hash ^= value;
+		hash *= HASH_MULTIPLIER;
+	}
+
+	// FNV mixes poorly into the high bits for small inputs, so finish with a final avalanche
+	hash ^= hash >> 33;
+	hash *= 0xFF51AFD7ED558CCDull;
+	hash ^= hash >> 33;
+
+	return hash;
+}
+
+static size_t calc_entry_cost(const GlyphBitmap& bitmap) {
+	return bitmap.get_byte_size() + ENTRY_OVERHEAD;
+}
+
+static void rasterize_from_registry(const SingleScriptFont& font, const GlyphCacheKey& key, GlyphBitmap& bitmap,
+		void*) {
+	auto fontData = FontRegistry::get_font_data(font);
+
+	if (!fontData) {
+		return;
+	}
+
+	auto copy_bitmap = [&](const FontRasterizeInfo& info) {
+		bitmap = {
+			.pData = {},
+			.offsetX = info.offsetX,
+			.offsetY = info.offsetY,
+			.width = info.width,
+			.height = info.height,
+			.format = info.format,
+		};
+
+		if (!info.pData || bitmap.empty()) {
+			bitmap.width = bitmap.height = 0;
+			bitmap.format = FontRasterFormat::INVALID;
+			return;
+		}
+
+		bitmap.pData = std::make_unique_for_overwrite<std::byte[]>(bitmap.get_byte_size());
+		std::memcpy(bitmap.pData.get(), info.pData, bitmap.get_byte_size());
+	};
+
+	if (key.strokeThickness > 0) {
+		fontData.rasterize_glyph_outline(key.glyphID, key.strokeThickness, key.strokeJoins, copy_bitmap);
+	}
+	else {
+		fontData.rasterize_glyph(key.glyphID, copy_bitmap);
+	}
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "font.hpp"
+#include "font_data.hpp"
+#include "stroke_type.hpp"
+
+#include <cstddef>
+#include <memory>
+
+namespace Text {
+
+/**
+ * Identifies a single rasterized glyph. Fill glyphs use a `strokeThickness` of 0 and `StrokeType::NONE`.
+ */
+struct GlyphCacheKey {
+	uint32_t glyphID;
+	uint32_t size;
+	FaceIndex_T face;
+	FontWeight weight;
+	FontStyle style;
+	uint8_t strokeThickness;
+	StrokeType strokeJoins;
+
+	static constexpr GlyphCacheKey make(const SingleScriptFont& font, uint32_t glyphID,
+			uint8_t strokeThickness = 0, StrokeType strokeJoins = StrokeType::NONE) {
+		return {
+			.glyphID = glyphID,
+			.size = font.get_effective_size(),
+			.face = font.face.handle,
+			.weight = font.weight,
+			.style = font.style,
+			.strokeThickness = strokeThickness,
+			.strokeJoins = strokeJoins,
+		};
+	}
+
+	constexpr bool operator==(const GlyphCacheKey&) const = default;
+};
+
+struct GlyphCacheKeyHash {
+	size_t operator()(const GlyphCacheKey& key) const;
+};
+
+/**
+ * An owned copy of the bitmap produced by `FontData::rasterize_glyph` or `FontData::rasterize_glyph_outline`.
+ * Rows are tightly packed, `width * bytes_per_pixel()` bytes apart.
+ *
+ * Glyphs with no visible bitmap, such as spaces, are cached as a bitmap with a `width` and `height` of 0 and
+ * `FontRasterFormat::INVALID`, so that they are not repeatedly rasterized.
+ */
+struct GlyphBitmap {
+	std::unique_ptr<std::byte[]> pData;
+	float offsetX;
+	float offsetY;
+	uint32_t width;
+	uint32_t height;
+	FontRasterFormat format;
+
+	constexpr uint32_t bytes_per_pixel() const {
+		return format == FontRasterFormat::BGRA8 ? 4 : format == FontRasterFormat::R8 ? 1 : 0;
+	}
+
+	constexpr size_t get_byte_size() const {
+		return static_cast<size_t>(width) * height * bytes_per_pixel();
+	}
+
+	constexpr bool empty() const {
+		return get_byte_size() == 0;
+	}
+};
+
+/**
+ * Rasterizes the glyph described by `key` into `bitmap`. `font` is the font the glyph was requested with.
+ */
+using PFN_GlyphRasterize = void (*)(const SingleScriptFont& font, const GlyphCacheKey& key, GlyphBitmap& bitmap,
+		void* pUserData);
+
+/**
+ * `byteBudget` bounds the total bitmap memory retained by the cache, and is split evenly between `shardCount`
+ * shards, which is rounded up to a power of 2. If `pfnRasterize` is null, glyphs are rasterized through
+ * `FontRegistry::get_font_data`.
+ */
+struct GlyphCacheCreateInfo {
+	size_t byteBudget;
+	uint32_t shardCount;
+	PFN_GlyphRasterize pfnRasterize;
+	void* pRasterizeUserData;
+};
+
+/**
+ * Thread safe cache of rasterized glyph bitmaps, so that any renderer or worker thread can share the cost of
+ * rasterization.
+ *
+ * Keys are distributed between independently locked shards, each evicting its least recently used bitmaps
+ * once over budget. Concurrent misses on the same key are deduplicated: the first caller rasterizes while the
+ * rest wait for its result.
+ *
+ * Bitmaps are returned as shared pointers and remain valid for as long as the caller holds them, even if they
+ * are evicted in the meantime.
+ *
+ * @thread_safety All functions are thread safe, and may block while another thread rasterizes the same glyph.
+ */
+class GlyphCache {
+	public:
+		explicit GlyphCache(const GlyphCacheCreateInfo& createInfo);
+		~GlyphCache();
+
+		GlyphCache(GlyphCache&&) = delete;
+		void operator=(GlyphCache&&) = delete;
+
+		GlyphCache(const GlyphCache&) = delete;
+		void operator=(const GlyphCache&) = delete;
+
+		std::shared_ptr<const GlyphBitmap> get_glyph(const SingleScriptFont& font, uint32_t glyphID);
+		std::shared_ptr<const GlyphBitmap> get_stroke(const SingleScriptFont& font, uint32_t glyphID,
+				uint8_t thickness, StrokeType joins);
+		/**
+		 * Gets the bitmap for `key`, rasterizing it with `font` on a miss.
+		 */
+		std::shared_ptr<const GlyphBitmap> get(const SingleScriptFont& font, const GlyphCacheKey& key);
+		/**
+		 * Gets the bitmap for `key` if it is already cached, without rasterizing or waiting on an in-flight
+		 * rasterization.
+		 */
+		std::shared_ptr<const GlyphBitmap> find(const GlyphCacheKey& key);
+
+		void clear();
+
+		size_t get_byte_size() const;
+		size_t get_entry_count() const;
+	private:
+		struct Shard;
+
+		std::unique_ptr<Shard[]> m_shards;
+		uint32_t m_shardMask;
+		size_t m_shardBudget;
+		PFN_GlyphRasterize m_pfnRasterize;
+		void* m_pRasterizeUserData;
+
+		Shard& get_shard(const GlyphCacheKey& key) const;
+};
+
+}
@@ -0,0 +1,304 @@
+#include "glyph_disk_cache.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+
+using namespace Text;
+
+static constexpr const uint32_t FILE_MAGIC = 0x43475452u; // "RTGC"
+static constexpr const uint32_t FILE_VERSION = 1;
+static constexpr const uint32_t RECORD_MAGIC = 0x44524347u; // "GCRD"
+static constexpr const size_t RECORD_ALIGNMENT = 8;
+
+static constexpr const uint64_t HASH_BASE = 0xCBF29CE484222325ull;
+static constexpr const uint64_t HASH_MULTIPLIER = 0x100000001B3ull;
+
+namespace {
+
+struct FileHeader {
+	uint32_t magic;
+	uint32_t version;
+};
+
+struct RecordHeader {
+	uint32_t magic;
+	uint32_t dataSize;
+	uint64_t fontHash;
+	uint32_t glyphID;
+	uint32_t size;
+	uint32_t pixelsPerEm;
+	uint32_t width;
+	uint32_t height;
+	uint8_t channels;
+	uint8_t strokeThickness;
+	uint8_t strokeJoins;
+	uint8_t reserved;
+	float offset[2];
+	float bitmapSize[2];
+};
+
+static_assert(sizeof(FileHeader) % RECORD_ALIGNMENT == 0);
+static_assert(sizeof(RecordHeader) % RECORD_ALIGNMENT == 0);
+
+}
+
+static constexpr size_t align_record_size(size_t size) {
+	return (size + RECORD_ALIGNMENT - 1) & ~(RECORD_ALIGNMENT - 1);
+}
+
+static uint64_t hash_combine(uint64_t hash, uint64_t value);
+
+// Public Functions
+
+GlyphDiskCache::~GlyphDiskCache() {
+	close();
+}
+
+void GlyphDiskCache::open(std::string_view fileName) {
+	close();
+
+	std::scoped_lock lock(m_mutex);
+	m_fileName = fileName;
+	map_and_index();
+}
+
+bool GlyphDiskCache::save() {
+	std::scoped_lock lock(m_mutex);
+	return save_internal();
+}
+
+void GlyphDiskCache::close() {
+	std::scoped_lock lock(m_mutex);
+
+	if (!m_fileName.empty()) {
+		save_internal();
+	}
+
+	unmap();
+	m_entries.clear();
+	m_unsavedKeys.clear();
+	m_unsavedData.clear();
+	m_fileName.clear();
+}
+
+bool GlyphDiskCache::find(const GlyphDiskCacheKey& key, GlyphDiskCacheEntry& outEntry) const {
+	std::scoped_lock lock(m_mutex);
+
+	if (auto it = m_entries.find(key); it != m_entries.end()) {
+		outEntry = it->second;
+		return true;
+	}
+
+	return false;
+}
+
+void GlyphDiskCache::insert(const GlyphDiskCacheKey& key, const GlyphDiskCacheEntry& entry) {
+	auto byteSize = entry.get_byte_size();
+	auto data = std::make_unique_for_overwrite<std::byte[]>(byteSize);
+
+	if (byteSize > 0) {
+		std::memcpy(data.get(), entry.pData, byteSize);
+	}
+
+	std::scoped_lock lock(m_mutex);
+
+	auto copy = entry;
+	copy.pData = data.get();
+
+	if (m_entries.emplace(key, copy).second) {
+		m_unsavedKeys.emplace_back(key);
+		m_unsavedData.emplace_back(std::move(data));
+	}
+}
+
+size_t GlyphDiskCache::get_entry_count() const {
+	std::scoped_lock lock(m_mutex);
+	return m_entries.size();
+}
+
+size_t GlyphDiskCache::get_unsaved_entry_count() const {
+	std::scoped_lock lock(m_mutex);
+	return m_unsavedKeys.size();
+}
+
+uint64_t GlyphDiskCache::hash_font_data(const void* data, size_t size, uint32_t faceIndex) {
+	auto* bytes = static_cast<const unsigned char*>(data);
+	auto hash = hash_combine(HASH_BASE, size);
+	hash = hash_combine(hash, faceIndex);
+
+	// Font files can run to tens of megabytes, so hash a word at a time rather than a byte at a time
+	size_t i = 0;
+
+	for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+		uint64_t word;
+		std::memcpy(&word, bytes + i, sizeof(uint64_t));
+		hash = hash_combine(hash, word);
+	}
+
+	for (; i < size; ++i) {
+		hash = hash_combine(hash, bytes[i]);
+	}
+
+	return hash;
+}
+
+size_t GlyphDiskCacheKeyHash::operator()(const GlyphDiskCacheKey& key) const {
+	auto hash = hash_combine(HASH_BASE, key.fontHash);
+	hash = hash_combine(hash, key.glyphID);
+	hash = hash_combine(hash, (static_cast<uint64_t>(key.size) << 32) | key.pixelsPerEm);
+	hash = hash_combine(hash, (static_cast<uint64_t>(key.strokeThickness) << 8)
+			| static_cast<uint64_t>(key.strokeJoins));
+	return static_cast<size_t>(hash);
+}
+
+void GlyphDiskCache::map_and_index() {
+	std::error_code err;
+	auto fileSize = std::filesystem::file_size(m_fileName, err);
+
+	m_validSize = 0;
+	m_rewriteFile = true;
+
+	if (err || fileSize < sizeof(FileHeader)) {
+		return;
+	}
+
+	m_mapping = map_file_default(m_fileName);
+
+	if (!m_mapping.mapping) {
+		return;
+	}
+
+	auto* bytes = static_cast<const std::byte*>(m_mapping.mapping);
+	FileHeader header;
+	std::memcpy(&header, bytes, sizeof(FileHeader));
+
+	if (header.magic != FILE_MAGIC || header.version != FILE_VERSION) {
+		return;
+	}
+
+	m_rewriteFile = false;
+	auto offset = sizeof(FileHeader);
+
+	while (offset + sizeof(RecordHeader) <= m_mapping.size) {
+		RecordHeader record;
+		std::memcpy(&record, bytes + offset, sizeof(RecordHeader));
+
+		auto dataSize = static_cast<size_t>(record.width) * record.height * record.channels;
+		auto recordSize = align_record_size(sizeof(RecordHeader) + dataSize);
+
+		if (record.magic != RECORD_MAGIC || record.dataSize != dataSize || offset + recordSize > m_mapping.size) {
+			break;
+		}
+
+		m_entries.emplace(GlyphDiskCacheKey{
+			.fontHash = record.fontHash,
+			.glyphID = record.glyphID,
+			.size = record.size,
+			.pixelsPerEm = record.pixelsPerEm,
+			.strokeThickness = record.strokeThickness,
+			.strokeJoins = static_cast<StrokeType>(record.strokeJoins),
+		}, GlyphDiskCacheEntry{
+			.pData = bytes + offset + sizeof(RecordHeader),
+			.offset = {record.offset[0], record.offset[1]},
+			.size = {record.bitmapSize[0], record.bitmapSize[1]},
+			.width = record.width,
+			.height = record.height,
+			.channels = record.channels,
+		});
+
+		offset += recordSize;
+	}
+
+	m_validSize = offset;
+}
+
+void GlyphDiskCache::unmap() {
+	if (m_mapping.mapping) {
+		unmap_file_default(m_mapping);
+		m_mapping = {};
+	}
+}
+
+bool GlyphDiskCache::save_internal() {
+	if (m_unsavedKeys.empty() || m_fileName.empty()) {
+		return true;
+	}
+
+	// The mapping must be released before writing, as some platforms refuse to write to a mapped file
+	unmap();
+
+	bool success = true;
+
+	if (!m_rewriteFile) {
+		std::error_code err;
+
+		if (std::filesystem::file_size(m_fileName, err) != m_validSize && !err) {
+			std::filesystem::resize_file(m_fileName, m_validSize, err);
+		}
+
+		success = !err;
+	}
+
+	FILE* file = success ? std::fopen(m_fileName.c_str(), m_rewriteFile ? "wb" : "ab") : nullptr;
+	success = file != nullptr;
+
+	if (file && m_rewriteFile) {
+		FileHeader header{
+			.magic = FILE_MAGIC,
+			.version = FILE_VERSION,
+		};
+
+		success = std::fwrite(&header, sizeof(header), 1, file) == 1;
+	}
+
+	for (size_t i = 0; success && i < m_unsavedKeys.size(); ++i) {
+		auto& key = m_unsavedKeys[i];
+		auto& entry = m_entries[key];
+		auto dataSize = entry.get_byte_size();
+
+		RecordHeader record{
+			.magic = RECORD_MAGIC,
+			.dataSize = static_cast<uint32_t>(dataSize),
+			.fontHash = key.fontHash,
+			.glyphID = key.glyphID,
+			.size = key.size,
+			.pixelsPerEm = key.pixelsPerEm,
+			.width = entry.width,
+			.height = entry.height,
+			.channels = static_cast<uint8_t>(entry.channels),
+			.strokeThickness = key.strokeThickness,
+			.strokeJoins = static_cast<uint8_t>(key.strokeJoins),
+			.reserved = 0,
+			.offset = {entry.offset[0], entry.offset[1]},
+			.bitmapSize = {entry.size[0], entry.size[1]},
+		};
+		static constexpr const std::byte padding[RECORD_ALIGNMENT]{};
+		auto paddingSize = align_record_size(dataSize) - dataSize;
+
+		success = std::fwrite(&record, sizeof(record), 1, file) == 1
+				&& (dataSize == 0 || std::fwrite(entry.pData, dataSize, 1, file) == 1)
+				&& (paddingSize == 0 || std::fwrite(padding, paddingSize, 1, file) == 1);
+	}
+
+	if (file) {
+		success = std::fclose(file) == 0 && success;
+	}
+
+	// Rebuild the index from the file, which now holds every entry that was successfully written
+	m_entries.clear();
+	m_unsavedKeys.clear();
+	m_unsavedData.clear();
+	map_and_index();
+
+	return success;
+}
+
+// Static Functions
+
+static uint64_t hash_combine(uint64_t hash, uint64_t value) {
+	hash ^= value;
+	hash *= HASH_MULTIPLIER;
+	return hash;
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "file_mapping.hpp"
+#include "stroke_type.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Text {
+
+/**
+ * Identifies a persisted glyph bitmap. `fontHash` identifies the font file and face, see
+ * `GlyphDiskCache::hash_font_data`. `size` may be 0 for bitmaps that do not depend on the font size, such as
+ * distance fields, and `pixelsPerEm` records the resolution the bitmap was generated at.
+ */
+struct GlyphDiskCacheKey {
+	uint64_t fontHash;
+	uint32_t glyphID;
+	uint32_t size;
+	uint32_t pixelsPerEm;
+	uint8_t strokeThickness;
+	StrokeType strokeJoins;
+
+	constexpr bool operator==(const GlyphDiskCacheKey&) const = default;
+};
+
+struct GlyphDiskCacheKeyHash {
+	size_t operator()(const GlyphDiskCacheKey& key) const;
+};
+
+/**
+ * A bitmap with `channels` bytes per pixel and tightly packed rows, along with the placement metadata the
+ * owner needs to draw it.
+ */
+struct GlyphDiskCacheEntry {
+	const std::byte* pData;
+	float offset[2];
+	float size[2];
+	uint32_t width;
+	uint32_t height;
+	uint32_t channels;
+
+	constexpr size_t get_byte_size() const {
+		return static_cast<size_t>(width) * height * channels;
+	}
+};
+
+/**
+ * Persists expensive glyph bitmaps, such as multi-channel distance fields, across runs of the program.
+ *
+ * The backing file is a header followed by a log of records, and is memory-mapped on `open` so that lookups
+ * of previously saved glyphs read straight from the mapping. New entries are held in memory until `save`,
+ * which appends them to the file. A record cut short by an interrupted save is discarded along with anything
+ * after it, and a file from an incompatible version is replaced on the next save.
+ *
+ * The file uses the native byte order and is intended as a local cache, not an interchange format.
+ *
+ * @thread_safety All functions are thread safe. The `pData` of an entry returned by `find` is valid until the
+ * next call to `save` or `close`.
+ */
+class GlyphDiskCache {
+	public:
+		GlyphDiskCache() = default;
+		~GlyphDiskCache();
+
+		GlyphDiskCache(GlyphDiskCache&&) = delete;
+		void operator=(GlyphDiskCache&&) = delete;
+
+		GlyphDiskCache(const GlyphDiskCache&) = delete;
+		void operator=(const GlyphDiskCache&) = delete;
+
+		/**
+		 * Saves and closes any open file, then maps `fileName` and indexes its entries. The file need not exist.
+		 */
+		void open(std::string_view fileName);
+		/**
+		 * Appends all entries inserted since the last save to the file and remaps it. Returns false if the file
+		 * could not be written, in which case the unsaved entries are dropped.
+		 */
+		bool save();
+		void close();
+
+		bool find(const GlyphDiskCacheKey& key, GlyphDiskCacheEntry& outEntry) const;
+		/**
+		 * Copies `entry` into the cache, replacing nothing if `key` is already present.
+		 */
+		void insert(const GlyphDiskCacheKey& key, const GlyphDiskCacheEntry& entry);
+
+		size_t get_entry_count() const;
+		size_t get_unsaved_entry_count() const;
+
+		/**
+		 * Hashes the contents of a font file, mixing in `faceIndex` to distinguish faces of a collection.
+		 */
+		static uint64_t hash_font_data(const void* data, size_t size, uint32_t faceIndex);
+	private:
+		mutable std::mutex m_mutex;
+		std::string m_fileName;
+		FileMapping m_mapping{};
+		// Size of the valid prefix of the file; anything after it is truncated before appending
+		size_t m_validSize{};
+		bool m_rewriteFile{};
+
+		std::unordered_map<GlyphDiskCacheKey, GlyphDiskCacheEntry, GlyphDiskCacheKeyHash> m_entries;
+		std::vector<GlyphDiskCacheKey> m_unsavedKeys;
+		std::vector<std::unique_ptr<std::byte[]>> m_unsavedData;
+
+		void map_and_index();
+		void unmap();
+		bool save_internal();
+};
+
+}
@@ -0,0 +1,125 @@
+#include "glyph_prerasterizer.hpp"
+
+#include "formatting.hpp"
+#include "formatting_iterator.hpp"
+#include "layout_info.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+using namespace Text;
+
+// Public Functions
+
+void GlyphPrerasterizer::clear() {
+	m_glyphs.clear();
+	m_keys.clear();
+}
+
+void GlyphPrerasterizer::collect(const LayoutInfo& layout) {
+	uint32_t glyphIndex{};
+
+	for (size_t runIndex = 0; runIndex < layout.get_run_count(); ++runIndex) {
+		auto& font = layout.get_run_font(runIndex);
+
+		for (auto glyphEndIndex = layout.get_run_glyph_end_index(runIndex); glyphIndex < glyphEndIndex;
+				++glyphIndex) {
+			add(font, GlyphCacheKey::make(font, layout.get_glyph_id(glyphIndex)));
+		}
+	}
+}
+
+void GlyphPrerasterizer::collect(const LayoutInfo& layout, const FormattingRuns& formatting) {
+	uint32_t glyphIndex{};
+
+	for (size_t runIndex = 0; runIndex < layout.get_run_count(); ++runIndex) {
+		auto& font = layout.get_run_font(runIndex);
+		FormattingIterator iter(formatting, layout.is_run_rtl(runIndex)
+				? layout.get_run_char_end_index(runIndex) : layout.get_run_char_start_index(runIndex));
+
+		for (auto glyphEndIndex = layout.get_run_glyph_end_index(runIndex); glyphIndex < glyphEndIndex;
+				++glyphIndex) {
+			auto glyphID = layout.get_glyph_id(glyphIndex);
+			iter.advance_to(layout.get_char_index(glyphIndex));
+			auto stroke = iter.get_stroke_state();
+
+			if (stroke.color.a > 0.f) {
+				add(font, GlyphCacheKey::make(font, glyphID, stroke.thickness, stroke.joins));
+			}
+
+			add(font, GlyphCacheKey::make(font, glyphID));
+		}
+	}
+}
+
+std::span<const PrerasterizedGlyph> GlyphPrerasterizer::rasterize(GlyphCache& cache, uint32_t threadCount) {
+	if (threadCount == 0) {
+		threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+
+	threadCount = static_cast<uint32_t>(std::min<size_t>(threadCount, m_glyphs.size()));
+
+	// Glyphs are handed out one at a time, as rasterization cost varies too much between glyphs for a static
+	// partition to balance well
+	std::atomic<size_t> nextIndex{};
+	std::exception_ptr firstError;
+	std::mutex errorMutex;
+
+	// Exceptions must not escape a worker, as they would terminate the process from a `std::thread` or skip
+	// joining the threads from the calling thread
+	auto worker = [&] {
+		try {
+			for (auto i = nextIndex.fetch_add(1, std::memory_order_relaxed); i < m_glyphs.size();
+					i = nextIndex.fetch_add(1, std::memory_order_relaxed)) {
+				auto& glyph = m_glyphs[i];
+				glyph.bitmap = cache.get(glyph.font, glyph.key);
+			}
+		}
+		catch (...) {
+			// Stop handing out glyphs so that the other workers finish early
+			nextIndex.store(m_glyphs.size(), std::memory_order_relaxed);
+
+			std::scoped_lock lock(errorMutex);
+
+			if (!firstError) {
+				firstError = std::current_exception();
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	threads.reserve(threadCount > 0 ? threadCount - 1 : 0);
+
+	for (uint32_t i = 1; i < threadCount; ++i) {
+		threads.emplace_back(worker);
+	}
+
+	worker();
+
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	if (firstError) {
+		std::rethrow_exception(firstError);
+	}
+
+	return m_glyphs;
+}
+
+size_t GlyphPrerasterizer::get_glyph_count() const {
+	return m_glyphs.size();
+}
+
+void GlyphPrerasterizer::add(const SingleScriptFont& font, const GlyphCacheKey& key) {
+	if (m_keys.insert(key).second) {
+		m_glyphs.push_back({
+			.font = font,
+			.key = key,
+			.bitmap = {},
+		});
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "glyph_cache.hpp"
+
+#include <span>
+#include <unordered_set>
+#include <vector>
+
+namespace Text {
+
+class LayoutInfo;
+
+struct FormattingRuns;
+
+struct PrerasterizedGlyph {
+	SingleScriptFont font;
+	GlyphCacheKey key;
+	std::shared_ptr<const GlyphBitmap> bitmap;
+};
+
+/**
+ * Collects the unique glyphs referenced by one or more layouts and rasterizes them into a `GlyphCache` on
+ * worker threads, so that an atlas can upload the finished bitmaps in a single batch instead of rasterizing
+ * each miss on the render thread.
+ *
+ * Glyphs already present in the cache are returned without being rasterized again. Workers rasterize through
+ * the cache, so with the default rasterizer each thread uses its own `FontData`.
+ *
+ * The prerasterizer retains its storage across calls to `clear`.
+ *
+ * @thread_safety Not thread safe, except that the `GlyphCache` passed to `rasterize` may be shared with other
+ * threads.
+ */
+class GlyphPrerasterizer {
+	public:
+		void clear();
+
+		/**
+		 * Adds the fill glyph of every glyph in `layout`.
+		 */
+		void collect(const LayoutInfo& layout);
+		/**
+		 * Adds the fill glyph of every glyph in `layout`, and its stroke wherever `formatting` applies a visible
+		 * stroke.
+		 */
+		void collect(const LayoutInfo& layout, const FormattingRuns& formatting);
+
+		/**
+		 * Rasterizes all collected glyphs into `cache` on up to `threadCount` threads, including the calling
+		 * thread, and blocks until they are complete. A `threadCount` of 0 uses one thread per hardware thread.
+		 *
+		 * If the rasterizer throws, the remaining glyphs are abandoned and the first exception is rethrown on the
+		 * calling thread once every worker has stopped.
+		 *
+		 * The returned span remains valid until the next call to `clear` or `collect`.
+		 */
+		std::span<const PrerasterizedGlyph> rasterize(GlyphCache& cache, uint32_t threadCount = 0);
+
+		size_t get_glyph_count() const;
+	private:
+		std::vector<PrerasterizedGlyph> m_glyphs;
+		std::unordered_set<GlyphCacheKey, GlyphCacheKeyHash> m_keys;
+
+		void add(const SingleScriptFont& font, const GlyphCacheKey& key);
+};
+
+}
@@ -0,0 +1,293 @@
+#include "glyph_quad_stream.hpp"
+
+#include "formatting.hpp"
+#include "formatting_iterator.hpp"
+#include "layout_info.hpp"
+
+#include <algorithm>
+
+using namespace Text;
+
+static constexpr const Color WHITE{1.f, 1.f, 1.f, 1.f};
+
+static bool batch_less(const GlyphQuadBatch& a, const GlyphQuadBatch& b);
+
+// Public Functions
+
+void GlyphQuadStream::clear() {
+	m_pending.clear();
+	m_pendingBatches.clear();
+	m_batches.clear();
+	m_positions.clear();
+	m_sizes.clear();
+	m_texCoords.clear();
+	m_colors.clear();
+	m_pages.clear();
+}
+
+void GlyphQuadStream::build(const LayoutInfo& layout, float textAreaWidth, XAlignment textXAlignment,
+		GlyphAtlasLookup& atlas, const Color& color, float originX, float originY) {
+	clear();
+	m_pending.reserve(layout.get_glyph_count());
+
+	uint32_t glyphIndex{};
+	uint32_t glyphPosIndex{};
+	auto* glyphPositions = layout.get_glyph_position_data();
+
+	layout.for_each_run(textAreaWidth, textXAlignment, [&](auto, auto runIndex, auto lineX, auto lineY) {
+		auto& font = layout.get_run_font(runIndex);
+		auto penX = originX + lineX;
+		auto penY = originY + lineY;
+
+		for (auto glyphEndIndex = layout.get_run_glyph_end_index(runIndex); glyphIndex < glyphEndIndex;
+				++glyphIndex, glyphPosIndex += 2) {
+			GlyphAtlasEntry entry;
+
+			if (atlas.get_glyph(font, layout.get_glyph_id(glyphIndex), entry)) {
+				emit_glyph(GlyphQuadLayer::GLYPH, entry, penX + glyphPositions[glyphPosIndex],
+						penY + glyphPositions[glyphPosIndex + 1], entry.hasColor ? WHITE : color);
+			}
+		}
+
+		glyphPosIndex += 2;
+	});
+
+	flush();
+}
+
+void GlyphQuadStream::build(const LayoutInfo& layout, const FormattingRuns& formatting, float textAreaWidth,
+		XAlignment textXAlignment, GlyphAtlasLookup& atlas, float originX, float originY) {
+	clear();
+	m_pending.reserve(layout.get_glyph_count());
+
+	uint32_t glyphIndex{};
+	uint32_t glyphPosIndex{};
+	auto* glyphPositions = layout.get_glyph_position_data();
+
+	layout.for_each_run(textAreaWidth, textXAlignment, [&](auto, auto runIndex, auto lineX, auto lineY) {
+		auto& font = layout.get_run_font(runIndex);
+		auto penX = originX + lineX;
+		auto penY = originY + lineY;
+		auto& metrics = layout.get_run_metrics(runIndex);
+
+		auto emit_underline = [&](float startX, float endX, const Color& color) {
+			emit_solid(atlas, penX + startX, penY + metrics.underlinePosition, endX - startX,
+					metrics.underlineThickness + 0.5f, color);
+		};
+
+		auto emit_strikethrough = [&](float startX, float endX, const Color& color) {
+			emit_solid(atlas, penX + startX, penY + metrics.strikethroughPosition, endX - startX,
+					metrics.strikethroughThickness + 0.5f, color);
+		};
+
+		FormattingIterator iter(formatting, layout.is_run_rtl(runIndex)
+				? layout.get_run_char_end_index(runIndex) : layout.get_run_char_start_index(runIndex));
+		float underlineStartPos = glyphPositions[glyphPosIndex];
+		float strikethroughStartPos = underlineStartPos;
+
+		for (auto glyphEndIndex = layout.get_run_glyph_end_index(runIndex); glyphIndex < glyphEndIndex;
+				++glyphIndex, glyphPosIndex += 2) {
+			auto pX = glyphPositions[glyphPosIndex];
+			auto pY = glyphPositions[glyphPosIndex + 1];
+			auto glyphID = layout.get_glyph_id(glyphIndex);
+			auto event = iter.advance_to(layout.get_char_index(glyphIndex));
+			auto stroke = iter.get_stroke_state();
+			GlyphAtlasEntry entry;
+
+			if (stroke.color.a > 0.f
+					&& atlas.get_stroke(font, glyphID, stroke.thickness, stroke.joins, entry)) {
+				emit_glyph(GlyphQuadLayer::STROKE, entry, penX + pX, penY + pY, stroke.color);
+			}
+
+			if (atlas.get_glyph(font, glyphID, entry)) {
+				emit_glyph(GlyphQuadLayer::GLYPH, entry, penX + pX, penY + pY,
+						entry.hasColor ? WHITE : iter.get_color());
+			}
+
+			if ((event & FormattingEvent::UNDERLINE_END) != FormattingEvent::NONE) {
+				emit_underline(underlineStartPos, pX, iter.get_prev_color());
+			}
+
+			if ((event & FormattingEvent::UNDERLINE_BEGIN) != FormattingEvent::NONE) {
+				underlineStartPos = pX;
+			}
+
+			if ((event & FormattingEvent::STRIKETHROUGH_END) != FormattingEvent::NONE) {
+				emit_strikethrough(strikethroughStartPos, pX, iter.get_prev_color());
+			}
+
+			if ((event & FormattingEvent::STRIKETHROUGH_BEGIN) != FormattingEvent::NONE) {
+				strikethroughStartPos = pX;
+			}
+		}
+
+		// Finalize decorations still open at the end of the run
+		if (iter.has_strikethrough()) {
+			emit_strikethrough(strikethroughStartPos, glyphPositions[glyphPosIndex], iter.get_color());
+		}
+
+		if (iter.has_underline()) {
+			emit_underline(underlineStartPos, glyphPositions[glyphPosIndex], iter.get_color());
+		}
+
+		glyphPosIndex += 2;
+	});
+
+	flush();
+}
+
+size_t GlyphQuadStream::get_quad_count() const {
+	return m_pages.size();
+}
+
+const float* GlyphQuadStream::get_positions() const {
+	return m_positions.data();
+}
+
+const float* GlyphQuadStream::get_sizes() const {
+	return m_sizes.data();
+}
+
+const float* GlyphQuadStream::get_tex_coords() const {
+	return m_texCoords.data();
+}
+
+const Color* GlyphQuadStream::get_colors() const {
+	return m_colors.data();
+}
+
+const uint32_t* GlyphQuadStream::get_pages() const {
+	return m_pages.data();
+}
+
+std::span<const GlyphQuadBatch> GlyphQuadStream::get_batches() const {
+	return m_batches;
+}
+
+bool GlyphQuadStream::empty() const {
+	return m_pages.empty();
+}
+
+void GlyphQuadStream::emit(GlyphQuadLayer layer, uint32_t page, float x, float y, float width, float height,
+		const float* texCoords, const Color& color) {
+	auto batchIndex = get_batch_index(layer, page);
+	++m_pendingBatches[batchIndex].quadCount;
+
+	m_pending.push_back({
+		.position = {x, y},
+		.size = {width, height},
+		.texCoords = {texCoords[0], texCoords[1], texCoords[2], texCoords[3]},
+		.color = color,
+		.batchIndex = batchIndex,
+	});
+}
+
+void GlyphQuadStream::emit_glyph(GlyphQuadLayer layer, const GlyphAtlasEntry& entry, float x, float y,
+		const Color& color) {
+	emit(layer, entry.page, x + entry.offset[0], y + entry.offset[1], entry.size[0], entry.size[1],
+			entry.texCoords, color);
+}
+
+void GlyphQuadStream::emit_solid(GlyphAtlasLookup& atlas, float x, float y, float width, float height,
+		const Color& color) {
+	GlyphAtlasEntry entry;
+
+	if (atlas.get_solid(entry)) {
+		emit(GlyphQuadLayer::DECORATION, entry.page, x, y, width, height, entry.texCoords, color);
+	}
+}
+
+uint32_t GlyphQuadStream::get_batch_index(GlyphQuadLayer layer, uint32_t page) {
+	// Consecutive glyphs overwhelmingly share a page, so check the most recently used batch first. The
+	// remaining batch count is bounded by pages * layers, which keeps the linear search short.
+	if (!m_pending.empty()) [[likely]] {
+		auto lastIndex = m_pending.back().batchIndex;
+		auto& lastBatch = m_pendingBatches[lastIndex];
+
+		if (lastBatch.page == page && lastBatch.layer == layer) [[likely]] {
+			return lastIndex;
+		}
+	}
+
+	for (uint32_t i = 0; i < m_pendingBatches.size(); ++i) {
+		if (m_pendingBatches[i].page == page && m_pendingBatches[i].layer == layer) {
+			return i;
+		}
+	}
+
+	m_pendingBatches.push_back({
+		.firstQuad = 0,
+		.quadCount = 0,
+		.page = page,
+		.layer = layer,
+	});
+
+	return static_cast<uint32_t>(m_pendingBatches.size() - 1);
+}
+
+void GlyphQuadStream::flush() {
+	// Order the batches by layer then page, and remember where each one starts so the pending quads can be
+	// scattered directly into their final slot
+	auto batchCount = static_cast<uint32_t>(m_pendingBatches.size());
+	m_batchOrder.resize(batchCount);
+	m_batchCursors.resize(batchCount);
+
+	for (uint32_t i = 0; i < batchCount; ++i) {
+		m_batchOrder[i] = i;
+	}
+
+	std::sort(m_batchOrder.begin(), m_batchOrder.end(), [&](auto a, auto b) {
+		return batch_less(m_pendingBatches[a], m_pendingBatches[b]);
+	});
+
+	uint32_t firstQuad{};
+
+	for (auto index : m_batchOrder) {
+		auto& batch = m_pendingBatches[index];
+		m_batches.push_back({
+			.firstQuad = firstQuad,
+			.quadCount = batch.quadCount,
+			.page = batch.page,
+			.layer = batch.layer,
+		});
+		m_batchCursors[index] = firstQuad;
+		firstQuad += batch.quadCount;
+	}
+
+	auto quadCount = m_pending.size();
+	m_positions.resize(2 * quadCount);
+	m_sizes.resize(2 * quadCount);
+	m_texCoords.resize(4 * quadCount);
+	m_colors.resize(quadCount);
+	m_pages.resize(quadCount);
+
+	// Scatter preserves emission order within each batch
+	for (auto& quad : m_pending) {
+		auto dst = m_batchCursors[quad.batchIndex]++;
+
+		m_positions[2 * dst] = quad.position[0];
+		m_positions[2 * dst + 1] = quad.position[1];
+		m_sizes[2 * dst] = quad.size[0];
+		m_sizes[2 * dst + 1] = quad.size[1];
+
+		for (size_t i = 0; i < 4; ++i) {
+			m_texCoords[4 * dst + i] = quad.texCoords[i];
+		}
+
+		m_colors[dst] = quad.color;
+		m_pages[dst] = m_pendingBatches[quad.batchIndex].page;
+	}
+
+	m_pending.clear();
+	m_pendingBatches.clear();
+}
+
+// Static Functions
+
+static bool batch_less(const GlyphQuadBatch& a, const GlyphQuadBatch& b) {
+	if (a.layer != b.layer) {
+		return a.layer < b.layer;
+	}
+
+	return a.page < b.page;
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include "color.hpp"
+#include "font.hpp"
+#include "stroke_type.hpp"
+#include "text_alignment.hpp"
+
+#include <span>
+#include <vector>
+
+namespace Text {
+
+class LayoutInfo;
+
+struct FormattingRuns;
+
+/**
+ * Atlas placement of a single glyph, as reported by a `GlyphAtlasLookup`.
+ */
+struct GlyphAtlasEntry {
+	// Offset of the top-left corner of the quad from the glyph pen position
+	float offset[2];
+	float size[2];
+	// UV rect of the glyph within its page, as {x, y, width, height}
+	float texCoords[4];
+	uint32_t page;
+	// Whether the glyph carries its own color (e.g. color emoji), in which case it is emitted tinted white
+	bool hasColor;
+};
+
+/**
+ * Interface used by `GlyphQuadStream` to locate glyphs inside an atlas. Implementations are free to
+ * rasterize and upload glyphs on a miss; the stream only records the resulting placement.
+ *
+ * Returning `false` from any lookup skips the quad, which is the expected response for glyphs with no
+ * visible bitmap, such as spaces.
+ */
+class GlyphAtlasLookup {
+	public:
+		virtual ~GlyphAtlasLookup() = default;
+
+		virtual bool get_glyph(const SingleScriptFont& font, uint32_t glyphID, GlyphAtlasEntry& entry) = 0;
+		virtual bool get_stroke(const SingleScriptFont& font, uint32_t glyphID, uint8_t thickness,
+				StrokeType joins, GlyphAtlasEntry& entry) = 0;
+		/**
+		 * Gets a region of the atlas that samples as solid white, used for underline and strikethrough quads.
+		 * Only `texCoords` and `page` are read from the result.
+		 */
+		virtual bool get_solid(GlyphAtlasEntry& entry) = 0;
+};
+
+/**
+ * Draw order of a quad. Batches are sorted by layer first, so that strokes never overlap the fill of a
+ * neighbouring glyph and decorations are always drawn on top, regardless of which page each quad lands on.
+ */
+enum class GlyphQuadLayer : uint8_t {
+	STROKE,
+	GLYPH,
+	DECORATION,
+};
+
+/**
+ * A contiguous range of quads in a `GlyphQuadStream` that share an atlas page and layer, and can be drawn
+ * with a single instanced call.
+ */
+struct GlyphQuadBatch {
+	uint32_t firstQuad;
+	uint32_t quadCount;
+	uint32_t page;
+	GlyphQuadLayer layer;
+};
+
+/**
+ * Converts a `LayoutInfo` into a flat list of textured quads, stored as separate position, size, UV,
+ * color and page arrays and grouped into per-page batches.
+ *
+ * The stream retains its storage across calls to `build`, so that re-emitting a text block every frame does
+ * not allocate once the buffers have grown to fit.
+ *
+ * @thread_safety Distinct streams may be built concurrently, provided the `GlyphAtlasLookup` is safe to call
+ * from each thread.
+ */
+class GlyphQuadStream {
+	public:
+		void clear();
+
+		/**
+		 * Emits one quad per visible glyph of `layout` in `color`, offset by (`originX`, `originY`).
+		 */
+		void build(const LayoutInfo& layout, float textAreaWidth, XAlignment textXAlignment,
+				GlyphAtlasLookup& atlas, const Color& color, float originX = 0.f, float originY = 0.f);
+		/**
+		 * Emits glyph, stroke, underline and strikethrough quads for `layout` as described by `formatting`,
+		 * offset by (`originX`, `originY`).
+		 */
+		void build(const LayoutInfo& layout, const FormattingRuns& formatting, float textAreaWidth,
+				XAlignment textXAlignment, GlyphAtlasLookup& atlas, float originX = 0.f, float originY = 0.f);
+
+		size_t get_quad_count() const;
+
+		/**
+		 * Quad top-left corners as interleaved {x, y} pairs.
+		 */
+		const float* get_positions() const;
+		/**
+		 * Quad extents as interleaved {width, height} pairs.
+		 */
+		const float* get_sizes() const;
+		/**
+		 * Quad UV rects as interleaved {x, y, width, height} tuples.
+		 */
+		const float* get_tex_coords() const;
+		const Color* get_colors() const;
+		const uint32_t* get_pages() const;
+
+		std::span<const GlyphQuadBatch> get_batches() const;
+
+		bool empty() const;
+	private:
+		struct PendingQuad {
+			float position[2];
+			float size[2];
+			float texCoords[4];
+			Color color;
+			uint32_t batchIndex;
+		};
+
+		std::vector<PendingQuad> m_pending;
+		std::vector<GlyphQuadBatch> m_pendingBatches;
+		std::vector<uint32_t> m_batchOrder;
+		std::vector<uint32_t> m_batchCursors;
+		std::vector<GlyphQuadBatch> m_batches;
+
+		std::vector<float> m_positions;
+		std::vector<float> m_sizes;
+		std::vector<float> m_texCoords;
+		std::vector<Color> m_colors;
+		std::vector<uint32_t> m_pages;
+
+		void emit(GlyphQuadLayer layer, uint32_t page, float x, float y, float width, float height,
+				const float* texCoords, const Color& color);
+		void emit_glyph(GlyphQuadLayer layer, const GlyphAtlasEntry& entry, float x, float y,
+				const Color& color);
+		void emit_solid(GlyphAtlasLookup& atlas, float x, float y, float width, float height,
+				const Color& color);
+		uint32_t get_batch_index(GlyphQuadLayer layer, uint32_t page);
+		void flush();
+};
+
+}
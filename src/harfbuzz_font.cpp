@@ -29,7 +29,6 @@
 
 #include "harfbuzz_font.hpp"
 
-#include "hb-cache.hh"
 #include "hb-machinery.hh"
 #include "hb-ot-os2-table.hh"
 #include "hb-ot-shaper-arabic-pua.hh"
@@ -39,6 +38,12 @@
 #include FT_ADVANCES_H
 #include FT_TRUETYPE_TABLES_H
 
+#include <hb-ot.h>
+
+#include <cmath>
+#include <cstring>
+#include <memory>
+
 /* TODO:
  *
  * In general, this file does a fine job of what it's supposed to do.
@@ -58,14 +63,33 @@
 
 static constexpr const int FREETYPE_LOAD_FLAGS = FT_LOAD_DEFAULT | FT_LOAD_NO_BITMAP;
 
-using hb_ft_advance_cache_t = hb_cache_t<16, 24, 8, false>;
+// Number of sizes per font for which glyph advances are kept, as layouts commonly alternate between a few sizes
+static constexpr const size_t MAX_ADVANCE_TABLES = 4;
+// Faces with more glyphs, such as CJK fonts, look up every advance through FreeType rather than holding several
+// tables of up to 256 KiB each
+static constexpr const size_t MAX_ADVANCE_TABLE_GLYPHS = 4096;
+static constexpr const hb_position_t ADVANCE_UNSET = -1;
 
 namespace {
 
+/**
+ * Dense table of horizontal advances for every glyph of a font at a single size. Entries are filled on first
+ * use, as FreeType reports hinted advances which cannot be derived from hmtx alone. Advances are stored before
+ * synthetic emboldening, which is added on every lookup.
+ */
+struct AdvanceTable {
+	FT_Fixed xScale{};
+	uint32_t lastUse{};
+	std::unique_ptr<hb_position_t[]> advances;
+};
+
 struct HarfbuzzFontImpl {
 	FT_Face ftFace;
-	unsigned cachedSerial{static_cast<unsigned>(-1)};
-	mutable hb_ft_advance_cache_t advanceCache;
+	AdvanceTable advanceTables[MAX_ADVANCE_TABLES];
+	hb_position_t* pAdvances{};
+	// Number of glyphs covered by pAdvances, 0 while the face has no size or too many glyphs to cache
+	hb_codepoint_t advanceCount{};
+	uint32_t advanceClock{};
 	bool isSymbolCharmap: 1;
 	bool applyFTFaceTransform: 1;
 };
@@ -77,12 +101,17 @@ struct FontFuncsLazyLoader : hb_font_funcs_lazy_loader_t<FontFuncsLazyLoader> {
 
 }
 
-static hb_face_t* harfbuzz_face_create(FT_Face ftFace);
+static hb_user_data_key_t g_ftFaceKey;
+
+static hb_face_t* harfbuzz_face_create(FT_Face ftFace, hb_blob_t* blob);
 
 static void harfbuzz_font_destroy(void* data);
 
 static void set_font_funcs(hb_font_t* font, FT_Face ftFace);
 
+static void set_scale_from_ft_face(hb_font_t* font, FT_Face ftFace);
+static void select_advance_table(HarfbuzzFontImpl& impl);
+
 static hb_blob_t* face_reference_table(hb_face_t* face, hb_tag_t tag, void* userData);
 
 static hb_bool_t hb_ft_get_nominal_glyph(hb_font_t* font, void* fontData, hb_codepoint_t unicode,
@@ -118,29 +147,72 @@ static hb_bool_t hb_ft_get_glyph_from_name(hb_font_t* font, void* fontData, cons
 
 // Public Functions
 
-hb_font_t* Text::harfbuzz_font_create(FT_Face ftFace) {
-	auto* face = harfbuzz_face_create(ftFace);
+hb_font_t* Text::harfbuzz_font_create(FT_Face ftFace, hb_blob_t* blob, HarfbuzzFontFuncs funcs) {
+	auto* face = harfbuzz_face_create(ftFace, blob);
 	auto* font = hb_font_create(face);
+	hb_face_destroy(face);
+
+	switch (funcs) {
+		case HarfbuzzFontFuncs::NATIVE:
+			hb_ot_font_set_funcs(font);
+			hb_font_set_user_data(font, &g_ftFaceKey, ftFace, nullptr, true);
+			break;
+		default:
+			set_font_funcs(font, ftFace);
+			break;
+	}
 
-	set_font_funcs(font, ftFace);
 	harfbuzz_font_mark_changed(font);
 
 	return font;
 }
 
 void Text::harfbuzz_font_mark_changed(hb_font_t* font) {
+	if (font->destroy != harfbuzz_font_destroy) {
+		auto* ftFace = reinterpret_cast<FT_Face>(hb_font_get_user_data(font, &g_ftFaceKey));
+		set_scale_from_ft_face(font, ftFace);
+		hb_font_set_ppem(font, ftFace->size->metrics.x_ppem, ftFace->size->metrics.y_ppem);
+		return;
+	}
+
 	auto* pImpl = reinterpret_cast<HarfbuzzFontImpl*>(font->user_data);
-	FT_Face ftFace = pImpl->ftFace;
 
-	int scaleX = (int)(((uint64_t)ftFace->size->metrics.x_scale * (uint64_t)ftFace->units_per_EM
-			+ (1u << 15)) >> 16);
-	int scaleY = (int)(((uint64_t)ftFace->size->metrics.y_scale * (uint64_t)ftFace->units_per_EM
-			+ (1u << 15)) >> 16);
+	set_scale_from_ft_face(font, pImpl->ftFace);
 
-	hb_font_set_scale(font, scaleX, scaleY);
+	select_advance_table(*pImpl);
+}
+
+void Text::harfbuzz_font_set_synthetics(hb_font_t* font, const SyntheticFontInfo& synthInfo) {
+	if (font->destroy == harfbuzz_font_destroy) {
+		return;
+	}
+
+	float boldX = 0.f;
+	float boldY = 0.f;
+	float slant = 0.f;
+
+	if (synthInfo.srcWeight != synthInfo.dstWeight) {
+		boldX = SYNTHETIC_BOLD_SCALE[static_cast<size_t>(synthInfo.dstWeight)];
+		boldY = boldX * SYNTHETIC_BOLD_SCALE_Y;
+	}
+
+	if (synthInfo.srcStyle != synthInfo.dstStyle) {
+		slant = static_cast<float>(std::sin(synthInfo.dstStyle == FontStyle::ITALIC ? SYNTHETIC_ITALIC_ANGLE
+				: -SYNTHETIC_ITALIC_ANGLE));
+	}
+
+	// Avoid bumping the font serial, which would invalidate HarfBuzz's internal caches, if nothing changed
+	float currBoldX, currBoldY;
+	hb_bool_t currInPlace;
+	hb_font_get_synthetic_bold(font, &currBoldX, &currBoldY, &currInPlace);
+
+	if (currBoldX != boldX || currBoldY != boldY) {
+		hb_font_set_synthetic_bold(font, boldX, boldY, false);
+	}
 
-	pImpl->advanceCache.clear();
-	pImpl->cachedSerial = font->serial;
+	if (hb_font_get_synthetic_slant(font) != slant) {
+		hb_font_set_synthetic_slant(font, slant);
+	}
 }
 
 // FontFuncsLazyLoader
@@ -183,10 +255,13 @@ void FontFuncsLazyLoader::at_exit() {
 
 // Static Functions
 
-static hb_face_t* harfbuzz_face_create(FT_Face ftFace) {
+static hb_face_t* harfbuzz_face_create(FT_Face ftFace, hb_blob_t* blob) {
 	hb_face_t* face;
 
-	if (!ftFace->stream->read) {
+	if (blob) {
+		face = hb_face_create(blob, ftFace->face_index);
+	}
+	else if (!ftFace->stream->read) {
 		auto* blob = hb_blob_create((const char*)ftFace->stream->base, (unsigned)ftFace->stream->size,
 				HB_MEMORY_MODE_READONLY, ftFace, nullptr);
 		face = hb_face_create(blob, ftFace->face_index);
@@ -219,6 +294,56 @@ static void set_font_funcs(hb_font_t* font, FT_Face ftFace) {
 	hb_font_set_funcs(font, g_fontFuncsLoader.get_unconst(), pImpl, harfbuzz_font_destroy);
 }
 
+static void set_scale_from_ft_face(hb_font_t* font, FT_Face ftFace) {
+	int scaleX = (int)(((uint64_t)ftFace->size->metrics.x_scale * (uint64_t)ftFace->units_per_EM
+			+ (1u << 15)) >> 16);
+	int scaleY = (int)(((uint64_t)ftFace->size->metrics.y_scale * (uint64_t)ftFace->units_per_EM
+			+ (1u << 15)) >> 16);
+
+	hb_font_set_scale(font, scaleX, scaleY);
+}
+
+static void select_advance_table(HarfbuzzFontImpl& impl) {
+	auto xScale = impl.ftFace->size->metrics.x_scale;
+	auto glyphCount = static_cast<size_t>(impl.ftFace->num_glyphs);
+	auto* pTarget = &impl.advanceTables[0];
+
+	// A face that has not been sized yet would only claim a slot with a table that is never used again, and
+	// faces with too many glyphs are not cached
+	if (xScale == 0 || glyphCount > MAX_ADVANCE_TABLE_GLYPHS) {
+		impl.pAdvances = nullptr;
+		impl.advanceCount = 0;
+		return;
+	}
+
+	++impl.advanceClock;
+
+	for (auto& table : impl.advanceTables) {
+		if (table.advances && table.xScale == xScale) {
+			table.lastUse = impl.advanceClock;
+			impl.pAdvances = table.advances.get();
+			impl.advanceCount = static_cast<hb_codepoint_t>(glyphCount);
+			return;
+		}
+
+		if (table.lastUse < pTarget->lastUse) {
+			pTarget = &table;
+		}
+	}
+
+	if (!pTarget->advances) {
+		pTarget->advances = std::make_unique_for_overwrite<hb_position_t[]>(glyphCount);
+	}
+
+	std::memset(pTarget->advances.get(), 0xFF, glyphCount * sizeof(hb_position_t));
+	static_assert(ADVANCE_UNSET == -1, "Table reset relies on all bits being set");
+
+	pTarget->xScale = xScale;
+	pTarget->lastUse = impl.advanceClock;
+	impl.pAdvances = pTarget->advances.get();
+	impl.advanceCount = static_cast<hb_codepoint_t>(glyphCount);
+}
+
 static hb_blob_t* face_reference_table(hb_face_t* /*face*/, hb_tag_t tag, void* userData) {
 	auto* ftFace = reinterpret_cast<FT_Face>(userData);
 	FT_ULong  length = 0;
@@ -343,8 +468,8 @@ static void hb_ft_get_glyph_h_advances(hb_font_t* font, void* fontData, unsigned
 		FT_Fixed v = 0;
 		hb_codepoint_t glyph = *pFirstGlyph;
 
-		if (unsigned cv; pImpl->advanceCache.get(glyph, &cv)) {
-		  v = cv;
+		if (glyph < pImpl->advanceCount && pImpl->pAdvances[glyph] != ADVANCE_UNSET) [[likely]] {
+			v = pImpl->pAdvances[glyph];
 		}
 		else {
 			FT_Get_Advance(ftFace, glyph, FREETYPE_LOAD_FLAGS, &v);
@@ -352,7 +477,10 @@ static void hb_ft_get_glyph_h_advances(hb_font_t* font, void* fontData, unsigned
 			* for variable-set fonts if x_scale is negative! */
 			v = abs (v);
 			v = (int) (v * x_mult + (1<<9)) >> 10;
-			pImpl->advanceCache.set(glyph, v);
+
+			if (glyph < pImpl->advanceCount) {
+				pImpl->pAdvances[glyph] = static_cast<hb_position_t>(v);
+			}
 		}
 
 		*pFirstAdvance = v;
@@ -1,13 +1,28 @@
 #pragma once
 
+#include "font_common.hpp"
+
 #include <hb.h>
 
 struct FT_FaceRec_;
 
 namespace Text {
 
-hb_font_t* harfbuzz_font_create(FT_FaceRec_* ftFace);
+/**
+ * Creates a HarfBuzz font backed by `ftFace`. If `blob` is non-null, it must contain the data of the font file
+ * `ftFace` was created from, and is referenced by the underlying `hb_face_t` instead of creating a new blob.
+ *
+ * Regardless of `funcs`, the font is scaled to the 26.6 metrics of the current size of `ftFace`.
+ */
+hb_font_t* harfbuzz_font_create(FT_FaceRec_* ftFace, hb_blob_t* blob = nullptr,
+		HarfbuzzFontFuncs funcs = HarfbuzzFontFuncs::FREETYPE);
 void harfbuzz_font_mark_changed(hb_font_t*);
 
+/**
+ * Applies synthetic bold and italic adjustments to glyph metrics reported by a font using
+ * `HarfbuzzFontFuncs::NATIVE`. Has no effect on fonts using FreeType font functions.
+ */
+void harfbuzz_font_set_synthetics(hb_font_t*, const SyntheticFontInfo& synthInfo);
+
 }
 
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace Text::Internal {
+
+/**
+ * Storage and split/merge primitives of a treap ordered by position rather than by key, shared by
+ * `EditableValueRuns` and `TextDocument`. Each node covers `length` consecutive positions, following those of its
+ * left subtree and preceding those of its right subtree.
+ *
+ * `Derived` holds the nodes in a `std::vector<Node> m_nodes`, where `Node` has `length`, `subtreeLength`,
+ * `subtreeCount`, `priority`, `left` and `right` members, and provides:
+ * - `uint32_t split_node(uint32_t node, Length offset)`, shortening `node` to its first `offset` positions and
+ *   returning a new node, allocated with `emplace_node`, for the rest.
+ * - Optionally `void update_node(Node&)`, recomputing any further subtree totals after the children of a node
+ *   change.
+ *
+ * Moving leaves the source tree empty, provided `Derived` moves `m_nodes` along with it.
+ */
+template <typename Derived>
+class ImplicitTreap {
+	protected:
+		static constexpr const uint32_t INVALID_NODE = ~0u;
+
+		std::vector<uint32_t> m_freeNodes;
+		uint32_t m_root{INVALID_NODE};
+		uint32_t m_seed{0x9E3779B9u};
+
+		ImplicitTreap() = default;
+
+		// The moved-from tree is left empty, as its root would otherwise refer to the nodes taken from it
+		ImplicitTreap(ImplicitTreap&& other) noexcept
+				: m_freeNodes(std::move(other.m_freeNodes))
+				, m_root(std::exchange(other.m_root, INVALID_NODE))
+				, m_seed(other.m_seed) {
+			other.m_freeNodes.clear();
+		}
+
+		ImplicitTreap& operator=(ImplicitTreap&& other) noexcept {
+			m_freeNodes = std::move(other.m_freeNodes);
+			m_root = std::exchange(other.m_root, INVALID_NODE);
+			m_seed = other.m_seed;
+			other.m_freeNodes.clear();
+
+			return *this;
+		}
+
+		/**
+		 * Stores `node` as a tree of its own with a new priority, reusing a freed slot if there is one.
+		 */
+		template <typename Node>
+		uint32_t emplace_node(Node&& node) {
+			auto& nodes = get_nodes();
+			node.subtreeLength = node.length;
+			node.subtreeCount = 1;
+			node.priority = next_priority();
+			node.left = INVALID_NODE;
+			node.right = INVALID_NODE;
+
+			if (m_freeNodes.empty()) {
+				nodes.emplace_back(std::move(node));
+				return static_cast<uint32_t>(nodes.size() - 1);
+			}
+
+			auto index = m_freeNodes.back();
+			m_freeNodes.pop_back();
+			nodes[index] = std::move(node);
+			return index;
+		}
+
+		void free_subtree(uint32_t node) {
+			if (node != INVALID_NODE) {
+				free_subtree(get_nodes()[node].left);
+				free_subtree(get_nodes()[node].right);
+				m_freeNodes.emplace_back(node);
+			}
+		}
+
+		void clear_nodes() {
+			get_nodes().clear();
+			m_freeNodes.clear();
+			m_root = INVALID_NODE;
+		}
+
+		auto get_subtree_length(uint32_t node) const {
+			using Length = decltype(get_nodes()[node].subtreeLength);
+			return node == INVALID_NODE ? Length{} : get_nodes()[node].subtreeLength;
+		}
+
+		uint32_t get_subtree_count(uint32_t node) const {
+			return node == INVALID_NODE ? 0 : get_nodes()[node].subtreeCount;
+		}
+
+		void update(uint32_t node) {
+			auto& n = get_nodes()[node];
+			n.subtreeLength = n.length + get_subtree_length(n.left) + get_subtree_length(n.right);
+			n.subtreeCount = 1 + get_subtree_count(n.left) + get_subtree_count(n.right);
+			static_cast<Derived*>(this)->update_node(n);
+		}
+
+		template <typename Node>
+		void update_node(Node&) {}
+
+		// Splits `node` into the positions before `position` and those from it onwards, cutting the node
+		// containing `position` in two if needed
+		template <typename Length>
+		void split(uint32_t node, Length position, uint32_t& left, uint32_t& right) {
+			if (node == INVALID_NODE) {
+				left = right = INVALID_NODE;
+				return;
+			}
+
+			auto& nodes = get_nodes();
+			auto leftLength = get_subtree_length(nodes[node].left);
+			uint32_t child;
+
+			// Splitting may allocate a node, so children are written back after the recursion rather than passed
+			// by reference
+			if (position <= leftLength) {
+				split(nodes[node].left, position, left, child);
+				nodes[node].left = child;
+				update(node);
+				right = node;
+			}
+			else if (position >= leftLength + nodes[node].length) {
+				split(nodes[node].right, position - leftLength - nodes[node].length, child, right);
+				nodes[node].right = child;
+				update(node);
+				left = node;
+			}
+			else {
+				auto tail = static_cast<Derived*>(this)->split_node(node, position - leftLength);
+
+				// Taking the priority of `node` keeps the heap order, as `tail` becomes the parent of its right child
+				auto& n = nodes[node];
+				auto& t = nodes[tail];
+				t.priority = n.priority;
+				t.right = n.right;
+				n.right = INVALID_NODE;
+
+				update(node);
+				update(tail);
+				left = node;
+				right = tail;
+			}
+		}
+
+		uint32_t merge(uint32_t left, uint32_t right) {
+			auto& nodes = get_nodes();
+
+			if (left == INVALID_NODE) {
+				return right;
+			}
+			else if (right == INVALID_NODE) {
+				return left;
+			}
+			else if (nodes[left].priority > nodes[right].priority) {
+				nodes[left].right = merge(nodes[left].right, right);
+				update(left);
+				return left;
+			}
+			else {
+				nodes[right].left = merge(left, nodes[right].left);
+				update(right);
+				return right;
+			}
+		}
+	private:
+		// xorshift32, deterministic so that the tree shape only depends on the edits made
+		uint32_t next_priority() {
+			m_seed ^= m_seed << 13;
+			m_seed ^= m_seed >> 17;
+			m_seed ^= m_seed << 5;
+			return m_seed;
+		}
+
+		auto& get_nodes() {
+			return static_cast<Derived*>(this)->m_nodes;
+		}
+
+		const auto& get_nodes() const {
+			return static_cast<const Derived*>(this)->m_nodes;
+		}
+};
+
+}
@@ -4,6 +4,7 @@
 #include "font_registry.hpp"
 #include "layout_info.hpp"
 #include "script_run_iterator.hpp"
+#include "style_table.hpp"
 #include "value_runs.hpp"
 #include "value_run_utils.hpp"
 
@@ -23,6 +24,22 @@ using namespace Text;
 
 namespace {
 
+struct LayoutStyle {
+	Font font;
+	bool smallcaps;
+	bool subscript;
+	bool superscript;
+
+	constexpr bool operator==(const LayoutStyle&) const = default;
+};
+
+}
+
+static LayoutStyle get_layout_style(const Font& font, bool smallcaps, bool subscript, bool superscript);
+static LayoutStyle get_layout_style(const TextStyle& style);
+
+namespace {
+
 class ScriptRunValueIterator {
 	public:
 		explicit ScriptRunValueIterator(const char* paragraphText, int32_t paragraphStart,
@@ -82,16 +99,65 @@ class LevelsIterator {
 		int32_t m_index;
 };
 
+// Walks the style runs, joining neighbouring runs that only differ in attributes that do not affect shaping,
+// such as color or decorations, so that they are shaped as one run
+class StyleRunsIterator {
+	public:
+		explicit StyleRunsIterator(const CompactFormattingRuns& formatting)
+				: m_formatting(&formatting) {
+			if (formatting.styleRuns.get_run_count() > 0) {
+				find_last_run();
+			}
+		}
+
+		int32_t get_limit() const { return m_formatting->styleRuns.get_run_limit(m_lastRunIndex); }
+
+		const TextStyle& get_value() const { return get_run_style(m_runIndex); }
+
+		void advance_to(int32_t index) {
+			while (get_limit() <= index && m_lastRunIndex + 1 < m_formatting->styleRuns.get_run_count()) {
+				m_runIndex = m_lastRunIndex + 1;
+				find_last_run();
+			}
+		}
+	private:
+		const CompactFormattingRuns* m_formatting;
+		size_t m_runIndex{};
+		size_t m_lastRunIndex{};
+
+		const TextStyle& get_run_style(size_t runIndex) const {
+			return m_formatting->styles.get_style(m_formatting->styleRuns.get_run_value(runIndex));
+		}
+
+		void find_last_run() {
+			auto style = get_layout_style(get_run_style(m_runIndex));
+			m_lastRunIndex = m_runIndex;
+
+			while (m_lastRunIndex + 1 < m_formatting->styleRuns.get_run_count()
+					&& get_layout_style(get_run_style(m_lastRunIndex + 1)) == style) {
+				++m_lastRunIndex;
+			}
+		}
+};
+
 }
 
+static int32_t get_text_length(std::span<const std::string_view> chunks);
+static bool starts_with_line_feed(std::span<const std::string_view> chunks, size_t chunkIndex);
+static bool ends_paragraph_separator(std::string_view text, size_t index, bool continuesWithLineFeed);
+static size_t find_first_paragraph_end(std::string_view text, bool continuesWithLineFeed);
+static size_t find_last_paragraph_end(std::string_view text, bool continuesWithLineFeed);
+
 static int32_t find_previous_line_break(icu::BreakIterator& iter, const char* chars, int32_t count,
 		int32_t charIndex);
 
-static void maybe_add_tag_runs(std::vector<hb_feature_t>& features, hb_tag_t tag, int32_t count,
-		bool needsFeature, bool isSynthesizingThis);
+static void maybe_add_feature(hb_feature_t* features, unsigned& featureCount, uint32_t& featureMask,
+		hb_tag_t tag, bool needsFeature, bool isSynthesizingThis);
 static void remap_char_indices(hb_glyph_info_t* glyphInfos, unsigned glyphCount, icu::Edits& edits,
 		const char* sourceStr, bool rightToLeft);
 
+static constexpr const size_t MAX_CACHED_SHAPE_PLANS = 16;
+
 static constexpr int32_t mul_fixed(int32_t a, int32_t b) {
 	auto ab = static_cast<int64_t>(a) * static_cast<int64_t>(b);
 	return static_cast<int32_t>(ab >> 6);
@@ -112,6 +178,8 @@ LayoutBuilder::~LayoutBuilder() {
 	if (m_buffer) {
 		hb_buffer_destroy(m_buffer);
 	}
+
+	clear_shape_plans();
 }
 
 LayoutBuilder::LayoutBuilder(LayoutBuilder&& other) noexcept {
@@ -127,10 +195,47 @@ LayoutBuilder& LayoutBuilder::operator=(LayoutBuilder&& other) noexcept {
 	m_glyphPositions[1] = std::move(other.m_glyphPositions[1]);
 	std::swap(m_cursor, other.m_cursor);
 	m_logicalRuns = std::move(other.m_logicalRuns);
+	std::swap(m_shapePlans, other.m_shapePlans);
+	std::swap(m_shapePlanClock, other.m_shapePlanClock);
+	m_paragraphBuffer = std::move(other.m_paragraphBuffer);
 
 	return *this;
 }
 
+void LayoutBuilder::build_layout_info(LayoutInfo& result, const char* chars, int32_t count,
+		const ValueRuns<Font>& fontRuns, const LayoutBuildParams& params) {
+	std::string_view text(chars, count);
+	build_layout_info(result, {&text, 1}, fontRuns, params);
+}
+
+void LayoutBuilder::build_layout_info(LayoutInfo& result, const char* chars, int32_t count,
+		const CompactFormattingRuns& formatting, const LayoutBuildParams& params) {
+	std::string_view text(chars, count);
+	build_layout_info(result, {&text, 1}, formatting, params);
+}
+
+void LayoutBuilder::build_layout_info(LayoutInfo& result, std::span<const std::string_view> chunks,
+		const ValueRuns<Font>& fontRuns, const LayoutBuildParams& params) {
+	auto count = get_text_length(chunks);
+	ValueRunsIterator itFont(fontRuns);
+	MaybeDefaultRunsIterator itSmallcaps(params.pSmallcapsRuns, false, count);
+	MaybeDefaultRunsIterator itSubscript(params.pSubscriptRuns, false, count);
+	MaybeDefaultRunsIterator itSuperscript(params.pSuperscriptRuns, false, count);
+
+	build_layout_info_internal(result, chunks, count, params, [&](int32_t index) {
+		return fontRuns.get_value(index);
+	}, itFont, itSmallcaps, itSubscript, itSuperscript);
+}
+
+void LayoutBuilder::build_layout_info(LayoutInfo& result, std::span<const std::string_view> chunks,
+		const CompactFormattingRuns& formatting, const LayoutBuildParams& params) {
+	StyleRunsIterator itStyle(formatting);
+
+	build_layout_info_internal(result, chunks, get_text_length(chunks), params, [&](int32_t index) {
+		return formatting.get_style(index).font;
+	}, itStyle);
+}
+
 /**
  * ALGORITHM:
  * 1. Split the string by paragraph boundaries (hard line breaks) (UBA P1)
@@ -155,20 +260,73 @@ LayoutBuilder& LayoutBuilder::operator=(LayoutBuilder&& other) noexcept {
  *    reversed relative to the source string if requested as RTL).
  * 3. Line breaking (step 2e) requires positions and charIndices to be in logical order to calculate widths
  *    (UBA L1.1).
+ *
+ * CHUNKED TEXT:
+ * Every step above only reads within a paragraph, so the text does not need to be contiguous as a whole. Each
+ * chunk is split after its last paragraph separator; the whole paragraphs before the split are built in place,
+ * and the paragraph after it is joined with the start of the following chunks in `m_paragraphBuffer`.
  */
-void LayoutBuilder::build_layout_info(LayoutInfo& result, const char* chars, int32_t count,
-		const ValueRuns<Font>& fontRuns, const LayoutBuildParams& params) {
+template <typename GetFont, typename... StyleIterators>
+void LayoutBuilder::build_layout_info_internal(LayoutInfo& result, std::span<const std::string_view> chunks,
+		int32_t count, const LayoutBuildParams& params, GetFont&& getFont, StyleIterators&... itStyles) {
 	result.clear();
 
+	int32_t textOffset{};
+	size_t chunkIndex{};
+	size_t chunkOffset{};
+
+	while (textOffset < count) {
+		auto text = chunks[chunkIndex].substr(chunkOffset);
+
+		if (text.empty()) {
+			++chunkIndex;
+			chunkOffset = 0;
+			continue;
+		}
+
+		auto length = textOffset + static_cast<int32_t>(text.size()) == count ? text.size()
+				: find_last_paragraph_end(text, starts_with_line_feed(chunks, chunkIndex + 1));
+
+		if (length > 0) {
+			build_paragraphs(result, text.data(), static_cast<int32_t>(length), textOffset, count, params,
+					getFont, itStyles...);
+			textOffset += static_cast<int32_t>(length);
+			chunkOffset += length;
+			continue;
+		}
+
+		m_paragraphBuffer.assign(text);
+
+		while (++chunkIndex < chunks.size()) {
+			auto chunk = chunks[chunkIndex];
+			auto end = find_first_paragraph_end(chunk, starts_with_line_feed(chunks, chunkIndex + 1));
+
+			if (end != std::string_view::npos) {
+				m_paragraphBuffer.append(chunk.substr(0, end));
+				chunkOffset = end;
+				break;
+			}
+
+			m_paragraphBuffer.append(chunk);
+		}
+
+		build_paragraphs(result, m_paragraphBuffer.data(), static_cast<int32_t>(m_paragraphBuffer.size()),
+				textOffset, count, params, getFont, itStyles...);
+		textOffset += static_cast<int32_t>(m_paragraphBuffer.size());
+	}
+
+	auto totalHeight = result.get_text_height();
+	result.set_text_start_y(static_cast<float>(params.yAlignment)
+			* (params.textAreaHeight - totalHeight) * 0.5f);
+}
+
+template <typename GetFont, typename... StyleIterators>
+void LayoutBuilder::build_paragraphs(LayoutInfo& result, const char* chars, int32_t count, int32_t textOffset,
+		int32_t textLength, const LayoutBuildParams& params, GetFont& getFont, StyleIterators&... itStyles) {
 	SBCodepointSequence codepointSequence{SBStringEncodingUTF8, (void*)chars, (size_t)count};
 	SBAlgorithmRef sbAlgorithm = SBAlgorithmCreate(&codepointSequence);
 	size_t paragraphOffset{};	
 
-	ValueRunsIterator itFont(fontRuns);
-	MaybeDefaultRunsIterator itSmallcaps(params.pSmallcapsRuns, false, count);
-	MaybeDefaultRunsIterator itSubscript(params.pSubscriptRuns, false, count);
-	MaybeDefaultRunsIterator itSuperscript(params.pSuperscriptRuns, false, count);
-
 	size_t lastHighestRun = 0;
 
 	SBLevel baseDefaultLevel = SBLevelDefaultLTR;
@@ -194,59 +352,54 @@ void LayoutBuilder::build_layout_info(LayoutInfo& result, const char* chars, int
 		size_t paragraphLength, separatorLength;
 		SBAlgorithmGetParagraphBoundary(sbAlgorithm, paragraphOffset, INT32_MAX, &paragraphLength,
 				&separatorLength);
-		bool isLastParagraph = paragraphOffset + paragraphLength == count;
+		auto paragraphStart = textOffset + static_cast<int32_t>(paragraphOffset);
+		bool isLastParagraph = paragraphStart + paragraphLength == textLength;
 
 		if (paragraphLength - separatorLength > 0) {
 			auto byteCount = paragraphLength - separatorLength;
 			
 			SBParagraphRef sbParagraph = SBAlgorithmCreateParagraph(sbAlgorithm, paragraphOffset,
 					paragraphLength, baseDefaultLevel);
-			lastHighestRun = build_paragraph(result, sbParagraph, chars, byteCount, paragraphOffset, itFont,
-					itSmallcaps, itSubscript, itSuperscript, fixedTextAreaWidth, tabWidthFixed, locale,
-					usePixelTabWidth, vertical);
+			lastHighestRun = build_paragraph(result, sbParagraph, chars + paragraphOffset, byteCount,
+					paragraphStart, fixedTextAreaWidth, tabWidthFixed, locale, usePixelTabWidth, vertical,
+					itStyles...);
 			SBParagraphRelease(sbParagraph);
 		}
 		else {
-			auto font = fontRuns.get_value(paragraphOffset == count ? count - 1 : paragraphOffset);
+			auto font = getFont(paragraphStart == textLength ? textLength - 1 : paragraphStart);
 			auto fontData = FontRegistry::get_font_data(font);
-			auto height = fontData.get_ascent() - fontData.get_descent();
 
 			lastHighestRun = result.get_run_count();
 			result.append_empty_line(FontRegistry::get_default_single_script_font(font),
-					static_cast<uint32_t>(paragraphOffset), height, fontData.get_ascent());
+					static_cast<uint32_t>(paragraphStart), fontData.get_metrics());
 		}
 
 		result.set_run_char_end_offset(lastHighestRun, separatorLength);
 
 		// Append empty line if string ends with a line break
 		if (isLastParagraph && separatorLength > 0) {
-			auto font = fontRuns.get_value(paragraphOffset == count ? count - 1 : paragraphOffset);
+			auto font = getFont(paragraphStart == textLength ? textLength - 1 : paragraphStart);
 			auto fontData = FontRegistry::get_font_data(font);
-			auto height = fontData.get_ascent() - fontData.get_descent();
 
 			result.append_empty_line(FontRegistry::get_default_single_script_font(font),
-					static_cast<uint32_t>(paragraphOffset + paragraphLength), height,
-					fontData.get_ascent());
+					static_cast<uint32_t>(paragraphStart + paragraphLength), fontData.get_metrics());
 			result.set_run_char_end_offset(result.get_run_count() - 1, 0);
 		}
 
 		paragraphOffset += paragraphLength;
 	}
 
-	auto totalHeight = result.get_text_height();
-	result.set_text_start_y(static_cast<float>(params.yAlignment)
-			* (params.textAreaHeight - totalHeight) * 0.5f);
-
 	SBAlgorithmRelease(sbAlgorithm);
 }
 
-size_t LayoutBuilder::build_paragraph(LayoutInfo& result, SBParagraphRef sbParagraph, const char* fullText,
-		int32_t paragraphLength, int32_t paragraphStart, ValueRunsIterator<Font>& itFont,
-		MaybeDefaultRunsIterator<bool>& itSmallcaps, MaybeDefaultRunsIterator<bool>& itSubscript,
-		MaybeDefaultRunsIterator<bool>& itSuperscript, int32_t textAreaWidth, int32_t tabWidthFixed,
-		const icu::Locale& defaultLocale, bool tabWidthFromPixels, bool vertical) {
-	const char* paragraphText = fullText + paragraphStart;
+template <typename... StyleIterators>
+size_t LayoutBuilder::build_paragraph(LayoutInfo& result, SBParagraphRef sbParagraph,
+		const char* paragraphText, int32_t paragraphLength, int32_t paragraphStart, int32_t textAreaWidth,
+		int32_t tabWidthFixed, const icu::Locale& defaultLocale, bool tabWidthFromPixels, bool vertical,
+		StyleIterators&... itStyles) {
 	auto paragraphEnd = paragraphStart + paragraphLength;
+	// SheenBidi offsets are relative to the text the paragraph was created from
+	auto sequenceOffset = paragraphStart - static_cast<int32_t>(SBParagraphGetOffset(sbParagraph));
 	auto primaryAxis = static_cast<size_t>(vertical);
 	auto secondaryAxis = static_cast<size_t>(!vertical);
 
@@ -255,31 +408,34 @@ size_t LayoutBuilder::build_paragraph(LayoutInfo& result, SBParagraphRef sbParag
 	// Generate logical run definitions and shape all logical runs
 	LevelsIterator itLevels(sbParagraph, paragraphStart, paragraphLength);
 	ScriptRunValueIterator itScripts(paragraphText, paragraphStart, paragraphLength);
-	auto subFontOffset = paragraphStart;
+	// Relative to the paragraph
+	int32_t subFontOffset{};
+
+	iterate_run_intersections(paragraphStart, paragraphEnd, [&](auto limit, auto script, auto level,
+			const auto&... styleValues) {
+		auto style = get_layout_style(styleValues...);
 
-	iterate_run_intersections(paragraphStart, paragraphEnd, [&](auto limit, auto baseFont, auto script,
-			auto level, bool smallcaps, bool subscript, bool superscript) {
-		while (subFontOffset < limit) {
+		while (subFontOffset < limit - paragraphStart) {
 			auto runStart = subFontOffset;
-			auto subFont = FontRegistry::get_sub_font(baseFont, fullText, subFontOffset, limit,
-					script, smallcaps, subscript, superscript);
+			auto subFont = FontRegistry::get_sub_font(style.font, paragraphText, subFontOffset,
+					limit - paragraphStart, script, style.smallcaps, style.subscript, style.superscript);
 
-			shape_logical_run(subFont, paragraphText, runStart - paragraphStart, subFontOffset - runStart,
-					paragraphStart, paragraphLength, script, defaultLocale, level & 1, vertical);
+			shape_logical_run(subFont, paragraphText, runStart, subFontOffset - runStart, paragraphStart,
+					paragraphLength, script, defaultLocale, level & 1, vertical);
 
 			if (!m_logicalRuns.empty() && m_logicalRuns.back().font == subFont) {
-				m_logicalRuns.back().charEndIndex = subFontOffset;
+				m_logicalRuns.back().charEndIndex = subFontOffset + paragraphStart;
 				m_logicalRuns.back().glyphEndIndex = static_cast<uint32_t>(m_glyphs.size());
 			}
 			else {
 				m_logicalRuns.push_back({
 					.font = subFont,
-					.charEndIndex = subFontOffset,
+					.charEndIndex = subFontOffset + paragraphStart,
 					.glyphEndIndex = static_cast<uint32_t>(m_glyphs.size()),
 				});
 			}
 		}
-	}, itFont, itScripts, itLevels, itSmallcaps, itSubscript, itSuperscript);
+	}, itScripts, itLevels, itStyles...);
 
 	// Finalize the last advance after the last character in the paragraph
 	m_glyphPositions[secondaryAxis].emplace_back(m_cursor);
@@ -289,10 +445,10 @@ size_t LayoutBuilder::build_paragraph(LayoutInfo& result, SBParagraphRef sbParag
 
 	// If width == 0, perform no line breaking
 	if (textAreaWidth == 0) {
-		apply_tab_widths_no_line_break(fullText, tabWidthFixed, tabWidthFromPixels,
+		apply_tab_widths_no_line_break(paragraphText, paragraphStart, tabWidthFixed, tabWidthFromPixels,
 				m_glyphPositions[primaryAxis].data());
-		compute_line_visual_runs(result, sbParagraph, paragraphText, paragraphLength, paragraphStart,
-				paragraphEnd, highestRun, highestRunCharEnd, vertical);
+		compute_line_visual_runs(result, sbParagraph, sequenceOffset, paragraphStart, paragraphEnd, highestRun,
+				highestRunCharEnd, vertical);
 		return highestRun;
 	}
 
@@ -317,7 +473,7 @@ size_t LayoutBuilder::build_paragraph(LayoutInfo& result, SBParagraphRef sbParag
 		});
 
 		while (glyphIndex < m_glyphs.size()) {
-			if (fullText[m_charIndices[glyphIndex]] == '\t') {
+			if (paragraphText[m_charIndices[glyphIndex] - paragraphStart] == '\t') {
 				auto baseTabWidth = tabWidthFromPixels ? tabWidthFixed
 						: mul_fixed(glyphWidths[glyphIndex], tabWidthFixed);
 				glyphWidths[glyphIndex] = baseTabWidth - (lineWidthSoFar % baseTabWidth);
@@ -357,7 +513,7 @@ size_t LayoutBuilder::build_paragraph(LayoutInfo& result, SBParagraphRef sbParag
 
 		// Adjust tab widths for glyphs included in the line after the line width calculation before
 		for (; glyphIndexBefore < glyphIndex; ++glyphIndexBefore) {
-			if (fullText[m_charIndices[glyphIndexBefore]] == '\t') {
+			if (paragraphText[m_charIndices[glyphIndexBefore] - paragraphStart] == '\t') {
 				auto baseTabWidth = tabWidthFromPixels ? tabWidthFixed
 						: mul_fixed(glyphWidths[glyphIndexBefore], tabWidthFixed);
 				glyphWidths[glyphIndexBefore] = baseTabWidth - (lineWidthSoFar % baseTabWidth);
@@ -366,8 +522,8 @@ size_t LayoutBuilder::build_paragraph(LayoutInfo& result, SBParagraphRef sbParag
 			lineWidthSoFar += glyphWidths[glyphIndexBefore];
 		}
 
-		compute_line_visual_runs(result, sbParagraph, paragraphText, paragraphLength, lineStart, lineEnd,
-				highestRun, highestRunCharEnd, vertical);
+		compute_line_visual_runs(result, sbParagraph, sequenceOffset, lineStart, lineEnd, highestRun,
+				highestRunCharEnd, vertical);
 	}
 
 	return highestRun;
@@ -409,14 +565,27 @@ void LayoutBuilder::shape_logical_run(const SingleScriptFont& font, const char*
 		hb_buffer_add_utf8(m_buffer, paragraphText + offset, paragraphLength - offset, 0, count);
 	}
 
-	std::vector<hb_feature_t> features;
-	maybe_add_tag_runs(features, HB_TAG('s', 'm', 'c', 'p'), count, font.smallcaps, font.syntheticSmallCaps);
-	maybe_add_tag_runs(features, HB_TAG('s', 'u', 'b', 's'), count, font.subscript, font.syntheticSubscript);
-	maybe_add_tag_runs(features, HB_TAG('s', 'u', 'p', 's'), count, font.superscript,
+	// Features always cover the whole buffer, as the surrounding context is only added as pre/post-context
+	hb_feature_t features[3];
+	unsigned featureCount{};
+	uint32_t featureMask{};
+	maybe_add_feature(features, featureCount, featureMask, HB_TAG('s', 'm', 'c', 'p'), font.smallcaps,
+			font.syntheticSmallCaps);
+	maybe_add_feature(features, featureCount, featureMask, HB_TAG('s', 'u', 'b', 's'), font.subscript,
+			font.syntheticSubscript);
+	maybe_add_feature(features, featureCount, featureMask, HB_TAG('s', 'u', 'p', 's'), font.superscript,
 			font.syntheticSuperscript);
 
 	auto fontData = FontRegistry::get_font_data(font);
-	hb_shape(fontData.hbFont, m_buffer, features.data(), static_cast<unsigned>(features.size()));
+
+	hb_segment_properties_t props;
+	hb_buffer_get_segment_properties(m_buffer, &props);
+
+	if (auto* plan = get_shape_plan(hb_font_get_face(fontData.hbFont), props, features, featureCount,
+			featureMask); !plan || !hb_shape_plan_execute(plan, fontData.hbFont, m_buffer, features, featureCount))
+			[[unlikely]] {
+		hb_shape(fontData.hbFont, m_buffer, features, featureCount);
+	}
 
 	auto glyphCount = hb_buffer_get_length(m_buffer);
 	auto* glyphPositions = hb_buffer_get_glyph_positions(m_buffer, nullptr);
@@ -489,10 +658,61 @@ void LayoutBuilder::shape_logical_run(const SingleScriptFont& font, const char*
 	}
 }
 
-void LayoutBuilder::compute_line_visual_runs(LayoutInfo& result, SBParagraphRef sbParagraph, const char* chars,
-		int32_t count, int32_t lineStart, int32_t lineEnd, size_t& highestRun, int32_t& highestRunCharEnd,
-		bool vertical) {
-	SBLineRef sbLine = SBParagraphCreateLine(sbParagraph, lineStart, lineEnd - lineStart);
+hb_shape_plan_t* LayoutBuilder::get_shape_plan(hb_face_t* face, const hb_segment_properties_t& props,
+		const hb_feature_t* pFeatures, unsigned featureCount, uint32_t featureMask) {
+	++m_shapePlanClock;
+
+	ShapePlanCacheEntry* pLRU{};
+
+	for (auto& entry : m_shapePlans) {
+		if (entry.face == face && entry.script == props.script && entry.direction == props.direction
+				&& entry.language == props.language && entry.featureMask == featureMask) {
+			entry.lastUse = m_shapePlanClock;
+			return entry.plan;
+		}
+
+		if (!pLRU || entry.lastUse < pLRU->lastUse) {
+			pLRU = &entry;
+		}
+	}
+
+	auto* plan = hb_shape_plan_create_cached(face, &props, pFeatures, featureCount, nullptr);
+
+	if (m_shapePlans.size() < MAX_CACHED_SHAPE_PLANS) {
+		pLRU = &m_shapePlans.emplace_back();
+	}
+	else {
+		hb_shape_plan_destroy(pLRU->plan);
+		hb_face_destroy(pLRU->face);
+	}
+
+	// Keep the face alive so its address cannot be reused by a different face while this entry exists
+	*pLRU = {
+		.face = hb_face_reference(face),
+		.language = props.language,
+		.script = static_cast<uint32_t>(props.script),
+		.direction = static_cast<uint32_t>(props.direction),
+		.featureMask = featureMask,
+		.lastUse = m_shapePlanClock,
+		.plan = plan,
+	};
+
+	return plan;
+}
+
+void LayoutBuilder::clear_shape_plans() {
+	for (auto& entry : m_shapePlans) {
+		hb_shape_plan_destroy(entry.plan);
+		hb_face_destroy(entry.face);
+	}
+
+	m_shapePlans.clear();
+}
+
+void LayoutBuilder::compute_line_visual_runs(LayoutInfo& result, SBParagraphRef sbParagraph,
+		int32_t sequenceOffset, int32_t lineStart, int32_t lineEnd, size_t& highestRun,
+		int32_t& highestRunCharEnd, bool vertical) {
+	SBLineRef sbLine = SBParagraphCreateLine(sbParagraph, lineStart - sequenceOffset, lineEnd - lineStart);
 	auto runCount = SBLineGetRunCount(sbLine);
 	auto* sbRuns = SBLineGetRunsPtr(sbLine);
 	float maxAscent{};
@@ -502,7 +722,7 @@ void LayoutBuilder::compute_line_visual_runs(LayoutInfo& result, SBParagraphRef
 	for (int32_t i = 0; i < runCount; ++i) {
 		int32_t logicalStart, runLength;
 		bool reversed = sbRuns[i].level & 1;
-		auto runStart = sbRuns[i].offset;
+		auto runStart = sbRuns[i].offset + sequenceOffset;
 		auto runEnd = runStart + sbRuns[i].length - 1;
 
 		if (!reversed) {
@@ -513,24 +733,24 @@ void LayoutBuilder::compute_line_visual_runs(LayoutInfo& result, SBParagraphRef
 
 			for (;;) {
 				auto logicalRunEnd = m_logicalRuns[run].charEndIndex;
-				auto fontData = FontRegistry::get_font_data(m_logicalRuns[run].font);
+				auto metrics = FontRegistry::get_font_data(m_logicalRuns[run].font).get_metrics();
 
-				if (auto ascent = fontData.get_ascent(); ascent > maxAscent) {
-					maxAscent = ascent;
+				if (metrics.ascent > maxAscent) {
+					maxAscent = metrics.ascent;
 				}
 
-				if (auto descent = fontData.get_descent(); descent < maxDescent) {
-					maxDescent = descent;
+				if (metrics.descent < maxDescent) {
+					maxDescent = metrics.descent;
 				}
 
 				if (runEnd < logicalRunEnd) {
 					append_visual_run(result, run, chrIndex, runEnd, visualRunWidth, highestRun,
-							highestRunCharEnd, reversed, vertical);
+							highestRunCharEnd, reversed, vertical, metrics);
 					break;
 				}
 				else {
 					append_visual_run(result, run, chrIndex, logicalRunEnd - 1, visualRunWidth, highestRun,
-							highestRunCharEnd, reversed, vertical);
+							highestRunCharEnd, reversed, vertical, metrics);
 					chrIndex = logicalRunEnd;
 					++run;
 				}
@@ -544,24 +764,24 @@ void LayoutBuilder::compute_line_visual_runs(LayoutInfo& result, SBParagraphRef
 
 			for (;;) {
 				auto logicalRunStart = run == 0 ? 0 : m_logicalRuns[run - 1].charEndIndex;
-				auto fontData = FontRegistry::get_font_data(m_logicalRuns[run].font);
+				auto metrics = FontRegistry::get_font_data(m_logicalRuns[run].font).get_metrics();
 
-				if (auto ascent = fontData.get_ascent(); ascent > maxAscent) {
-					maxAscent = ascent;
+				if (metrics.ascent > maxAscent) {
+					maxAscent = metrics.ascent;
 				}
 
-				if (auto descent = fontData.get_descent(); descent < maxDescent) {
-					maxDescent = descent;
+				if (metrics.descent < maxDescent) {
+					maxDescent = metrics.descent;
 				}
 
 				if (runStart >= logicalRunStart) {
 					append_visual_run(result, run, runStart, chrIndex, visualRunWidth, highestRun,
-							highestRunCharEnd, reversed, vertical);
+							highestRunCharEnd, reversed, vertical, metrics);
 					break;
 				}
 				else {
 					append_visual_run(result, run, logicalRunStart, chrIndex, visualRunWidth, highestRun,
-							highestRunCharEnd, reversed, vertical);
+							highestRunCharEnd, reversed, vertical, metrics);
 					chrIndex = logicalRunStart - 1;
 					--run;
 				}
@@ -576,7 +796,7 @@ void LayoutBuilder::compute_line_visual_runs(LayoutInfo& result, SBParagraphRef
 
 void LayoutBuilder::append_visual_run(LayoutInfo& result, size_t run, int32_t charStartIndex,
 		int32_t charEndIndex, int32_t& visualRunWidth, size_t& highestRun, int32_t& highestRunCharEnd,
-		bool reversed, bool vertical) {
+		bool reversed, bool vertical, const FontMetrics& metrics) {
 	auto logicalFirstGlyph = run == 0 ? 0 : m_logicalRuns[run - 1].glyphEndIndex;
 	auto logicalLastGlyph = m_logicalRuns[run].glyphEndIndex;
 	auto primaryAxis = static_cast<size_t>(vertical);
@@ -627,18 +847,18 @@ void LayoutBuilder::append_visual_run(LayoutInfo& result, size_t run, int32_t ch
 	}
 
 	result.append_run(m_logicalRuns[run].font, static_cast<uint32_t>(charStartIndex),
-			static_cast<uint32_t>(charEndIndex + 1), reversed);
+			static_cast<uint32_t>(charEndIndex + 1), reversed, metrics);
 }
 
-void LayoutBuilder::apply_tab_widths_no_line_break(const char* fullText, int32_t tabWidthFixed,
-		bool tabWidthFromPixels, int32_t* glyphWidths) {
+void LayoutBuilder::apply_tab_widths_no_line_break(const char* paragraphText, int32_t paragraphStart,
+		int32_t tabWidthFixed, bool tabWidthFromPixels, int32_t* glyphWidths) {
 	size_t runIndex = 0;
 	int32_t lineWidthSoFar = 0;
 
 	for (size_t i = 0; i < m_charIndices.size(); ++i) {
 		runIndex += m_logicalRuns[runIndex].glyphEndIndex == i;
 
-		if (fullText[m_charIndices[i]] == '\t') {
+		if (paragraphText[m_charIndices[i] - paragraphStart] == '\t') {
 			auto baseTabWidth = tabWidthFromPixels ? tabWidthFixed : mul_fixed(glyphWidths[i], tabWidthFixed);
 			glyphWidths[i] = baseTabWidth - (lineWidthSoFar % baseTabWidth);
 		}
@@ -666,6 +886,85 @@ void LayoutBuilder::reset(size_t capacity) {
 
 // Static Functions
 
+static LayoutStyle get_layout_style(const Font& font, bool smallcaps, bool subscript, bool superscript) {
+	return {
+		.font = font,
+		.smallcaps = smallcaps,
+		.subscript = subscript,
+		.superscript = superscript,
+	};
+}
+
+static LayoutStyle get_layout_style(const TextStyle& style) {
+	return {
+		.font = style.font,
+		.smallcaps = style.has(StyleFlags::SMALLCAPS),
+		.subscript = style.has(StyleFlags::SUBSCRIPT),
+		.superscript = style.has(StyleFlags::SUPERSCRIPT),
+	};
+}
+
+static int32_t get_text_length(std::span<const std::string_view> chunks) {
+	size_t result{};
+
+	for (auto chunk : chunks) {
+		result += chunk.size();
+	}
+
+	return static_cast<int32_t>(result);
+}
+
+static bool starts_with_line_feed(std::span<const std::string_view> chunks, size_t chunkIndex) {
+	for (; chunkIndex < chunks.size(); ++chunkIndex) {
+		if (!chunks[chunkIndex].empty()) {
+			return chunks[chunkIndex].front() == '\n';
+		}
+	}
+
+	return false;
+}
+
+// Paragraph separators are the characters of bidi class B: LF, CR, FS, GS, RS, NEL and PS. A CR followed by
+// a LF, which may be in the next chunk, only ends the paragraph after the LF.
+static bool ends_paragraph_separator(std::string_view text, size_t index, bool continuesWithLineFeed) {
+	switch (static_cast<uint8_t>(text[index])) {
+		case '\n':
+		case 0x1C:
+		case 0x1D:
+		case 0x1E:
+			return true;
+		case '\r':
+			return index + 1 < text.size() ? text[index + 1] != '\n' : !continuesWithLineFeed;
+		case 0x85:
+			return index >= 1 && static_cast<uint8_t>(text[index - 1]) == 0xC2;
+		case 0xA9:
+			return index >= 2 && static_cast<uint8_t>(text[index - 1]) == 0x80
+					&& static_cast<uint8_t>(text[index - 2]) == 0xE2;
+		default:
+			return false;
+	}
+}
+
+static size_t find_first_paragraph_end(std::string_view text, bool continuesWithLineFeed) {
+	for (size_t i = 0; i < text.size(); ++i) {
+		if (ends_paragraph_separator(text, i, continuesWithLineFeed)) {
+			return i + 1;
+		}
+	}
+
+	return std::string_view::npos;
+}
+
+static size_t find_last_paragraph_end(std::string_view text, bool continuesWithLineFeed) {
+	for (size_t i = text.size(); i-- > 0;) {
+		if (ends_paragraph_separator(text, i, continuesWithLineFeed)) {
+			return i + 1;
+		}
+	}
+
+	return 0;
+}
+
 static int32_t find_previous_line_break(icu::BreakIterator& iter, const char* chars, int32_t count,
 		int32_t charIndex) {
 	// Skip over any whitespace or control characters because they can hang in the margin
@@ -685,17 +984,21 @@ static int32_t find_previous_line_break(icu::BreakIterator& iter, const char* ch
 	return iter.preceding(charIndex);
 }
 
-static void maybe_add_tag_runs(std::vector<hb_feature_t>& features, hb_tag_t tag, int32_t count,
-		bool needsFeature, bool isSynthesizingThis) {
+static void maybe_add_feature(hb_feature_t* features, unsigned& featureCount, uint32_t& featureMask,
+		hb_tag_t tag, bool needsFeature, bool isSynthesizingThis) {
+	featureMask <<= 1;
+
 	if (!needsFeature || isSynthesizingThis) {
 		return;
 	}
 
-	features.push_back({
+	features[featureCount++] = {
 		.tag = tag,
 		.value = 1,
-		.end = static_cast<unsigned>(count),
-	});
+		.start = HB_FEATURE_GLOBAL_START,
+		.end = HB_FEATURE_GLOBAL_END,
+	};
+	featureMask |= 1;
 }
 
 static void remap_char_index(hb_glyph_info_t& glyphInfo, icu::Edits::Iterator& it, const char* sourceStr) {
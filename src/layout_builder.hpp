@@ -2,9 +2,13 @@
 
 #include "font.hpp"
 #include "text_alignment.hpp"
+#include "value_runs_iterator.hpp"
 
 #include <unicode/uversion.h>
 
+#include <span>
+#include <string>
+#include <string_view>
 #include <vector>
 
 U_NAMESPACE_BEGIN
@@ -15,15 +19,19 @@ class Locale;
 U_NAMESPACE_END
 
 struct hb_buffer_t;
+struct hb_face_t;
+struct hb_feature_t;
+struct hb_language_impl_t;
+struct hb_segment_properties_t;
+struct hb_shape_plan_t;
 struct _SBParagraph;
 
 namespace Text {
 
 class LayoutInfo;
 enum class LayoutInfoFlags : uint8_t;
+struct CompactFormattingRuns;
 template <typename> class ValueRuns;
-template <typename> class ValueRunsIterator;
-template <typename> class MaybeDefaultRunsIterator;
 
 struct LayoutBuildParams {
 	float textAreaWidth;
@@ -50,6 +58,24 @@ class LayoutBuilder {
 
 		void build_layout_info(LayoutInfo&, const char* chars, int32_t count, const ValueRuns<Font>& fontRuns,
 				const LayoutBuildParams& params);
+		/**
+		 * Builds the layout with the fonts and the smallcaps, subscript and superscript flags of `formatting`,
+		 * stepping a single iterator over its styles. Neighbouring styles that only differ in color, stroke or
+		 * decorations are shaped as one run, producing the same layout as the font runs overload. The run pointers
+		 * of `params` are ignored.
+		 */
+		void build_layout_info(LayoutInfo&, const char* chars, int32_t count,
+				const CompactFormattingRuns& formatting, const LayoutBuildParams& params);
+		/**
+		 * Builds the layout of the text formed by concatenating `chunks`, such as the pieces of a piece table or
+		 * the leaves of a rope. Paragraphs that lie within a single chunk are read in place, and only paragraphs
+		 * spanning a chunk boundary are copied, so the text is never flattened as a whole. Chunk boundaries must
+		 * not split UTF-8 sequences.
+		 */
+		void build_layout_info(LayoutInfo&, std::span<const std::string_view> chunks,
+				const ValueRuns<Font>& fontRuns, const LayoutBuildParams& params);
+		void build_layout_info(LayoutInfo&, std::span<const std::string_view> chunks,
+				const CompactFormattingRuns& formatting, const LayoutBuildParams& params);
 	private:
 		struct LogicalRun {
 			SingleScriptFont font;
@@ -57,6 +83,16 @@ class LayoutBuilder {
 			uint32_t glyphEndIndex;
 		};
 
+		struct ShapePlanCacheEntry {
+			hb_face_t* face;
+			const hb_language_impl_t* language;
+			uint32_t script;
+			uint32_t direction;
+			uint32_t featureMask;
+			uint32_t lastUse;
+			hb_shape_plan_t* plan;
+		};
+
 		icu::BreakIterator* m_lineBreakIterator{};
 		hb_buffer_t* m_buffer{};
 		std::vector<uint32_t> m_glyphs;
@@ -70,24 +106,43 @@ class LayoutBuilder {
 
 		std::vector<LogicalRun> m_logicalRuns;
 
-		size_t build_paragraph(LayoutInfo& result, _SBParagraph* sbParagraph, const char* fullText,
-				int32_t paragraphLength, int32_t paragraphStart, ValueRunsIterator<Font>& itFont,
-				MaybeDefaultRunsIterator<bool>& itSmallcaps, MaybeDefaultRunsIterator<bool>& itSubscript,
-				MaybeDefaultRunsIterator<bool>& itSuperscript, int32_t textAreaWidthFixed,
-				int32_t tabWidthFixed, const icu::Locale& defaultLocale, bool tabWidthFromPixels,
-				bool vertical);
+		// Small MRU cache of shape plans, avoiding a lookup in the face's shared plan list for each logical run
+		std::vector<ShapePlanCacheEntry> m_shapePlans;
+		uint32_t m_shapePlanClock{};
+
+		// Holds a paragraph that spans multiple chunks of the source text
+		std::string m_paragraphBuffer;
+
+		// `getFont` returns the base font at a character index, and `itStyles` are iterators over the values
+		// accepted by `get_layout_style` in layout_builder.cpp
+		template <typename GetFont, typename... StyleIterators>
+		void build_layout_info_internal(LayoutInfo& result, std::span<const std::string_view> chunks,
+				int32_t count, const LayoutBuildParams& params, GetFont&& getFont, StyleIterators&... itStyles);
+		// Builds the paragraphs of `chars`, which begins at `textOffset` within a text of `textLength` bytes
+		template <typename GetFont, typename... StyleIterators>
+		void build_paragraphs(LayoutInfo& result, const char* chars, int32_t count, int32_t textOffset,
+				int32_t textLength, const LayoutBuildParams& params, GetFont& getFont,
+				StyleIterators&... itStyles);
+		template <typename... StyleIterators>
+		size_t build_paragraph(LayoutInfo& result, _SBParagraph* sbParagraph, const char* paragraphText,
+				int32_t paragraphLength, int32_t paragraphStart, int32_t textAreaWidthFixed,
+				int32_t tabWidthFixed, const icu::Locale& defaultLocale, bool tabWidthFromPixels, bool vertical,
+				StyleIterators&... itStyles);
 		void shape_logical_run(const SingleScriptFont& font, const char* paragraphText, int32_t offset,
 				int32_t count, int32_t paragraphStart, int32_t paragraphLength, int script,
 				const icu::Locale& locale, bool reversed, bool vertical);
-		void compute_line_visual_runs(LayoutInfo& result, _SBParagraph* sbParagraph, const char* chars,
-				int32_t count, int32_t lineStart, int32_t lineEnd, size_t& highestRun,
-				int32_t& highestRunCharEnd, bool vertical);
+		hb_shape_plan_t* get_shape_plan(hb_face_t* face, const hb_segment_properties_t& props,
+				const hb_feature_t* pFeatures, unsigned featureCount, uint32_t featureMask);
+		void clear_shape_plans();
+		void compute_line_visual_runs(LayoutInfo& result, _SBParagraph* sbParagraph, int32_t sequenceOffset,
+				int32_t lineStart, int32_t lineEnd, size_t& highestRun, int32_t& highestRunCharEnd,
+				bool vertical);
 		void append_visual_run(LayoutInfo& result, size_t logicalRunIndex, int32_t charStartIndex,
 				int32_t charEndIndex, int32_t& visualRunWidth, size_t& highestRun, int32_t& highestRunCharEnd,
-				bool reversed, bool vertical);
+				bool reversed, bool vertical, const FontMetrics& metrics);
 
-		void apply_tab_widths_no_line_break(const char* fullText, int32_t tabWidthFixed,
-				bool tabWidthFromPixels, int32_t* glyphWidths);
+		void apply_tab_widths_no_line_break(const char* paragraphText, int32_t paragraphStart,
+				int32_t tabWidthFixed, bool tabWidthFromPixels, int32_t* glyphWidths);
 
 		void reset(size_t capacity);
 };
@@ -23,6 +23,7 @@ void LayoutInfo::clear() {
 	m_glyphs.clear();
 	m_charIndices.clear();
 	m_glyphPositions.clear();
+	m_runMetrics.clear();
 }
 
 void LayoutInfo::reserve_runs(size_t runCount) {
@@ -43,12 +44,13 @@ void LayoutInfo::append_glyph_position(float x, float y) {
 }
 
 void LayoutInfo::append_run(const SingleScriptFont& font, uint32_t charStartIndex, uint32_t charEndIndex,
-		bool rightToLeft) {
+		bool rightToLeft, const FontMetrics& metrics) {
 	m_visualRuns.push_back({
 		.font = font,
 		.glyphEndIndex = static_cast<uint32_t>(m_glyphs.size()),
 		.charStartIndex = charStartIndex,
 		.charEndIndex = charEndIndex,
+		.metricsIndex = add_run_metrics(metrics),
 		.rightToLeft = rightToLeft,
 	});
 }
@@ -57,16 +59,27 @@ void LayoutInfo::append_line(float height, float ascent) {
 	auto lastRunIndex = static_cast<uint32_t>(m_visualRuns.size()) - 1;
 	auto width = m_glyphPositions[2 * (m_visualRuns[lastRunIndex].glyphEndIndex + lastRunIndex)];
 
+	auto firstRunIndex = get_first_run_index(m_lines.size());
+	auto charStartIndex = m_visualRuns[firstRunIndex].charStartIndex;
+	auto charEndIndex = m_visualRuns[firstRunIndex].charEndIndex;
+
+	for (auto i = firstRunIndex + 1; i <= lastRunIndex; ++i) {
+		charStartIndex = std::min(charStartIndex, m_visualRuns[i].charStartIndex);
+		charEndIndex = std::max(charEndIndex, m_visualRuns[i].charEndIndex);
+	}
+
 	m_lines.push_back({
 		.visualRunsEndIndex = static_cast<uint32_t>(m_visualRuns.size()),
+		.charStartIndex = charStartIndex,
+		.charEndIndex = charEndIndex,
 		.width = width,
 		.ascent = ascent,
 		.totalDescent = m_lines.empty() ? height : m_lines.back().totalDescent + height,
 	});
 }
 
-void LayoutInfo::append_empty_line(const SingleScriptFont& font, uint32_t charIndex, float height,
-		float ascent) {
+void LayoutInfo::append_empty_line(const SingleScriptFont& font, uint32_t charIndex,
+		const FontMetrics& metrics) {
 	// All inserted runs need at least 2 glyph position entries
 	m_glyphPositions.emplace_back();
 	m_glyphPositions.emplace_back();
@@ -76,11 +89,16 @@ void LayoutInfo::append_empty_line(const SingleScriptFont& font, uint32_t charIn
 		.glyphEndIndex = m_visualRuns.empty() ? 0 : m_visualRuns.back().glyphEndIndex,
 		.charStartIndex = charIndex,
 		.charEndIndex = charIndex,
+		.metricsIndex = add_run_metrics(metrics),
 	});
 
+	auto height = metrics.ascent - metrics.descent;
+
 	m_lines.push_back({
 		.visualRunsEndIndex = static_cast<uint32_t>(m_visualRuns.size()),
-		.ascent = ascent,
+		.charStartIndex = charIndex,
+		.charEndIndex = charIndex,
+		.ascent = metrics.ascent,
 		.totalDescent = m_lines.empty() ? height : m_lines.back().totalDescent + height,
 	});
 }
@@ -149,6 +167,54 @@ size_t LayoutInfo::get_closest_line_to_height(float y) const {
 	});
 }
 
+Pair<size_t, size_t> LayoutInfo::get_visible_line_range(float minY, float maxY) const {
+	minY -= m_textStartY;
+	maxY -= m_textStartY;
+
+	auto firstLine = binary_search(0, m_lines.size(), [&](auto index) {
+		return m_lines[index].totalDescent <= minY;
+	});
+
+	auto lastLine = binary_search(firstLine, m_lines.size() - firstLine, [&](auto index) {
+		return (index == 0 ? 0.f : m_lines[index - 1].totalDescent) < maxY;
+	});
+
+	return {firstLine, lastLine};
+}
+
+Pair<uint32_t, uint32_t> LayoutInfo::get_visible_run_range(size_t lineIndex, float minX, float maxX) const {
+	auto firstRunIndex = get_first_run_index(lineIndex);
+	auto lastRunIndex = m_lines[lineIndex].visualRunsEndIndex;
+
+	auto firstRun = binary_search(firstRunIndex, lastRunIndex - firstRunIndex, [&](auto index) {
+		return m_glyphPositions[2 * (m_visualRuns[index].glyphEndIndex + index)] < minX;
+	});
+
+	auto lastRun = binary_search(firstRun, lastRunIndex - firstRun, [&](auto index) {
+		return m_glyphPositions[get_first_position_index(index)] <= maxX;
+	});
+
+	return {static_cast<uint32_t>(firstRun), static_cast<uint32_t>(lastRun)};
+}
+
+Pair<uint32_t, uint32_t> LayoutInfo::get_visible_glyph_range(size_t runIndex, float minX, float maxX) const {
+	auto firstGlyphIndex = get_first_glyph_index(runIndex);
+	auto glyphCount = m_visualRuns[runIndex].glyphEndIndex - firstGlyphIndex;
+	auto* positions = m_glyphPositions.data() + get_first_position_index(runIndex);
+
+	// Glyph `i` covers [positions[2 * i], positions[2 * (i + 1)]]
+	auto firstGlyph = binary_search(0, glyphCount, [&](auto index) {
+		return positions[2 * (index + 1)] < minX;
+	});
+
+	auto lastGlyph = binary_search(firstGlyph, glyphCount - firstGlyph, [&](auto index) {
+		return positions[2 * index] <= maxX;
+	});
+
+	return {static_cast<uint32_t>(firstGlyphIndex + firstGlyph),
+			static_cast<uint32_t>(firstGlyphIndex + lastGlyph)};
+}
+
 CursorPosition LayoutInfo::get_line_start_position(size_t lineIndex) const {
 	if (m_lines.empty()) {
 		return {};
@@ -317,6 +383,59 @@ CursorPosition LayoutInfo::find_closest_cursor_position(float textWidth, XAlignm
 	RICHTEXT_UNREACHABLE();
 }
 
+void LayoutInfo::get_selection_rects(uint32_t firstCharIndex, uint32_t lastCharIndex, float textWidth,
+		XAlignment textXAlignment, std::vector<SelectionRect>& result) const {
+	result.clear();
+
+	if (firstCharIndex >= lastCharIndex) {
+		return;
+	}
+
+	auto firstLine = binary_search(0, m_lines.size(), [&](auto index) {
+		return m_lines[index].charEndIndex <= firstCharIndex;
+	});
+
+	auto lastLine = binary_search(firstLine, m_lines.size() - firstLine, [&](auto index) {
+		return m_lines[index].charStartIndex < lastCharIndex;
+	});
+
+	for (auto lineIndex = firstLine; lineIndex < lastLine; ++lineIndex) {
+		auto& line = m_lines[lineIndex];
+		auto lineX = get_line_x_start(lineIndex, textWidth, textXAlignment);
+		auto lineTop = m_textStartY + (lineIndex == 0 ? 0.f : m_lines[lineIndex - 1].totalDescent);
+		auto lineHeight = get_line_height(lineIndex);
+		auto firstRunIndex = get_first_run_index(lineIndex);
+
+		if (line.charStartIndex >= firstCharIndex && line.charEndIndex <= lastCharIndex) {
+			auto minPos = m_glyphPositions[get_first_position_index(firstRunIndex)];
+
+			if (line.width > minPos) {
+				result.push_back({lineX + minPos, lineTop, line.width - minPos, lineHeight});
+			}
+
+			continue;
+		}
+
+		// Runs are in visual order, so ranges of neighbouring selected runs touch and are merged
+		auto firstRect = result.size();
+
+		for (auto runIndex = firstRunIndex; runIndex < line.visualRunsEndIndex; ++runIndex) {
+			if (!run_contains_char_range(runIndex, firstCharIndex, lastCharIndex)) {
+				continue;
+			}
+
+			auto [minPos, maxPos] = get_position_range_in_run(runIndex, firstCharIndex, lastCharIndex);
+
+			if (result.size() > firstRect && result.back().x + result.back().width >= lineX + minPos) {
+				result.back().width = std::max(result.back().width, lineX + maxPos - result.back().x);
+			}
+			else {
+				result.push_back({lineX + minPos, lineTop, maxPos - minPos, lineHeight});
+			}
+		}
+	}
+}
+
 bool LayoutInfo::run_contains_char_range(size_t runIndex, uint32_t firstCharIndex,
 		uint32_t lastCharIndex) const {
 	return m_visualRuns[runIndex].charStartIndex < lastCharIndex
@@ -380,6 +499,10 @@ const SingleScriptFont& LayoutInfo::get_run_font(size_t runIndex) const {
 	return m_visualRuns[runIndex].font;
 }
 
+const FontMetrics& LayoutInfo::get_run_metrics(size_t runIndex) const {
+	return m_runMetrics[m_visualRuns[runIndex].metricsIndex];
+}
+
 uint32_t LayoutInfo::get_run_glyph_end_index(size_t runIndex) const {
 	return m_visualRuns[runIndex].glyphEndIndex;
 }
@@ -464,6 +587,21 @@ bool LayoutInfo::empty() const {
 	return m_lines.empty();
 }
 
+uint32_t LayoutInfo::add_run_metrics(const FontMetrics& metrics) {
+	// Layouts rarely reference more than a handful of font sizes, and neighbouring runs usually share one, so a
+	// short backwards scan keeps the table small without hashing
+	static constexpr const size_t SEARCH_WINDOW = 8;
+
+	for (size_t i = m_runMetrics.size(), end = i > SEARCH_WINDOW ? i - SEARCH_WINDOW : 0; i-- > end;) {
+		if (m_runMetrics[i] == metrics) {
+			return static_cast<uint32_t>(i);
+		}
+	}
+
+	m_runMetrics.push_back(metrics);
+	return static_cast<uint32_t>(m_runMetrics.size() - 1);
+}
+
 float LayoutInfo::get_glyph_offset_ltr(size_t runIndex, uint32_t cursor) const {
 	auto firstGlyphIndex = get_first_glyph_index(runIndex);
 	auto lastGlyphIndex = m_visualRuns[runIndex].glyphEndIndex;
@@ -35,6 +35,31 @@ enum class LayoutInfoFlags : uint8_t {
 
 RICHTEXT_DEFINE_ENUM_BITFLAG_OPERATORS(LayoutInfoFlags)
 
+/**
+ * Axis-aligned region in the same space as the line positions passed to `LayoutInfo::for_each_line`, used to
+ * skip lines, runs and glyphs that cannot be seen.
+ *
+ * Culling is based on line boxes and glyph advances, not ink bounds. Callers drawing glyphs that overhang
+ * their advance (italics, large strokes, combining marks at the edge) should pad the rect accordingly.
+ */
+struct LayoutClipRect {
+	float minX;
+	float minY;
+	float maxX;
+	float maxY;
+};
+
+/**
+ * Highlighted region of one line of a selection, in the same space as the line positions passed to
+ * `LayoutInfo::for_each_line`, with `y` at the top of the line.
+ */
+struct SelectionRect {
+	float x;
+	float y;
+	float width;
+	float height;
+};
+
 struct VisualCursorInfo {
 	float x;
 	float y;
@@ -62,10 +87,14 @@ class LayoutInfo {
 		void append_glyph(uint32_t glyphID);
 		void append_char_index(uint32_t charIndex);
 		void append_glyph_position(float x, float y);
+		/**
+		 * Appends a run covering the glyphs appended since the previous run. `metrics` are the metrics of
+		 * `font` at its effective size, and are kept so that drawing never has to query the font registry.
+		 */
 		void append_run(const SingleScriptFont& font, uint32_t charStartIndex, uint32_t charEndIndex,
-				bool rightToLeft);
+				bool rightToLeft, const FontMetrics& metrics);
 		void append_line(float height, float ascent);
-		void append_empty_line(const SingleScriptFont& font, uint32_t charIndex, float height, float ascent);
+		void append_empty_line(const SingleScriptFont& font, uint32_t charIndex, const FontMetrics& metrics);
 		void set_run_char_end_offset(size_t runIndex, uint8_t charEndOffset);
 		void set_text_start_y(float);
 
@@ -98,6 +127,22 @@ class LayoutInfo {
 		 */
 		size_t get_closest_line_to_height(float y) const;
 
+		/**
+		 * Gets the range of lines [first, last) whose line boxes intersect the vertical span [minY, maxY), in
+		 * the same space as the `lineY` passed to `for_each_line` minus the line ascent.
+		 */
+		Pair<size_t, size_t> get_visible_line_range(float minY, float maxY) const;
+		/**
+		 * Gets the range of runs [first, last) within `lineIndex` whose horizontal extent intersects
+		 * [minX, maxX], relative to the start of the line.
+		 */
+		Pair<uint32_t, uint32_t> get_visible_run_range(size_t lineIndex, float minX, float maxX) const;
+		/**
+		 * Gets the range of glyph indices [first, last) within `runIndex` whose advances intersect
+		 * [minX, maxX], relative to the start of the line.
+		 */
+		Pair<uint32_t, uint32_t> get_visible_glyph_range(size_t runIndex, float minX, float maxX) const;
+
 		CursorPosition get_line_start_position(size_t lineIndex) const;
 		CursorPosition get_line_end_position(size_t lineIndex) const;
 
@@ -106,6 +151,17 @@ class LayoutInfo {
 
 		float get_line_x_start(size_t lineIndex, float textWidth, XAlignment) const;
 
+		/**
+		 * Replaces the contents of `result` with the highlight rects of the character range
+		 * [firstCharIndex, lastCharIndex), ordered by line and then from left to right, with touching runs merged.
+		 *
+		 * The affected lines are found with a binary search over the character range of each line, and lines
+		 * covered entirely by the selection are a single rect without visiting their runs, so the cost is
+		 * O(log n) in the number of lines plus the number of selected lines.
+		 */
+		void get_selection_rects(uint32_t firstCharIndex, uint32_t lastCharIndex, float textWidth, XAlignment,
+				std::vector<SelectionRect>& result) const;
+
 		/**
 		 * Whether the range [firstCharIndex, lastCharIndex) intersect's the run's [charStartIndex, charEndIndex)
 		 */
@@ -145,6 +201,7 @@ class LayoutInfo {
 		float get_line_total_descent(size_t lineIndex) const;
 
 		const SingleScriptFont& get_run_font(size_t runIndex) const;
+		const FontMetrics& get_run_metrics(size_t runIndex) const;
 		uint32_t get_run_glyph_end_index(size_t runIndex) const;
 		uint32_t get_run_char_start_index(size_t runIndex) const;
 		uint32_t get_run_char_end_index(size_t runIndex) const;
@@ -170,18 +227,37 @@ class LayoutInfo {
 		void for_each_run(float textWidth, XAlignment textXAlignment, Functor&& func) const;
 		template <typename Functor>
 		void for_each_glyph(float textWidth, XAlignment textXAlignment, Functor&& func) const;
+
+		/**
+		 * Equivalent to `for_each_line`, but only visits lines intersecting `clip`. The first visible line is
+		 * found with a binary search, so the cost is proportional to the number of visible lines.
+		 */
+		template <typename Functor>
+		void for_each_line(float textWidth, XAlignment textXAlignment, const LayoutClipRect& clip,
+				Functor&& func) const;
+		/**
+		 * Equivalent to `for_each_run`, but only visits runs intersecting `clip`.
+		 */
+		template <typename Functor>
+		void for_each_run(float textWidth, XAlignment textXAlignment, const LayoutClipRect& clip,
+				Functor&& func) const;
 	private:
 		struct VisualRun {
 			SingleScriptFont font;
 			uint32_t glyphEndIndex;
 			uint32_t charStartIndex; // First (lowest) logical code unit index of the run
 			uint32_t charEndIndex; // First logical code unit index not in the run
+			uint32_t metricsIndex; // Index into m_runMetrics
 			uint8_t charEndOffset; // Offset ahead of charEndIndex for separator codepoints, if applicable
 			bool rightToLeft;
 		};
 
 		struct LineInfo {
 			uint32_t visualRunsEndIndex;
+			// Lowest charStartIndex and highest charEndIndex of the runs of the line. Lines are in logical
+			// order, so both are non-decreasing from one line to the next
+			uint32_t charStartIndex;
+			uint32_t charEndIndex;
 			float width;
 			float ascent;
 			// Total descent from the top of the paragraph to the bottom of this line. The difference between
@@ -194,8 +270,12 @@ class LayoutInfo {
 		std::vector<uint32_t> m_glyphs;
 		std::vector<uint32_t> m_charIndices;
 		std::vector<float> m_glyphPositions;
+		// Deduplicated metrics of the fonts referenced by m_visualRuns
+		std::vector<FontMetrics> m_runMetrics;
 		float m_textStartY{};
 
+		uint32_t add_run_metrics(const FontMetrics& metrics);
+
 		float get_glyph_offset_ltr(size_t runIndex, uint32_t cursor) const;
 		float get_glyph_offset_rtl(size_t runIndex, uint32_t cursor) const;
 };
@@ -224,6 +304,30 @@ void Text::LayoutInfo::for_each_run(float textWidth, XAlignment textXAlignment,
 	});
 }
 
+template <typename Functor>
+void Text::LayoutInfo::for_each_line(float textWidth, XAlignment textXAlignment, const LayoutClipRect& clip,
+		Functor&& func) const {
+	auto [firstLine, lastLine] = get_visible_line_range(clip.minY, clip.maxY);
+
+	for (auto i = firstLine; i < lastLine; ++i) {
+		auto lineX = get_line_x_start(i, textWidth, textXAlignment);
+		auto lineY = m_textStartY + (i == 0 ? 0.f : m_lines[i - 1].totalDescent);
+		func(i, lineX, lineY + m_lines[i].ascent);
+	}
+}
+
+template <typename Functor>
+void Text::LayoutInfo::for_each_run(float textWidth, XAlignment textXAlignment, const LayoutClipRect& clip,
+		Functor&& func) const {
+	for_each_line(textWidth, textXAlignment, clip, [&](auto lineIndex, auto lineX, auto lineY) {
+		auto [firstRun, lastRun] = get_visible_run_range(lineIndex, clip.minX - lineX, clip.maxX - lineX);
+
+		for (auto runIndex = firstRun; runIndex < lastRun; ++runIndex) {
+			func(lineIndex, runIndex, lineX, lineY);
+		}
+	});
+}
+
 template <typename Functor>
 void Text::LayoutInfo::for_each_glyph(float textWidth, XAlignment textXAlignment, Functor&& func) const {
 	uint32_t glyphIndex{};
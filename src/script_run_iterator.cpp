@@ -19,6 +19,8 @@
 
 #include <unicode/utf8.h>
 
+#include <array>
+
 #define MOD(sp) ((sp) % PAREN_STACK_DEPTH)
 #define LIMIT_INC(sp) (((sp) < PAREN_STACK_DEPTH)? (sp) + 1 : PAREN_STACK_DEPTH)
 #define INC(sp,count) (MOD((sp) + (count)))
@@ -49,6 +51,40 @@ static constexpr const UChar32 pairedChars[] = {
 	0x301a, 0x301b
 };
 
+namespace {
+
+/**
+ * Script and paired punctuation index of a code point in U+0000..U+00FF, allowing ASCII and Latin-1 text to be
+ * classified without querying ICU or searching `pairedChars`.
+ */
+struct Latin1CharInfo {
+	UScriptCode script;
+	int32_t pairIndex;
+};
+
+}
+
+static constexpr std::array<Latin1CharInfo, 256> make_latin1_char_info() {
+	std::array<Latin1CharInfo, 256> result{};
+
+	for (UChar32 ch = 0; ch < 256; ++ch) {
+		bool latin = (ch >= 0x41 && ch <= 0x5a) || (ch >= 0x61 && ch <= 0x7a) || ch == 0xaa || ch == 0xba
+				|| (ch >= 0xc0 && ch != 0xd7 && ch != 0xf7);
+		result[ch] = {
+			.script = latin ? USCRIPT_LATIN : USCRIPT_COMMON,
+			.pairIndex = -1,
+		};
+	}
+
+	for (int32_t i = 0; i < static_cast<int32_t>(std::size(pairedChars)) && pairedChars[i] < 256; ++i) {
+		result[pairedChars[i]].pairIndex = i;
+	}
+
+	return result;
+}
+
+static constexpr const auto g_latin1CharInfo = make_latin1_char_info();
+
 static int8_t high_bit(int32_t value);
 static int32_t get_pair_index(UChar32 ch);
 static UBool script_is_same(UScriptCode scriptOne, UScriptCode scriptTwo);
@@ -72,12 +108,34 @@ bool ScriptRunIterator::next(int32_t& outRunStart, int32_t& outRunLimit, UScript
 	auto scriptStart = m_scriptLimit;
 	UScriptCode scriptCode = USCRIPT_COMMON;
 	UChar32 ch;
-	UErrorCode err{};
 
 	for (; m_scriptLimit < m_textLength;) {
-		U8_GET((const uint8_t*)m_text, 0, m_scriptLimit, m_textLength, ch);
-		auto sc = uscript_getScript(ch, &err);
-		auto pairIndex = get_pair_index(ch);
+		auto lead = static_cast<uint8_t>(m_text[m_scriptLimit]);
+		int32_t charLength;
+		UScriptCode sc;
+		int32_t pairIndex;
+
+		// Fast path for ASCII and 2-byte sequences encoding U+0080..U+00FF
+		if (lead < 0x80) [[likely]] {
+			sc = g_latin1CharInfo[lead].script;
+			pairIndex = g_latin1CharInfo[lead].pairIndex;
+			charLength = 1;
+		}
+		else if ((lead == 0xc2 || lead == 0xc3) && m_scriptLimit + 1 < m_textLength
+				&& U8_IS_TRAIL(m_text[m_scriptLimit + 1])) {
+			auto& info = g_latin1CharInfo[((lead & 0x1f) << 6) | (m_text[m_scriptLimit + 1] & 0x3f)];
+			sc = info.script;
+			pairIndex = info.pairIndex;
+			charLength = 2;
+		}
+		else {
+			// Ill-formed sequences produce an error here, which must not leak into lookups of later characters
+			UErrorCode err{};
+			U8_GET((const uint8_t*)m_text, 0, m_scriptLimit, m_textLength, ch);
+			sc = uscript_getScript(ch, &err);
+			pairIndex = get_pair_index(ch);
+			charLength = 0;
+		}
 
 		/*
 		 * Paired character handling:
@@ -122,7 +180,12 @@ bool ScriptRunIterator::next(int32_t& outRunStart, int32_t& outRunLimit, UScript
 			break;
 		}
 
-		U8_FWD_1(m_text, m_scriptLimit, m_textLength);
+		if (charLength > 0) [[likely]] {
+			m_scriptLimit += charLength;
+		}
+		else {
+			U8_FWD_1(m_text, m_scriptLimit, m_textLength);
+		}
 	}
 
 	outRunStart = scriptStart;
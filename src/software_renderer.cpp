@@ -0,0 +1,458 @@
+#include "software_renderer.hpp"
+
+#include "formatting.hpp"
+#include "formatting_iterator.hpp"
+#include "glyph_cache.hpp"
+#include "layout_info.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RICHTEXT_SOFTWARE_RENDERER_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace Text;
+
+// Tall enough that a line of text rarely spans more than two bands, short enough to balance between threads
+static constexpr const uint32_t BAND_HEIGHT = 32;
+
+static int32_t round_to_pixel(float value);
+static void premultiply(const Color& color, uint8_t* outColor);
+
+static void blend_coverage_row(uint8_t* pDst, const uint8_t* pCoverage, uint32_t count, const uint8_t* color);
+static void blend_bgra_row(uint8_t* pDst, const uint8_t* pSrc, uint32_t count);
+static void blend_solid_row(uint8_t* pDst, uint32_t count, const uint8_t* color);
+
+// Public Functions
+
+void SoftwareRenderer::clear() {
+	m_strokes.clear();
+	m_glyphs.clear();
+	m_decorations.clear();
+	m_commands.clear();
+}
+
+void SoftwareRenderer::build(const LayoutInfo& layout, float textAreaWidth, XAlignment textXAlignment,
+		GlyphCache& cache, const Color& color, float originX, float originY) {
+	clear();
+	m_glyphs.reserve(layout.get_glyph_count());
+
+	uint32_t glyphIndex{};
+	uint32_t glyphPosIndex{};
+	auto* glyphPositions = layout.get_glyph_position_data();
+
+	layout.for_each_run(textAreaWidth, textXAlignment, [&](auto, auto runIndex, auto lineX, auto lineY) {
+		auto& font = layout.get_run_font(runIndex);
+		auto penX = originX + lineX;
+		auto penY = originY + lineY + font.get_baseline_offset();
+
+		for (auto glyphEndIndex = layout.get_run_glyph_end_index(runIndex); glyphIndex < glyphEndIndex;
+				++glyphIndex, glyphPosIndex += 2) {
+			add_bitmap(m_glyphs, cache.get_glyph(font, layout.get_glyph_id(glyphIndex)),
+					penX + glyphPositions[glyphPosIndex], penY + glyphPositions[glyphPosIndex + 1], color);
+		}
+
+		glyphPosIndex += 2;
+	});
+
+	flush();
+}
+
+void SoftwareRenderer::build(const LayoutInfo& layout, const FormattingRuns& formatting, float textAreaWidth,
+		XAlignment textXAlignment, GlyphCache& cache, float originX, float originY) {
+	clear();
+	m_glyphs.reserve(layout.get_glyph_count());
+
+	uint32_t glyphIndex{};
+	uint32_t glyphPosIndex{};
+	auto* glyphPositions = layout.get_glyph_position_data();
+
+	layout.for_each_run(textAreaWidth, textXAlignment, [&](auto, auto runIndex, auto lineX, auto lineY) {
+		auto& font = layout.get_run_font(runIndex);
+		auto penX = originX + lineX;
+		auto penY = originY + lineY;
+		auto glyphY = penY + font.get_baseline_offset();
+		auto& metrics = layout.get_run_metrics(runIndex);
+
+		auto add_underline = [&](float startX, float endX, const Color& color) {
+			add_solid(penX + startX, penY + metrics.underlinePosition, endX - startX,
+					metrics.underlineThickness + 0.5f, color);
+		};
+
+		auto add_strikethrough = [&](float startX, float endX, const Color& color) {
+			add_solid(penX + startX, penY + metrics.strikethroughPosition, endX - startX,
+					metrics.strikethroughThickness + 0.5f, color);
+		};
+
+		FormattingIterator iter(formatting, layout.is_run_rtl(runIndex)
+				? layout.get_run_char_end_index(runIndex) : layout.get_run_char_start_index(runIndex));
+		float underlineStartPos = glyphPositions[glyphPosIndex];
+		float strikethroughStartPos = underlineStartPos;
+
+		for (auto glyphEndIndex = layout.get_run_glyph_end_index(runIndex); glyphIndex < glyphEndIndex;
+				++glyphIndex, glyphPosIndex += 2) {
+			auto pX = glyphPositions[glyphPosIndex];
+			auto pY = glyphPositions[glyphPosIndex + 1];
+			auto glyphID = layout.get_glyph_id(glyphIndex);
+			auto event = iter.advance_to(layout.get_char_index(glyphIndex));
+			auto stroke = iter.get_stroke_state();
+
+			if (stroke.color.a > 0.f) {
+				add_bitmap(m_strokes, cache.get_stroke(font, glyphID, stroke.thickness, stroke.joins),
+						penX + pX, glyphY + pY, stroke.color);
+			}
+
+			add_bitmap(m_glyphs, cache.get_glyph(font, glyphID), penX + pX, glyphY + pY, iter.get_color());
+
+			if ((event & FormattingEvent::UNDERLINE_END) != FormattingEvent::NONE) {
+				add_underline(underlineStartPos, pX, iter.get_prev_color());
+			}
+
+			if ((event & FormattingEvent::UNDERLINE_BEGIN) != FormattingEvent::NONE) {
+				underlineStartPos = pX;
+			}
+
+			if ((event & FormattingEvent::STRIKETHROUGH_END) != FormattingEvent::NONE) {
+				add_strikethrough(strikethroughStartPos, pX, iter.get_prev_color());
+			}
+
+			if ((event & FormattingEvent::STRIKETHROUGH_BEGIN) != FormattingEvent::NONE) {
+				strikethroughStartPos = pX;
+			}
+		}
+
+		// Finalize decorations still open at the end of the run
+		if (iter.has_strikethrough()) {
+			add_strikethrough(strikethroughStartPos, glyphPositions[glyphPosIndex], iter.get_color());
+		}
+
+		if (iter.has_underline()) {
+			add_underline(underlineStartPos, glyphPositions[glyphPosIndex], iter.get_color());
+		}
+
+		glyphPosIndex += 2;
+	});
+
+	flush();
+}
+
+void SoftwareRenderer::render(const RenderTarget& target, uint32_t threadCount) {
+	auto bandCount = (target.height + BAND_HEIGHT - 1) / BAND_HEIGHT;
+
+	if (bandCount == 0 || m_commands.empty()) {
+		return;
+	}
+
+	// Bin commands by band with a counting sort, preserving draw order within each band
+	m_bandOffsets.assign(bandCount + 1, 0);
+
+	auto for_each_band = [&](const Command& cmd, auto&& func) {
+		auto top = std::max(cmd.y, 0);
+		auto bottom = std::min(cmd.y + static_cast<int32_t>(cmd.height), static_cast<int32_t>(target.height));
+
+		if (top >= bottom || cmd.x >= static_cast<int32_t>(target.width)
+				|| cmd.x + static_cast<int32_t>(cmd.width) <= 0) {
+			return;
+		}
+
+		for (auto band = static_cast<uint32_t>(top) / BAND_HEIGHT,
+				lastBand = static_cast<uint32_t>(bottom - 1) / BAND_HEIGHT; band <= lastBand; ++band) {
+			func(band);
+		}
+	};
+
+	for (auto& cmd : m_commands) {
+		for_each_band(cmd, [&](auto band) {
+			++m_bandOffsets[band + 1];
+		});
+	}
+
+	for (uint32_t i = 0; i < bandCount; ++i) {
+		m_bandOffsets[i + 1] += m_bandOffsets[i];
+	}
+
+	m_bandCommands.resize(m_bandOffsets.back());
+
+	for (uint32_t i = 0; i < m_commands.size(); ++i) {
+		for_each_band(m_commands[i], [&](auto band) {
+			m_bandCommands[m_bandOffsets[band]++] = i;
+		});
+	}
+
+	// Filling shifted each offset to the start of the next band
+	for (uint32_t i = bandCount; i > 0; --i) {
+		m_bandOffsets[i] = m_bandOffsets[i - 1];
+	}
+
+	m_bandOffsets[0] = 0;
+
+	if (threadCount == 0) {
+		threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+
+	threadCount = std::min(threadCount, bandCount);
+
+	std::atomic<uint32_t> nextBand{};
+
+	auto worker = [&] {
+		for (auto band = nextBand.fetch_add(1, std::memory_order_relaxed); band < bandCount;
+				band = nextBand.fetch_add(1, std::memory_order_relaxed)) {
+			auto rowBegin = band * BAND_HEIGHT;
+			auto rowEnd = std::min(rowBegin + BAND_HEIGHT, target.height);
+
+			for (auto i = m_bandOffsets[band]; i < m_bandOffsets[band + 1]; ++i) {
+				draw_command(target, m_commands[m_bandCommands[i]], rowBegin, rowEnd);
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	threads.reserve(threadCount - 1);
+
+	for (uint32_t i = 1; i < threadCount; ++i) {
+		threads.emplace_back(worker);
+	}
+
+	worker();
+
+	for (auto& thread : threads) {
+		thread.join();
+	}
+}
+
+void SoftwareRenderer::render_band(const RenderTarget& target, uint32_t rowBegin, uint32_t rowEnd) const {
+	rowEnd = std::min(rowEnd, target.height);
+
+	for (auto& cmd : m_commands) {
+		draw_command(target, cmd, rowBegin, rowEnd);
+	}
+}
+
+size_t SoftwareRenderer::get_command_count() const {
+	return m_commands.size();
+}
+
+bool SoftwareRenderer::empty() const {
+	return m_commands.empty();
+}
+
+void SoftwareRenderer::add_bitmap(std::vector<Command>& commands, std::shared_ptr<const GlyphBitmap>&& bitmap,
+		float x, float y, const Color& color) {
+	if (!bitmap || bitmap->empty()) {
+		return;
+	}
+
+	auto left = round_to_pixel(x) + static_cast<int32_t>(bitmap->offsetX);
+	auto top = round_to_pixel(y) + static_cast<int32_t>(bitmap->offsetY);
+	auto width = bitmap->width;
+	auto height = bitmap->height;
+
+	auto& cmd = commands.emplace_back(Command{
+		.bitmap = std::move(bitmap),
+		.x = left,
+		.y = top,
+		.width = width,
+		.height = height,
+		.color = {},
+	});
+	premultiply(color, cmd.color);
+}
+
+void SoftwareRenderer::add_solid(float x, float y, float width, float height, const Color& color) {
+	auto left = round_to_pixel(x);
+	auto top = round_to_pixel(y);
+	auto right = round_to_pixel(x + width);
+	// Thin decorations always cover at least one row
+	auto bottom = std::max(round_to_pixel(y + height), top + 1);
+
+	if (right <= left || height <= 0.f) {
+		return;
+	}
+
+	auto& cmd = m_decorations.emplace_back(Command{
+		.bitmap = {},
+		.x = left,
+		.y = top,
+		.width = static_cast<uint32_t>(right - left),
+		.height = static_cast<uint32_t>(bottom - top),
+		.color = {},
+	});
+	premultiply(color, cmd.color);
+}
+
+void SoftwareRenderer::flush() {
+	m_commands.reserve(m_strokes.size() + m_glyphs.size() + m_decorations.size());
+
+	for (auto* pLayer : {&m_strokes, &m_glyphs, &m_decorations}) {
+		std::move(pLayer->begin(), pLayer->end(), std::back_inserter(m_commands));
+		pLayer->clear();
+	}
+}
+
+void SoftwareRenderer::draw_command(const RenderTarget& target, const Command& cmd, uint32_t rowBegin,
+		uint32_t rowEnd) {
+	auto top = std::max(cmd.y, static_cast<int32_t>(rowBegin));
+	auto bottom = std::min(cmd.y + static_cast<int32_t>(cmd.height), static_cast<int32_t>(rowEnd));
+	auto left = std::max(cmd.x, 0);
+	auto right = std::min(cmd.x + static_cast<int32_t>(cmd.width), static_cast<int32_t>(target.width));
+
+	if (top >= bottom || left >= right) {
+		return;
+	}
+
+	auto count = static_cast<uint32_t>(right - left);
+	auto* pSrc = cmd.bitmap ? reinterpret_cast<const uint8_t*>(cmd.bitmap->pData.get()) : nullptr;
+
+	for (auto y = top; y < bottom; ++y) {
+		auto* pDst = target.pData + static_cast<size_t>(y) * target.stride + 4 * left;
+		auto srcIndex = static_cast<size_t>(y - cmd.y) * cmd.width + static_cast<size_t>(left - cmd.x);
+
+		if (!pSrc) {
+			blend_solid_row(pDst, count, cmd.color);
+		}
+		else if (cmd.bitmap->format == FontRasterFormat::BGRA8) {
+			blend_bgra_row(pDst, pSrc + 4 * srcIndex, count);
+		}
+		else {
+			blend_coverage_row(pDst, pSrc + srcIndex, count, cmd.color);
+		}
+	}
+}
+
+// Static Functions
+
+static int32_t round_to_pixel(float value) {
+	return static_cast<int32_t>(std::floor(value + 0.5f));
+}
+
+static void premultiply(const Color& color, uint8_t* outColor) {
+	auto alpha = std::clamp(color.a, 0.f, 1.f);
+	outColor[0] = static_cast<uint8_t>(std::clamp(color.r, 0.f, 1.f) * alpha * 255.f + 0.5f);
+	outColor[1] = static_cast<uint8_t>(std::clamp(color.g, 0.f, 1.f) * alpha * 255.f + 0.5f);
+	outColor[2] = static_cast<uint8_t>(std::clamp(color.b, 0.f, 1.f) * alpha * 255.f + 0.5f);
+	outColor[3] = static_cast<uint8_t>(alpha * 255.f + 0.5f);
+}
+
+// x / 255 for x in [0, 255 * 255], rounded to nearest
+static constexpr uint32_t div255(uint32_t x) {
+	x += 128;
+	return (x + (x >> 8)) >> 8;
+}
+
+static void blend_pixel(uint8_t* pDst, uint32_t r, uint32_t g, uint32_t b, uint32_t a) {
+	auto invAlpha = 255 - a;
+	pDst[0] = static_cast<uint8_t>(r + div255(pDst[0] * invAlpha));
+	pDst[1] = static_cast<uint8_t>(g + div255(pDst[1] * invAlpha));
+	pDst[2] = static_cast<uint8_t>(b + div255(pDst[2] * invAlpha));
+	pDst[3] = static_cast<uint8_t>(a + div255(pDst[3] * invAlpha));
+}
+
+#ifdef RICHTEXT_SOFTWARE_RENDERER_SSE2
+
+static __m128i div255_epi16(__m128i x) {
+	x = _mm_add_epi16(x, _mm_set1_epi16(128));
+	return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+// Blends two premultiplied source pixels over two destination pixels, with each channel in a 16-bit lane
+static __m128i blend_epi16(__m128i src, __m128i dst) {
+	auto alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+	auto invAlpha = _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+	return _mm_add_epi16(src, div255_epi16(_mm_mullo_epi16(dst, invAlpha)));
+}
+
+#endif
+
+static void blend_coverage_row(uint8_t* pDst, const uint8_t* pCoverage, uint32_t count, const uint8_t* color) {
+	uint32_t i = 0;
+
+#ifdef RICHTEXT_SOFTWARE_RENDERER_SSE2
+	auto zero = _mm_setzero_si128();
+	auto color16 = _mm_setr_epi16(color[0], color[1], color[2], color[3], color[0], color[1], color[2], color[3]);
+
+	for (; i + 4 <= count; i += 4) {
+		uint32_t coverage;
+		std::memcpy(&coverage, pCoverage + i, sizeof(uint32_t));
+
+		// Glyph bitmaps are mostly empty space, which leaves the destination untouched
+		if (coverage == 0) {
+			continue;
+		}
+
+		// Broadcast each coverage byte across the 4 channels of its pixel
+		auto cov = _mm_cvtsi32_si128(static_cast<int>(coverage));
+		cov = _mm_unpacklo_epi8(cov, cov);
+		cov = _mm_unpacklo_epi16(cov, cov);
+
+		auto dst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pDst + 4 * i));
+		auto srcLo = div255_epi16(_mm_mullo_epi16(color16, _mm_unpacklo_epi8(cov, zero)));
+		auto srcHi = div255_epi16(_mm_mullo_epi16(color16, _mm_unpackhi_epi8(cov, zero)));
+		auto resultLo = blend_epi16(srcLo, _mm_unpacklo_epi8(dst, zero));
+		auto resultHi = blend_epi16(srcHi, _mm_unpackhi_epi8(dst, zero));
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + 4 * i), _mm_packus_epi16(resultLo, resultHi));
+	}
+#endif
+
+	for (; i < count; ++i) {
+		if (uint32_t coverage = pCoverage[i]; coverage != 0) {
+			blend_pixel(pDst + 4 * i, div255(color[0] * coverage), div255(color[1] * coverage),
+					div255(color[2] * coverage), div255(color[3] * coverage));
+		}
+	}
+}
+
+static void blend_bgra_row(uint8_t* pDst, const uint8_t* pSrc, uint32_t count) {
+	uint32_t i = 0;
+
+#ifdef RICHTEXT_SOFTWARE_RENDERER_SSE2
+	auto zero = _mm_setzero_si128();
+
+	for (; i + 4 <= count; i += 4) {
+		auto src = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + 4 * i));
+		auto dst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pDst + 4 * i));
+
+		// Swap B and R within each pixel
+		auto srcLo = _mm_unpacklo_epi8(src, zero);
+		auto srcHi = _mm_unpackhi_epi8(src, zero);
+		srcLo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(srcLo, _MM_SHUFFLE(3, 0, 1, 2)), _MM_SHUFFLE(3, 0, 1, 2));
+		srcHi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(srcHi, _MM_SHUFFLE(3, 0, 1, 2)), _MM_SHUFFLE(3, 0, 1, 2));
+
+		auto resultLo = blend_epi16(srcLo, _mm_unpacklo_epi8(dst, zero));
+		auto resultHi = blend_epi16(srcHi, _mm_unpackhi_epi8(dst, zero));
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + 4 * i), _mm_packus_epi16(resultLo, resultHi));
+	}
+#endif
+
+	// Color glyphs are already premultiplied, and are drawn untinted as with `GlyphQuadStream`
+	for (; i < count; ++i) {
+		auto* pPixel = pSrc + 4 * i;
+		blend_pixel(pDst + 4 * i, pPixel[2], pPixel[1], pPixel[0], pPixel[3]);
+	}
+}
+
+static void blend_solid_row(uint8_t* pDst, uint32_t count, const uint8_t* color) {
+	uint32_t i = 0;
+
+#ifdef RICHTEXT_SOFTWARE_RENDERER_SSE2
+	auto zero = _mm_setzero_si128();
+	auto color16 = _mm_setr_epi16(color[0], color[1], color[2], color[3], color[0], color[1], color[2], color[3]);
+
+	for (; i + 4 <= count; i += 4) {
+		auto dst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pDst + 4 * i));
+		auto resultLo = blend_epi16(color16, _mm_unpacklo_epi8(dst, zero));
+		auto resultHi = blend_epi16(color16, _mm_unpackhi_epi8(dst, zero));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + 4 * i), _mm_packus_epi16(resultLo, resultHi));
+	}
+#endif
+
+	for (; i < count; ++i) {
+		blend_pixel(pDst + 4 * i, color[0], color[1], color[2], color[3]);
+	}
+}
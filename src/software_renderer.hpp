@@ -0,0 +1,102 @@
+#pragma once
+
+#include "color.hpp"
+#include "text_alignment.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Text {
+
+class GlyphCache;
+class LayoutInfo;
+
+struct FormattingRuns;
+struct GlyphBitmap;
+
+/**
+ * An RGBA8 image with premultiplied alpha, stored as rows of `width` pixels, `stride` bytes apart.
+ */
+struct RenderTarget {
+	uint8_t* pData;
+	uint32_t width;
+	uint32_t height;
+	uint32_t stride;
+};
+
+/**
+ * Composites a `LayoutInfo` into a `RenderTarget` on the CPU, for use where no GPU is available.
+ *
+ * `build` resolves every glyph, stroke, underline and strikethrough of a layout into a list of draw commands,
+ * pulling bitmaps from a `GlyphCache`. `render` then blends the commands over the target with premultiplied
+ * source-over blending, in the same order as `GlyphQuadStream`: strokes, then glyphs, then decorations.
+ *
+ * Glyphs are drawn at whole pixel positions, rounded from the layout's pen positions.
+ *
+ * Rendering splits the target into horizontal bands, which are composited independently and can therefore be
+ * handed to separate threads.
+ *
+ * @thread_safety `build`, `clear` and `render` must not be called concurrently. `render_band` may be called
+ * concurrently from several threads, provided the row ranges do not overlap.
+ */
+class SoftwareRenderer {
+	public:
+		void clear();
+
+		/**
+		 * Adds a command for each visible glyph of `layout` in `color`, offset by (`originX`, `originY`).
+		 */
+		void build(const LayoutInfo& layout, float textAreaWidth, XAlignment textXAlignment, GlyphCache& cache,
+				const Color& color, float originX = 0.f, float originY = 0.f);
+		/**
+		 * Adds commands for the glyphs, strokes, underlines and strikethroughs of `layout` as described by
+		 * `formatting`, offset by (`originX`, `originY`).
+		 */
+		void build(const LayoutInfo& layout, const FormattingRuns& formatting, float textAreaWidth,
+				XAlignment textXAlignment, GlyphCache& cache, float originX = 0.f, float originY = 0.f);
+
+		/**
+		 * Composites all commands over `target`, splitting it into bands rendered by up to `threadCount`
+		 * threads, including the calling thread. A `threadCount` of 0 uses one thread per hardware thread.
+		 */
+		void render(const RenderTarget& target, uint32_t threadCount = 1);
+		/**
+		 * Composites all commands over the rows [`rowBegin`, `rowEnd`) of `target`, leaving other rows untouched.
+		 */
+		void render_band(const RenderTarget& target, uint32_t rowBegin, uint32_t rowEnd) const;
+
+		size_t get_command_count() const;
+		bool empty() const;
+	private:
+		struct Command {
+			// Null for solid rectangles
+			std::shared_ptr<const GlyphBitmap> bitmap;
+			int32_t x;
+			int32_t y;
+			uint32_t width;
+			uint32_t height;
+			// Premultiplied color as R, G, B, A bytes
+			uint8_t color[4];
+		};
+
+		std::vector<Command> m_strokes;
+		std::vector<Command> m_glyphs;
+		std::vector<Command> m_decorations;
+		std::vector<Command> m_commands;
+
+		// Indices into `m_commands` of the commands overlapping each band, built by `render`
+		std::vector<uint32_t> m_bandOffsets;
+		std::vector<uint32_t> m_bandCommands;
+
+		void add_bitmap(std::vector<Command>& commands, std::shared_ptr<const GlyphBitmap>&& bitmap, float x,
+				float y, const Color& color);
+		void add_solid(float x, float y, float width, float height, const Color& color);
+		void flush();
+
+		static void draw_command(const RenderTarget& target, const Command& cmd, uint32_t rowBegin,
+				uint32_t rowEnd);
+};
+
+}
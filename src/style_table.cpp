@@ -0,0 +1,105 @@
+#include "style_table.hpp"
+
+#include "value_run_utils.hpp"
+
+using namespace Text;
+
+static constexpr const uint64_t HASH_BASE = 0xCBF29CE484222325ull;
+static constexpr const uint64_t HASH_MULTIPLIER = 0x100000001B3ull;
+
+static uint64_t hash_combine(uint64_t hash, uint64_t value);
+
+// Public Functions
+
+uint16_t StyleTable::intern(const TextStyle& style) {
+	if (auto it = m_ids.find(style); it != m_ids.end()) {
+		return it->second;
+	}
+
+	if (m_styles.size() >= INVALID_STYLE_ID) {
+		return INVALID_STYLE_ID;
+	}
+
+	auto id = static_cast<uint16_t>(m_styles.size());
+	m_styles.emplace_back(style);
+	m_ids.emplace(style, id);
+
+	return id;
+}
+
+void StyleTable::clear() {
+	m_styles.clear();
+	m_ids.clear();
+}
+
+const TextStyle& StyleTable::get_style(uint16_t id) const {
+	return m_styles[id];
+}
+
+size_t StyleTable::get_style_count() const {
+	return m_styles.size();
+}
+
+size_t StyleTable::StyleHash::operator()(const TextStyle& style) const {
+	// Colors are hashed at 8 bits per channel: equal colors still hash equally, which is all that is required
+	auto hash = hash_combine(HASH_BASE, (static_cast<uint64_t>(style.font.get_family().handle) << 8)
+			| (static_cast<uint64_t>(style.font.get_weight()) << 1)
+			| static_cast<uint64_t>(style.font.get_style()));
+	hash = hash_combine(hash, (static_cast<uint64_t>(style.font.get_size()) << 32)
+			| Color::to_rgba(style.color));
+	hash = hash_combine(hash, (static_cast<uint64_t>(Color::to_rgba(style.stroke.color)) << 24)
+			| (static_cast<uint64_t>(style.stroke.thickness) << 16)
+			| (static_cast<uint64_t>(style.stroke.joins) << 8)
+			| static_cast<uint64_t>(style.flags));
+	return static_cast<size_t>(hash);
+}
+
+bool Text::make_compact_formatting_runs(const FormattingRuns& formatting, CompactFormattingRuns& result) {
+	result.styles.clear();
+	result.styleRuns.clear();
+
+	bool overflow = false;
+
+	iterate_run_intersections([&](int32_t limit, const Font& font, const Color& color, const StrokeState& stroke,
+			bool strikethrough, bool underline, bool smallcaps, bool subscript, bool superscript) {
+		auto id = result.styles.intern({
+			.font = font,
+			.color = color,
+			.stroke = stroke,
+			.flags = (strikethrough ? StyleFlags::STRIKETHROUGH : StyleFlags::NONE)
+					| (underline ? StyleFlags::UNDERLINE : StyleFlags::NONE)
+					| (smallcaps ? StyleFlags::SMALLCAPS : StyleFlags::NONE)
+					| (subscript ? StyleFlags::SUBSCRIPT : StyleFlags::NONE)
+					| (superscript ? StyleFlags::SUPERSCRIPT : StyleFlags::NONE),
+		});
+
+		overflow |= id == StyleTable::INVALID_STYLE_ID;
+
+		// Runs of the source may be split without a change of value, so equal neighbours are merged here
+		auto runCount = result.styleRuns.get_run_count();
+
+		if (runCount > 0 && result.styleRuns.get_run_value(runCount - 1) == id) {
+			result.styleRuns.truncate(runCount - 1);
+		}
+
+		result.styleRuns.add(limit, id);
+	}, formatting.fontRuns, formatting.colorRuns, formatting.strokeRuns, formatting.strikethroughRuns,
+			formatting.underlineRuns, formatting.smallcapsRuns, formatting.subscriptRuns, formatting.superscriptRuns);
+
+	if (overflow) {
+		result.styles.clear();
+		result.styleRuns.clear();
+		return false;
+	}
+
+	return true;
+}
+
+// Static Functions
+
+static uint64_t hash_combine(uint64_t hash, uint64_t value) {
+	hash ^= value;
+	hash *= HASH_MULTIPLIER;
+	return hash;
+}
+
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "common.hpp"
+#include "formatting.hpp"
+
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace Text {
+
+enum class StyleFlags : uint8_t {
+	NONE = 0,
+	STRIKETHROUGH = 1,
+	UNDERLINE = 2,
+	SMALLCAPS = 4,
+	SUBSCRIPT = 8,
+	SUPERSCRIPT = 16,
+};
+
+RICHTEXT_DEFINE_ENUM_BITFLAG_OPERATORS(StyleFlags)
+
+/**
+ * The combined value of every `FormattingRuns` member at a single character.
+ */
+struct TextStyle {
+	Font font;
+	Color color;
+	StrokeState stroke;
+	StyleFlags flags;
+
+	constexpr bool has(StyleFlags flag) const {
+		return (flags & flag) != StyleFlags::NONE;
+	}
+
+	constexpr bool operator==(const TextStyle&) const = default;
+};
+
+/**
+ * Stores each distinct `TextStyle` once, and identifies it by a 16-bit ID in order of insertion.
+ *
+ * @thread_safety Not thread safe.
+ */
+class StyleTable {
+	public:
+		static constexpr const uint16_t INVALID_STYLE_ID = 0xFFFFu;
+
+		/**
+		 * Returns the ID of `style`, adding it to the table if it is not already present. Returns
+		 * `INVALID_STYLE_ID` if the table already holds the maximum of 65535 styles.
+		 */
+		uint16_t intern(const TextStyle& style);
+		void clear();
+
+		const TextStyle& get_style(uint16_t id) const;
+		size_t get_style_count() const;
+	private:
+		struct StyleHash {
+			size_t operator()(const TextStyle& style) const;
+		};
+
+		std::vector<TextStyle> m_styles;
+		std::unordered_map<TextStyle, uint16_t, StyleHash> m_ids;
+};
+
+/**
+ * A compact alternative to `FormattingRuns`: a single set of runs of style IDs into a `StyleTable`. Iterating
+ * it steps one run index instead of one per formatting attribute, and each run boundary marks an actual change
+ * of style.
+ */
+struct CompactFormattingRuns {
+	StyleTable styles;
+	ValueRuns<uint16_t> styleRuns;
+
+	const TextStyle& get_style(int32_t index) const {
+		return styles.get_style(styleRuns.get_value(index));
+	}
+};
+
+/**
+ * Interns every distinct combination of `formatting`'s runs into `result`, replacing its previous contents.
+ *
+ * @return false if `formatting` contains more distinct styles than a `StyleTable` can hold, in which case
+ * `result` is left empty.
+ */
+bool make_compact_formatting_runs(const FormattingRuns& formatting, CompactFormattingRuns& result);
+
+}
+
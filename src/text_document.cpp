@@ -0,0 +1,328 @@
+#include "text_document.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace Text;
+
+// Public Functions
+
+TextDocument::TextDocument(std::string text) {
+	set_text(std::move(text));
+}
+
+void TextDocument::insert(uint32_t offset, std::string_view text) {
+	if (text.empty()) {
+		return;
+	}
+
+	offset = insert_internal(offset, text);
+	notify({offset, 0, static_cast<uint32_t>(text.size())});
+}
+
+void TextDocument::erase(uint32_t offset, uint32_t length) {
+	offset = std::min(offset, get_length());
+
+	if (auto removedLength = erase_internal(offset, length); removedLength > 0) {
+		notify({offset, removedLength, 0});
+	}
+}
+
+void TextDocument::replace(uint32_t offset, uint32_t length, std::string_view text) {
+	offset = std::min(offset, get_length());
+	auto removedLength = erase_internal(offset, length);
+	insert_internal(offset, text);
+
+	if (removedLength > 0 || !text.empty()) {
+		notify({offset, removedLength, static_cast<uint32_t>(text.size())});
+	}
+}
+
+void TextDocument::set_text(std::string text) {
+	auto removedLength = get_length();
+
+	for (auto& lineBreaks : m_lineBreaks) {
+		lineBreaks.clear();
+	}
+
+	m_buffers[static_cast<size_t>(BufferType::ORIGINAL)] = std::move(text);
+	m_buffers[static_cast<size_t>(BufferType::ADDED)].clear();
+	index_line_breaks(BufferType::ORIGINAL, 0);
+
+	clear_nodes();
+
+	auto length = static_cast<uint32_t>(m_buffers[static_cast<size_t>(BufferType::ORIGINAL)].size());
+
+	if (length > 0) {
+		m_root = alloc_node(BufferType::ORIGINAL, 0, length);
+	}
+
+	notify({0, removedLength, length});
+}
+
+void TextDocument::add_listener(PFN_TextDocumentChanged pfnChanged, void* pUserData) {
+	m_listeners.push_back({
+		.pfnChanged = pfnChanged,
+		.pUserData = pUserData,
+	});
+}
+
+void TextDocument::remove_listener(PFN_TextDocumentChanged pfnChanged, void* pUserData) {
+	std::erase_if(m_listeners, [&](const auto& listener) {
+		return listener.pfnChanged == pfnChanged && listener.pUserData == pUserData;
+	});
+}
+
+void TextDocument::get_chunks(std::vector<std::string_view>& chunks) const {
+	chunks.clear();
+	chunks.reserve(get_piece_count());
+
+	for_each_piece(m_root, 0, 0, get_length(), [&](std::string_view piece) {
+		chunks.emplace_back(piece);
+	});
+}
+
+void TextDocument::get_text(uint32_t offset, uint32_t length, std::string& result) const {
+	auto start = std::min(offset, get_length());
+	auto end = start + std::min(length, get_length() - start);
+
+	result.clear();
+	result.reserve(end - start);
+
+	for_each_piece(m_root, 0, start, end, [&](std::string_view piece) {
+		result.append(piece);
+	});
+}
+
+void TextDocument::get_text(std::string& result) const {
+	get_text(0, get_length(), result);
+}
+
+uint32_t TextDocument::get_line_index(uint32_t offset) const {
+	uint32_t result{};
+	auto node = m_root;
+
+	while (node != INVALID_NODE) {
+		auto& n = m_nodes[node];
+		auto leftLength = get_subtree_length(n.left);
+
+		if (offset < leftLength) {
+			node = n.left;
+		}
+		else if (offset < leftLength + n.length) {
+			return result + get_subtree_line_break_count(n.left)
+					+ count_line_breaks(n.buffer, n.start, n.start + offset - leftLength);
+		}
+		else {
+			offset -= leftLength + n.length;
+			result += get_subtree_line_break_count(n.left) + n.lineBreakCount;
+			node = n.right;
+		}
+	}
+
+	return result;
+}
+
+uint32_t TextDocument::get_line_start(uint32_t lineIndex) const {
+	if (lineIndex == 0) {
+		return 0;
+	}
+	else if (lineIndex >= get_line_count()) {
+		return get_length();
+	}
+
+	// Line `lineIndex` starts after the `lineIndex`th line break
+	uint32_t result{};
+	auto node = m_root;
+
+	for (;;) {
+		auto& n = m_nodes[node];
+		auto leftLineBreakCount = get_subtree_line_break_count(n.left);
+
+		if (lineIndex <= leftLineBreakCount) {
+			node = n.left;
+		}
+		else if (lineIndex <= leftLineBreakCount + n.lineBreakCount) {
+			auto& lineBreaks = m_lineBreaks[static_cast<size_t>(n.buffer)];
+			auto first = std::lower_bound(lineBreaks.begin(), lineBreaks.end(), n.start);
+			auto lineBreak = first[lineIndex - leftLineBreakCount - 1];
+
+			return result + get_subtree_length(n.left) + (lineBreak - n.start) + 1;
+		}
+		else {
+			lineIndex -= leftLineBreakCount + n.lineBreakCount;
+			result += get_subtree_length(n.left) + n.length;
+			node = n.right;
+		}
+	}
+}
+
+uint32_t TextDocument::get_line_count() const {
+	return get_subtree_line_break_count(m_root) + 1;
+}
+
+uint32_t TextDocument::get_piece_count() const {
+	return get_subtree_count(m_root);
+}
+
+uint32_t TextDocument::get_length() const {
+	return get_subtree_length(m_root);
+}
+
+bool TextDocument::empty() const {
+	return m_root == INVALID_NODE;
+}
+
+uint32_t TextDocument::insert_internal(uint32_t offset, std::string_view text) {
+	offset = std::min(offset, get_length());
+
+	if (text.empty()) {
+		return offset;
+	}
+
+	auto start = static_cast<uint32_t>(m_buffers[static_cast<size_t>(BufferType::ADDED)].size());
+	auto length = static_cast<uint32_t>(text.size());
+	m_buffers[static_cast<size_t>(BufferType::ADDED)].append(text);
+	index_line_breaks(BufferType::ADDED, start);
+
+	uint32_t left;
+	uint32_t right;
+	split(m_root, offset, left, right);
+
+	auto last = left;
+
+	while (last != INVALID_NODE && m_nodes[last].right != INVALID_NODE) {
+		last = m_nodes[last].right;
+	}
+
+	// Consecutive typing continues the piece of the previous insertion, which ends at the end of the buffer
+	if (last != INVALID_NODE && m_nodes[last].buffer == BufferType::ADDED
+			&& m_nodes[last].start + m_nodes[last].length == start) {
+		auto lineBreakCount = count_line_breaks(BufferType::ADDED, start, start + length);
+
+		for (auto node = left; node != INVALID_NODE; node = m_nodes[node].right) {
+			m_nodes[node].subtreeLength += length;
+			m_nodes[node].subtreeLineBreakCount += lineBreakCount;
+		}
+
+		m_nodes[last].length += length;
+		m_nodes[last].lineBreakCount += lineBreakCount;
+		m_root = merge(left, right);
+	}
+	else {
+		auto node = alloc_node(BufferType::ADDED, start, length);
+		m_root = merge(merge(left, node), right);
+	}
+
+	return offset;
+}
+
+uint32_t TextDocument::erase_internal(uint32_t offset, uint32_t length) {
+	auto start = std::min(offset, get_length());
+	auto end = start + std::min(length, get_length() - start);
+
+	if (start == end) {
+		return 0;
+	}
+
+	uint32_t left;
+	uint32_t middle;
+	uint32_t right;
+	split(m_root, start, left, middle);
+	split(middle, end - start, middle, right);
+
+	free_subtree(middle);
+	m_root = merge(left, right);
+
+	return end - start;
+}
+
+void TextDocument::notify(const SourceEdit& edit) {
+	for (auto& listener : m_listeners) {
+		listener.pfnChanged(*this, edit, listener.pUserData);
+	}
+}
+
+void TextDocument::index_line_breaks(BufferType buffer, uint32_t start) {
+	const auto& text = m_buffers[static_cast<size_t>(buffer)];
+	auto& lineBreaks = m_lineBreaks[static_cast<size_t>(buffer)];
+	auto* data = text.data();
+	auto* end = data + text.size();
+
+	for (auto* pos = data + start; pos != end;) {
+		auto* lineBreak = static_cast<const char*>(std::memchr(pos, '\n', end - pos));
+
+		if (!lineBreak) {
+			break;
+		}
+
+		lineBreaks.emplace_back(static_cast<uint32_t>(lineBreak - data));
+		pos = lineBreak + 1;
+	}
+}
+
+uint32_t TextDocument::count_line_breaks(BufferType buffer, uint32_t start, uint32_t end) const {
+	auto& lineBreaks = m_lineBreaks[static_cast<size_t>(buffer)];
+	auto first = std::lower_bound(lineBreaks.begin(), lineBreaks.end(), start);
+	auto last = std::lower_bound(first, lineBreaks.end(), end);
+
+	return static_cast<uint32_t>(last - first);
+}
+
+uint32_t TextDocument::alloc_node(BufferType buffer, uint32_t start, uint32_t length) {
+	auto lineBreakCount = count_line_breaks(buffer, start, start + length);
+
+	return emplace_node(Node{
+		.start = start,
+		.length = length,
+		.lineBreakCount = lineBreakCount,
+		.subtreeLineBreakCount = lineBreakCount,
+		.buffer = buffer,
+	});
+}
+
+uint32_t TextDocument::split_node(uint32_t node, uint32_t offset) {
+	auto tail = alloc_node(m_nodes[node].buffer, m_nodes[node].start + offset, m_nodes[node].length - offset);
+
+	auto& n = m_nodes[node];
+	n.length = offset;
+	n.lineBreakCount -= m_nodes[tail].lineBreakCount;
+
+	return tail;
+}
+
+void TextDocument::update_node(Node& n) {
+	n.subtreeLineBreakCount = n.lineBreakCount + get_subtree_line_break_count(n.left)
+			+ get_subtree_line_break_count(n.right);
+}
+
+uint32_t TextDocument::get_subtree_line_break_count(uint32_t node) const {
+	return node == INVALID_NODE ? 0 : m_nodes[node].subtreeLineBreakCount;
+}
+
+template <typename Functor>
+void TextDocument::for_each_piece(uint32_t node, uint32_t position, uint32_t start, uint32_t end,
+		Functor&& func) const {
+	if (node == INVALID_NODE || start >= end) {
+		return;
+	}
+
+	auto& n = m_nodes[node];
+	auto pieceStart = position + get_subtree_length(n.left);
+	auto pieceEnd = pieceStart + n.length;
+
+	if (start < pieceStart) {
+		for_each_piece(n.left, position, start, end, func);
+	}
+
+	if (start < pieceEnd && end > pieceStart) {
+		auto first = std::max(start, pieceStart) - pieceStart;
+		auto last = std::min(end, pieceEnd) - pieceStart;
+		func(std::string_view(m_buffers[static_cast<size_t>(n.buffer)]).substr(n.start + first, last - first));
+	}
+
+	if (end > pieceEnd) {
+		for_each_piece(n.right, pieceEnd, start, end, func);
+	}
+}
+
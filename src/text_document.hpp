@@ -0,0 +1,148 @@
+#pragma once
+
+#include "formatting.hpp"
+#include "implicit_treap.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Text {
+
+class TextDocument;
+
+/**
+ * Callback notifying a listener that `edit` was applied to `document`, which already holds the edited text.
+ */
+using PFN_TextDocumentChanged = void (*)(const TextDocument& document, const SourceEdit& edit, void* pUserData);
+
+/**
+ * Editable UTF-8 text stored as a piece table: the text is a sequence of pieces referring to either the original
+ * text or an append-only buffer of inserted text, held in a treap ordered by position. Inserting or erasing only
+ * splits the pieces at the edit, so edits are O(log n) in the number of pieces rather than O(n) in the length of
+ * the text, and typing at the end of the last insertion extends its piece instead of adding a new one.
+ *
+ * Lines are separated by LF, so a CRLF ends its line after the LF. The positions of the line breaks of both
+ * buffers are indexed once as text is added to them, so that offset to line lookups are also O(log n).
+ *
+ * The text is exposed as a sequence of chunks, one per piece, which `LayoutBuilder` accepts directly. Edits must
+ * start and end on code point boundaries, so that no chunk splits a UTF-8 sequence.
+ *
+ * @thread_safety Const member functions may be called concurrently, provided no thread modifies the document.
+ */
+class TextDocument : public Internal::ImplicitTreap<TextDocument> {
+	public:
+		TextDocument() = default;
+		explicit TextDocument(std::string text);
+
+		TextDocument(TextDocument&&) noexcept = default;
+		TextDocument& operator=(TextDocument&&) noexcept = default;
+
+		TextDocument(const TextDocument&) = delete;
+		void operator=(const TextDocument&) = delete;
+
+		/**
+		 * Inserts `text` at `offset`, clamped to the length of the document.
+		 */
+		void insert(uint32_t offset, std::string_view text);
+		/**
+		 * Removes the bytes [`offset`, `offset + length`), clamped to the length of the document.
+		 */
+		void erase(uint32_t offset, uint32_t length);
+		/**
+		 * Replaces the bytes [`offset`, `offset + length`) with `text`, notifying listeners of a single edit.
+		 */
+		void replace(uint32_t offset, uint32_t length, std::string_view text);
+		/**
+		 * Replaces the whole text, discarding all pieces and inserted text.
+		 */
+		void set_text(std::string text);
+
+		/**
+		 * Registers `pfnChanged` to be invoked with `pUserData` after every edit. Listeners move along with the
+		 * document, and must be removed before `pUserData` is destroyed.
+		 */
+		void add_listener(PFN_TextDocumentChanged pfnChanged, void* pUserData);
+		void remove_listener(PFN_TextDocumentChanged pfnChanged, void* pUserData);
+
+		/**
+		 * Replaces the contents of `chunks` with views of the pieces of the text, in order. The views are valid
+		 * until the next edit.
+		 */
+		void get_chunks(std::vector<std::string_view>& chunks) const;
+		/**
+		 * Replaces the contents of `result` with the bytes [`offset`, `offset + length`), clamped to the length
+		 * of the document.
+		 */
+		void get_text(uint32_t offset, uint32_t length, std::string& result) const;
+		void get_text(std::string& result) const;
+
+		/**
+		 * Gets the index of the line containing `offset`. Offsets past the end are in the last line.
+		 */
+		uint32_t get_line_index(uint32_t offset) const;
+		/**
+		 * Gets the offset of the first byte of the line `lineIndex`, or the length of the document if `lineIndex`
+		 * is past the last line.
+		 */
+		uint32_t get_line_start(uint32_t lineIndex) const;
+		uint32_t get_line_count() const;
+
+		uint32_t get_piece_count() const;
+		uint32_t get_length() const;
+		bool empty() const;
+	private:
+		enum class BufferType : uint8_t {
+			ORIGINAL,
+			ADDED,
+		};
+
+		struct Node {
+			uint32_t start;
+			uint32_t length;
+			uint32_t lineBreakCount;
+			uint32_t subtreeLength{};
+			uint32_t subtreeLineBreakCount{};
+			uint32_t subtreeCount{};
+			uint32_t priority{};
+			uint32_t left{};
+			uint32_t right{};
+			BufferType buffer;
+		};
+
+		struct Listener {
+			PFN_TextDocumentChanged pfnChanged;
+			void* pUserData;
+		};
+
+		std::string m_buffers[2];
+		// Offsets of the LFs within each buffer, in increasing order
+		std::vector<uint32_t> m_lineBreaks[2];
+
+		std::vector<Node> m_nodes;
+
+		std::vector<Listener> m_listeners;
+
+		friend class Internal::ImplicitTreap<TextDocument>;
+
+		uint32_t insert_internal(uint32_t offset, std::string_view text);
+		uint32_t erase_internal(uint32_t offset, uint32_t length);
+		void notify(const SourceEdit& edit);
+
+		void index_line_breaks(BufferType buffer, uint32_t start);
+		uint32_t count_line_breaks(BufferType buffer, uint32_t start, uint32_t end) const;
+
+		uint32_t alloc_node(BufferType buffer, uint32_t start, uint32_t length);
+		uint32_t split_node(uint32_t node, uint32_t offset);
+		void update_node(Node& n);
+		uint32_t get_subtree_line_break_count(uint32_t node) const;
+
+		// Invokes `func` with the part of each piece of the subtree of `node`, which begins at `position`, that
+		// overlaps [`start`, `end`)
+		template <typename Functor>
+		void for_each_piece(uint32_t node, uint32_t position, uint32_t start, uint32_t end, Functor&& func) const;
+};
+
+}
+
@@ -1,9 +1,10 @@
 #pragma once
 
-#include "font_registry.hpp"
 #include "formatting.hpp"
 #include "formatting_iterator.hpp"
+#include "formatting_spans.hpp"
 #include "layout_info.hpp"
+#include "style_table.hpp"
 
 namespace Text {
 
@@ -17,7 +18,6 @@ void draw_text(const LayoutInfo& layout, float textAreaWidth, XAlignment textXAl
 	layout.for_each_run(textAreaWidth, textXAlignment, [&](auto lineIndex, auto runIndex, auto lineX,
 			auto lineY) {
 		auto font = layout.get_run_font(runIndex);
-		auto fontData = Text::FontRegistry::get_font_data(font);
 
 		for (auto glyphEndIndex = layout.get_run_glyph_end_index(runIndex); glyphIndex < glyphEndIndex; 
 				++glyphIndex, glyphPosIndex += 2) {
@@ -33,8 +33,8 @@ void draw_text(const LayoutInfo& layout, float textAreaWidth, XAlignment textXAl
 	});
 }
 
-template <typename Visitor>
-void draw_text(const LayoutInfo& layout, const FormattingRuns& formatting, float textAreaWidth,
+template <FormattingSource Formatting, typename Visitor>
+void draw_text(const LayoutInfo& layout, const Formatting& formatting, float textAreaWidth,
 		XAlignment textXAlignment, Visitor&& visitor) {
 	uint32_t glyphIndex{};
 	uint32_t glyphPosIndex{};
@@ -45,11 +45,11 @@ void draw_text(const LayoutInfo& layout, const FormattingRuns& formatting, float
 	layout.for_each_run(textAreaWidth, textXAlignment, [&](auto lineIndex, auto runIndex, auto lineX,
 			auto lineY) {
 		auto font = layout.get_run_font(runIndex);
-		auto fontData = Text::FontRegistry::get_font_data(font);
+		auto& metrics = layout.get_run_metrics(runIndex);
 
 		visitor(lineIndex, runIndex);
 
-		Text::FormattingIterator iter(formatting, layout.is_run_rtl(runIndex)
+		auto iter = make_formatting_iterator(formatting, layout.is_run_rtl(runIndex)
 				? layout.get_run_char_end_index(runIndex) : layout.get_run_char_start_index(runIndex));
 		underlineStartPos = strikethroughStartPos = glyphPositions[glyphPosIndex];	
 
@@ -71,8 +71,8 @@ void draw_text(const LayoutInfo& layout, const FormattingRuns& formatting, float
 			
 			// Underline
 			if ((event & Text::FormattingEvent::UNDERLINE_END) != Text::FormattingEvent::NONE) {
-				auto height = fontData.get_underline_thickness() + 0.5f;
-				visitor(lineX + underlineStartPos, lineY + fontData.get_underline_position(),
+				auto height = metrics.underlineThickness + 0.5f;
+				visitor(lineX + underlineStartPos, lineY + metrics.underlinePosition,
 						pX - underlineStartPos, height, iter.get_prev_color());
 			}
 
@@ -82,8 +82,8 @@ void draw_text(const LayoutInfo& layout, const FormattingRuns& formatting, float
 
 			// Strikethrough
 			if ((event & Text::FormattingEvent::STRIKETHROUGH_END) != Text::FormattingEvent::NONE) {
-				auto height = fontData.get_strikethrough_thickness() + 0.5f;
-				visitor(lineX + strikethroughStartPos, lineY + fontData.get_strikethrough_position(),
+				auto height = metrics.strikethroughThickness + 0.5f;
+				visitor(lineX + strikethroughStartPos, lineY + metrics.strikethroughPosition,
 						pX - strikethroughStartPos, height, iter.get_prev_color());
 			}
 
@@ -95,16 +95,16 @@ void draw_text(const LayoutInfo& layout, const FormattingRuns& formatting, float
 		// Finalize last strikethrough
 		if (iter.has_strikethrough()) {
 			auto strikethroughEndPos = glyphPositions[glyphPosIndex];
-			auto height = fontData.get_strikethrough_thickness() + 0.5f;
-			visitor(lineX + strikethroughStartPos, lineY + fontData.get_strikethrough_position(),
+			auto height = metrics.strikethroughThickness + 0.5f;
+			visitor(lineX + strikethroughStartPos, lineY + metrics.strikethroughPosition,
 					strikethroughEndPos - strikethroughStartPos, height, iter.get_color());
 		}
 
 		// Finalize last underline
 		if (iter.has_underline()) {
 			auto underlineEndPos = glyphPositions[glyphPosIndex];
-			auto height = fontData.get_underline_thickness() + 0.5f;
-			visitor(lineX + underlineStartPos, lineY + fontData.get_underline_position(),
+			auto height = metrics.underlineThickness + 0.5f;
+			visitor(lineX + underlineStartPos, lineY + metrics.underlinePosition,
 					underlineEndPos - underlineStartPos, height, iter.get_color());
 		}
 
@@ -112,5 +112,172 @@ void draw_text(const LayoutInfo& layout, const FormattingRuns& formatting, float
 	});
 }
 
+/**
+ * Equivalent to the formatted `draw_text`, but reads the formatting of each glyph from `spans` built for `layout`
+ * instead of searching the formatting runs. Each run's underlines and strikethroughs are visited after its
+ * glyphs.
+ */
+template <typename Visitor>
+void draw_text(const LayoutInfo& layout, const FormattingSpans& spans, float textAreaWidth,
+		XAlignment textXAlignment, Visitor&& visitor) {
+	uint32_t glyphIndex{};
+	uint32_t glyphPosIndex{};
+	auto* glyphPositions = layout.get_glyph_position_data();
+
+	layout.for_each_run(textAreaWidth, textXAlignment, [&](auto lineIndex, auto runIndex, auto lineX,
+			auto lineY) {
+		auto font = layout.get_run_font(runIndex);
+
+		visitor(lineIndex, runIndex);
+
+		for (auto& span : spans.get_run_spans(runIndex)) {
+			auto& color = spans.get_color(span.colorIndex);
+
+			if (span.strokeIndex != FormattingSpans::NO_STROKE) {
+				auto& stroke = spans.get_stroke(span.strokeIndex);
+
+				for (; glyphIndex < span.glyphEndIndex; ++glyphIndex, glyphPosIndex += 2) {
+					auto pX = lineX + glyphPositions[glyphPosIndex];
+					auto pY = lineY + glyphPositions[glyphPosIndex + 1];
+					auto glyphID = layout.get_glyph_id(glyphIndex);
+					visitor(font, glyphID, pX, pY, stroke);
+					visitor(font, glyphID, pX, pY, color);
+				}
+			}
+			else {
+				for (; glyphIndex < span.glyphEndIndex; ++glyphIndex, glyphPosIndex += 2) {
+					visitor(font, layout.get_glyph_id(glyphIndex), lineX + glyphPositions[glyphPosIndex],
+							lineY + glyphPositions[glyphPosIndex + 1], color);
+				}
+			}
+		}
+
+		for (auto& decoration : spans.get_run_decorations(runIndex)) {
+			visitor(lineX + decoration.x, lineY + decoration.y, decoration.width, decoration.height,
+					spans.get_color(decoration.colorIndex));
+		}
+
+		glyphPosIndex += 2;
+	});
 }
 
+/**
+ * Equivalent to `draw_text`, but only visits glyphs whose advances intersect `clip`. Lines outside of the clip
+ * rect are skipped entirely, so the cost of a scrolled layout is proportional to the visible text.
+ */
+template <typename Visitor>
+void draw_text(const LayoutInfo& layout, float textAreaWidth, XAlignment textXAlignment,
+		const LayoutClipRect& clip, Visitor&& visitor) {
+	auto* glyphPositions = layout.get_glyph_position_data();
+
+	layout.for_each_run(textAreaWidth, textXAlignment, clip, [&](auto lineIndex, auto runIndex, auto lineX,
+			auto lineY) {
+		auto font = layout.get_run_font(runIndex);
+		auto [firstGlyph, lastGlyph] = layout.get_visible_glyph_range(runIndex, clip.minX - lineX,
+				clip.maxX - lineX);
+		auto glyphPosIndex = layout.get_first_position_index(runIndex)
+				+ 2 * (firstGlyph - layout.get_first_glyph_index(runIndex));
+
+		for (auto glyphIndex = firstGlyph; glyphIndex < lastGlyph; ++glyphIndex, glyphPosIndex += 2) {
+			auto pX = glyphPositions[glyphPosIndex];
+			auto pY = glyphPositions[glyphPosIndex + 1];
+			auto glyphID = layout.get_glyph_id(glyphIndex);
+
+			// Main Glyph
+			visitor(font, glyphID, lineX + pX, lineY + pY);
+		}
+	});
+}
+
+/**
+ * Equivalent to the formatted `draw_text`, but only visits glyphs whose advances intersect `clip`. Underlines
+ * and strikethroughs are cut at the first and last visible glyph of each run.
+ */
+template <FormattingSource Formatting, typename Visitor>
+void draw_text(const LayoutInfo& layout, const Formatting& formatting, float textAreaWidth,
+		XAlignment textXAlignment, const LayoutClipRect& clip, Visitor&& visitor) {
+	float strikethroughStartPos{};
+	float underlineStartPos{};
+	auto* glyphPositions = layout.get_glyph_position_data();
+
+	layout.for_each_run(textAreaWidth, textXAlignment, clip, [&](auto lineIndex, auto runIndex, auto lineX,
+			auto lineY) {
+		visitor(lineIndex, runIndex);
+
+		auto [firstGlyph, lastGlyph] = layout.get_visible_glyph_range(runIndex, clip.minX - lineX,
+				clip.maxX - lineX);
+
+		if (firstGlyph == lastGlyph) {
+			return;
+		}
+
+		auto font = layout.get_run_font(runIndex);
+		auto& metrics = layout.get_run_metrics(runIndex);
+		auto glyphPosIndex = layout.get_first_position_index(runIndex)
+				+ 2 * (firstGlyph - layout.get_first_glyph_index(runIndex));
+
+		// Formatting iterators seek in both directions, so each glyph gets the formatting of its own character
+		// wherever the iterator starts. Starting at the first visible glyph, rather than at the run's start or end
+		// as the unclipped overload does, skips the hidden glyphs without changing the colors or strokes drawn.
+		// Only the events of the first glyph differ, and those can only begin decorations, which the clip starts
+		// at that glyph anyway.
+		auto iter = make_formatting_iterator(formatting, layout.get_char_index(firstGlyph));
+		underlineStartPos = strikethroughStartPos = glyphPositions[glyphPosIndex];
+
+		for (auto glyphIndex = firstGlyph; glyphIndex < lastGlyph; ++glyphIndex, glyphPosIndex += 2) {
+			auto pX = glyphPositions[glyphPosIndex];
+			auto pY = glyphPositions[glyphPosIndex + 1];
+			auto glyphID = layout.get_glyph_id(glyphIndex);
+			auto event = iter.advance_to(layout.get_char_index(glyphIndex));
+			auto stroke = iter.get_stroke_state();
+
+			// Stroke
+			if (stroke.color.a > 0.f) {
+				visitor(font, glyphID, lineX + pX, lineY + pY, stroke);
+			}
+
+			// Main Glyph
+			visitor(font, glyphID, lineX + pX, lineY + pY, iter.get_color());
+
+			// Underline
+			if ((event & Text::FormattingEvent::UNDERLINE_END) != Text::FormattingEvent::NONE) {
+				auto height = metrics.underlineThickness + 0.5f;
+				visitor(lineX + underlineStartPos, lineY + metrics.underlinePosition,
+						pX - underlineStartPos, height, iter.get_prev_color());
+			}
+
+			if ((event & Text::FormattingEvent::UNDERLINE_BEGIN) != Text::FormattingEvent::NONE) {
+				underlineStartPos = pX;
+			}
+
+			// Strikethrough
+			if ((event & Text::FormattingEvent::STRIKETHROUGH_END) != Text::FormattingEvent::NONE) {
+				auto height = metrics.strikethroughThickness + 0.5f;
+				visitor(lineX + strikethroughStartPos, lineY + metrics.strikethroughPosition,
+						pX - strikethroughStartPos, height, iter.get_prev_color());
+			}
+
+			if ((event & Text::FormattingEvent::STRIKETHROUGH_BEGIN) != Text::FormattingEvent::NONE) {
+				strikethroughStartPos = pX;
+			}
+		}
+
+		// Finalize last strikethrough
+		if (iter.has_strikethrough()) {
+			auto strikethroughEndPos = glyphPositions[glyphPosIndex];
+			auto height = metrics.strikethroughThickness + 0.5f;
+			visitor(lineX + strikethroughStartPos, lineY + metrics.strikethroughPosition,
+					strikethroughEndPos - strikethroughStartPos, height, iter.get_color());
+		}
+
+		// Finalize last underline
+		if (iter.has_underline()) {
+			auto underlineEndPos = glyphPositions[glyphPosIndex];
+			auto height = metrics.underlineThickness + 0.5f;
+			visitor(lineX + underlineStartPos, lineY + metrics.underlinePosition,
+					underlineEndPos - underlineStartPos, height, iter.get_color());
+		}
+	});
+}
+
+}
@@ -2,11 +2,15 @@
 
 #include "value_runs.hpp"
 
+#include <utility>
+
 namespace Text {
 
 template <typename T>
 class ValueRunBuilder {
 	public:
+		constexpr ValueRunBuilder() = default;
+
 		template <typename U>
 		constexpr explicit ValueRunBuilder(U&& baseValue)
 				: m_stack{std::forward<U>(baseValue)} {}
@@ -29,7 +33,30 @@ class ValueRunBuilder {
 			return std::move(m_runs);
 		}
 
-		constexpr T& get_base_value() {
+		/**
+		 * Moves the built runs into `output`, taking the previous storage of `output` in exchange so that a
+		 * builder and its output can be reused without reallocating.
+		 */
+		constexpr void get(ValueRuns<T>& output) {
+			std::swap(output, m_runs);
+			m_runs.clear();
+		}
+
+		/**
+		 * Discards all runs and pushed values, keeping their storage, and restarts from `baseValue`.
+		 */
+		template <typename U>
+		constexpr void reset(U&& baseValue) {
+			m_runs.clear();
+			m_stack.clear();
+			m_stack.emplace_back(std::forward<U>(baseValue));
+		}
+
+		constexpr const ValueRuns<T>& get_runs() const {
+			return m_runs;
+		}
+
+		constexpr decltype(auto) get_base_value() {
 			return m_stack.front();
 		}
 
@@ -117,6 +117,31 @@ class ValueRuns<T> : public Internal::ValueRunsMixin<ValueRuns<T>> {
 			m_limits.clear();
 		}
 
+		constexpr void reserve(size_t runCount) {
+			m_values.reserve(runCount);
+			m_limits.reserve(runCount);
+		}
+
+		/**
+		 * Replaces the runs [`first`, `last`) with a copy of `runs`, and offsets the limits of the runs after them
+		 * by `limitOffset`.
+		 */
+		constexpr void replace_runs(size_t first, size_t last, const ValueRuns& runs, int32_t limitOffset) {
+			for (size_t i = last; i < m_limits.size(); ++i) {
+				m_limits[i] += limitOffset;
+			}
+
+			m_values.erase(m_values.begin() + first, m_values.begin() + last);
+			m_values.insert(m_values.begin() + first, runs.m_values.begin(), runs.m_values.end());
+			m_limits.erase(m_limits.begin() + first, m_limits.begin() + last);
+			m_limits.insert(m_limits.begin() + first, runs.m_limits.begin(), runs.m_limits.end());
+		}
+
+		constexpr void truncate(size_t runCount) {
+			m_values.erase(m_values.begin() + runCount, m_values.end());
+			m_limits.erase(m_limits.begin() + runCount, m_limits.end());
+		}
+
 		constexpr bool empty() const {
 			return m_values.empty();
 		}
@@ -169,6 +194,27 @@ class ValueRuns<T> : public Internal::ValueRunsMixin<ValueRuns<T>> {
 			m_values.clear();
 		}
 
+		constexpr void reserve(size_t runCount) {
+			m_values.reserve(runCount);
+		}
+
+		/**
+		 * Replaces the runs [`first`, `last`) with a copy of `runs`, and offsets the limits of the runs after them
+		 * by `limitOffset`.
+		 */
+		constexpr void replace_runs(size_t first, size_t last, const ValueRuns& runs, int32_t limitOffset) {
+			for (size_t i = last; i < m_values.size(); ++i) {
+				m_values[i] = encode(get_run_value(i), get_run_limit(i) + limitOffset);
+			}
+
+			m_values.erase(m_values.begin() + first, m_values.begin() + last);
+			m_values.insert(m_values.begin() + first, runs.m_values.begin(), runs.m_values.end());
+		}
+
+		constexpr void truncate(size_t runCount) {
+			m_values.erase(m_values.begin() + runCount, m_values.end());
+		}
+
 		constexpr bool empty() const {
 			return m_values.empty();
 		}
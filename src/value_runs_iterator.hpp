@@ -15,10 +15,14 @@ concept ValueRunsIterable = requires(T t) {
 	t.advance_to(int32_t{});
 };
 
-template <typename T>
+/**
+ * Walks the runs of `Runs` in order. `Runs` defaults to `ValueRuns<T>`, other run containers provide their own
+ * specializations.
+ */
+template <typename T, typename Runs = ValueRuns<T>>
 class ValueRunsIterator {
 	public:
-		constexpr explicit ValueRunsIterator(const ValueRuns<T>& runs)
+		constexpr explicit ValueRunsIterator(const Runs& runs)
 				: m_runs(&runs) {}
 
 		constexpr T get_value() const;
@@ -26,10 +30,13 @@ class ValueRunsIterator {
 
 		constexpr void advance_to(int32_t index);
 	private:
-		const ValueRuns<T>* m_runs;
+		const Runs* m_runs;
 		int32_t m_runIndex{};
 };
 
+template <typename T>
+ValueRunsIterator(const ValueRuns<T>&) -> ValueRunsIterator<T>;
+
 template <typename T>
 class MaybeDefaultRunsIterator {
 	public:
@@ -51,18 +58,18 @@ class MaybeDefaultRunsIterator {
 
 // ValueRunsIterator
 
-template <typename T>
-constexpr T ValueRunsIterator<T>::get_value() const {
+template <typename T, typename Runs>
+constexpr T ValueRunsIterator<T, Runs>::get_value() const {
 	return m_runs->get_run_value(m_runIndex);
 }
 
-template <typename T>
-constexpr int32_t ValueRunsIterator<T>::get_limit() const {
+template <typename T, typename Runs>
+constexpr int32_t ValueRunsIterator<T, Runs>::get_limit() const {
 	return m_runs->get_run_limit(m_runIndex); 
 }
 
-template <typename T>
-constexpr void ValueRunsIterator<T>::advance_to(int32_t index) {
+template <typename T, typename Runs>
+constexpr void ValueRunsIterator<T, Runs>::advance_to(int32_t index) {
 	while (m_runs->get_run_limit(m_runIndex) <= index) {
 		++m_runIndex;
 	}
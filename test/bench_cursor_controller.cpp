@@ -0,0 +1,78 @@
+#include <benchmark/benchmark.h>
+
+#include <cursor_controller.hpp>
+
+#include <random>
+#include <string>
+
+static std::string make_paragraph(size_t wordCount);
+
+// Crosses a long paragraph with Ctrl+Right, starting over once the end is reached
+static void CursorControllerNextWord(benchmark::State& state) {
+	auto text = make_paragraph(static_cast<size_t>(state.range(0)));
+	Text::CursorController ctrl;
+	ctrl.set_text(text);
+
+	Text::CursorPosition cursor{0u};
+
+	for (auto _ : state) {
+		auto next = ctrl.next_word(cursor);
+		cursor = next.get_position() == cursor.get_position() ? Text::CursorPosition{0u} : next;
+		benchmark::DoNotOptimize(cursor);
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+static void CursorControllerPrevWord(benchmark::State& state) {
+	auto text = make_paragraph(static_cast<size_t>(state.range(0)));
+	Text::CursorController ctrl;
+	ctrl.set_text(text);
+
+	Text::CursorPosition cursor{static_cast<uint32_t>(text.size())};
+
+	for (auto _ : state) {
+		auto prev = ctrl.prev_word(cursor);
+		cursor = prev.get_position() == 0 ? Text::CursorPosition{static_cast<uint32_t>(text.size())} : prev;
+		benchmark::DoNotOptimize(cursor);
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+// Sets new text before each jump, as after every edit, so word stops are found again each time
+static void CursorControllerNextWordAfterEdit(benchmark::State& state) {
+	auto text = make_paragraph(static_cast<size_t>(state.range(0)));
+	Text::CursorController ctrl;
+	auto position = static_cast<uint32_t>(text.size() / 2);
+
+	for (auto _ : state) {
+		ctrl.set_text(text);
+		benchmark::DoNotOptimize(ctrl.next_word({position}));
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(CursorControllerNextWord)->Arg(1000)->Arg(100000);
+BENCHMARK(CursorControllerPrevWord)->Arg(1000)->Arg(100000);
+BENCHMARK(CursorControllerNextWordAfterEdit)->Arg(1000)->Arg(100000);
+
+// Static Functions
+
+static std::string make_paragraph(size_t wordCount) {
+	static constexpr const char* words[] = {"lorem", "ipsum,", "dolor", "sit", "amet;", "consectetur", "adipiscing",
+			"élit", "sed", "do"};
+
+	std::default_random_engine rng(1234);
+	std::uniform_int_distribution<size_t> distWord(0, std::size(words) - 1);
+
+	std::string result;
+
+	for (size_t i = 0; i < wordCount; ++i) {
+		result.append(words[distWord(rng)]);
+		result.push_back(' ');
+	}
+
+	return result;
+}
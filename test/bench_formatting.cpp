@@ -0,0 +1,296 @@
+#include <benchmark/benchmark.h>
+
+#include <formatting.hpp>
+#include <formatting_binary.hpp>
+#include <formatting_iterator.hpp>
+#include <style_table.hpp>
+
+#include "other_formatting_parsers.hpp"
+
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+static constexpr const size_t TEST_STRING_SIZE = 1 * 1024 * 1024;
+static constexpr const size_t UI_STRING_COUNT = 4096;
+
+static constexpr const char* g_openTags[] = {
+	"<font color=\"#FF8800\">",
+	"<font size=\"24\">",
+	"<font weight=\"bold\" color=\"rgb(20, 40, 60)\">",
+	"<i>",
+	"<u>",
+	"<s>",
+	"<sc>",
+	"<sub>",
+	"<stroke thickness=\"2\" color=\"#000000\" joins=\"miter\">",
+};
+
+static constexpr const char* g_closeTags[] = {
+	"</font>",
+	"</font>",
+	"</font>",
+	"</i>",
+	"</u>",
+	"</s>",
+	"</sc>",
+	"</sub>",
+	"</stroke>",
+};
+
+static std::string make_test_string(size_t tagsPerKB);
+static std::vector<std::string> make_ui_strings();
+
+static void FormattingParseInlineFormatting(benchmark::State& state) {
+	auto text = make_test_string(static_cast<size_t>(state.range(0)));
+	std::string contentText;
+
+	for (auto _ : state) {
+		auto runs = Text::parse_inline_formatting(text, contentText, {}, {0.f, 0.f, 0.f, 1.f}, {});
+		benchmark::DoNotOptimize(runs);
+		benchmark::DoNotOptimize(contentText.data());
+	}
+
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+
+// The parser before FormattingParser, as a baseline for the two above
+static void FormattingParseInlineFormattingBaseline(benchmark::State& state) {
+	auto text = make_test_string(static_cast<size_t>(state.range(0)));
+	std::string contentText;
+
+	for (auto _ : state) {
+		auto runs = Text::parse_inline_formatting_baseline(text, contentText, {}, {0.f, 0.f, 0.f, 1.f}, {});
+		benchmark::DoNotOptimize(runs);
+		benchmark::DoNotOptimize(contentText.data());
+	}
+
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+
+static void FormattingParserReused(benchmark::State& state) {
+	auto text = make_test_string(static_cast<size_t>(state.range(0)));
+	Text::FormattingParser parser;
+	Text::FormattingRuns runs;
+
+	for (auto _ : state) {
+		auto contentText = parser.parse(text, runs, {}, {0.f, 0.f, 0.f, 1.f}, {});
+		benchmark::DoNotOptimize(contentText.data());
+		benchmark::DoNotOptimize(runs);
+	}
+
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+
+// Types and then deletes a character in the middle of the text, parsing the whole text after each edit
+static void FormattingEditFullParse(benchmark::State& state) {
+	auto text = make_test_string(static_cast<size_t>(state.range(0)));
+	auto editPos = text.find("ipsum", text.size() / 2);
+	Text::FormattingParser parser;
+	Text::FormattingRuns runs;
+
+	for (auto _ : state) {
+		text.insert(editPos, 1, 'x');
+		benchmark::DoNotOptimize(parser.parse(text, runs, {}, {0.f, 0.f, 0.f, 1.f}, {}).data());
+		text.erase(editPos, 1);
+		benchmark::DoNotOptimize(parser.parse(text, runs, {}, {0.f, 0.f, 0.f, 1.f}, {}).data());
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(2 * state.iterations()));
+}
+
+// Types and then deletes a character in the middle of the text, re-parsing only around the edit
+static void FormattingEditReparse(benchmark::State& state) {
+	auto text = make_test_string(static_cast<size_t>(state.range(0)));
+	auto editPos = static_cast<uint32_t>(text.find("ipsum", text.size() / 2));
+	Text::FormattingParser parser;
+	std::string contentText;
+	Text::FormattingRuns runs;
+	Text::FormattingSourceMap sourceMap;
+
+	parser.parse(text, contentText, runs, sourceMap, {}, {0.f, 0.f, 0.f, 1.f}, {});
+
+	for (auto _ : state) {
+		text.insert(editPos, 1, 'x');
+		parser.reparse(text, {editPos, 0, 1}, contentText, runs, sourceMap, {}, {0.f, 0.f, 0.f, 1.f}, {});
+		text.erase(editPos, 1);
+		parser.reparse(text, {editPos, 1, 0}, contentText, runs, sourceMap, {}, {0.f, 0.f, 0.f, 1.f}, {});
+		benchmark::DoNotOptimize(contentText.data());
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(2 * state.iterations()));
+}
+
+static void FormattingMakeCompactRuns(benchmark::State& state) {
+	auto text = make_test_string(static_cast<size_t>(state.range(0)));
+	std::string contentText;
+	auto runs = Text::parse_inline_formatting(text, contentText, {}, {0.f, 0.f, 0.f, 1.f}, {});
+	Text::CompactFormattingRuns compactRuns;
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(Text::make_compact_formatting_runs(runs, compactRuns));
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * contentText.size()));
+}
+
+// Steps a formatting iterator over every character, as drawing does for every glyph
+template <typename Formatting>
+static void iterate_formatting(benchmark::State& state, const Formatting& formatting, uint32_t charCount) {
+	for (auto _ : state) {
+		auto iter = Text::make_formatting_iterator(formatting, 0);
+		uint32_t eventCount{};
+
+		for (uint32_t i = 0; i < charCount; ++i) {
+			eventCount += iter.advance_to(i) != Text::FormattingEvent::NONE;
+			benchmark::DoNotOptimize(iter.get_color());
+			benchmark::DoNotOptimize(iter.get_stroke_state());
+		}
+
+		benchmark::DoNotOptimize(eventCount);
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * charCount));
+}
+
+static void FormattingIterateSeparateRuns(benchmark::State& state) {
+	auto text = make_test_string(static_cast<size_t>(state.range(0)));
+	std::string contentText;
+	auto runs = Text::parse_inline_formatting(text, contentText, {}, {0.f, 0.f, 0.f, 1.f}, {});
+
+	iterate_formatting(state, runs, static_cast<uint32_t>(contentText.size()));
+}
+
+static void FormattingIterateCompactRuns(benchmark::State& state) {
+	auto text = make_test_string(static_cast<size_t>(state.range(0)));
+	std::string contentText;
+	auto runs = Text::parse_inline_formatting(text, contentText, {}, {0.f, 0.f, 0.f, 1.f}, {});
+	Text::CompactFormattingRuns compactRuns;
+	Text::make_compact_formatting_runs(runs, compactRuns);
+
+	iterate_formatting(state, compactRuns, static_cast<uint32_t>(contentText.size()));
+}
+
+// Loads many short strings, as a UI does for its labels, from markup
+static void FormattingLoadUIStringsParse(benchmark::State& state) {
+	auto strings = make_ui_strings();
+	Text::FormattingParser parser;
+	Text::FormattingRuns runs;
+
+	for (auto _ : state) {
+		for (auto& str : strings) {
+			benchmark::DoNotOptimize(parser.parse(str, runs, {}, {0.f, 0.f, 0.f, 1.f}, {}).data());
+		}
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * strings.size()));
+}
+
+// Loads the same strings from their binary encoding
+static void FormattingLoadUIStringsBinary(benchmark::State& state) {
+	auto strings = make_ui_strings();
+	Text::FormattingParser parser;
+	Text::FormattingRuns runs;
+	Text::FormattingWriter writer;
+
+	for (auto& str : strings) {
+		writer.write(parser.parse(str, runs, {}, {0.f, 0.f, 0.f, 1.f}, {}), runs);
+	}
+
+	std::string_view contentText;
+
+	for (auto _ : state) {
+		Text::FormattingReader reader(writer.get_data());
+
+		while (reader.read(contentText, runs)) {
+			benchmark::DoNotOptimize(contentText.data());
+		}
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * strings.size()));
+}
+
+// Range is the number of tag pairs per KB of text, 0 for plain text
+BENCHMARK(FormattingParseInlineFormatting)->Arg(0)->Arg(4)->Arg(32);
+BENCHMARK(FormattingParseInlineFormattingBaseline)->Arg(0)->Arg(4)->Arg(32);
+BENCHMARK(FormattingParserReused)->Arg(0)->Arg(4)->Arg(32);
+BENCHMARK(FormattingEditFullParse)->Arg(4)->Arg(32);
+BENCHMARK(FormattingEditReparse)->Arg(4)->Arg(32);
+BENCHMARK(FormattingMakeCompactRuns)->Arg(4)->Arg(32);
+BENCHMARK(FormattingIterateSeparateRuns)->Arg(4)->Arg(32);
+BENCHMARK(FormattingIterateCompactRuns)->Arg(4)->Arg(32);
+BENCHMARK(FormattingLoadUIStringsParse);
+BENCHMARK(FormattingLoadUIStringsBinary);
+
+// Static Functions
+
+static std::string make_test_string(size_t tagsPerKB) {
+	static constexpr const size_t TAG_COUNT = std::size(g_openTags);
+	static constexpr const char* words[] = {"lorem", "ipsum", "dolor", "sit", "amet", "consectetur", "adipiscing",
+			"elit", "sed", "do", "eiusmod", "tempor"};
+
+	std::default_random_engine rng;
+	std::uniform_int_distribution<size_t> distWord(0, std::size(words) - 1);
+	std::uniform_int_distribution<size_t> distTag(0, TAG_COUNT - 1);
+
+	std::string result;
+	result.reserve(TEST_STRING_SIZE + 256);
+
+	auto tagSpacing = tagsPerKB > 0 ? 1024 / tagsPerKB : TEST_STRING_SIZE;
+	size_t nextTagPos = tagSpacing;
+
+	while (result.size() < TEST_STRING_SIZE) {
+		auto wordCount = distWord(rng) + 1;
+
+		// Wrap a phrase in a tag every `tagSpacing` bytes
+		if (result.size() >= nextTagPos) {
+			auto tagIndex = distTag(rng);
+			nextTagPos += tagSpacing;
+			result += g_openTags[tagIndex];
+
+			for (size_t i = 0; i < wordCount; ++i) {
+				result += words[distWord(rng)];
+				result += ' ';
+			}
+
+			result += g_closeTags[tagIndex];
+			result += ' ';
+		}
+		else {
+			for (size_t i = 0; i < wordCount; ++i) {
+				result += words[distWord(rng)];
+				result += ' ';
+			}
+		}
+
+		if (distWord(rng) == 0) {
+			result += '\n';
+		}
+	}
+
+	return result;
+}
+
+static std::vector<std::string> make_ui_strings() {
+	static constexpr const char* words[] = {"Open", "Save", "Close", "File", "Settings", "Volume", "Quit",
+			"Continue", "Options", "Level"};
+
+	std::default_random_engine rng;
+	std::uniform_int_distribution<size_t> distWord(0, std::size(words) - 1);
+	std::uniform_int_distribution<size_t> distTag(0, std::size(g_openTags) - 1);
+
+	std::vector<std::string> result;
+	result.reserve(UI_STRING_COUNT);
+
+	for (size_t i = 0; i < UI_STRING_COUNT; ++i) {
+		auto tagIndex = distTag(rng);
+		auto& str = result.emplace_back(words[distWord(rng)]);
+		str += ' ';
+		str += g_openTags[tagIndex];
+		str += words[distWord(rng)];
+		str += g_closeTags[tagIndex];
+	}
+
+	return result;
+}
@@ -0,0 +1,139 @@
+#include <benchmark/benchmark.h>
+
+#include "test_layout_helpers.hpp"
+
+#include <formatting.hpp>
+#include <glyph_quad_stream.hpp>
+#include <layout_info.hpp>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+static constexpr const uint32_t GLYPHS_PER_LINE = 80;
+static constexpr const uint32_t GLYPHS_PER_RUN = 16;
+static constexpr const uint32_t GLYPH_ID_COUNT = 2048;
+static constexpr const uint32_t PAGE_COUNT = 4;
+static constexpr const float GLYPH_ADVANCE = 12.f;
+
+namespace {
+
+/**
+ * Flat table lookup, so that the benchmark measures the stream itself rather than any particular atlas.
+ */
+class TableAtlas final : public Text::GlyphAtlasLookup {
+	public:
+		TableAtlas() {
+			std::default_random_engine rng;
+			std::uniform_int_distribution<uint32_t> distPage(0, PAGE_COUNT - 1);
+
+			m_entries.resize(GLYPH_ID_COUNT);
+
+			for (uint32_t i = 0; i < GLYPH_ID_COUNT; ++i) {
+				m_entries[i] = {
+					.offset = {1.f, -10.f},
+					.size = {10.f, 14.f},
+					.texCoords = {static_cast<float>(i % 64) / 64.f, static_cast<float>(i / 64) / 64.f,
+							1.f / 64.f, 1.f / 64.f},
+					.page = distPage(rng),
+					.hasColor = false,
+				};
+			}
+		}
+
+		bool get_glyph(const Text::SingleScriptFont&, uint32_t glyphID,
+				Text::GlyphAtlasEntry& entry) override {
+			entry = m_entries[glyphID];
+			return true;
+		}
+
+		bool get_stroke(const Text::SingleScriptFont&, uint32_t glyphID, uint8_t, Text::StrokeType,
+				Text::GlyphAtlasEntry& entry) override {
+			entry = m_entries[glyphID];
+			entry.page += PAGE_COUNT;
+			return true;
+		}
+
+		bool get_solid(Text::GlyphAtlasEntry& entry) override {
+			entry = m_entries[0];
+			return true;
+		}
+	private:
+		std::vector<Text::GlyphAtlasEntry> m_entries;
+};
+
+}
+
+class GlyphQuadFixture : public benchmark::Fixture {
+	public:
+		void SetUp(benchmark::State& state) override {
+			std::default_random_engine rng;
+			std::uniform_int_distribution<uint32_t> distGlyph(0, GLYPH_ID_COUNT - 1);
+
+			auto lineCount = static_cast<uint32_t>(state.range(0));
+
+			m_layout = build_test_layout({
+				.lineCount = lineCount,
+				.glyphsPerRun = GLYPHS_PER_RUN,
+				.glyphAdvance = GLYPH_ADVANCE,
+			}, [](auto) { return GLYPHS_PER_LINE / GLYPHS_PER_RUN; },
+					[&](auto, auto, auto) { return distGlyph(rng); });
+
+			// Alternate color every 7 characters and stroke every other 64 to exercise batch switching
+			auto limit = static_cast<int32_t>(lineCount * (GLYPHS_PER_LINE + 1));
+			m_formatting = {
+				.fontRuns{Text::Font{}, limit},
+				.strikethroughRuns{false, limit},
+				.underlineRuns{false, limit},
+				.smallcapsRuns{false, limit},
+				.subscriptRuns{false, limit},
+				.superscriptRuns{false, limit},
+			};
+
+			for (int32_t i = 0; i < limit; i += 7) {
+				m_formatting.colorRuns.add(std::min(i + 7, limit), Text::Color{1.f, static_cast<float>(i & 1),
+						0.f, 1.f});
+			}
+
+			for (int32_t i = 0; i < limit; i += 64) {
+				m_formatting.strokeRuns.add(std::min(i + 64, limit), Text::StrokeState{
+					.color = {0.f, 0.f, 0.f, static_cast<float>((i / 64) & 1)},
+					.thickness = 2,
+					.joins = Text::StrokeType::ROUND,
+				});
+			}
+		}
+	protected:
+		Text::LayoutInfo m_layout;
+		Text::FormattingRuns m_formatting;
+		Text::GlyphQuadStream m_stream;
+		TableAtlas m_atlas;
+
+		void set_counters(benchmark::State& state) {
+			state.counters["glyphs/s"] = benchmark::Counter(static_cast<double>(state.iterations()
+					* m_layout.get_glyph_count()), benchmark::Counter::kIsRate);
+		}
+};
+
+BENCHMARK_DEFINE_F(GlyphQuadFixture, SingleColor)(benchmark::State& state) {
+	for (auto _ : state) {
+		m_stream.build(m_layout, 1000.f, Text::XAlignment::LEFT, m_atlas, {1.f, 1.f, 1.f, 1.f});
+		benchmark::DoNotOptimize(m_stream.get_positions());
+		benchmark::ClobberMemory();
+	}
+
+	set_counters(state);
+}
+
+BENCHMARK_DEFINE_F(GlyphQuadFixture, Formatted)(benchmark::State& state) {
+	for (auto _ : state) {
+		m_stream.build(m_layout, m_formatting, 1000.f, Text::XAlignment::LEFT, m_atlas);
+		benchmark::DoNotOptimize(m_stream.get_positions());
+		benchmark::ClobberMemory();
+	}
+
+	set_counters(state);
+}
+
+BENCHMARK_REGISTER_F(GlyphQuadFixture, SingleColor)->RangeMultiplier(8)->Range(1, 4096);
+BENCHMARK_REGISTER_F(GlyphQuadFixture, Formatted)->RangeMultiplier(8)->Range(1, 4096);
@@ -0,0 +1,80 @@
+#include <benchmark/benchmark.h>
+
+#include "test_layout_helpers.hpp"
+
+#include <layout_info.hpp>
+
+#include <vector>
+
+static constexpr const uint32_t RUNS_PER_LINE = 6;
+static constexpr const uint32_t GLYPHS_PER_RUN = 12;
+static constexpr const float GLYPH_ADVANCE = 10.f;
+static constexpr const float TEXT_AREA_WIDTH = 1000.f;
+
+static Text::LayoutInfo make_layout(uint32_t lineCount);
+
+// Selects all of the text by visiting every run, as the sample did before `get_selection_rects`
+static void SelectionRectsPerRun(benchmark::State& state) {
+	auto layout = make_layout(static_cast<uint32_t>(state.range(0)));
+	auto charCount = layout.get_run_char_end_index(layout.get_run_count() - 1);
+	std::vector<Text::SelectionRect> rects;
+
+	for (auto _ : state) {
+		rects.clear();
+
+		layout.for_each_run(TEXT_AREA_WIDTH, Text::XAlignment::CENTER, [&](auto lineIndex, auto runIndex,
+				auto lineX, auto lineY) {
+			if (layout.run_contains_char_range(runIndex, 0, charCount)) {
+				auto [minPos, maxPos] = layout.get_position_range_in_run(runIndex, 0, charCount);
+				rects.push_back({lineX + minPos, lineY - layout.get_line_ascent(lineIndex), maxPos - minPos,
+						layout.get_line_height(lineIndex)});
+			}
+		});
+
+		benchmark::DoNotOptimize(rects.data());
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+static void SelectionRectsSelectAll(benchmark::State& state) {
+	auto layout = make_layout(static_cast<uint32_t>(state.range(0)));
+	auto charCount = layout.get_run_char_end_index(layout.get_run_count() - 1);
+	std::vector<Text::SelectionRect> rects;
+
+	for (auto _ : state) {
+		layout.get_selection_rects(0, charCount, TEXT_AREA_WIDTH, Text::XAlignment::CENTER, rects);
+		benchmark::DoNotOptimize(rects.data());
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+// Selects a few words near the end of the text, where a full walk would visit every run before them
+static void SelectionRectsSmallSelection(benchmark::State& state) {
+	auto layout = make_layout(static_cast<uint32_t>(state.range(0)));
+	auto charCount = layout.get_run_char_end_index(layout.get_run_count() - 1);
+	std::vector<Text::SelectionRect> rects;
+
+	for (auto _ : state) {
+		layout.get_selection_rects(charCount - 150, charCount - 100, TEXT_AREA_WIDTH, Text::XAlignment::CENTER,
+				rects);
+		benchmark::DoNotOptimize(rects.data());
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(SelectionRectsPerRun)->Arg(100)->Arg(10000);
+BENCHMARK(SelectionRectsSelectAll)->Arg(100)->Arg(10000);
+BENCHMARK(SelectionRectsSmallSelection)->Arg(100)->Arg(10000);
+
+// Static Functions
+
+static Text::LayoutInfo make_layout(uint32_t lineCount) {
+	return build_test_layout({
+		.lineCount = lineCount,
+		.glyphsPerRun = GLYPHS_PER_RUN,
+		.glyphAdvance = GLYPH_ADVANCE,
+	}, [](auto) { return RUNS_PER_LINE; }, [](auto, auto, auto i) { return i; });
+}
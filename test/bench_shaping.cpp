@@ -0,0 +1,174 @@
+#include <benchmark/benchmark.h>
+
+#include <harfbuzz_font.hpp>
+#include <pair.hpp>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <unicode/utf8.h>
+
+static constexpr const size_t RUN_COUNT = 256;
+static constexpr const double RUN_SIZE_AVERAGE = 24.0;
+static constexpr const double RUN_SIZE_STDDEV = 12.0;
+static constexpr const uint32_t FONT_SIZE = 48;
+
+static constexpr const Text::Pair<uint32_t, uint32_t> g_unicodeLatin[] = {
+	{0x21u, 0x7Eu},
+	{0x100u, 0x17Fu},
+};
+
+static constexpr const Text::Pair<uint32_t, uint32_t> g_unicodeCJK[] = {
+	{0x3041u, 0x3096u},
+	{0x30A0u, 0x30FFu},
+	{0x4E00u, 0x9FFFu},
+};
+
+using Lang = std::span<const Text::Pair<uint32_t, uint32_t>>;
+
+static std::vector<std::string> gen_test_runs(Lang lang);
+
+/**
+ * Shapes a fixed set of short single-script runs, roughly the size of the logical runs produced by
+ * `LayoutBuilder`, to compare the cost of the FreeType-backed and native HarfBuzz font functions.
+ */
+class ShapingFixture : public benchmark::Fixture {
+	public:
+		void SetUp(benchmark::State& state) override {
+			FT_Init_FreeType(&m_lib);
+
+			if (FT_New_Face(m_lib, get_font_path(), 0, &m_ftFace) != 0) {
+				state.SkipWithError("Failed to load font");
+				return;
+			}
+
+			FT_Size_RequestRec sr{
+				.type = FT_SIZE_REQUEST_TYPE_REAL_DIM,
+				.height = static_cast<FT_Long>(FONT_SIZE) * 64,
+			};
+			FT_Request_Size(m_ftFace, &sr);
+
+			m_hbFont = Text::harfbuzz_font_create(m_ftFace, nullptr,
+					static_cast<Text::HarfbuzzFontFuncs>(state.range(0)));
+			m_buffer = hb_buffer_create();
+			m_runs = gen_test_runs(get_lang());
+		}
+
+		void TearDown(benchmark::State&) override {
+			if (m_buffer) {
+				hb_buffer_destroy(m_buffer);
+			}
+
+			if (m_hbFont) {
+				hb_font_destroy(m_hbFont);
+			}
+
+			if (m_ftFace) {
+				FT_Done_Face(m_ftFace);
+			}
+
+			FT_Done_FreeType(m_lib);
+
+			m_buffer = nullptr;
+			m_hbFont = nullptr;
+			m_ftFace = nullptr;
+		}
+	protected:
+		FT_Library m_lib{};
+		FT_Face m_ftFace{};
+		hb_font_t* m_hbFont{};
+		hb_buffer_t* m_buffer{};
+		std::vector<std::string> m_runs;
+
+		virtual const char* get_font_path() const = 0;
+		virtual Lang get_lang() const = 0;
+
+		void shape_all(benchmark::State& state) {
+			size_t glyphCount{};
+
+			for (auto _ : state) {
+				for (auto& run : m_runs) {
+					hb_buffer_clear_contents(m_buffer);
+					hb_buffer_add_utf8(m_buffer, run.data(), static_cast<int>(run.size()), 0,
+							static_cast<int>(run.size()));
+					hb_buffer_guess_segment_properties(m_buffer);
+					hb_shape(m_hbFont, m_buffer, nullptr, 0);
+					glyphCount += hb_buffer_get_length(m_buffer);
+				}
+
+				benchmark::ClobberMemory();
+			}
+
+			state.counters["glyphs/s"] = benchmark::Counter(static_cast<double>(glyphCount),
+					benchmark::Counter::kIsRate);
+		}
+};
+
+class LatinShapingFixture : public ShapingFixture {
+	protected:
+		const char* get_font_path() const override final {
+			return "fonts/NotoSans/NotoSans-Regular.ttf";
+		}
+
+		Lang get_lang() const override final {
+			return g_unicodeLatin;
+		}
+};
+
+class CJKShapingFixture : public ShapingFixture {
+	protected:
+		const char* get_font_path() const override final {
+			return "fonts/NotoSans/NotoSansCJKjp-Regular.otf";
+		}
+
+		Lang get_lang() const override final {
+			return g_unicodeCJK;
+		}
+};
+
+BENCHMARK_DEFINE_F(LatinShapingFixture, Shape)(benchmark::State& state) {
+	shape_all(state);
+}
+
+BENCHMARK_DEFINE_F(CJKShapingFixture, Shape)(benchmark::State& state) {
+	shape_all(state);
+}
+
+BENCHMARK_REGISTER_F(LatinShapingFixture, Shape)
+		->ArgName("NativeFuncs")
+		->Arg(static_cast<int64_t>(Text::HarfbuzzFontFuncs::FREETYPE))
+		->Arg(static_cast<int64_t>(Text::HarfbuzzFontFuncs::NATIVE));
+BENCHMARK_REGISTER_F(CJKShapingFixture, Shape)
+		->ArgName("NativeFuncs")
+		->Arg(static_cast<int64_t>(Text::HarfbuzzFontFuncs::FREETYPE))
+		->Arg(static_cast<int64_t>(Text::HarfbuzzFontFuncs::NATIVE));
+
+// Static Functions
+
+static std::vector<std::string> gen_test_runs(Lang lang) {
+	std::default_random_engine rng;
+	std::normal_distribution distRunSize(RUN_SIZE_AVERAGE, RUN_SIZE_STDDEV);
+	std::uniform_int_distribution<size_t> distBlocks(0, lang.size() - 1);
+
+	std::vector<std::string> result(RUN_COUNT);
+
+	for (auto& run : result) {
+		auto runSize = static_cast<size_t>(std::min(std::max(distRunSize(rng), 1.0), 100.0));
+		auto [blkStart, blkEnd] = lang[distBlocks(rng)];
+		std::uniform_int_distribution<uint32_t> distChars(blkStart, blkEnd);
+
+		for (size_t i = 0; i < runSize; ++i) {
+			char buffer[U8_MAX_LENGTH];
+			int32_t offset{};
+			U8_APPEND_UNSAFE(buffer, offset, distChars(rng));
+			run.append(buffer, offset);
+		}
+	}
+
+	return result;
+}
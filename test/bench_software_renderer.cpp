@@ -0,0 +1,147 @@
+#include <benchmark/benchmark.h>
+
+#include "test_layout_helpers.hpp"
+
+#include <formatting.hpp>
+#include <glyph_cache.hpp>
+#include <layout_info.hpp>
+#include <software_renderer.hpp>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+static constexpr const uint32_t GLYPHS_PER_LINE = 80;
+static constexpr const uint32_t GLYPH_ID_COUNT = 128;
+static constexpr const uint32_t GLYPH_WIDTH = 10;
+static constexpr const uint32_t GLYPH_HEIGHT = 14;
+static constexpr const float GLYPH_ADVANCE = 12.f;
+static constexpr const float LINE_HEIGHT = 20.f;
+static constexpr const float LINE_ASCENT = 16.f;
+
+static void rasterize_bench_glyph(const Text::SingleScriptFont&, const Text::GlyphCacheKey& key,
+		Text::GlyphBitmap& bitmap, void*) {
+	std::default_random_engine rng(key.glyphID);
+	std::uniform_int_distribution<uint32_t> distCoverage(0, 255);
+
+	auto border = static_cast<uint32_t>(key.strokeThickness);
+	bitmap.width = GLYPH_WIDTH + 2 * border;
+	bitmap.height = GLYPH_HEIGHT + 2 * border;
+	bitmap.offsetX = -static_cast<float>(border);
+	bitmap.offsetY = -static_cast<float>(GLYPH_HEIGHT + border - 3);
+	bitmap.format = Text::FontRasterFormat::R8;
+	bitmap.pData = std::make_unique<std::byte[]>(bitmap.get_byte_size());
+
+	// Roughly a third of a glyph's bounding box is empty, as with real text
+	for (size_t i = 0; i < bitmap.get_byte_size(); ++i) {
+		auto coverage = distCoverage(rng);
+		bitmap.pData[i] = static_cast<std::byte>(coverage < 85 ? 0 : coverage);
+	}
+}
+
+class SoftwareRendererFixture : public benchmark::Fixture {
+	public:
+		SoftwareRendererFixture()
+				: m_cache({
+					.byteBudget = 16 << 20,
+					.shardCount = 8,
+					.pfnRasterize = rasterize_bench_glyph,
+					.pRasterizeUserData = nullptr,
+				}) {}
+
+		void SetUp(benchmark::State& state) override {
+			std::default_random_engine rng;
+			std::uniform_int_distribution<uint32_t> distGlyph(0, GLYPH_ID_COUNT - 1);
+
+			auto lineCount = static_cast<uint32_t>(state.range(0));
+			Text::SingleScriptFont font{};
+			font.size = 16;
+
+			m_layout = build_test_layout({
+				.lineCount = lineCount,
+				.glyphsPerRun = GLYPHS_PER_LINE,
+				.glyphAdvance = GLYPH_ADVANCE,
+				.lineHeight = LINE_HEIGHT,
+				.lineAscent = LINE_ASCENT,
+				.font = font,
+				.metrics = {
+					.ascent = LINE_ASCENT,
+					.descent = LINE_HEIGHT - LINE_ASCENT,
+					.underlinePosition = 2.f,
+					.underlineThickness = 1.f,
+					.strikethroughPosition = -5.f,
+					.strikethroughThickness = 1.f,
+				},
+			}, [](auto) { return 1; }, [&](auto, auto, auto) { return distGlyph(rng); });
+
+			// Stroke and underline every other 64 characters
+			auto limit = static_cast<int32_t>(lineCount * (GLYPHS_PER_LINE + 1));
+			m_formatting = {
+				.fontRuns{Text::Font{}, limit},
+				.colorRuns{Text::Color{0.2f, 0.4f, 0.9f, 1.f}, limit},
+				.strikethroughRuns{false, limit},
+				.smallcapsRuns{false, limit},
+				.subscriptRuns{false, limit},
+				.superscriptRuns{false, limit},
+			};
+
+			for (int32_t i = 0; i < limit; i += 64) {
+				auto end = std::min(i + 64, limit);
+				m_formatting.strokeRuns.add(end, Text::StrokeState{
+					.color = {0.f, 0.f, 0.f, static_cast<float>((i / 64) & 1)},
+					.thickness = 2,
+					.joins = Text::StrokeType::ROUND,
+				});
+				m_formatting.underlineRuns.add(end, ((i / 64) & 1) != 0);
+			}
+
+			m_width = static_cast<uint32_t>(GLYPHS_PER_LINE * GLYPH_ADVANCE);
+			m_height = static_cast<uint32_t>(static_cast<float>(lineCount) * LINE_HEIGHT);
+			m_pixels.assign(static_cast<size_t>(m_width) * m_height * 4, 0);
+			m_renderer.build(m_layout, m_formatting, static_cast<float>(m_width), Text::XAlignment::LEFT, m_cache);
+		}
+	protected:
+		Text::GlyphCache m_cache;
+		Text::LayoutInfo m_layout;
+		Text::FormattingRuns m_formatting;
+		Text::SoftwareRenderer m_renderer;
+		std::vector<uint8_t> m_pixels;
+		uint32_t m_width;
+		uint32_t m_height;
+
+		Text::RenderTarget get_target() {
+			return {m_pixels.data(), m_width, m_height, 4 * m_width};
+		}
+
+		void set_counters(benchmark::State& state) {
+			state.counters["MP/s"] = benchmark::Counter(static_cast<double>(state.iterations())
+					* static_cast<double>(m_width) * static_cast<double>(m_height) / 1e6,
+					benchmark::Counter::kIsRate);
+		}
+};
+
+BENCHMARK_DEFINE_F(SoftwareRendererFixture, Build)(benchmark::State& state) {
+	for (auto _ : state) {
+		m_renderer.build(m_layout, m_formatting, static_cast<float>(m_width), Text::XAlignment::LEFT, m_cache);
+		benchmark::ClobberMemory();
+	}
+
+	state.counters["glyphs/s"] = benchmark::Counter(static_cast<double>(state.iterations()
+			* m_layout.get_glyph_count()), benchmark::Counter::kIsRate);
+}
+
+BENCHMARK_DEFINE_F(SoftwareRendererFixture, Render)(benchmark::State& state) {
+	auto target = get_target();
+	auto threadCount = static_cast<uint32_t>(state.range(1));
+
+	for (auto _ : state) {
+		m_renderer.render(target, threadCount);
+		benchmark::DoNotOptimize(m_pixels.data());
+		benchmark::ClobberMemory();
+	}
+
+	set_counters(state);
+}
+
+BENCHMARK_REGISTER_F(SoftwareRendererFixture, Build)->RangeMultiplier(8)->Range(1, 512);
+BENCHMARK_REGISTER_F(SoftwareRendererFixture, Render)->ArgsProduct({{8, 64, 512}, {1, 2, 4, 8}})->UseRealTime();
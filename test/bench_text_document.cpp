@@ -0,0 +1,85 @@
+#include <benchmark/benchmark.h>
+
+#include <text_document.hpp>
+
+#include <random>
+#include <string>
+
+static constexpr const size_t TEST_TEXT_SIZE = 1 * 1024 * 1024;
+
+static std::string make_test_text();
+
+// Types a character in the middle of the text by rebuilding it around the insertion
+static void TextDocumentTypeConcatenate(benchmark::State& state) {
+	auto text = make_test_text();
+	auto offset = text.size() / 2;
+
+	for (auto _ : state) {
+		auto before = text.substr(0, offset);
+		auto after = text.substr(offset);
+		text = before + "x" + after;
+		++offset;
+		benchmark::DoNotOptimize(text.data());
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+static void TextDocumentTypePieceTable(benchmark::State& state) {
+	Text::TextDocument document(make_test_text());
+	auto offset = document.get_length() / 2;
+
+	for (auto _ : state) {
+		document.insert(offset, "x");
+		++offset;
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+// Inserts and erases at scattered offsets, then looks up the line of each edit
+static void TextDocumentScatteredEdits(benchmark::State& state) {
+	Text::TextDocument document(make_test_text());
+	std::default_random_engine rng;
+
+	for (auto _ : state) {
+		std::uniform_int_distribution<uint32_t> distOffset(0, document.get_length() - 2);
+		auto offset = distOffset(rng);
+
+		if (rng() & 1) {
+			document.insert(offset, "word\n");
+		}
+		else {
+			document.erase(offset, 2);
+		}
+
+		benchmark::DoNotOptimize(document.get_line_start(document.get_line_index(offset)));
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+	state.counters["pieces"] = document.get_piece_count();
+}
+
+BENCHMARK(TextDocumentTypeConcatenate);
+BENCHMARK(TextDocumentTypePieceTable);
+BENCHMARK(TextDocumentScatteredEdits);
+
+// Static Functions
+
+static std::string make_test_text() {
+	static constexpr const char* words[] = {"lorem", "ipsum", "dolor", "sit", "amet", "consectetur", "adipiscing",
+			"elit", "sed", "do", "eiusmod", "tempor"};
+
+	std::default_random_engine rng;
+	std::uniform_int_distribution<size_t> distWord(0, std::size(words) - 1);
+
+	std::string result;
+	result.reserve(TEST_TEXT_SIZE + 16);
+
+	while (result.size() < TEST_TEXT_SIZE) {
+		result += words[distWord(rng)];
+		result += distWord(rng) == 0 ? '\n' : ' ';
+	}
+
+	return result;
+}
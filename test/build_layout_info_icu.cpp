@@ -129,11 +129,9 @@ void Text::build_layout_info_icu(LayoutInfo& result, const char16_t* chars, int3
 			else {
 				auto font = fontRuns.get_value(byteIndex == count ? count - 1 : byteIndex);
 				auto fontData = FontRegistry::get_font_data(font);
-				auto height = fontData.get_ascent() - fontData.get_descent();
-
 				lastHighestRun = result.get_run_count();
 				result.append_empty_line(FontRegistry::get_default_single_script_font(font),
-						static_cast<uint32_t>(byteIndex), height, fontData.get_ascent());
+						static_cast<uint32_t>(byteIndex), fontData.get_metrics());
 			}
 
 			if (c == U_SENTINEL) {
@@ -542,6 +540,7 @@ static void append_visual_run(LayoutBuildState& state, LayoutInfo& result, const
 	visualRunLastX += state.glyphPositions[logicalLastPos];
 
 	result.append_run(logicalRuns[run].font, static_cast<uint32_t>(charStartIndex),
-			static_cast<uint32_t>(charEndIndex + 1), rightToLeft);
+			static_cast<uint32_t>(charEndIndex + 1), rightToLeft,
+			FontRegistry::get_font_data(logicalRuns[run].font).get_metrics());
 }
 
@@ -197,12 +197,10 @@ void Text::build_layout_info_icu_lx(LayoutInfo& result, const char16_t* chars, i
 			else {
 				auto font = fontRuns.get_value(byteIndex == count ? count - 1 : byteIndex);
 				auto fontData = FontRegistry::get_font_data(font);
-				auto height = fontData.get_ascent() - fontData.get_descent();
-
 				lastHighestRun = result.get_run_count();
 				highestRunCharEnd = byteIndex;
 				result.append_empty_line(FontRegistry::get_default_single_script_font(font),
-						static_cast<uint32_t>(byteIndex), height, fontData.get_ascent());
+						static_cast<uint32_t>(byteIndex), fontData.get_metrics());
 			}
 
 			if (c == U_SENTINEL) {
@@ -273,7 +271,8 @@ static void handle_line_icu_lx(LayoutInfo& result, icu::ParagraphLayout::Line& l
 
 		auto* pLEFont = static_cast<const LESingleScript*>(pRun->getFont());
 		result.append_run(pLEFont->get_font(), static_cast<uint32_t>(firstChar),
-				static_cast<uint32_t>(lastChar), rightToLeft);
+				static_cast<uint32_t>(lastChar), rightToLeft,
+				FontRegistry::get_font_data(pLEFont->get_font()).get_metrics());
 	}
 
 	result.append_line(static_cast<float>(maxAscent + maxDescent), static_cast<float>(maxAscent));
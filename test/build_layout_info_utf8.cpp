@@ -124,11 +124,9 @@ void Text::build_layout_info_utf8(LayoutInfo& result, const char* chars, int32_t
 		else {
 			auto font = fontRuns.get_value(paragraphOffset == count ? count - 1 : paragraphOffset);
 			auto fontData = FontRegistry::get_font_data(font);
-			auto height = fontData.get_ascent() - fontData.get_descent();
-
 			lastHighestRun = result.get_run_count();
 			result.append_empty_line(FontRegistry::get_default_single_script_font(font),
-					static_cast<uint32_t>(paragraphOffset), height, fontData.get_ascent());
+					static_cast<uint32_t>(paragraphOffset), fontData.get_metrics());
 		}
 
 		result.set_run_char_end_offset(lastHighestRun, separatorLength * (!isLastParagraph));
@@ -632,6 +630,7 @@ static void append_visual_run(LayoutBuildState& state, LayoutInfo& result, const
 	visualRunLastX += state.glyphPositions[logicalLastPos];
 
 	result.append_run(logicalRuns[run].font, static_cast<uint32_t>(charStartIndex),
-			static_cast<uint32_t>(charEndIndex + 1), rightToLeft);
+			static_cast<uint32_t>(charEndIndex + 1), rightToLeft,
+			FontRegistry::get_font_data(logicalRuns[run].font).get_metrics());
 }
 
@@ -177,11 +177,9 @@ void Text::build_layout_info_utf8_2(LayoutInfo& result, const char* chars, int32
 		else {
 			auto font = fontRuns.get_value(paragraphOffset == count ? count - 1 : paragraphOffset);
 			auto fontData = FontRegistry::get_font_data(font);
-			auto height = fontData.get_ascent() - fontData.get_descent();
-
 			lastHighestRun = result.get_run_count();
 			result.append_empty_line(FontRegistry::get_default_single_script_font(font),
-					static_cast<uint32_t>(paragraphOffset), height, fontData.get_ascent());
+					static_cast<uint32_t>(paragraphOffset), fontData.get_metrics());
 		}
 
 		result.set_run_char_end_offset(lastHighestRun, separatorLength * (!isLastParagraph));
@@ -750,7 +748,8 @@ static void append_visual_run(LayoutBuildState& state, LayoutInfo& result, const
 	visualRunLastX += state.glyphPositionsX[visualLastPosIndex];
 
 	result.append_run(logicalRuns[run].font, static_cast<uint32_t>(charStartIndex),
-			static_cast<uint32_t>(charEndIndex + 1), rightToLeft);
+			static_cast<uint32_t>(charEndIndex + 1), rightToLeft,
+			FontRegistry::get_font_data(logicalRuns[run].font).get_metrics());
 }
 
 // LayoutBuildState
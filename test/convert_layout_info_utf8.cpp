@@ -51,7 +51,8 @@ static void convert_runs(const LayoutInfo& src, LayoutInfo& dst, const char16_t*
 					src.get_run_char_end_index(run));
 			auto charStartIndex = utf16_index_to_utf8(srcChars, srcCharCount, dstChars, dstCharCount,
 					src.get_run_char_start_index(run));
-			dst.append_run(src.get_run_font(run), charStartIndex, lowChar, src.is_run_rtl(run));
+			dst.append_run(src.get_run_font(run), charStartIndex, lowChar, src.is_run_rtl(run),
+					src.get_run_metrics(run));
 			dst.set_run_char_end_offset(run, highChar - lowChar);
 		}
 
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "formatting.hpp"
+
+#include <string>
+
+namespace Text {
+
+/**
+ * @brief Parses inline formatting with the parser that predates `FormattingParser`, which copies content text
+ * one byte at a time through an `std::ostringstream`. Kept as a baseline for bench_formatting.
+ */
+FormattingRuns parse_inline_formatting_baseline(const std::string& text, std::string& contentText, Font baseFont,
+		Color baseColor, const StrokeState& baseStroke);
+
+}
@@ -0,0 +1,221 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <atlas_packer.hpp>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace {
+
+struct PackerEvents {
+	std::vector<uint32_t> evicted;
+	std::vector<uint32_t> resetPages;
+};
+
+}
+
+static void on_evict(uint32_t allocationID, void* pUserData);
+static void on_page_reset(uint32_t page, uint32_t pageClass, void* pUserData);
+static bool rects_overlap(const Text::AtlasRect& a, const Text::AtlasRect& b, uint32_t padding);
+static Text::AtlasPacker make_grid_packer(PackerEvents& events, uint32_t maxPageCount, uint32_t idleFrameLimit);
+
+TEST_CASE("No Overlap", "[AtlasPacker]") {
+	static constexpr const uint32_t PAGE_EXTENT = 512;
+	static constexpr const uint32_t PADDING = 1;
+
+	Text::AtlasPacker packer({
+		.pageWidth = PAGE_EXTENT,
+		.pageHeight = PAGE_EXTENT,
+		.padding = PADDING,
+		.maxPageCount = 0,
+		.idleFrameLimit = 0,
+		.pfnEvict = nullptr,
+		.pfnPageReset = nullptr,
+		.pUserData = nullptr,
+	});
+
+	std::default_random_engine rng;
+	std::uniform_int_distribution<uint32_t> distWidth(4, 40);
+	std::uniform_int_distribution<uint32_t> distHeight(10, 30);
+	std::vector<Text::AtlasRect> rects;
+
+	for (uint32_t i = 0; i < 3000; ++i) {
+		Text::AtlasRect rect;
+		auto width = distWidth(rng);
+		auto height = distHeight(rng);
+
+		REQUIRE(packer.allocate(width, height, 0, rect) == i);
+		REQUIRE(rect.width == width);
+		REQUIRE(rect.height == height);
+		REQUIRE(rect.x + width + PADDING <= PAGE_EXTENT);
+		REQUIRE(rect.y + height + PADDING <= PAGE_EXTENT);
+		rects.push_back(rect);
+	}
+
+	for (size_t i = 0; i < rects.size(); ++i) {
+		for (size_t j = i + 1; j < rects.size(); ++j) {
+			if (rects_overlap(rects[i], rects[j], PADDING)) {
+				FAIL("Allocations " << i << " and " << j << " overlap");
+			}
+		}
+	}
+
+	// Every page but the last has been filled as far as the packer can manage
+	REQUIRE(packer.get_page_count() > 1);
+
+	for (uint32_t i = 0; i + 1 < packer.get_page_count(); ++i) {
+		REQUIRE(packer.get_page_occupancy(i) > 0.8f);
+	}
+}
+
+TEST_CASE("Page Classes", "[AtlasPacker]") {
+	PackerEvents events;
+	auto packer = make_grid_packer(events, 0, 0);
+	Text::AtlasRect rect;
+
+	REQUIRE(packer.allocate(16, 16, 0, rect) != Text::AtlasPacker::INVALID_ALLOCATION);
+	REQUIRE(rect.page == 0);
+	REQUIRE(packer.allocate(16, 16, 1, rect) != Text::AtlasPacker::INVALID_ALLOCATION);
+	REQUIRE(rect.page == 1);
+	REQUIRE(packer.allocate(16, 16, 0, rect) != Text::AtlasPacker::INVALID_ALLOCATION);
+	REQUIRE(rect.page == 0);
+	REQUIRE(packer.get_page_class(1) == 1);
+	REQUIRE(events.resetPages == std::vector<uint32_t>{0, 1});
+
+	REQUIRE(packer.allocate(65, 16, 0, rect) == Text::AtlasPacker::INVALID_ALLOCATION);
+}
+
+TEST_CASE("LRU Page Eviction", "[AtlasPacker]") {
+	PackerEvents events;
+	auto packer = make_grid_packer(events, 2, 0);
+	Text::AtlasRect rect;
+	std::vector<uint32_t> page0;
+	std::vector<uint32_t> page1;
+
+	for (uint32_t i = 0; i < 16; ++i) {
+		page0.push_back(packer.allocate(16, 16, 0, rect));
+		REQUIRE(rect.page == 0);
+	}
+
+	packer.begin_frame();
+
+	for (uint32_t i = 0; i < 16; ++i) {
+		page1.push_back(packer.allocate(16, 16, 0, rect));
+		REQUIRE(rect.page == 1);
+	}
+
+	// Both pages were used this frame, so neither may be reclaimed
+	packer.touch(page0[3]);
+	REQUIRE(packer.allocate(16, 16, 0, rect) == Text::AtlasPacker::INVALID_ALLOCATION);
+
+	// Keep page 0 alive instead, leaving page 1 as the coldest
+	packer.begin_frame();
+	packer.touch(page0[3]);
+	REQUIRE(packer.get_last_use_frame(page0[3]) == 2);
+
+	auto id = packer.allocate(16, 16, 0, rect);
+	REQUIRE(id != Text::AtlasPacker::INVALID_ALLOCATION);
+	REQUIRE(rect.page == 1);
+	REQUIRE(events.evicted.size() == 16);
+	REQUIRE(events.resetPages == std::vector<uint32_t>{0, 1, 1});
+	REQUIRE(packer.get_allocation_count() == 17);
+
+	for (auto evictedID : events.evicted) {
+		REQUIRE(std::find(page1.begin(), page1.end(), evictedID) != page1.end());
+	}
+
+	REQUIRE(packer.get_rect(page0[3]).page == 0);
+}
+
+TEST_CASE("Idle Page Reuse", "[AtlasPacker]") {
+	PackerEvents events;
+	auto packer = make_grid_packer(events, 0, 3);
+	Text::AtlasRect rect;
+
+	for (uint32_t i = 0; i < 16; ++i) {
+		packer.allocate(16, 16, 0, rect);
+	}
+
+	packer.begin_frame();
+	packer.begin_frame();
+
+	// Page 0 has only been idle for 2 frames, so a new page is created
+	packer.allocate(16, 16, 1, rect);
+	REQUIRE(rect.page == 1);
+
+	packer.begin_frame();
+
+	for (uint32_t i = 1; i < 16; ++i) {
+		packer.allocate(16, 16, 1, rect);
+	}
+
+	// Page 0 has now been idle for 3 frames, and is reclaimed for the other class
+	packer.allocate(16, 16, 1, rect);
+	REQUIRE(rect.page == 0);
+	REQUIRE(packer.get_page_count() == 2);
+	REQUIRE(packer.get_page_class(0) == 1);
+	REQUIRE(events.evicted.size() == 16);
+
+	packer.clear();
+	REQUIRE(packer.get_allocation_count() == 0);
+	REQUIRE(events.evicted.size() == 33);
+	REQUIRE(packer.get_page_occupancy(0) == 0.f);
+}
+
+TEST_CASE("Full Atlas", "[AtlasPacker]") {
+	PackerEvents events;
+	auto packer = make_grid_packer(events, 4, 600);
+	Text::AtlasRect rect;
+
+	for (uint32_t i = 0; i < 4 * 16; ++i) {
+		REQUIRE(packer.allocate(16, 16, i % 2, rect) != Text::AtlasPacker::INVALID_ALLOCATION);
+	}
+
+	REQUIRE(packer.get_page_count() == 4);
+
+	// Every page was used this frame, so requests fail without disturbing existing allocations, however often
+	// they are repeated
+	for (uint32_t i = 0; i < 3; ++i) {
+		REQUIRE(packer.allocate(16, 16, 0, rect) == Text::AtlasPacker::INVALID_ALLOCATION);
+		REQUIRE(packer.allocate(16, 16, 1, rect) == Text::AtlasPacker::INVALID_ALLOCATION);
+	}
+
+	REQUIRE(packer.get_allocation_count() == 4 * 16);
+	REQUIRE(events.evicted.empty());
+
+	// A request retried in the next frame recycles a page
+	packer.begin_frame();
+	REQUIRE(packer.allocate(16, 16, 1, rect) != Text::AtlasPacker::INVALID_ALLOCATION);
+	REQUIRE(events.evicted.size() == 16);
+	REQUIRE(packer.get_allocation_count() == 3 * 16 + 1);
+}
+
+// Static Functions
+
+static void on_evict(uint32_t allocationID, void* pUserData) {
+	static_cast<PackerEvents*>(pUserData)->evicted.push_back(allocationID);
+}
+
+static void on_page_reset(uint32_t page, uint32_t, void* pUserData) {
+	static_cast<PackerEvents*>(pUserData)->resetPages.push_back(page);
+}
+
+static bool rects_overlap(const Text::AtlasRect& a, const Text::AtlasRect& b, uint32_t padding) {
+	return a.page == b.page && a.x < b.x + b.width + padding && b.x < a.x + a.width + padding
+			&& a.y < b.y + b.height + padding && b.y < a.y + a.height + padding;
+}
+
+static Text::AtlasPacker make_grid_packer(PackerEvents& events, uint32_t maxPageCount, uint32_t idleFrameLimit) {
+	// 64x64 pages without padding fit exactly 16 allocations of 16x16
+	return Text::AtlasPacker({
+		.pageWidth = 64,
+		.pageHeight = 64,
+		.padding = 0,
+		.maxPageCount = maxPageCount,
+		.idleFrameLimit = idleFrameLimit,
+		.pfnEvict = on_evict,
+		.pfnPageReset = on_page_reset,
+		.pUserData = &events,
+	});
+}
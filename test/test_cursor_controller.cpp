@@ -0,0 +1,194 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cursor_controller.hpp>
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+static uint32_t reference_next_word(const std::string& text, uint32_t position);
+static uint32_t reference_prev_word(const std::string& text, uint32_t position);
+
+TEST_CASE("Word Stops", "[CursorController]") {
+	Text::CursorController ctrl;
+	std::string text = "Hello, world  foo\r\n  bar\n\nbaz";
+	ctrl.set_text(text);
+
+	auto next = [&](uint32_t position) { return ctrl.next_word({position}).get_position(); };
+	auto prev = [&](uint32_t position) { return ctrl.prev_word({position}).get_position(); };
+
+	REQUIRE(next(0) == 5);
+	REQUIRE(next(5) == 7);
+	REQUIRE(next(7) == 14);
+	REQUIRE(next(14) == 17);
+	REQUIRE(next(17) == 21);
+	REQUIRE(next(21) == 24);
+	REQUIRE(next(24) == 25);
+	REQUIRE(next(25) == 26);
+	REQUIRE(next(26) == 29);
+	REQUIRE(next(29) == 29);
+
+	REQUIRE(prev(29) == 26);
+	REQUIRE(prev(26) == 25);
+	REQUIRE(prev(25) == 24);
+	REQUIRE(prev(24) == 21);
+	REQUIRE(prev(21) == 17);
+	REQUIRE(prev(19) == 17);
+	REQUIRE(prev(17) == 14);
+	REQUIRE(prev(16) == 14);
+	REQUIRE(prev(14) == 7);
+	REQUIRE(prev(7) == 5);
+	REQUIRE(prev(3) == 0);
+	REQUIRE(prev(0) == 0);
+
+	// Stops are recomputed for new text
+	text = "  one";
+	ctrl.set_text(text);
+	REQUIRE(next(0) == 2);
+	REQUIRE(prev(2) == 0);
+	REQUIRE(next(2) == 5);
+
+	text.clear();
+	ctrl.set_text(text);
+	REQUIRE(next(0) == 0);
+	REQUIRE(prev(0) == 0);
+}
+
+TEST_CASE("Punctuation Runs", "[CursorController]") {
+	Text::CursorController ctrl;
+	std::string text = "foo(); bar";
+	ctrl.set_text(text);
+
+	auto next = [&](uint32_t position) { return ctrl.next_word({position}).get_position(); };
+	auto prev = [&](uint32_t position) { return ctrl.prev_word({position}).get_position(); };
+
+	REQUIRE(next(0) == 3);
+	REQUIRE(next(3) == 7);
+	REQUIRE(next(7) == 10);
+
+	REQUIRE(prev(10) == 7);
+	REQUIRE(prev(7) == 3);
+	REQUIRE(prev(5) == 3);
+	REQUIRE(prev(3) == 0);
+
+	// A run longer than a cached span stays a single stop, whichever span is looked up first
+	text = "a" + std::string(200, '.') + " b";
+	ctrl.set_text(text);
+	REQUIRE(prev(150) == 1);
+	REQUIRE(next(0) == 1);
+	REQUIRE(next(1) == 202);
+	REQUIRE(prev(202) == 1);
+
+	ctrl.set_text(text);
+	REQUIRE(next(100) == 202);
+	REQUIRE(prev(100) == 1);
+}
+
+TEST_CASE("Whitespace Separated Words", "[CursorController]") {
+	static constexpr const char* pieces[] = {"a", "word", " ", "  ", "\n", "\r\n", "été", "\u2029"};
+
+	std::default_random_engine rng(4321);
+	std::uniform_int_distribution<size_t> distPiece(0, std::size(pieces) - 1);
+
+	Text::CursorController ctrl;
+	std::string text;
+	std::vector<uint32_t> positions;
+
+	for (int i = 0; i < 20; ++i) {
+		text.clear();
+
+		for (int j = 0; j < 300; ++j) {
+			text.append(pieces[distPiece(rng)]);
+		}
+
+		ctrl.set_text(text);
+
+		// Visit offsets out of order, so that cached spans are filled in around earlier ones
+		positions.resize(text.size() + 1);
+		std::iota(positions.begin(), positions.end(), 0u);
+		std::shuffle(positions.begin(), positions.end(), rng);
+
+		for (auto position : positions) {
+			// Skip offsets inside code points and CRLFs
+			if ((position < text.size() && (static_cast<uint8_t>(text[position]) & 0xC0) == 0x80)
+					|| (position > 0 && text[position - 1] == '\r' && text[position] == '\n')) {
+				continue;
+			}
+
+			REQUIRE(ctrl.next_word({position}).get_position() == reference_next_word(text, position));
+			REQUIRE(ctrl.prev_word({position}).get_position() == reference_prev_word(text, position));
+		}
+	}
+}
+
+// Static Functions
+
+static bool is_break(const std::string& text, uint32_t position) {
+	return text[position] == '\n' || text[position] == '\r' || text.compare(position, 3, "\u2029") == 0;
+}
+
+static bool is_space(const std::string& text, uint32_t position) {
+	return text[position] == ' ' || is_break(text, position);
+}
+
+// Skips to the start of the next code point, keeping CRLF together
+static uint32_t next_code_point(const std::string& text, uint32_t position) {
+	if (text.compare(position, 2, "\r\n") == 0) {
+		return position + 2;
+	}
+
+	do {
+		++position;
+	}
+	while (position < text.size() && (static_cast<uint8_t>(text[position]) & 0xC0) == 0x80);
+
+	return position;
+}
+
+static uint32_t reference_next_word(const std::string& text, uint32_t position) {
+	if (position == text.size()) {
+		return position;
+	}
+
+	bool lastSpace = is_space(text, position);
+
+	while ((position = next_code_point(text, position)) < text.size()) {
+		bool space = is_space(text, position);
+
+		if ((!space && lastSpace) || is_break(text, position)) {
+			break;
+		}
+
+		lastSpace = space;
+	}
+
+	return position;
+}
+
+static uint32_t reference_prev_word(const std::string& text, uint32_t position) {
+	uint32_t result = position;
+	bool lastSpace = true;
+
+	for (uint32_t i = position; i-- > 0;) {
+		if ((static_cast<uint8_t>(text[i]) & 0xC0) == 0x80 || (text[i] == '\n' && i > 0 && text[i - 1] == '\r')) {
+			continue;
+		}
+
+		bool space = is_space(text, i);
+
+		if (space && !lastSpace) {
+			break;
+		}
+
+		if (is_break(text, i)) {
+			return i;
+		}
+
+		result = i;
+		lastSpace = space;
+	}
+
+	return result;
+}
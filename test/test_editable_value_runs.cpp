@@ -0,0 +1,188 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <editable_value_runs.hpp>
+#include <value_run_utils.hpp>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+template <typename T>
+static void require_matches_model(const Text::EditableValueRuns<T>& runs, const std::vector<T>& model);
+
+TEST_CASE("Editing", "[EditableValueRuns]") {
+	Text::EditableValueRuns<int> runs(1, 10);
+	runs.set_value(3, 4, 2);
+	REQUIRE(runs.get_run_count() == 3);
+	REQUIRE(runs.get_run_limit(0) == 3);
+	REQUIRE(runs.get_run_limit(1) == 7);
+	REQUIRE(runs.get_limit() == 10);
+
+	// Typing extends the run before the cursor
+	runs.insert(7, 5);
+	REQUIRE(runs.get_run_limit(1) == 12);
+	REQUIRE(runs.get_limit() == 15);
+
+	runs.insert(0, 2);
+	REQUIRE(runs.get_run_limit(0) == 5);
+
+	// Runs with equal values are merged across an edit
+	runs.erase(5, 9);
+	REQUIRE(runs.get_run_count() == 1);
+	REQUIRE(runs.get_limit() == 8);
+	REQUIRE(runs.get_value(7) == 1);
+
+	runs.insert(8, 3, 4);
+	REQUIRE(runs.get_run_count() == 2);
+	REQUIRE(runs.get_run_containing_index(8) == 1);
+	REQUIRE(runs.get_run_containing_index(11) == 2);
+
+	runs.set_value(0, 11, 4);
+	REQUIRE(runs.get_run_count() == 1);
+
+	runs.erase(0, 11);
+	REQUIRE(runs.empty());
+}
+
+TEST_CASE("Move", "[EditableValueRuns]") {
+	Text::EditableValueRuns<int> source(1, 10);
+	source.set_value(3, 4, 2);
+
+	auto runs = std::move(source);
+	require_matches_model(runs, {1, 1, 1, 2, 2, 2, 2, 1, 1, 1});
+
+	// The moved-from runs are empty and can be edited again
+	REQUIRE(source.empty());
+	REQUIRE(source.get_run_count() == 0);
+	source.insert(0, 3, 5);
+	require_matches_model(source, {5, 5, 5});
+
+	runs = std::move(source);
+	require_matches_model(runs, {5, 5, 5});
+	REQUIRE(source.empty());
+	source.add(2, 7);
+	require_matches_model(source, {7, 7});
+}
+
+TEST_CASE("Random Edits", "[EditableValueRuns]") {
+	std::default_random_engine rng(1234);
+	std::uniform_int_distribution<int> distValue(0, 3);
+	std::uniform_int_distribution<int> distOp(0, 3);
+
+	Text::EditableValueRuns<int> runs(0, 64);
+	std::vector<int> model(64, 0);
+
+	for (size_t i = 0; i < 2000; ++i) {
+		auto size = static_cast<int32_t>(model.size());
+		auto index = std::uniform_int_distribution<int32_t>(0, size)(rng);
+		auto length = std::uniform_int_distribution<int32_t>(0, 20)(rng);
+		auto value = distValue(rng);
+
+		switch (distOp(rng)) {
+			case 0:
+				if (size > 0) {
+					auto extendedValue = model[std::clamp(index - 1, 0, size - 1)];
+					model.insert(model.begin() + index, length, extendedValue);
+					runs.insert(index, length);
+				}
+				break;
+			case 1:
+				model.insert(model.begin() + index, length, value);
+				runs.insert(index, length, value);
+				break;
+			case 2:
+				length = std::min(length, size - index);
+				model.erase(model.begin() + index, model.begin() + index + length);
+				runs.erase(index, length);
+				break;
+			default:
+				length = std::min(length, size - index);
+				std::fill(model.begin() + index, model.begin() + index + length, value);
+				runs.set_value(index, length, value);
+				break;
+		}
+
+		require_matches_model(runs, model);
+	}
+}
+
+TEST_CASE("Run Intersections", "[EditableValueRuns]") {
+	Text::ValueRuns<bool> flatRuns(false, 4);
+	flatRuns.add(12, true);
+	flatRuns.add(20, false);
+
+	Text::EditableValueRuns<int> runs(1, 20);
+	runs.set_value(2, 8, 2);
+	runs.erase(0, 1);
+	runs.insert(0, 1);
+
+	std::vector<int32_t> limits;
+	std::vector<int> values;
+
+	Text::iterate_run_intersections([&](int32_t limit, bool flag, int value) {
+		limits.emplace_back(limit);
+		values.emplace_back(value * 10 + flag);
+	}, flatRuns, runs);
+
+	REQUIRE(limits == std::vector<int32_t>{2, 4, 10, 12, 20});
+	REQUIRE(values == std::vector<int>{10, 20, 21, 11, 10});
+
+	limits.clear();
+	values.clear();
+
+	Text::ValueRunsIterator itFlat(flatRuns);
+	Text::ValueRunsIterator itRuns(runs);
+	Text::iterate_run_intersections(0, 20, [&](int32_t limit, bool flag, int value) {
+		limits.emplace_back(limit);
+		values.emplace_back(value * 10 + flag);
+	}, itFlat, itRuns);
+
+	REQUIRE(limits == std::vector<int32_t>{2, 4, 10, 12, 20});
+	REQUIRE(values == std::vector<int>{10, 20, 21, 11, 10});
+}
+
+// Static Functions
+
+template <typename T>
+static void require_matches_model(const Text::EditableValueRuns<T>& runs, const std::vector<T>& model) {
+	REQUIRE(runs.get_limit() == static_cast<int32_t>(model.size()));
+
+	if (model.empty()) {
+		REQUIRE(runs.empty());
+		return;
+	}
+
+	// Runs are maximal: each ends where the value changes
+	std::vector<int32_t> expectedLimits;
+	std::vector<int32_t> limits;
+	std::vector<T> expectedValues;
+	std::vector<T> values;
+
+	for (size_t i = 0; i < model.size(); ++i) {
+		if (i + 1 == model.size() || model[i] != model[i + 1]) {
+			expectedLimits.emplace_back(static_cast<int32_t>(i + 1));
+			expectedValues.emplace_back(model[i]);
+		}
+	}
+
+	for (size_t i = 0; i < runs.get_run_count(); ++i) {
+		limits.emplace_back(runs.get_run_limit(i));
+		values.emplace_back(runs.get_run_value(i));
+	}
+
+	REQUIRE(limits == expectedLimits);
+	REQUIRE(values == expectedValues);
+
+	std::vector<T> iteratedValues;
+	std::vector<T> pointValues;
+	Text::ValueRunsIterator it(runs);
+
+	for (size_t i = 0; i < model.size(); ++i) {
+		it.advance_to(static_cast<int32_t>(i));
+		iteratedValues.emplace_back(it.get_value());
+		pointValues.emplace_back(runs.get_value(static_cast<int32_t>(i)));
+	}
+
+	REQUIRE(iteratedValues == model);
+	REQUIRE(pointValues == model);
+}
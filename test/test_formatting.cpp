@@ -0,0 +1,180 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <formatting.hpp>
+
+#include <string>
+
+static constexpr const Text::Color BASE_COLOR{0.f, 0.f, 0.f, 1.f};
+
+static Text::Font get_base_font();
+template <typename T>
+static void require_same_runs(const Text::ValueRuns<T>& runs, const Text::ValueRuns<T>& expected);
+
+TEST_CASE("Plain Text", "[FormattingParser]") {
+	std::string text = "No tags & no entities here";
+	Text::FormattingParser parser;
+	Text::FormattingRuns runs;
+
+	// Text without tags is returned as is rather than copied
+	auto contentText = parser.parse(text, runs, get_base_font(), BASE_COLOR, {});
+	REQUIRE(contentText.data() == text.data());
+	REQUIRE(contentText.size() == text.size());
+	REQUIRE(!parser.has_error());
+
+	REQUIRE(runs.fontRuns.get_run_count() == 1);
+	REQUIRE(runs.fontRuns.get_limit() == static_cast<int32_t>(text.size()));
+	REQUIRE(runs.underlineRuns.get_run_count() == 1);
+	REQUIRE(!runs.underlineRuns.get_run_value(0));
+}
+
+TEST_CASE("Nested Tags", "[FormattingParser]") {
+	std::string text = "a<u>bc<font size=\"20\" color=\"#FF0000\">de</font></u><!-- comment -->f"
+			"<stroke thickness=\"3\" joins=\"bevel\">g</stroke>";
+	Text::FormattingParser parser;
+	Text::FormattingRuns runs;
+
+	auto contentText = parser.parse(text, runs, get_base_font(), BASE_COLOR, {});
+	REQUIRE(!parser.has_error());
+	REQUIRE(contentText == "abcdefg");
+
+	REQUIRE(runs.underlineRuns.get_run_count() == 3);
+	REQUIRE(runs.underlineRuns.get_run_limit(0) == 1);
+	REQUIRE(runs.underlineRuns.get_run_limit(1) == 5);
+	REQUIRE(runs.underlineRuns.get_run_value(1));
+	REQUIRE(runs.underlineRuns.get_limit() == 7);
+
+	REQUIRE(runs.fontRuns.get_run_count() == 3);
+	REQUIRE(runs.fontRuns.get_run_limit(1) == 5);
+	REQUIRE(runs.fontRuns.get_run_value(1).get_size() == 20);
+	REQUIRE(runs.fontRuns.get_run_value(2).get_size() == get_base_font().get_size());
+
+	REQUIRE(runs.colorRuns.get_run_count() == 3);
+	REQUIRE(runs.colorRuns.get_run_value(1).r == 1.f);
+
+	REQUIRE(runs.strokeRuns.get_run_count() == 2);
+	REQUIRE(runs.strokeRuns.get_run_limit(0) == 6);
+	REQUIRE(runs.strokeRuns.get_run_value(1).thickness == 3);
+	REQUIRE(runs.strokeRuns.get_run_value(1).joins == Text::StrokeType::BEVEL);
+}
+
+TEST_CASE("Malformed Markup", "[FormattingParser]") {
+	Text::FormattingParser parser;
+	Text::FormattingRuns runs;
+
+	for (std::string text : {"<u>unclosed", "</i>", "<i>mismatched</u>", "trailing <",
+			"<font color=\"#12\">x</font>"}) {
+		auto contentText = parser.parse(text, runs, get_base_font(), BASE_COLOR, {});
+		REQUIRE(parser.has_error());
+		REQUIRE(contentText == text);
+		REQUIRE(runs.fontRuns.get_run_count() == 1);
+		REQUIRE(runs.underlineRuns.get_run_count() == 1);
+		REQUIRE(runs.underlineRuns.get_limit() == static_cast<int32_t>(text.size()));
+	}
+}
+
+TEST_CASE("Parser Reuse", "[FormattingParser]") {
+	Text::FormattingParser parser;
+	Text::FormattingRuns reusedRuns;
+
+	for (std::string text : {"<i>x</i>yz", "<s>a</s><sub>b", "w<sub>x</sub><super>y</super>z", "plain",
+			"<u>u</u>"}) {
+		std::string contentText;
+		auto freshRuns = Text::parse_inline_formatting(text, contentText, get_base_font(), BASE_COLOR, {});
+		auto reusedContentText = parser.parse(text, reusedRuns, get_base_font(), BASE_COLOR, {});
+
+		REQUIRE(reusedContentText == contentText);
+		REQUIRE(reusedRuns.fontRuns.get_run_count() == freshRuns.fontRuns.get_run_count());
+		REQUIRE(reusedRuns.strikethroughRuns.get_run_count() == freshRuns.strikethroughRuns.get_run_count());
+		REQUIRE(reusedRuns.subscriptRuns.get_run_count() == freshRuns.subscriptRuns.get_run_count());
+		REQUIRE(reusedRuns.superscriptRuns.get_run_count() == freshRuns.superscriptRuns.get_run_count());
+		REQUIRE(reusedRuns.underlineRuns.get_run_count() == freshRuns.underlineRuns.get_run_count());
+
+		for (size_t i = 0; i < freshRuns.fontRuns.get_run_count(); ++i) {
+			REQUIRE(reusedRuns.fontRuns.get_run_limit(i) == freshRuns.fontRuns.get_run_limit(i));
+			REQUIRE(reusedRuns.fontRuns.get_run_value(i).get_style()
+					== freshRuns.fontRuns.get_run_value(i).get_style());
+		}
+	}
+}
+
+TEST_CASE("Incremental Reparse", "[FormattingParser]") {
+	std::string text = "ab<i>cd<u>ef</u></i>gh<s>ij</s>kl";
+	Text::FormattingParser parser;
+	std::string contentText;
+	Text::FormattingRuns runs;
+	Text::FormattingSourceMap sourceMap;
+
+	parser.parse(text, contentText, runs, sourceMap, get_base_font(), BASE_COLOR, {});
+	REQUIRE(sourceMap.valid);
+	REQUIRE(sourceMap.elements.size() == 2);
+
+	auto apply_edit = [&](uint32_t start, uint32_t removedLength, std::string_view insertedText) {
+		text.replace(start, removedLength, insertedText);
+		parser.reparse(text, {start, removedLength, static_cast<uint32_t>(insertedText.size())}, contentText, runs,
+				sourceMap, get_base_font(), BASE_COLOR, {});
+
+		Text::FormattingParser fullParser;
+		std::string expectedContentText;
+		Text::FormattingRuns expectedRuns;
+		Text::FormattingSourceMap expectedSourceMap;
+		fullParser.parse(text, expectedContentText, expectedRuns, expectedSourceMap, get_base_font(), BASE_COLOR,
+				{});
+
+		REQUIRE(contentText == expectedContentText);
+		REQUIRE(sourceMap.valid == expectedSourceMap.valid);
+		REQUIRE(sourceMap.elements.size() == expectedSourceMap.elements.size());
+
+		require_same_runs(runs.fontRuns, expectedRuns.fontRuns);
+		require_same_runs(runs.colorRuns, expectedRuns.colorRuns);
+		require_same_runs(runs.strokeRuns, expectedRuns.strokeRuns);
+		require_same_runs(runs.strikethroughRuns, expectedRuns.strikethroughRuns);
+		require_same_runs(runs.underlineRuns, expectedRuns.underlineRuns);
+		require_same_runs(runs.smallcapsRuns, expectedRuns.smallcapsRuns);
+		require_same_runs(runs.subscriptRuns, expectedRuns.subscriptRuns);
+		require_same_runs(runs.superscriptRuns, expectedRuns.superscriptRuns);
+	};
+
+	// Typing between tags
+	apply_edit(1, 0, "X");
+	REQUIRE(contentText == "aXbcdefghijkl");
+
+	// Typing inside nested tags shifts everything after it
+	apply_edit(12, 0, "YZ");
+	REQUIRE(contentText == "aXbcdeYZfghijkl");
+	REQUIRE(runs.strikethroughRuns.get_run_limit(1) == 13);
+
+	// Deleting a whole tag
+	apply_edit(25, 9, "");
+	REQUIRE(contentText == "aXbcdeYZfghkl");
+	REQUIRE(sourceMap.elements.size() == 1);
+
+	// Breaking a tag falls back to plain text, and fixing it again restores the formatting
+	apply_edit(3, 1, "");
+	REQUIRE(!sourceMap.valid);
+	REQUIRE(contentText == text);
+
+	apply_edit(3, 0, "<");
+	REQUIRE(sourceMap.valid);
+
+	// Inserting and removing a whole tag
+	apply_edit(0, 0, "<u>new</u>");
+	REQUIRE(contentText == "newaXbcdeYZfghkl");
+	apply_edit(0, 10, "");
+	REQUIRE(contentText == "aXbcdeYZfghkl");
+}
+
+// Static Functions
+
+static Text::Font get_base_font() {
+	return Text::Font(Text::FontFamily{}, Text::FontWeight::REGULAR, Text::FontStyle::NORMAL, 16);
+}
+
+template <typename T>
+static void require_same_runs(const Text::ValueRuns<T>& runs, const Text::ValueRuns<T>& expected) {
+	REQUIRE(runs.get_run_count() == expected.get_run_count());
+
+	for (size_t i = 0; i < expected.get_run_count(); ++i) {
+		REQUIRE(runs.get_run_limit(i) == expected.get_run_limit(i));
+		REQUIRE(runs.get_run_value(i) == expected.get_run_value(i));
+	}
+}
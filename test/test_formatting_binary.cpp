@@ -0,0 +1,158 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <font_registry.hpp>
+#include <formatting_binary.hpp>
+
+#include <string>
+#include <vector>
+
+static constexpr const Text::Color BASE_COLOR{0.f, 0.f, 0.f, 1.f};
+
+static Text::FontFamily get_test_family();
+
+template <typename T>
+static void require_equal_runs(const Text::ValueRuns<T>& a, const Text::ValueRuns<T>& b);
+static void require_equal_formatting(const Text::FormattingRuns& a, const Text::FormattingRuns& b);
+
+TEST_CASE("Round Trip", "[FormattingBinary]") {
+	auto baseFont = Text::Font(get_test_family(), Text::FontWeight::REGULAR, Text::FontStyle::NORMAL, 16);
+	const char* sources[] = {
+		"Plain text",
+		"",
+		"<font weight=\"bold\">Bold</font> and <i>italic <font size=\"24\" color=\"#FF8800\">large</font></i>",
+		"<u>under</u><s>strike</s><sc>caps</sc><sub>sub</sub><super>super</super>",
+		"<stroke thickness=\"2\" color=\"#102030\" joins=\"miter\">stroked</stroke> text",
+	};
+
+	Text::FormattingWriter writer;
+	std::vector<std::string> contentTexts;
+	std::vector<Text::FormattingRuns> expectedRuns;
+
+	for (auto* source : sources) {
+		auto& contentText = contentTexts.emplace_back();
+		auto& runs = expectedRuns.emplace_back(Text::parse_inline_formatting(source, contentText, baseFont,
+				BASE_COLOR, {}));
+		writer.write(contentText, runs);
+	}
+
+	// The mixed source must actually parse into several fonts for the font table to be exercised
+	REQUIRE(expectedRuns[2].fontRuns.get_run_count() > 1);
+
+	std::vector<std::byte> data(writer.get_data().begin(), writer.get_data().end());
+	Text::FormattingReader reader(data);
+	Text::FormattingRuns runs;
+	std::string_view contentText;
+	size_t recordCount{};
+
+	while (reader.read(contentText, runs)) {
+		REQUIRE(recordCount < std::size(sources));
+		REQUIRE(contentText == contentTexts[recordCount]);
+		require_equal_formatting(runs, expectedRuns[recordCount]);
+		++recordCount;
+	}
+
+	REQUIRE(!reader.has_error());
+	REQUIRE(recordCount == std::size(sources));
+
+	// Fonts are stored by name, so the family resolves to the same handle
+	reader = Text::FormattingReader(data);
+	REQUIRE(reader.read(contentText, runs));
+	REQUIRE(runs.fontRuns.get_run_value(0).get_family() == get_test_family());
+}
+
+TEST_CASE("Empty Runs", "[FormattingBinary]") {
+	Text::FormattingWriter writer;
+	writer.write("", Text::FormattingRuns{});
+	writer.write("", Text::FormattingRuns{});
+
+	std::vector<std::byte> data(writer.get_data().begin(), writer.get_data().end());
+	Text::FormattingReader reader(data);
+	// Runs left over from an earlier record are replaced
+	std::string contentText;
+	auto runs = Text::parse_inline_formatting("<u>abc</u>", contentText, {}, BASE_COLOR, {});
+	std::string_view readText;
+
+	for (int i = 0; i < 2; ++i) {
+		REQUIRE(reader.read(readText, runs));
+		REQUIRE(readText.empty());
+		require_equal_formatting(runs, Text::FormattingRuns{});
+	}
+
+	REQUIRE(!reader.read(readText, runs));
+	REQUIRE(!reader.has_error());
+
+	// Empty runs over text that is not empty are rejected
+	writer.clear();
+	writer.write("abc", Text::FormattingRuns{});
+	data.assign(writer.get_data().begin(), writer.get_data().end());
+	reader = Text::FormattingReader(data);
+	REQUIRE(!reader.read(readText, runs));
+	REQUIRE(reader.has_error());
+}
+
+TEST_CASE("Malformed Data", "[FormattingBinary]") {
+	std::string contentText;
+	auto formatting = Text::parse_inline_formatting("<u>abc</u>def", contentText, {}, BASE_COLOR, {});
+
+	Text::FormattingWriter writer;
+	writer.write(contentText, formatting);
+	std::vector<std::byte> data(writer.get_data().begin(), writer.get_data().end());
+
+	Text::FormattingRuns runs;
+	std::string_view readText;
+
+	// Every truncation fails without reading out of bounds
+	for (size_t size = 0; size < data.size(); ++size) {
+		Text::FormattingReader reader(std::span(data.data(), size));
+		REQUIRE(!reader.read(readText, runs));
+		REQUIRE((reader.has_error() || size == 8));
+	}
+
+	// Corrupt header
+	data[0] = std::byte{0};
+	Text::FormattingReader reader(data);
+	REQUIRE(reader.has_error());
+	REQUIRE(!reader.read(readText, runs));
+}
+
+// Static Functions
+
+static Text::FontFamily get_test_family() {
+	static const std::byte fontData[4]{};
+	static const Text::FontFaceCreateInfo faceInfo{
+		.name = "Formatting Binary Test",
+		.data = fontData,
+		.weight = Text::FontWeight::REGULAR,
+		.style = Text::FontStyle::NORMAL,
+	};
+	static const auto registered = Text::FontRegistry::register_family({
+		.name = "Formatting Binary Test",
+		.pFaces = &faceInfo,
+		.faceCount = 1,
+	});
+
+	(void)registered;
+	return Text::FontRegistry::get_family("Formatting Binary Test");
+}
+
+template <typename T>
+static void require_equal_runs(const Text::ValueRuns<T>& a, const Text::ValueRuns<T>& b) {
+	REQUIRE(a.get_run_count() == b.get_run_count());
+
+	for (size_t i = 0; i < a.get_run_count(); ++i) {
+		REQUIRE(a.get_run_limit(i) == b.get_run_limit(i));
+		REQUIRE(a.get_run_value(i) == b.get_run_value(i));
+	}
+}
+
+static void require_equal_formatting(const Text::FormattingRuns& a, const Text::FormattingRuns& b) {
+	require_equal_runs(a.fontRuns, b.fontRuns);
+	require_equal_runs(a.colorRuns, b.colorRuns);
+	require_equal_runs(a.strokeRuns, b.strokeRuns);
+	require_equal_runs(a.strikethroughRuns, b.strikethroughRuns);
+	require_equal_runs(a.underlineRuns, b.underlineRuns);
+	require_equal_runs(a.smallcapsRuns, b.smallcapsRuns);
+	require_equal_runs(a.subscriptRuns, b.subscriptRuns);
+	require_equal_runs(a.superscriptRuns, b.superscriptRuns);
+}
+
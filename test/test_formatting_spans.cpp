@@ -0,0 +1,167 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "test_layout_helpers.hpp"
+
+#include <layout_info.hpp>
+#include <text_draw_util.hpp>
+
+#include <algorithm>
+#include <random>
+#include <tuple>
+#include <vector>
+
+static constexpr const uint32_t LINE_COUNT = 50;
+static constexpr const uint32_t RUNS_PER_LINE = 3;
+static constexpr const uint32_t GLYPHS_PER_RUN = 12;
+static constexpr const float GLYPH_ADVANCE = 10.f;
+static constexpr const float TEXT_AREA_WIDTH = 400.f;
+
+namespace {
+
+struct DrawCall {
+	uint32_t glyphID;
+	float x;
+	float y;
+	float width;
+	float height;
+	Text::Color color;
+	uint8_t strokeThickness;
+
+	bool operator==(const DrawCall&) const = default;
+	auto operator<=>(const DrawCall& other) const {
+		return std::make_tuple(x, y, width, height, Text::Color::to_rgba(color)) <=> std::make_tuple(other.x,
+				other.y, other.width, other.height, Text::Color::to_rgba(other.color));
+	}
+};
+
+struct DrawCalls {
+	std::vector<DrawCall> glyphs;
+	std::vector<DrawCall> decorations;
+	std::vector<size_t> runs;
+};
+
+}
+
+static Text::LayoutInfo make_test_layout();
+static Text::FormattingRuns make_test_formatting(int32_t limit);
+
+template <typename Formatting>
+static DrawCalls record_draw_calls(const Text::LayoutInfo& layout, const Formatting& formatting);
+
+TEST_CASE("Matches Formatting Runs", "[FormattingSpans]") {
+	auto layout = make_test_layout();
+	auto formatting = make_test_formatting(LINE_COUNT * (RUNS_PER_LINE * GLYPHS_PER_RUN + 1));
+
+	Text::FormattingSpans spans;
+	spans.build(layout, formatting);
+	REQUIRE(!spans.empty());
+
+	auto expected = record_draw_calls(layout, formatting);
+	auto result = record_draw_calls(layout, spans);
+
+	REQUIRE(!expected.decorations.empty());
+	REQUIRE(result.runs == expected.runs);
+	REQUIRE(result.glyphs == expected.glyphs);
+	REQUIRE(result.decorations == expected.decorations);
+
+	// Rebuilding from the compact form produces the same spans
+	Text::CompactFormattingRuns compactFormatting;
+	REQUIRE(Text::make_compact_formatting_runs(formatting, compactFormatting));
+	spans.build(layout, compactFormatting);
+
+	auto compactResult = record_draw_calls(layout, spans);
+	REQUIRE(compactResult.glyphs == expected.glyphs);
+	REQUIRE(compactResult.decorations == expected.decorations);
+
+	spans.clear();
+	REQUIRE(spans.empty());
+}
+
+// Static Functions
+
+static Text::LayoutInfo make_test_layout() {
+	uint32_t glyphID{};
+
+	// Every other run is right-to-left, with its characters in reverse visual order
+	return build_test_layout({
+		.lineCount = LINE_COUNT,
+		.glyphsPerRun = GLYPHS_PER_RUN,
+		.glyphAdvance = GLYPH_ADVANCE,
+		.metrics = {
+			.ascent = 16.f,
+			.descent = 4.f,
+			.underlinePosition = 2.f,
+			.underlineThickness = 1.f,
+			.strikethroughPosition = -5.f,
+			.strikethroughThickness = 1.f,
+		},
+	}, [](auto) { return RUNS_PER_LINE; }, [&](auto, auto, auto) { return glyphID++; },
+			[](auto line, auto run) { return (line + run) % 2 == 1; });
+}
+
+static Text::FormattingRuns make_test_formatting(int32_t limit) {
+	static constexpr const Text::Color colors[] = {{0.f, 0.f, 0.f, 1.f}, {1.f, 0.f, 0.f, 1.f},
+			{0.f, 0.5f, 1.f, 1.f}};
+
+	std::default_random_engine rng(5678);
+	std::uniform_int_distribution<int32_t> distLength(1, 9);
+	std::uniform_int_distribution<size_t> distColor(0, std::size(colors) - 1);
+	std::bernoulli_distribution distFlag(0.4);
+
+	Text::FormattingRuns result{
+		.fontRuns{Text::Font{}, limit},
+		.smallcapsRuns{false, limit},
+		.subscriptRuns{false, limit},
+		.superscriptRuns{false, limit},
+	};
+
+	for (int32_t i = 0; i < limit;) {
+		auto end = std::min(limit, i + distLength(rng));
+		result.colorRuns.add(end, colors[distColor(rng)]);
+		result.strokeRuns.add(end, Text::StrokeState{
+			.color = {0.f, 0.f, 0.f, distFlag(rng) ? 1.f : 0.f},
+			.thickness = 2,
+			.joins = Text::StrokeType::ROUND,
+		});
+		result.strikethroughRuns.add(end, distFlag(rng));
+		result.underlineRuns.add(end, distFlag(rng));
+		i = end;
+	}
+
+	return result;
+}
+
+template <typename Formatting>
+static DrawCalls record_draw_calls(const Text::LayoutInfo& layout, const Formatting& formatting) {
+	DrawCalls result;
+
+	Text::draw_text(layout, formatting, TEXT_AREA_WIDTH, Text::XAlignment::CENTER, [&]<typename... Args>(
+			const Args&... args) {
+		auto tup = std::tie(args...);
+
+		if constexpr (sizeof...(Args) == 2) {
+			result.runs.emplace_back(std::get<1>(tup));
+		}
+		else if constexpr (sizeof...(Args) == 5 && std::is_same_v<std::tuple_element_t<4,
+				std::tuple<Args...>>, Text::StrokeState>) {
+			auto& stroke = std::get<4>(tup);
+			result.glyphs.push_back({std::get<1>(tup), std::get<2>(tup), std::get<3>(tup), 0.f, 0.f,
+					stroke.color, stroke.thickness});
+		}
+		else if constexpr (sizeof...(Args) == 5 && std::is_same_v<std::tuple_element_t<0,
+				std::tuple<Args...>>, Text::SingleScriptFont>) {
+			result.glyphs.push_back({std::get<1>(tup), std::get<2>(tup), std::get<3>(tup), 0.f, 0.f,
+					std::get<4>(tup), 0});
+		}
+		else {
+			result.decorations.push_back({0, std::get<0>(tup), std::get<1>(tup), std::get<2>(tup),
+					std::get<3>(tup), std::get<4>(tup), 0});
+		}
+	});
+
+	// Spans visit each run's decorations after its glyphs, so only the set of decorations is compared
+	std::sort(result.decorations.begin(), result.decorations.end());
+
+	return result;
+}
+
@@ -0,0 +1,211 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "test_layout_helpers.hpp"
+
+#include <glyph_cache.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+static constexpr const uint32_t THREAD_COUNT = 8;
+static constexpr const uint32_t GLYPH_COUNT = 64;
+
+static void rasterize_slowly(const Text::SingleScriptFont& font, const Text::GlyphCacheKey& key,
+		Text::GlyphBitmap& bitmap, void* pUserData);
+static void rasterize_failing_once(const Text::SingleScriptFont& font, const Text::GlyphCacheKey& key,
+		Text::GlyphBitmap& bitmap, void* pUserData);
+static Text::SingleScriptFont make_test_font(uint32_t size);
+
+TEST_CASE("Hits and Keys", "[GlyphCache]") {
+	std::atomic<uint32_t> rasterizeCount{};
+	Text::GlyphCache cache({
+		.byteBudget = 1 << 20,
+		.shardCount = 4,
+		.pfnRasterize = rasterize_slowly,
+		.pRasterizeUserData = &rasterizeCount,
+	});
+
+	auto font = make_test_font(16);
+	auto glyph = cache.get_glyph(font, 5);
+
+	REQUIRE(rasterizeCount == 1);
+	REQUIRE(glyph->width == 5);
+	REQUIRE(glyph->format == Text::FontRasterFormat::R8);
+	REQUIRE(glyph->pData[0] == std::byte{get_test_coverage(5, 0, 0)});
+
+	REQUIRE(cache.get_glyph(font, 5) == glyph);
+	REQUIRE(cache.find(Text::GlyphCacheKey::make(font, 5)) == glyph);
+	REQUIRE(rasterizeCount == 1);
+
+	// Strokes and sizes are cached separately from the fill glyph
+	auto stroke = cache.get_stroke(font, 5, 2, Text::StrokeType::ROUND);
+	REQUIRE(stroke != glyph);
+	REQUIRE(stroke->width == 5 + 4);
+	REQUIRE(cache.get_stroke(font, 5, 2, Text::StrokeType::MITER) != stroke);
+	REQUIRE(cache.get_glyph(make_test_font(24), 5) != glyph);
+	REQUIRE(rasterizeCount == 4);
+	REQUIRE(cache.get_entry_count() == 4);
+
+	// Glyph 0 rasterizes to nothing, which is cached like any other glyph
+	REQUIRE(cache.get_glyph(font, 0)->empty());
+	REQUIRE(cache.get_glyph(font, 0)->empty());
+	REQUIRE(rasterizeCount == 5);
+
+	cache.clear();
+	REQUIRE(cache.get_entry_count() == 0);
+	REQUIRE(cache.get_byte_size() == 0);
+	REQUIRE(cache.find(Text::GlyphCacheKey::make(font, 5)) == nullptr);
+
+	// Bitmaps held by the caller outlive the cache entry
+	REQUIRE(glyph->pData[glyph->get_byte_size() - 1] == std::byte{get_test_coverage(5, 4, 5)});
+}
+
+TEST_CASE("LRU Eviction", "[GlyphCache]") {
+	std::atomic<uint32_t> rasterizeCount{};
+
+	// The same glyph at different sizes, so that every entry costs the same
+	Text::GlyphCache probe({
+		.byteBudget = 1 << 20,
+		.shardCount = 1,
+		.pfnRasterize = rasterize_slowly,
+		.pRasterizeUserData = &rasterizeCount,
+	});
+	(void)probe.get_glyph(make_test_font(16), 5);
+	auto entryCost = probe.get_byte_size();
+
+	// Room for exactly 4 glyphs
+	Text::GlyphCache cache({
+		.byteBudget = 4 * entryCost,
+		.shardCount = 1,
+		.pfnRasterize = rasterize_slowly,
+		.pRasterizeUserData = &rasterizeCount,
+	});
+
+	for (uint32_t i = 1; i <= 4; ++i) {
+		(void)cache.get_glyph(make_test_font(16 + i), 5);
+	}
+
+	REQUIRE(cache.get_entry_count() == 4);
+
+	// Touch size 17 so that size 18 becomes the least recently used
+	(void)cache.get_glyph(make_test_font(17), 5);
+	(void)cache.get_glyph(make_test_font(21), 5);
+
+	REQUIRE(cache.get_entry_count() == 4);
+	REQUIRE(cache.get_byte_size() <= 4 * entryCost);
+	REQUIRE(cache.find(Text::GlyphCacheKey::make(make_test_font(17), 5)) != nullptr);
+	REQUIRE(cache.find(Text::GlyphCacheKey::make(make_test_font(18), 5)) == nullptr);
+	REQUIRE(cache.find(Text::GlyphCacheKey::make(make_test_font(21), 5)) != nullptr);
+}
+
+TEST_CASE("Concurrent Misses Rasterize Once", "[GlyphCache]") {
+	std::atomic<uint32_t> rasterizeCount{};
+	Text::GlyphCache cache({
+		.byteBudget = 1 << 20,
+		.shardCount = 4,
+		.pfnRasterize = rasterize_slowly,
+		.pRasterizeUserData = &rasterizeCount,
+	});
+
+	auto font = make_test_font(16);
+	std::vector<std::vector<const Text::GlyphBitmap*>> results(THREAD_COUNT);
+	std::vector<std::thread> threads;
+
+	for (uint32_t t = 0; t < THREAD_COUNT; ++t) {
+		threads.emplace_back([&, t] {
+			std::vector<uint32_t> order(GLYPH_COUNT);
+
+			for (uint32_t i = 0; i < GLYPH_COUNT; ++i) {
+				order[i] = i;
+			}
+
+			std::shuffle(order.begin(), order.end(), std::default_random_engine(t));
+			results[t].resize(GLYPH_COUNT);
+
+			for (auto glyphID : order) {
+				results[t][glyphID] = cache.get_glyph(font, glyphID).get();
+			}
+		});
+	}
+
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	REQUIRE(rasterizeCount == GLYPH_COUNT);
+
+	for (uint32_t t = 1; t < THREAD_COUNT; ++t) {
+		REQUIRE(results[t] == results[0]);
+	}
+}
+
+TEST_CASE("Failed Rasterization Releases Waiters", "[GlyphCache]") {
+	std::atomic<uint32_t> rasterizeCount{};
+	Text::GlyphCache cache({
+		.byteBudget = 1 << 20,
+		.shardCount = 1,
+		.pfnRasterize = rasterize_failing_once,
+		.pRasterizeUserData = &rasterizeCount,
+	});
+
+	auto font = make_test_font(16);
+	std::atomic<uint32_t> failureCount{};
+	std::vector<const Text::GlyphBitmap*> results(THREAD_COUNT);
+	std::vector<std::thread> threads;
+
+	for (uint32_t t = 0; t < THREAD_COUNT; ++t) {
+		threads.emplace_back([&, t] {
+			try {
+				results[t] = cache.get_glyph(font, 5).get();
+			}
+			catch (const std::runtime_error&) {
+				++failureCount;
+			}
+		});
+	}
+
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	// The thread whose rasterization failed sees the exception, and a waiting thread rasterizes in its place
+	REQUIRE(failureCount == 1);
+	REQUIRE(rasterizeCount == 2);
+	REQUIRE(cache.get_entry_count() == 1);
+
+	auto glyph = cache.find(Text::GlyphCacheKey::make(font, 5)).get();
+	REQUIRE(glyph != nullptr);
+	REQUIRE(std::count(results.begin(), results.end(), glyph) == THREAD_COUNT - 1);
+}
+
+// Static Functions
+
+static void rasterize_slowly(const Text::SingleScriptFont& font, const Text::GlyphCacheKey& key,
+		Text::GlyphBitmap& bitmap, void* pUserData) {
+	// Widen the window in which concurrent misses can overlap
+	std::this_thread::sleep_for(std::chrono::microseconds(100));
+	rasterize_test_glyph(font, key, bitmap, pUserData);
+}
+
+static void rasterize_failing_once(const Text::SingleScriptFont& font, const Text::GlyphCacheKey& key,
+		Text::GlyphBitmap& bitmap, void* pUserData) {
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+	if (++*static_cast<std::atomic<uint32_t>*>(pUserData) == 1) {
+		throw std::runtime_error("rasterization failed");
+	}
+
+	rasterize_test_glyph(font, key, bitmap, nullptr);
+}
+
+static Text::SingleScriptFont make_test_font(uint32_t size) {
+	Text::SingleScriptFont font{};
+	font.face.handle = 0;
+	font.size = size;
+	return font;
+}
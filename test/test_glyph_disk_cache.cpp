@@ -0,0 +1,191 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <glyph_disk_cache.hpp>
+
+#include <cstdio>
+#include <filesystem>
+#include <vector>
+
+static constexpr const uint32_t PIXELS_PER_EM = 32;
+
+static std::string make_temp_file_name(const char* name);
+static Text::GlyphDiskCacheKey make_key(uint32_t glyphID, uint8_t strokeThickness = 0);
+static void insert_test_glyph(Text::GlyphDiskCache& cache, const Text::GlyphDiskCacheKey& key);
+static bool matches_test_glyph(const Text::GlyphDiskCache& cache, const Text::GlyphDiskCacheKey& key);
+
+TEST_CASE("Round Trip", "[GlyphDiskCache]") {
+	auto fileName = make_temp_file_name("richtext_test_round_trip.bin");
+
+	{
+		Text::GlyphDiskCache cache;
+		cache.open(fileName);
+		REQUIRE(cache.get_entry_count() == 0);
+
+		for (uint32_t i = 1; i <= 20; ++i) {
+			insert_test_glyph(cache, make_key(i));
+		}
+
+		insert_test_glyph(cache, make_key(1, 2));
+
+		// Unsaved entries are visible immediately
+		REQUIRE(matches_test_glyph(cache, make_key(7)));
+		REQUIRE(cache.get_unsaved_entry_count() == 21);
+		REQUIRE(cache.save());
+		REQUIRE(cache.get_unsaved_entry_count() == 0);
+		REQUIRE(matches_test_glyph(cache, make_key(7)));
+	}
+
+	Text::GlyphDiskCache cache;
+	cache.open(fileName);
+
+	REQUIRE(cache.get_entry_count() == 21);
+
+	for (uint32_t i = 1; i <= 20; ++i) {
+		REQUIRE(matches_test_glyph(cache, make_key(i)));
+	}
+
+	REQUIRE(matches_test_glyph(cache, make_key(1, 2)));
+
+	Text::GlyphDiskCacheEntry entry;
+	REQUIRE(!cache.find(make_key(21), entry));
+	REQUIRE(!cache.find(make_key(2, 2), entry));
+
+	// Entries are appended to the existing file
+	insert_test_glyph(cache, make_key(21));
+	cache.close();
+	cache.open(fileName);
+	REQUIRE(cache.get_entry_count() == 22);
+	REQUIRE(matches_test_glyph(cache, make_key(21)));
+
+	cache.close();
+	std::filesystem::remove(fileName);
+}
+
+TEST_CASE("Truncated Records", "[GlyphDiskCache]") {
+	auto fileName = make_temp_file_name("richtext_test_truncated.bin");
+
+	{
+		Text::GlyphDiskCache cache;
+		cache.open(fileName);
+		insert_test_glyph(cache, make_key(1));
+		insert_test_glyph(cache, make_key(2));
+	}
+
+	// Simulate a save interrupted partway through the last record
+	std::filesystem::resize_file(fileName, std::filesystem::file_size(fileName) - 5);
+
+	Text::GlyphDiskCache cache;
+	cache.open(fileName);
+	REQUIRE(cache.get_entry_count() == 1);
+	REQUIRE(matches_test_glyph(cache, make_key(1)));
+
+	insert_test_glyph(cache, make_key(3));
+	cache.close();
+	cache.open(fileName);
+
+	REQUIRE(cache.get_entry_count() == 2);
+	REQUIRE(matches_test_glyph(cache, make_key(1)));
+	REQUIRE(matches_test_glyph(cache, make_key(3)));
+
+	cache.close();
+	std::filesystem::remove(fileName);
+}
+
+TEST_CASE("Incompatible File", "[GlyphDiskCache]") {
+	auto fileName = make_temp_file_name("richtext_test_incompatible.bin");
+
+	if (auto* file = std::fopen(fileName.c_str(), "wb")) {
+		std::fputs("not a glyph cache file", file);
+		std::fclose(file);
+	}
+
+	Text::GlyphDiskCache cache;
+	cache.open(fileName);
+	REQUIRE(cache.get_entry_count() == 0);
+
+	insert_test_glyph(cache, make_key(4));
+	cache.close();
+	cache.open(fileName);
+
+	REQUIRE(cache.get_entry_count() == 1);
+	REQUIRE(matches_test_glyph(cache, make_key(4)));
+
+	cache.close();
+	std::filesystem::remove(fileName);
+}
+
+TEST_CASE("Font Data Hash", "[GlyphDiskCache]") {
+	std::vector<unsigned char> data(1001);
+
+	for (size_t i = 0; i < data.size(); ++i) {
+		data[i] = static_cast<unsigned char>(i * 7);
+	}
+
+	auto hash = Text::GlyphDiskCache::hash_font_data(data.data(), data.size(), 0);
+	REQUIRE(hash == Text::GlyphDiskCache::hash_font_data(data.data(), data.size(), 0));
+	REQUIRE(hash != Text::GlyphDiskCache::hash_font_data(data.data(), data.size(), 1));
+	REQUIRE(hash != Text::GlyphDiskCache::hash_font_data(data.data(), data.size() - 1, 0));
+
+	data[1000] ^= 1;
+	REQUIRE(hash != Text::GlyphDiskCache::hash_font_data(data.data(), data.size(), 0));
+}
+
+// Static Functions
+
+static std::string make_temp_file_name(const char* name) {
+	auto path = std::filesystem::temp_directory_path() / name;
+	std::filesystem::remove(path);
+	return path.string();
+}
+
+static Text::GlyphDiskCacheKey make_key(uint32_t glyphID, uint8_t strokeThickness) {
+	return {
+		.fontHash = 0x1234,
+		.glyphID = glyphID,
+		.size = strokeThickness > 0 ? 16u : 0u,
+		.pixelsPerEm = PIXELS_PER_EM,
+		.strokeThickness = strokeThickness,
+		.strokeJoins = strokeThickness > 0 ? Text::StrokeType::ROUND : Text::StrokeType::NONE,
+	};
+}
+
+// Bitmap contents and dimensions are derived from the key, with odd sizes to exercise record padding
+static void insert_test_glyph(Text::GlyphDiskCache& cache, const Text::GlyphDiskCacheKey& key) {
+	auto width = key.glyphID + key.strokeThickness;
+	auto height = 3u;
+	std::vector<std::byte> data(width * height * 3);
+
+	for (size_t i = 0; i < data.size(); ++i) {
+		data[i] = static_cast<std::byte>(i + key.glyphID);
+	}
+
+	cache.insert(key, {
+		.pData = data.data(),
+		.offset = {static_cast<float>(key.glyphID), -1.f},
+		.size = {static_cast<float>(width), static_cast<float>(height)},
+		.width = width,
+		.height = height,
+		.channels = 3,
+	});
+}
+
+static bool matches_test_glyph(const Text::GlyphDiskCache& cache, const Text::GlyphDiskCacheKey& key) {
+	Text::GlyphDiskCacheEntry entry;
+
+	if (!cache.find(key, entry)) {
+		return false;
+	}
+
+	if (entry.width != key.glyphID + key.strokeThickness || entry.height != 3 || entry.channels != 3
+			|| entry.offset[0] != static_cast<float>(key.glyphID) || entry.offset[1] != -1.f) {
+		return false;
+	}
+
+	for (size_t i = 0; i < entry.get_byte_size(); ++i) {
+		if (entry.pData[i] != static_cast<std::byte>(i + key.glyphID)) {
+			return false;
+		}
+	}
+
+	return true;
+}
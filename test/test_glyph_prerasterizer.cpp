@@ -0,0 +1,134 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "test_layout_helpers.hpp"
+
+#include <formatting.hpp>
+#include <glyph_prerasterizer.hpp>
+#include <layout_info.hpp>
+
+#include <atomic>
+#include <stdexcept>
+
+static constexpr const uint32_t LINE_COUNT = 20;
+static constexpr const uint32_t GLYPHS_PER_LINE = 40;
+static constexpr const uint32_t UNIQUE_GLYPH_COUNT = 13;
+
+static void rasterize_throwing(const Text::SingleScriptFont& font, const Text::GlyphCacheKey& key,
+		Text::GlyphBitmap& bitmap, void* pUserData);
+static Text::LayoutInfo make_test_layout();
+
+TEST_CASE("Collect Unique Glyphs", "[GlyphPrerasterizer]") {
+	auto layout = make_test_layout();
+	Text::GlyphPrerasterizer prerasterizer;
+
+	prerasterizer.collect(layout);
+	REQUIRE(prerasterizer.get_glyph_count() == UNIQUE_GLYPH_COUNT);
+
+	// Collecting the same layout again adds nothing
+	prerasterizer.collect(layout);
+	REQUIRE(prerasterizer.get_glyph_count() == UNIQUE_GLYPH_COUNT);
+
+	// Stroke only the first line, which contains every glyph
+	auto limit = static_cast<int32_t>(LINE_COUNT * (GLYPHS_PER_LINE + 1));
+	Text::FormattingRuns formatting{
+		.fontRuns{Text::Font{}, limit},
+		.colorRuns{Text::Color{1.f, 1.f, 1.f, 1.f}, limit},
+		.strikethroughRuns{false, limit},
+		.underlineRuns{false, limit},
+		.smallcapsRuns{false, limit},
+		.subscriptRuns{false, limit},
+		.superscriptRuns{false, limit},
+	};
+	formatting.strokeRuns.add(static_cast<int32_t>(GLYPHS_PER_LINE), Text::StrokeState{
+		.color = {0.f, 0.f, 0.f, 1.f},
+		.thickness = 2,
+		.joins = Text::StrokeType::ROUND,
+	});
+	formatting.strokeRuns.add(limit, Text::StrokeState{
+		.color = {0.f, 0.f, 0.f, 0.f},
+		.thickness = 2,
+		.joins = Text::StrokeType::ROUND,
+	});
+
+	prerasterizer.clear();
+	prerasterizer.collect(layout, formatting);
+	REQUIRE(prerasterizer.get_glyph_count() == 2 * UNIQUE_GLYPH_COUNT);
+}
+
+TEST_CASE("Parallel Rasterization", "[GlyphPrerasterizer]") {
+	std::atomic<uint32_t> rasterizeCount{};
+	Text::GlyphCache cache({
+		.byteBudget = 1 << 20,
+		.shardCount = 8,
+		.pfnRasterize = rasterize_test_glyph,
+		.pRasterizeUserData = &rasterizeCount,
+	});
+
+	auto layout = make_test_layout();
+	Text::GlyphPrerasterizer prerasterizer;
+	prerasterizer.collect(layout);
+
+	auto glyphs = prerasterizer.rasterize(cache, 4);
+	REQUIRE(glyphs.size() == UNIQUE_GLYPH_COUNT);
+	REQUIRE(rasterizeCount == UNIQUE_GLYPH_COUNT);
+
+	for (auto& glyph : glyphs) {
+		REQUIRE(glyph.bitmap != nullptr);
+		REQUIRE(glyph.bitmap->width == glyph.key.glyphID);
+		REQUIRE(cache.find(glyph.key) == glyph.bitmap);
+	}
+
+	// Cached glyphs are returned without rasterizing again
+	glyphs = prerasterizer.rasterize(cache);
+	REQUIRE(glyphs.size() == UNIQUE_GLYPH_COUNT);
+	REQUIRE(rasterizeCount == UNIQUE_GLYPH_COUNT);
+
+	prerasterizer.clear();
+	REQUIRE(prerasterizer.rasterize(cache).empty());
+}
+
+TEST_CASE("Rasterizer Exceptions", "[GlyphPrerasterizer]") {
+	// Counts the attempts at the glyph that fails
+	std::atomic<uint32_t> rasterizeCount{};
+	Text::GlyphCache cache({
+		.byteBudget = 1 << 20,
+		.shardCount = 8,
+		.pfnRasterize = rasterize_throwing,
+		.pRasterizeUserData = &rasterizeCount,
+	});
+
+	auto layout = make_test_layout();
+	Text::GlyphPrerasterizer prerasterizer;
+	prerasterizer.collect(layout);
+
+	// Both on worker threads and on the calling thread, the exception reaches the caller after the workers stop
+	REQUIRE_THROWS_AS(prerasterizer.rasterize(cache, 4), std::runtime_error);
+	REQUIRE_THROWS_AS(prerasterizer.rasterize(cache, 1), std::runtime_error);
+	// The failed glyph was not cached, so the second call tried it again
+	REQUIRE(rasterizeCount == 2);
+}
+
+// Static Functions
+
+static void rasterize_throwing(const Text::SingleScriptFont& font, const Text::GlyphCacheKey& key,
+		Text::GlyphBitmap& bitmap, void* pUserData) {
+	if (key.glyphID == 7) {
+		++*static_cast<std::atomic<uint32_t>*>(pUserData);
+		throw std::runtime_error("rasterization failed");
+	}
+
+	rasterize_test_glyph(font, key, bitmap, nullptr);
+}
+
+static Text::LayoutInfo make_test_layout() {
+	Text::SingleScriptFont font{};
+	font.face.handle = 0;
+	font.size = 16;
+
+	return build_test_layout({
+		.lineCount = LINE_COUNT,
+		.glyphsPerRun = GLYPHS_PER_LINE,
+		.glyphAdvance = 10.f,
+		.font = font,
+	}, [](auto) { return 1; }, [](auto line, auto, auto i) { return (line + i) % UNIQUE_GLYPH_COUNT; });
+}
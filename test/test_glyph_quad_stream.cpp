@@ -0,0 +1,300 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "test_layout_helpers.hpp"
+
+#include <formatting.hpp>
+#include <glyph_quad_stream.hpp>
+#include <layout_info.hpp>
+
+#include <vector>
+
+static constexpr const float GLYPH_ADVANCE = 10.f;
+static constexpr const float LINE_HEIGHT = 20.f;
+static constexpr const float LINE_ASCENT = 16.f;
+static constexpr const uint32_t STROKE_PAGE = 2;
+static constexpr const uint32_t COLOR_GLYPH_ID = 7;
+
+static constexpr const Text::FontMetrics g_metrics{
+	.ascent = LINE_ASCENT,
+	.descent = LINE_ASCENT - LINE_HEIGHT,
+	.underlinePosition = 2.f,
+	.underlineThickness = 1.f,
+	.strikethroughPosition = -5.f,
+	.strikethroughThickness = 2.f,
+};
+
+static constexpr const uint32_t g_lineGlyphs[2][4] = {
+	{1, 2, 0, 3},
+	{4, 5, 6, COLOR_GLYPH_ID},
+};
+
+static constexpr const Text::Color g_red{1.f, 0.f, 0.f, 1.f};
+static constexpr const Text::Color g_green{0.f, 1.f, 0.f, 1.f};
+static constexpr const Text::Color g_blue{0.f, 0.f, 1.f, 1.f};
+static constexpr const Text::Color g_white{1.f, 1.f, 1.f, 1.f};
+
+namespace {
+
+/**
+ * Places glyph N on page N % 2, with glyph 0 treated as an invisible space.
+ */
+class TestAtlas final : public Text::GlyphAtlasLookup {
+	public:
+		bool get_glyph(const Text::SingleScriptFont&, uint32_t glyphID,
+				Text::GlyphAtlasEntry& entry) override {
+			if (glyphID == 0) {
+				return false;
+			}
+
+			entry = {
+				.offset = {1.f, -8.f},
+				.size = {8.f, 12.f},
+				.texCoords = {0.1f * static_cast<float>(glyphID), 0.f, 0.1f, 0.5f},
+				.page = glyphID % 2,
+				.hasColor = glyphID == COLOR_GLYPH_ID,
+			};
+
+			return true;
+		}
+
+		bool get_stroke(const Text::SingleScriptFont&, uint32_t glyphID, uint8_t thickness, Text::StrokeType,
+				Text::GlyphAtlasEntry& entry) override {
+			auto t = static_cast<float>(thickness);
+
+			entry = {
+				.offset = {1.f - t, -8.f - t},
+				.size = {8.f + 2.f * t, 12.f + 2.f * t},
+				.texCoords = {0.1f * static_cast<float>(glyphID), 0.5f, 0.1f, 0.5f},
+				.page = STROKE_PAGE,
+				.hasColor = false,
+			};
+
+			return true;
+		}
+
+		bool get_solid(Text::GlyphAtlasEntry& entry) override {
+			entry = {
+				.texCoords = {0.f, 0.f, 0.f, 0.f},
+				.page = 0,
+			};
+
+			return true;
+		}
+};
+
+}
+
+static Text::LayoutInfo make_test_layout();
+static Text::FormattingRuns make_test_formatting();
+static void check_batches(const Text::GlyphQuadStream& stream);
+static std::vector<uint32_t> get_batch_glyphs(const Text::GlyphQuadStream& stream, size_t batchIndex);
+
+TEST_CASE("Single Color", "[GlyphQuadStream]") {
+	auto layout = make_test_layout();
+	TestAtlas atlas;
+	Text::GlyphQuadStream stream;
+
+	stream.build(layout, 100.f, Text::XAlignment::LEFT, atlas, g_red);
+
+	// One quad per glyph, minus the space
+	REQUIRE(stream.get_quad_count() == 7);
+	check_batches(stream);
+
+	auto batches = stream.get_batches();
+	REQUIRE(batches.size() == 2);
+	REQUIRE(batches[0].page == 0);
+	REQUIRE(batches[1].page == 1);
+	REQUIRE(get_batch_glyphs(stream, 0) == std::vector<uint32_t>{2, 4, 6});
+	REQUIRE(get_batch_glyphs(stream, 1) == std::vector<uint32_t>{1, 3, 5, 7});
+
+	// Glyph 1 sits at the start of the first line
+	REQUIRE(stream.get_positions()[2 * batches[1].firstQuad] == 1.f);
+	REQUIRE(stream.get_positions()[2 * batches[1].firstQuad + 1] == LINE_ASCENT - 8.f);
+	REQUIRE(stream.get_sizes()[2 * batches[1].firstQuad] == 8.f);
+	REQUIRE(stream.get_sizes()[2 * batches[1].firstQuad + 1] == 12.f);
+	REQUIRE(stream.get_colors()[batches[1].firstQuad] == g_red);
+
+	// Glyph 7 is the last glyph of the second line and carries its own color
+	auto lastQuad = batches[1].firstQuad + batches[1].quadCount - 1;
+	REQUIRE(stream.get_positions()[2 * lastQuad] == 3.f * GLYPH_ADVANCE + 1.f);
+	REQUIRE(stream.get_positions()[2 * lastQuad + 1] == LINE_HEIGHT + LINE_ASCENT - 8.f);
+	REQUIRE(stream.get_colors()[lastQuad] == g_white);
+}
+
+TEST_CASE("Alignment and Origin", "[GlyphQuadStream]") {
+	auto layout = make_test_layout();
+	TestAtlas atlas;
+	Text::GlyphQuadStream stream;
+
+	stream.build(layout, 100.f, Text::XAlignment::RIGHT, atlas, g_red, 5.f, 7.f);
+
+	auto batches = stream.get_batches();
+	REQUIRE(batches.size() == 2);
+
+	// Lines are 4 glyphs wide, so right alignment shifts them by 100 - 40
+	REQUIRE(stream.get_positions()[2 * batches[1].firstQuad] == 5.f + 60.f + 1.f);
+	REQUIRE(stream.get_positions()[2 * batches[1].firstQuad + 1] == 7.f + LINE_ASCENT - 8.f);
+}
+
+TEST_CASE("Formatting", "[GlyphQuadStream]") {
+	auto layout = make_test_layout();
+	auto formatting = make_test_formatting();
+	TestAtlas atlas;
+	Text::GlyphQuadStream stream;
+
+	stream.build(layout, formatting, 100.f, Text::XAlignment::LEFT, atlas);
+
+	// 7 glyphs, plus strokes on the 4 glyphs of the second line
+	REQUIRE(stream.get_quad_count() == 11);
+	check_batches(stream);
+
+	auto batches = stream.get_batches();
+	REQUIRE(batches.size() == 3);
+	REQUIRE(batches[0].layer == Text::GlyphQuadLayer::STROKE);
+	REQUIRE(batches[0].page == STROKE_PAGE);
+	REQUIRE(batches[0].quadCount == 4);
+	REQUIRE(batches[1].layer == Text::GlyphQuadLayer::GLYPH);
+	REQUIRE(batches[2].layer == Text::GlyphQuadLayer::GLYPH);
+
+	// Stroke quads grow outwards from the glyph quad by the stroke thickness
+	for (uint32_t i = 0; i < batches[0].quadCount; ++i) {
+		REQUIRE(stream.get_colors()[i] == g_blue);
+		REQUIRE(stream.get_positions()[2 * i] == static_cast<float>(i) * GLYPH_ADVANCE);
+	}
+
+	auto* colors = stream.get_colors();
+	auto page1 = batches[2].firstQuad;
+
+	// Glyphs 1 and 3 are on the red line, 5 is green and 7 has its own color
+	REQUIRE(colors[page1] == g_red);
+	REQUIRE(colors[page1 + 1] == g_red);
+	REQUIRE(colors[page1 + 2] == g_green);
+	REQUIRE(colors[page1 + 3] == g_white);
+}
+
+TEST_CASE("Decorations", "[GlyphQuadStream]") {
+	auto layout = make_test_layout();
+	auto formatting = make_test_formatting();
+	TestAtlas atlas;
+	Text::GlyphQuadStream stream;
+
+	formatting.underlineRuns = Text::ValueRuns<bool>(true, 2);
+	formatting.underlineRuns.add(10, false);
+	formatting.strikethroughRuns = Text::ValueRuns<bool>(false, 5);
+	formatting.strikethroughRuns.add(10, true);
+
+	stream.build(layout, formatting, 100.f, Text::XAlignment::LEFT, atlas);
+	check_batches(stream);
+
+	auto batches = stream.get_batches();
+	REQUIRE(batches.back().layer == Text::GlyphQuadLayer::DECORATION);
+	REQUIRE(batches.back().quadCount == 2);
+
+	auto* positions = stream.get_positions() + 2 * batches.back().firstQuad;
+	auto* sizes = stream.get_sizes() + 2 * batches.back().firstQuad;
+	auto* colors = stream.get_colors() + batches.back().firstQuad;
+
+	// Underline under the first two glyphs of the first line
+	REQUIRE(positions[0] == 0.f);
+	REQUIRE(positions[1] == LINE_ASCENT + g_metrics.underlinePosition);
+	REQUIRE(sizes[0] == 2.f * GLYPH_ADVANCE);
+	REQUIRE(sizes[1] == g_metrics.underlineThickness + 0.5f);
+	REQUIRE(colors[0] == g_red);
+
+	// Strikethrough across the whole second line
+	REQUIRE(positions[2] == 0.f);
+	REQUIRE(positions[3] == LINE_HEIGHT + LINE_ASCENT + g_metrics.strikethroughPosition);
+	REQUIRE(sizes[2] == 4.f * GLYPH_ADVANCE);
+	REQUIRE(sizes[3] == g_metrics.strikethroughThickness + 0.5f);
+	REQUIRE(colors[1] == g_green);
+}
+
+TEST_CASE("Reuse", "[GlyphQuadStream]") {
+	auto layout = make_test_layout();
+	TestAtlas atlas;
+	Text::GlyphQuadStream stream;
+
+	stream.build(layout, 100.f, Text::XAlignment::LEFT, atlas, g_red);
+	stream.build(layout, 100.f, Text::XAlignment::LEFT, atlas, g_green);
+
+	REQUIRE(stream.get_quad_count() == 7);
+	REQUIRE(stream.get_batches().size() == 2);
+	REQUIRE(stream.get_colors()[0] == g_green);
+
+	Text::LayoutInfo emptyLayout;
+	stream.build(emptyLayout, 100.f, Text::XAlignment::LEFT, atlas, g_red);
+
+	REQUIRE(stream.empty());
+	REQUIRE(stream.get_batches().empty());
+}
+
+// Static Functions
+
+static Text::LayoutInfo make_test_layout() {
+	return build_test_layout({
+		.lineCount = std::size(g_lineGlyphs),
+		.glyphsPerRun = std::size(g_lineGlyphs[0]),
+		.glyphAdvance = GLYPH_ADVANCE,
+		.lineHeight = LINE_HEIGHT,
+		.lineAscent = LINE_ASCENT,
+		.metrics = g_metrics,
+	}, [](auto) { return 1; }, [](auto line, auto, auto i) { return g_lineGlyphs[line][i]; });
+}
+
+static Text::FormattingRuns make_test_formatting() {
+	Text::FormattingRuns result{
+		.fontRuns{Text::Font{}, 10},
+		.colorRuns{g_red, 5},
+		.strokeRuns{Text::StrokeState{}, 5},
+		.strikethroughRuns{false, 10},
+		.underlineRuns{false, 10},
+		.smallcapsRuns{false, 10},
+		.subscriptRuns{false, 10},
+		.superscriptRuns{false, 10},
+	};
+
+	result.colorRuns.add(10, g_green);
+	result.strokeRuns.add(10, Text::StrokeState{
+		.color = g_blue,
+		.thickness = 1,
+		.joins = Text::StrokeType::ROUND,
+	});
+
+	return result;
+}
+
+static void check_batches(const Text::GlyphQuadStream& stream) {
+	auto batches = stream.get_batches();
+	uint32_t quadIndex{};
+
+	for (size_t i = 0; i < batches.size(); ++i) {
+		REQUIRE(batches[i].firstQuad == quadIndex);
+		REQUIRE(batches[i].quadCount > 0);
+
+		if (i > 0) {
+			REQUIRE((batches[i - 1].layer < batches[i].layer || (batches[i - 1].layer == batches[i].layer
+					&& batches[i - 1].page < batches[i].page)));
+		}
+
+		for (uint32_t j = 0; j < batches[i].quadCount; ++j) {
+			REQUIRE(stream.get_pages()[quadIndex + j] == batches[i].page);
+		}
+
+		quadIndex += batches[i].quadCount;
+	}
+
+	REQUIRE(quadIndex == stream.get_quad_count());
+}
+
+static std::vector<uint32_t> get_batch_glyphs(const Text::GlyphQuadStream& stream, size_t batchIndex) {
+	auto& batch = stream.get_batches()[batchIndex];
+	std::vector<uint32_t> result;
+
+	for (uint32_t i = 0; i < batch.quadCount; ++i) {
+		// The test atlas encodes the glyph ID in the UV x coordinate
+		auto u = stream.get_tex_coords()[4 * (batch.firstQuad + i)];
+		result.emplace_back(static_cast<uint32_t>(u * 10.f + 0.5f));
+	}
+
+	return result;
+}
@@ -0,0 +1,345 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "test_layout_helpers.hpp"
+
+#include <formatting.hpp>
+#include <layout_info.hpp>
+#include <text_draw_util.hpp>
+
+#include <algorithm>
+#include <random>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+static constexpr const uint32_t LINE_COUNT = 1000;
+static constexpr const uint32_t RUNS_PER_LINE = 4;
+static constexpr const uint32_t GLYPHS_PER_RUN = 8;
+static constexpr const float GLYPH_ADVANCE = 10.f;
+static constexpr const float LINE_HEIGHT = 20.f;
+static constexpr const float LINE_ASCENT = 16.f;
+static constexpr const float TEXT_AREA_WIDTH = 400.f;
+
+namespace {
+
+struct GlyphDraw {
+	uint32_t glyphID;
+	float x;
+	float y;
+
+	bool operator==(const GlyphDraw&) const = default;
+};
+
+struct ColoredGlyphDraw {
+	GlyphDraw glyph;
+	Text::Color color;
+
+	bool operator==(const ColoredGlyphDraw&) const = default;
+};
+
+}
+
+static Text::LayoutInfo make_test_layout();
+static Text::FormattingRuns make_test_formatting(const Text::LayoutInfo& layout);
+template <typename... Clip>
+static std::vector<ColoredGlyphDraw> record_colored_glyphs(const Text::LayoutInfo& layout,
+		const Text::FormattingRuns& formatting, const Clip&... clip);
+static std::vector<GlyphDraw> cull_glyphs(const Text::LayoutInfo& layout, const Text::LayoutClipRect& clip);
+static std::vector<Text::SelectionRect> select_runs(const Text::LayoutInfo& layout, uint32_t firstCharIndex,
+		uint32_t lastCharIndex);
+
+TEST_CASE("Visible Line Range", "[LayoutClip]") {
+	auto layout = make_test_layout();
+
+	auto range = layout.get_visible_line_range(0.f, 100.f);
+	REQUIRE(range.first == 0);
+	REQUIRE(range.second == 5);
+
+	// Boundaries between lines belong to the lower line
+	range = layout.get_visible_line_range(40.f, 61.f);
+	REQUIRE(range.first == 2);
+	REQUIRE(range.second == 4);
+
+	range = layout.get_visible_line_range(-50.f, -10.f);
+	REQUIRE(range.first == range.second);
+
+	range = layout.get_visible_line_range(LINE_COUNT * LINE_HEIGHT, LINE_COUNT * LINE_HEIGHT + 100.f);
+	REQUIRE(range.first == LINE_COUNT);
+	REQUIRE(range.second == LINE_COUNT);
+}
+
+TEST_CASE("Clipped Runs", "[LayoutClip]") {
+	auto layout = make_test_layout();
+	Text::LayoutClipRect clip{
+		.minX = 100.f,
+		.minY = 1000.f,
+		.maxX = 150.f,
+		.maxY = 1100.f,
+	};
+
+	std::vector<size_t> expected;
+	std::vector<size_t> result;
+
+	layout.for_each_run(TEXT_AREA_WIDTH, Text::XAlignment::CENTER, [&](auto lineIndex, auto runIndex,
+			auto lineX, auto lineY) {
+		auto* positions = layout.get_run_positions(runIndex);
+		auto runMinX = lineX + positions[0];
+		auto runMaxX = lineX + positions[2 * layout.get_run_glyph_count(runIndex)];
+		auto lineTop = lineY - layout.get_line_ascent(lineIndex);
+
+		if (lineTop < clip.maxY && lineTop + layout.get_line_height(lineIndex) > clip.minY
+				&& runMinX <= clip.maxX && runMaxX >= clip.minX) {
+			expected.emplace_back(runIndex);
+		}
+	});
+
+	layout.for_each_run(TEXT_AREA_WIDTH, Text::XAlignment::CENTER, clip, [&](auto, auto runIndex, auto,
+			auto) {
+		result.emplace_back(runIndex);
+	});
+
+	REQUIRE(!result.empty());
+	REQUIRE(result == expected);
+}
+
+TEST_CASE("Clipped Glyphs", "[LayoutClip]") {
+	auto layout = make_test_layout();
+	std::default_random_engine rng;
+	std::uniform_real_distribution<float> distX(-50.f, TEXT_AREA_WIDTH + 50.f);
+	std::uniform_real_distribution<float> distY(-50.f, LINE_COUNT * LINE_HEIGHT + 50.f);
+
+	for (size_t i = 0; i < 100; ++i) {
+		auto x0 = distX(rng);
+		auto x1 = distX(rng);
+		auto y0 = distY(rng);
+		auto y1 = y0 + 200.f;
+
+		Text::LayoutClipRect clip{
+			.minX = std::min(x0, x1),
+			.minY = y0,
+			.maxX = std::max(x0, x1),
+			.maxY = y1,
+		};
+
+		std::vector<GlyphDraw> result;
+
+		Text::draw_text(layout, TEXT_AREA_WIDTH, Text::XAlignment::RIGHT, clip, [&](const auto&,
+				uint32_t glyphID, float x, float y) {
+			result.push_back({glyphID, x, y});
+		});
+
+		REQUIRE(result == cull_glyphs(layout, clip));
+	}
+}
+
+TEST_CASE("Clipped Formatted Glyphs", "[LayoutClip]") {
+	uint32_t glyphID{};
+
+	// Alternate run directions, so that clipping starts right to left runs part way through
+	auto layout = build_test_layout({
+		.lineCount = LINE_COUNT,
+		.glyphsPerRun = GLYPHS_PER_RUN,
+		.glyphAdvance = GLYPH_ADVANCE,
+		.lineHeight = LINE_HEIGHT,
+		.lineAscent = LINE_ASCENT,
+	}, [](auto line) { return 1 + line % RUNS_PER_LINE; }, [&](auto, auto, auto) { return glyphID++; },
+			[](auto line, auto run) { return (line + run) % 2 == 1; });
+	auto formatting = make_test_formatting(layout);
+	auto allGlyphs = record_colored_glyphs(layout, formatting);
+
+	std::default_random_engine rng;
+	std::uniform_real_distribution<float> distX(-50.f, TEXT_AREA_WIDTH + 50.f);
+	std::uniform_real_distribution<float> distY(-50.f, LINE_COUNT * LINE_HEIGHT + 50.f);
+
+	for (size_t i = 0; i < 100; ++i) {
+		auto x0 = distX(rng);
+		auto x1 = distX(rng);
+		auto y0 = distY(rng);
+
+		Text::LayoutClipRect clip{
+			.minX = std::min(x0, x1),
+			.minY = y0,
+			.maxX = std::max(x0, x1),
+			.maxY = y0 + 200.f,
+		};
+
+		// Visible glyphs keep the colors they are drawn with when the whole layout is drawn
+		auto visible = cull_glyphs(layout, clip);
+		std::vector<ColoredGlyphDraw> expected;
+
+		for (auto& draw : allGlyphs) {
+			if (std::find(visible.begin(), visible.end(), draw.glyph) != visible.end()) {
+				expected.emplace_back(draw);
+			}
+		}
+
+		REQUIRE(record_colored_glyphs(layout, formatting, clip) == expected);
+	}
+}
+
+TEST_CASE("Selection Rects", "[LayoutClip]") {
+	auto layout = make_test_layout();
+	std::vector<Text::SelectionRect> rects;
+
+	// Runs within a line touch, so a selection crossing them is one rect
+	layout.get_selection_rects(10, 22, TEXT_AREA_WIDTH, Text::XAlignment::CENTER, rects);
+	REQUIRE(rects.size() == 1);
+	REQUIRE(rects[0].x == layout.get_line_x_start(1, TEXT_AREA_WIDTH, Text::XAlignment::CENTER) + GLYPH_ADVANCE);
+	REQUIRE(rects[0].y == LINE_HEIGHT);
+	REQUIRE(rects[0].width == 12 * GLYPH_ADVANCE);
+	REQUIRE(rects[0].height == LINE_HEIGHT);
+
+	// Whole lines are a single rect covering the line
+	layout.get_selection_rects(0, 30, TEXT_AREA_WIDTH, Text::XAlignment::CENTER, rects);
+	REQUIRE(rects.size() == 3);
+	REQUIRE(rects[1].width == 2 * GLYPHS_PER_RUN * GLYPH_ADVANCE);
+
+	layout.get_selection_rects(5, 5, TEXT_AREA_WIDTH, Text::XAlignment::CENTER, rects);
+	REQUIRE(rects.empty());
+
+	std::default_random_engine rng;
+	auto charCount = layout.get_run_char_end_index(layout.get_run_count() - 1) + 1;
+	std::uniform_int_distribution<uint32_t> distChar(0, charCount);
+
+	for (size_t i = 0; i < 100; ++i) {
+		auto first = distChar(rng);
+		auto last = distChar(rng);
+
+		if (first > last) {
+			std::swap(first, last);
+		}
+
+		layout.get_selection_rects(first, last, TEXT_AREA_WIDTH, Text::XAlignment::CENTER, rects);
+		auto expected = select_runs(layout, first, last);
+
+		REQUIRE(rects.size() == expected.size());
+
+		for (size_t j = 0; j < rects.size(); ++j) {
+			REQUIRE(rects[j].x == expected[j].x);
+			REQUIRE(rects[j].y == expected[j].y);
+			REQUIRE(rects[j].width == expected[j].width);
+			REQUIRE(rects[j].height == expected[j].height);
+		}
+	}
+}
+
+// Static Functions
+
+static Text::LayoutInfo make_test_layout() {
+	uint32_t glyphID{};
+
+	// Vary line widths so that alignment shifts each line differently
+	return build_test_layout({
+		.lineCount = LINE_COUNT,
+		.glyphsPerRun = GLYPHS_PER_RUN,
+		.glyphAdvance = GLYPH_ADVANCE,
+		.lineHeight = LINE_HEIGHT,
+		.lineAscent = LINE_ASCENT,
+	}, [](auto line) { return 1 + line % RUNS_PER_LINE; }, [&](auto, auto, auto) { return glyphID++; });
+}
+
+// A new color every 3 characters
+static Text::FormattingRuns make_test_formatting(const Text::LayoutInfo& layout) {
+	static constexpr const Text::Color colors[] = {
+		{1.f, 0.f, 0.f, 1.f},
+		{0.f, 1.f, 0.f, 1.f},
+		{0.f, 0.f, 1.f, 1.f},
+		{1.f, 1.f, 0.f, 1.f},
+	};
+
+	auto charCount = static_cast<int32_t>(layout.get_run_char_end_index(layout.get_run_count() - 1) + 1);
+	Text::FormattingRuns result{
+		.fontRuns{Text::Font{}, charCount},
+		.colorRuns{},
+		.strokeRuns{Text::StrokeState{}, charCount},
+		.strikethroughRuns{false, charCount},
+		.underlineRuns{false, charCount},
+		.smallcapsRuns{false, charCount},
+		.subscriptRuns{false, charCount},
+		.superscriptRuns{false, charCount},
+	};
+
+	for (int32_t i = 3, colorIndex = 0; i < charCount + 3; i += 3, ++colorIndex) {
+		result.colorRuns.add(std::min(i, charCount), colors[colorIndex % std::size(colors)]);
+	}
+
+	return result;
+}
+
+// Records the main glyph draws of the formatted `draw_text`, clipped if `clip` is given
+template <typename... Clip>
+static std::vector<ColoredGlyphDraw> record_colored_glyphs(const Text::LayoutInfo& layout,
+		const Text::FormattingRuns& formatting, const Clip&... clip) {
+	std::vector<ColoredGlyphDraw> result;
+
+	Text::draw_text(layout, formatting, TEXT_AREA_WIDTH, Text::XAlignment::RIGHT, clip..., [&]<typename... Args>(
+			const Args&... args) {
+		if constexpr (sizeof...(Args) == 5) {
+			using First = std::tuple_element_t<0, std::tuple<Args...>>;
+			using Last = std::tuple_element_t<4, std::tuple<Args...>>;
+
+			if constexpr (std::is_same_v<First, Text::SingleScriptFont> && std::is_same_v<Last, Text::Color>) {
+				auto tup = std::tie(args...);
+				result.push_back({{std::get<1>(tup), std::get<2>(tup), std::get<3>(tup)}, std::get<4>(tup)});
+			}
+		}
+	});
+
+	return result;
+}
+
+static std::vector<GlyphDraw> cull_glyphs(const Text::LayoutInfo& layout, const Text::LayoutClipRect& clip) {
+	std::vector<GlyphDraw> result;
+
+	layout.for_each_run(TEXT_AREA_WIDTH, Text::XAlignment::RIGHT, [&](auto lineIndex, auto runIndex,
+			auto lineX, auto lineY) {
+		auto lineTop = lineY - layout.get_line_ascent(lineIndex);
+
+		if (lineTop >= clip.maxY || lineTop + layout.get_line_height(lineIndex) <= clip.minY) {
+			return;
+		}
+
+		auto* positions = layout.get_run_positions(runIndex);
+		auto firstGlyphIndex = layout.get_first_glyph_index(runIndex);
+
+		for (uint32_t i = 0; i < layout.get_run_glyph_count(runIndex); ++i) {
+			auto minX = lineX + positions[2 * i];
+			auto maxX = lineX + positions[2 * (i + 1)];
+
+			if (minX <= clip.maxX && maxX >= clip.minX) {
+				result.push_back({layout.get_glyph_id(firstGlyphIndex + i), minX,
+						lineY + positions[2 * i + 1]});
+			}
+		}
+	});
+
+	return result;
+}
+
+// Visits every run, merging the selected parts of neighbouring runs within each line
+static std::vector<Text::SelectionRect> select_runs(const Text::LayoutInfo& layout, uint32_t firstCharIndex,
+		uint32_t lastCharIndex) {
+	std::vector<Text::SelectionRect> result;
+	size_t lastLineIndex = ~size_t{};
+
+	layout.for_each_run(TEXT_AREA_WIDTH, Text::XAlignment::CENTER, [&](auto lineIndex, auto runIndex,
+			auto lineX, auto lineY) {
+		if (!layout.run_contains_char_range(runIndex, firstCharIndex, lastCharIndex)) {
+			return;
+		}
+
+		auto [minPos, maxPos] = layout.get_position_range_in_run(runIndex, firstCharIndex, lastCharIndex);
+
+		if (lineIndex == lastLineIndex && result.back().x + result.back().width == lineX + minPos) {
+			result.back().width += maxPos - minPos;
+		}
+		else {
+			result.push_back({lineX + minPos, lineY - layout.get_line_ascent(lineIndex), maxPos - minPos,
+					layout.get_line_height(lineIndex)});
+		}
+
+		lastLineIndex = lineIndex;
+	});
+
+	return result;
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <glyph_cache.hpp>
+#include <layout_info.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+inline constexpr const uint32_t TEST_COLOR_GLYPH_ID = 100;
+
+/**
+ * Shape of the layouts built by `build_test_layout`: lines of runs of glyphs with a fixed advance, each line
+ * followed by a line break character that belongs to no run.
+ */
+struct TestLayoutParams {
+	uint32_t lineCount;
+	uint32_t glyphsPerRun;
+	float glyphAdvance;
+	float lineHeight = 20.f;
+	float lineAscent = 16.f;
+	Text::SingleScriptFont font{};
+	Text::FontMetrics metrics{};
+};
+
+/**
+ * Builds a layout shaped by `params`, with `getRunCount(lineIndex)` runs in each line and glyph IDs given by
+ * `getGlyphID(lineIndex, runIndex, glyphIndex)`, called in visual order. Runs for which
+ * `isRightToLeft(lineIndex, runIndex)` is true have their characters in reverse visual order.
+ */
+template <typename RunCountFunctor, typename GlyphIDFunctor, typename RightToLeftFunctor>
+Text::LayoutInfo build_test_layout(const TestLayoutParams& params, RunCountFunctor&& getRunCount,
+		GlyphIDFunctor&& getGlyphID, RightToLeftFunctor&& isRightToLeft) {
+	Text::LayoutInfo layout;
+	uint32_t charIndex{};
+
+	for (uint32_t line = 0; line < params.lineCount; ++line) {
+		auto runCount = static_cast<uint32_t>(getRunCount(line));
+		float x{};
+
+		for (uint32_t run = 0; run < runCount; ++run) {
+			bool rightToLeft = isRightToLeft(line, run);
+			auto charStartIndex = charIndex;
+
+			for (uint32_t i = 0; i < params.glyphsPerRun; ++i) {
+				layout.append_glyph(static_cast<uint32_t>(getGlyphID(line, run, i)));
+				layout.append_char_index(rightToLeft ? charStartIndex + params.glyphsPerRun - 1 - i : charIndex);
+				layout.append_glyph_position(x, 0.f);
+				x += params.glyphAdvance;
+				++charIndex;
+			}
+
+			layout.append_glyph_position(x, 0.f);
+			layout.append_run(params.font, charStartIndex, charIndex, rightToLeft, params.metrics);
+		}
+
+		layout.append_line(params.lineHeight, params.lineAscent);
+		++charIndex;
+	}
+
+	return layout;
+}
+
+template <typename RunCountFunctor, typename GlyphIDFunctor>
+Text::LayoutInfo build_test_layout(const TestLayoutParams& params, RunCountFunctor&& getRunCount,
+		GlyphIDFunctor&& getGlyphID) {
+	return build_test_layout(params, getRunCount, getGlyphID, [](auto, auto) { return false; });
+}
+
+/**
+ * Coverage of the pixel (`x`, `y`) of glyph `glyphID` as produced by `rasterize_test_glyph`, spread over the
+ * full range with runs of fully transparent and fully opaque pixels.
+ */
+inline uint8_t get_test_coverage(uint32_t glyphID, uint32_t x, uint32_t y) {
+	auto value = (x * 37 + y * 101 + glyphID * 11) % 320;
+	return static_cast<uint8_t>(value < 32 ? 0 : value > 287 ? 255 : value - 32);
+}
+
+/**
+ * `GlyphCache` rasterizer for tests. Glyph N is N pixels wide and (N % 7) + 1 tall, plus the stroke thickness on
+ * every side, with coverage from `get_test_coverage`. Glyph 0 is empty, and `TEST_COLOR_GLYPH_ID` is a single
+ * row of 6 BGRA8 pixels. If `pUserData` is not null, it is a `std::atomic<uint32_t>` counting the calls.
+ */
+inline void rasterize_test_glyph(const Text::SingleScriptFont&, const Text::GlyphCacheKey& key,
+		Text::GlyphBitmap& bitmap, void* pUserData) {
+	if (pUserData) {
+		++*static_cast<std::atomic<uint32_t>*>(pUserData);
+	}
+
+	if (key.glyphID == 0) {
+		return;
+	}
+
+	if (key.glyphID == TEST_COLOR_GLYPH_ID) {
+		bitmap.width = 6;
+		bitmap.height = 1;
+		bitmap.offsetX = 0.f;
+		bitmap.offsetY = -1.f;
+		bitmap.format = Text::FontRasterFormat::BGRA8;
+		bitmap.pData = std::make_unique<std::byte[]>(bitmap.get_byte_size());
+
+		for (uint32_t i = 0; i < bitmap.width; ++i) {
+			bitmap.pData[4 * i] = std::byte{10};
+			bitmap.pData[4 * i + 1] = std::byte{20};
+			bitmap.pData[4 * i + 2] = std::byte{30};
+			bitmap.pData[4 * i + 3] = std::byte{255};
+		}
+
+		return;
+	}
+
+	// Strokes extend past the glyph by their thickness on every side
+	auto border = static_cast<uint32_t>(key.strokeThickness);
+	bitmap.width = key.glyphID + 2 * border;
+	bitmap.height = (key.glyphID % 7) + 1 + 2 * border;
+	bitmap.offsetX = -static_cast<float>(border);
+	bitmap.offsetY = -static_cast<float>(border + 1);
+	bitmap.format = Text::FontRasterFormat::R8;
+	bitmap.pData = std::make_unique<std::byte[]>(bitmap.get_byte_size());
+
+	for (uint32_t y = 0; y < bitmap.height; ++y) {
+		for (uint32_t x = 0; x < bitmap.width; ++x) {
+			bitmap.pData[y * bitmap.width + x] = std::byte{get_test_coverage(key.glyphID, x, y)};
+		}
+	}
+}
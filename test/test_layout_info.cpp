@@ -3,6 +3,7 @@
 #include <font_registry.hpp>
 #include <layout_builder.hpp>
 #include <layout_info.hpp>
+#include <style_table.hpp>
 #include <value_runs.hpp>
 
 #include "other_layout_builders.hpp"
@@ -11,6 +12,8 @@
 #include <unicode/unistr.h>
 
 #include <cmath>
+#include <string_view>
+#include <vector>
 
 static bool g_initialized = false;
 
@@ -36,6 +39,8 @@ static void init_font_registry();
 static void test_lx_vs_icu(Text::Font font, const char* str, float width);
 static void test_lx_vs_utf8(Text::Font font, const char* str, float width);
 static void test_utf8_vs_utf8(Text::Font font, const char* str, float width);
+static void test_chunked_vs_contiguous(Text::Font font, const char* str, float width);
+static void test_color_runs_vs_font_runs(Text::Font font, const char* str, float width);
 static void test_compare_layouts(const Text::LayoutInfo& lxLayout, const Text::LayoutInfo& icuLayout);
 
 TEST_CASE("ICU UTF-16", "[LayoutInfo]") {
@@ -99,6 +104,42 @@ TEST_CASE("UTF-8 REGRESSION", "[Regression]") {
 	}
 }
 
+TEST_CASE("Chunked Text", "[LayoutInfo]") {
+	init_font_registry();
+	auto family = Text::FontRegistry::get_family("Noto Sans"); 
+	Text::Font font(family, Text::FontWeight::REGULAR, Text::FontStyle::NORMAL, 48);
+
+	SECTION("Single Font Softbreaking") {
+		for (size_t i = 0; i < std::ssize(g_testStrings); ++i) {
+			test_chunked_vs_contiguous(font, g_testStrings[i], 100.f);
+		}
+	}
+
+	SECTION("Single Font No Softbreaking") {
+		for (size_t i = 0; i < std::ssize(g_testStrings); ++i) {
+			test_chunked_vs_contiguous(font, g_testStrings[i], 0.f);
+		}
+	}
+}
+
+TEST_CASE("Color Runs", "[LayoutInfo]") {
+	init_font_registry();
+	auto family = Text::FontRegistry::get_family("Noto Sans"); 
+	Text::Font font(family, Text::FontWeight::REGULAR, Text::FontStyle::NORMAL, 48);
+
+	SECTION("Single Font Softbreaking") {
+		for (size_t i = 0; i < std::ssize(g_testStrings); ++i) {
+			test_color_runs_vs_font_runs(font, g_testStrings[i], 100.f);
+		}
+	}
+
+	SECTION("Single Font No Softbreaking") {
+		for (size_t i = 0; i < std::ssize(g_testStrings); ++i) {
+			test_color_runs_vs_font_runs(font, g_testStrings[i], 0.f);
+		}
+	}
+}
+
 // Static Functions
 
 static void init_font_registry() {
@@ -133,6 +174,103 @@ static void test_utf8_vs_utf8(Text::Font font, const char* str, float width) {
 	test_compare_layouts(layoutA, layoutB);
 }
 
+static void test_chunked_vs_contiguous(Text::Font font, const char* str, float width) {
+	std::string_view text(str);
+	Text::ValueRuns<Text::Font> fontRuns(font, static_cast<int32_t>(text.size()));
+	Text::LayoutBuildParams params{
+		.textAreaWidth = width,
+		.textAreaHeight = 100.f,
+		.tabWidth = 4.f,
+		.xAlignment = Text::XAlignment::LEFT,
+		.yAlignment = Text::YAlignment::BOTTOM,
+	};
+
+	Text::LayoutBuilder builder;
+	Text::LayoutInfo expected{};
+	builder.build_layout_info(expected, text.data(), static_cast<int32_t>(text.size()), fontRuns, params);
+
+	std::vector<size_t> boundaries;
+
+	for (size_t i = 1; i < text.size(); ++i) {
+		if ((text[i] & 0xC0) != 0x80) {
+			boundaries.emplace_back(i);
+		}
+	}
+
+	// Split in two at every code point boundary, including between the CR and LF of a CRLF
+	for (auto boundary : boundaries) {
+		std::string_view chunks[] = {text.substr(0, boundary), text.substr(boundary)};
+		Text::LayoutInfo result{};
+		builder.build_layout_info(result, chunks, fontRuns, params);
+		test_compare_layouts(expected, result);
+	}
+
+	// One chunk per code point, with empty chunks in between
+	std::vector<std::string_view> chunks;
+	size_t start{};
+
+	for (auto boundary : boundaries) {
+		chunks.emplace_back(text.substr(start, boundary - start));
+		chunks.emplace_back();
+		start = boundary;
+	}
+
+	chunks.emplace_back(text.substr(start));
+
+	Text::LayoutInfo result{};
+	builder.build_layout_info(result, chunks, fontRuns, params);
+	test_compare_layouts(expected, result);
+}
+
+// Styles that only change color and decorations must not split shaping, so ligatures and kerning across them
+// stay intact
+static void test_color_runs_vs_font_runs(Text::Font font, const char* str, float width) {
+	std::string_view text(str);
+	auto count = static_cast<int32_t>(text.size());
+	Text::ValueRuns<Text::Font> fontRuns(font, count);
+	Text::LayoutBuildParams params{
+		.textAreaWidth = width,
+		.textAreaHeight = 100.f,
+		.tabWidth = 4.f,
+		.xAlignment = Text::XAlignment::LEFT,
+		.yAlignment = Text::YAlignment::BOTTOM,
+	};
+
+	Text::LayoutBuilder builder;
+	Text::LayoutInfo expected{};
+	builder.build_layout_info(expected, text.data(), count, fontRuns, params);
+
+	Text::CompactFormattingRuns formatting;
+	uint16_t styleIDs[] = {
+		formatting.styles.intern({
+			.font = font,
+			.color = {0.f, 0.f, 0.f, 1.f},
+			.stroke = {},
+			.flags = Text::StyleFlags::NONE,
+		}),
+		formatting.styles.intern({
+			.font = font,
+			.color = {1.f, 0.f, 0.f, 1.f},
+			.stroke = {},
+			.flags = Text::StyleFlags::UNDERLINE,
+		}),
+	};
+
+	// A new style on every code point
+	size_t styleIndex{};
+
+	for (int32_t i = 1; i <= count; ++i) {
+		if (i == count || (text[i] & 0xC0) != 0x80) {
+			formatting.styleRuns.add(i, styleIDs[styleIndex]);
+			styleIndex ^= 1;
+		}
+	}
+
+	Text::LayoutInfo result{};
+	builder.build_layout_info(result, text.data(), count, formatting, params);
+	test_compare_layouts(expected, result);
+}
+
 static void test_lx_vs_icu(Text::Font font, const char* str, float width) {
 	icu::UnicodeString text(str);
 	Text::ValueRuns<Text::Font> fontRuns(font, text.length());
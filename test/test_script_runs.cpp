@@ -4,6 +4,7 @@
 
 #include <usc_impl.h>
 #include <unicode/ustring.h>
+#include <unicode/utf8.h>
 
 #include <array>
 
@@ -33,17 +34,53 @@ static constexpr const RunTestData g_scriptRunTestData2[] = {
 	{"((((((((((abc))))))))))", USCRIPT_LATIN},
 };
 
+static constexpr const RunTestData g_scriptRunTestData3[] = {
+	{"\\u00ABCaf\\u00E9\\u00BB \\u00D7 [", USCRIPT_LATIN},
+	{"\\u03B1\\u03B2\\u03B3", USCRIPT_GREEK},
+	{"] \\u00BFQu\\u00E9? <\\u00E0>", USCRIPT_LATIN},
+	{"\\u05E9\\u05DC\\u05D5\\u05DD {", USCRIPT_HEBREW},
+	{"\\u0416", USCRIPT_CYRILLIC},
+	{"}", USCRIPT_HEBREW},
+};
+
 static void test_script_runs_icu(const RunTestData* pTestData, size_t testCount);
 static void test_script_runs_utf8(const RunTestData* pTestData, size_t testCount);
 
 TEST_CASE("ICU Script Runs", "[ScriptRuns]") {
 	test_script_runs_icu(g_scriptRunTestData1, std::ssize(g_scriptRunTestData1));
 	test_script_runs_icu(g_scriptRunTestData2, std::ssize(g_scriptRunTestData2));
+	test_script_runs_icu(g_scriptRunTestData3, std::ssize(g_scriptRunTestData3));
 }
 
 TEST_CASE("UTF-8 Script Runs", "[ScriptRuns]") {
 	test_script_runs_utf8(g_scriptRunTestData1, std::ssize(g_scriptRunTestData1));
 	test_script_runs_utf8(g_scriptRunTestData2, std::ssize(g_scriptRunTestData2));
+	test_script_runs_utf8(g_scriptRunTestData3, std::ssize(g_scriptRunTestData3));
+}
+
+TEST_CASE("UTF-8 Script Runs Latin-1", "[ScriptRuns]") {
+	for (UChar32 ch = 1; ch < 256; ++ch) {
+		char testString[U8_MAX_LENGTH];
+		int32_t length{};
+		U8_APPEND_UNSAFE(testString, length, ch);
+
+		UErrorCode err{};
+		auto expectedCode = uscript_getScript(ch, &err);
+
+		if (expectedCode <= USCRIPT_INHERITED) {
+			expectedCode = USCRIPT_COMMON;
+		}
+
+		ScriptRunIterator runIter(testString, length);
+		int32_t runStart, runLimit;
+		UScriptCode runCode;
+
+		REQUIRE(runIter.next(runStart, runLimit, runCode));
+		REQUIRE(runStart == 0);
+		REQUIRE(runLimit == length);
+		REQUIRE(runCode == expectedCode);
+		REQUIRE(!runIter.next(runStart, runLimit, runCode));
+	}
 }
 
 static void test_script_runs_icu(const RunTestData* pTestData, size_t testCount) {
@@ -0,0 +1,196 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "test_layout_helpers.hpp"
+
+#include <formatting.hpp>
+#include <glyph_cache.hpp>
+#include <layout_info.hpp>
+#include <software_renderer.hpp>
+
+#include <algorithm>
+#include <vector>
+
+static constexpr const float LINE_HEIGHT = 20.f;
+static constexpr const float LINE_ASCENT = 16.f;
+static constexpr const float GLYPH_ADVANCE = 24.f;
+
+namespace {
+
+struct TestImage {
+	std::vector<uint8_t> data;
+	Text::RenderTarget target;
+
+	explicit TestImage(uint32_t width, uint32_t height, uint8_t fill = 0, uint32_t rowPadding = 0) {
+		auto stride = 4 * width + rowPadding;
+		data.assign(static_cast<size_t>(stride) * height, fill);
+		target = {data.data(), width, height, stride};
+	}
+
+	const uint8_t* get_pixel(uint32_t x, uint32_t y) const {
+		return data.data() + static_cast<size_t>(y) * target.stride + 4 * x;
+	}
+};
+
+}
+
+static Text::LayoutInfo make_test_layout(uint32_t lineCount, uint32_t glyphsPerLine, uint32_t firstGlyphID = 1);
+static uint32_t div255(uint32_t x);
+
+TEST_CASE("Coverage Blending", "[SoftwareRenderer]") {
+	Text::GlyphCache cache({
+		.byteBudget = 1 << 20,
+		.shardCount = 1,
+		.pfnRasterize = rasterize_test_glyph,
+		.pRasterizeUserData = nullptr,
+	});
+
+	// Glyph widths of 1 to 19 cover every remainder of the 4 pixel SIMD blocks
+	auto layout = make_test_layout(1, 19);
+	Text::SoftwareRenderer renderer;
+	Text::Color color{1.f, 0.5f, 0.25f, 0.75f};
+	uint8_t premultiplied[4]{191, 96, 48, 191};
+
+	renderer.build(layout, 480.f, Text::XAlignment::LEFT, cache, color);
+	REQUIRE(renderer.get_command_count() == 19);
+
+	// Blend over an opaque grey background
+	TestImage image(480, 32, 100);
+	renderer.render(image.target);
+
+	for (uint32_t glyphID = 1; glyphID <= 19; ++glyphID) {
+		auto x0 = static_cast<uint32_t>(GLYPH_ADVANCE * static_cast<float>(glyphID - 1));
+		auto y = static_cast<uint32_t>(LINE_ASCENT) - 1;
+
+		for (uint32_t x = 0; x < glyphID; ++x) {
+			auto coverage = get_test_coverage(glyphID, x, 0);
+			auto* pPixel = image.get_pixel(x0 + x, y);
+
+			for (uint32_t c = 0; c < 4; ++c) {
+				auto src = div255(premultiplied[c] * coverage);
+				auto expected = src + div255(100 * (255 - div255(premultiplied[3] * coverage)));
+				REQUIRE(pPixel[c] == expected);
+			}
+		}
+	}
+
+	// Rows outside the glyphs are untouched
+	REQUIRE(*image.get_pixel(0, 0) == 100);
+	REQUIRE(*image.get_pixel(0, 31) == 100);
+}
+
+TEST_CASE("Color Glyphs", "[SoftwareRenderer]") {
+	Text::GlyphCache cache({
+		.byteBudget = 1 << 20,
+		.shardCount = 1,
+		.pfnRasterize = rasterize_test_glyph,
+		.pRasterizeUserData = nullptr,
+	});
+
+	auto layout = make_test_layout(1, 1, TEST_COLOR_GLYPH_ID);
+	Text::SoftwareRenderer renderer;
+	renderer.build(layout, 200.f, Text::XAlignment::LEFT, cache, {0.f, 1.f, 0.f, 1.f});
+
+	TestImage image(16, 32);
+	renderer.render(image.target);
+
+	// Color glyphs keep their own color regardless of tint, and are converted from BGRA to RGBA
+	for (uint32_t x = 0; x < 6; ++x) {
+		auto* pPixel = image.get_pixel(x, static_cast<uint32_t>(LINE_ASCENT) - 1);
+		REQUIRE(pPixel[0] == 30);
+		REQUIRE(pPixel[1] == 20);
+		REQUIRE(pPixel[2] == 10);
+		REQUIRE(pPixel[3] == 255);
+	}
+}
+
+TEST_CASE("Banded Rendering", "[SoftwareRenderer]") {
+	Text::GlyphCache cache({
+		.byteBudget = 1 << 20,
+		.shardCount = 4,
+		.pfnRasterize = rasterize_test_glyph,
+		.pRasterizeUserData = nullptr,
+	});
+
+	auto layout = make_test_layout(40, 30);
+	auto limit = static_cast<int32_t>(40 * 31);
+	Text::FormattingRuns formatting{
+		.fontRuns{Text::Font{}, limit},
+		.smallcapsRuns{false, limit},
+		.subscriptRuns{false, limit},
+		.superscriptRuns{false, limit},
+	};
+
+	for (int32_t i = 0; i < limit; i += 5) {
+		formatting.colorRuns.add(std::min(i + 5, limit), Text::Color{static_cast<float>(i & 1), 0.5f, 1.f,
+				0.6f});
+	}
+
+	for (int32_t i = 0; i < limit; i += 11) {
+		auto end = std::min(i + 11, limit);
+		formatting.strokeRuns.add(end, Text::StrokeState{
+			.color = {0.f, 0.f, 0.f, static_cast<float>((i / 11) & 1)},
+			.thickness = 2,
+			.joins = Text::StrokeType::ROUND,
+		});
+		formatting.underlineRuns.add(end, (i / 11) % 3 == 0);
+		formatting.strikethroughRuns.add(end, (i / 11) % 4 == 1);
+	}
+
+	Text::SoftwareRenderer renderer;
+	renderer.build(layout, formatting, 300.f, Text::XAlignment::CENTER, cache, 3.f, 5.f);
+	REQUIRE(renderer.get_command_count() > layout.get_glyph_count());
+
+	TestImage reference(300, 40 * static_cast<uint32_t>(LINE_HEIGHT), 0, 12);
+	renderer.render_band(reference.target, 0, reference.target.height);
+
+	TestImage threaded(300, reference.target.height, 0, 12);
+	renderer.render(threaded.target, 4);
+	REQUIRE(threaded.data == reference.data);
+
+	TestImage halves(300, reference.target.height, 0, 12);
+	renderer.render_band(halves.target, 0, 301);
+	renderer.render_band(halves.target, 301, halves.target.height);
+	REQUIRE(halves.data == reference.data);
+
+	// Nothing is drawn into the row padding
+	for (uint32_t y = 0; y < reference.target.height; ++y) {
+		for (uint32_t i = 4 * reference.target.width; i < reference.target.stride; ++i) {
+			REQUIRE(threaded.data[y * reference.target.stride + i] == 0);
+		}
+	}
+
+	renderer.clear();
+	REQUIRE(renderer.empty());
+}
+
+// Static Functions
+
+static Text::LayoutInfo make_test_layout(uint32_t lineCount, uint32_t glyphsPerLine, uint32_t firstGlyphID) {
+	Text::SingleScriptFont font{};
+	font.face.handle = 0;
+	font.size = 16;
+
+	return build_test_layout({
+		.lineCount = lineCount,
+		.glyphsPerRun = glyphsPerLine,
+		.glyphAdvance = GLYPH_ADVANCE,
+		.lineHeight = LINE_HEIGHT,
+		.lineAscent = LINE_ASCENT,
+		.font = font,
+		.metrics = {
+			.ascent = LINE_ASCENT,
+			.descent = LINE_HEIGHT - LINE_ASCENT,
+			.underlinePosition = 2.f,
+			.underlineThickness = 1.f,
+			.strikethroughPosition = -5.f,
+			.strikethroughThickness = 1.f,
+		},
+	}, [](auto) { return 1; }, [&](auto, auto, auto i) {
+		return firstGlyphID == TEST_COLOR_GLYPH_ID ? TEST_COLOR_GLYPH_ID : firstGlyphID + i;
+	});
+}
+
+static uint32_t div255(uint32_t x) {
+	x += 128;
+	return (x + (x >> 8)) >> 8;
+}
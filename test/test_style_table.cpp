@@ -0,0 +1,97 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <formatting_iterator.hpp>
+#include <style_table.hpp>
+
+#include <string>
+
+static constexpr const Text::Color BASE_COLOR{0.f, 0.f, 0.f, 1.f};
+
+static Text::FormattingRuns parse(const std::string& text, std::string& contentText);
+
+TEST_CASE("Interning", "[StyleTable]") {
+	Text::StyleTable table;
+	Text::TextStyle style{
+		.font = Text::Font(Text::FontFamily{}, Text::FontWeight::BOLD, Text::FontStyle::NORMAL, 16),
+		.color = BASE_COLOR,
+		.stroke = {},
+		.flags = Text::StyleFlags::UNDERLINE,
+	};
+
+	REQUIRE(table.intern(style) == 0);
+
+	auto underlined = style;
+	underlined.flags |= Text::StyleFlags::STRIKETHROUGH;
+	REQUIRE(table.intern(underlined) == 1);
+	REQUIRE(table.intern(style) == 0);
+	REQUIRE(table.get_style_count() == 2);
+	REQUIRE(table.get_style(1).has(Text::StyleFlags::STRIKETHROUGH));
+}
+
+TEST_CASE("Conversion", "[StyleTable]") {
+	std::string contentText;
+	auto runs = parse("a<u>bc<font size=\"20\" color=\"#FF0000\">de</font></u>f<s>g<sc>h</sc></s>"
+			"<u>i</u>j<stroke thickness=\"3\">k</stroke><sub>l</sub><super>m</super>n<u>o</u>", contentText);
+
+	Text::CompactFormattingRuns compactRuns;
+	REQUIRE(Text::make_compact_formatting_runs(runs, compactRuns));
+	REQUIRE(compactRuns.styleRuns.get_limit() == static_cast<int32_t>(contentText.size()));
+
+	// Unformatted and underlined text reuse the same styles each time they appear
+	REQUIRE(compactRuns.styles.get_style_count() == 8);
+	REQUIRE(compactRuns.styleRuns.get_value(0) == compactRuns.styleRuns.get_value(13));
+	REQUIRE(compactRuns.styleRuns.get_value(1) == compactRuns.styleRuns.get_value(14));
+
+	for (int32_t i = 0; i < static_cast<int32_t>(contentText.size()); ++i) {
+		auto& style = compactRuns.get_style(i);
+		REQUIRE(style.font == runs.fontRuns.get_value(i));
+		REQUIRE(style.color == runs.colorRuns.get_value(i));
+		REQUIRE(style.stroke == runs.strokeRuns.get_value(i));
+		REQUIRE(style.has(Text::StyleFlags::STRIKETHROUGH) == runs.strikethroughRuns.get_value(i));
+		REQUIRE(style.has(Text::StyleFlags::UNDERLINE) == runs.underlineRuns.get_value(i));
+		REQUIRE(style.has(Text::StyleFlags::SMALLCAPS) == runs.smallcapsRuns.get_value(i));
+		REQUIRE(style.has(Text::StyleFlags::SUBSCRIPT) == runs.subscriptRuns.get_value(i));
+		REQUIRE(style.has(Text::StyleFlags::SUPERSCRIPT) == runs.superscriptRuns.get_value(i));
+	}
+
+	// Adjacent intersections with the same style are merged
+	for (size_t i = 1; i < compactRuns.styleRuns.get_run_count(); ++i) {
+		REQUIRE(compactRuns.styleRuns.get_run_value(i - 1) != compactRuns.styleRuns.get_run_value(i));
+	}
+}
+
+TEST_CASE("Compact Iterator", "[StyleTable]") {
+	std::string contentText;
+	auto runs = parse("ab<u>cd<font color=\"#FF0000\">ef</font>g</u>h<s><u>ij</u></s>k<font size=\"30\">lm</font>"
+			"<s>n<font color=\"#00FF00\">o</font></s>", contentText);
+
+	Text::CompactFormattingRuns compactRuns;
+	REQUIRE(Text::make_compact_formatting_runs(runs, compactRuns));
+
+	auto count = static_cast<uint32_t>(contentText.size());
+
+	// Glyphs are visited in both directions, as with LTR and RTL runs
+	for (uint32_t start : {0u, 4u, count - 1}) {
+		Text::FormattingIterator iter(runs, start);
+		Text::CompactFormattingIterator compactIter(compactRuns, start);
+
+		for (uint32_t i = 0; i < 2 * count; ++i) {
+			auto charIndex = i < count ? (start + i) % count : (start + 2 * count - 1 - i) % count;
+
+			REQUIRE(iter.advance_to(charIndex) == compactIter.advance_to(charIndex));
+			REQUIRE(iter.get_color() == compactIter.get_color());
+			REQUIRE(iter.get_prev_color() == compactIter.get_prev_color());
+			REQUIRE(iter.get_stroke_state() == compactIter.get_stroke_state());
+			REQUIRE(iter.has_strikethrough() == compactIter.has_strikethrough());
+			REQUIRE(iter.has_underline() == compactIter.has_underline());
+		}
+	}
+}
+
+// Static Functions
+
+static Text::FormattingRuns parse(const std::string& text, std::string& contentText) {
+	auto baseFont = Text::Font(Text::FontFamily{}, Text::FontWeight::REGULAR, Text::FontStyle::NORMAL, 16);
+	return Text::parse_inline_formatting(text, contentText, baseFont, BASE_COLOR, {});
+}
+
@@ -0,0 +1,212 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <text_document.hpp>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct EditLog {
+	std::vector<Text::SourceEdit> edits;
+	uint32_t lengthAfterLastEdit;
+};
+
+}
+
+static void on_document_changed(const Text::TextDocument& document, const Text::SourceEdit& edit,
+		void* pUserData);
+
+static void require_matches(const Text::TextDocument& document, const std::string& expected);
+
+TEST_CASE("Edits", "[TextDocument]") {
+	Text::TextDocument document("Hello\nWorld");
+	std::string text;
+
+	document.insert(5, ",\nDear");
+	document.get_text(text);
+	REQUIRE(text == "Hello,\nDear\nWorld");
+
+	document.erase(0, 7);
+	document.get_text(text);
+	REQUIRE(text == "Dear\nWorld");
+
+	document.replace(5, 100, "Reader\r\n");
+	document.get_text(text);
+	REQUIRE(text == "Dear\nReader\r\n");
+	REQUIRE(document.get_line_count() == 3);
+	REQUIRE(document.get_line_start(1) == 5);
+	REQUIRE(document.get_line_start(2) == document.get_length());
+	REQUIRE(document.get_line_index(document.get_length()) == 2);
+
+	document.get_text(2, 6, text);
+	REQUIRE(text == "ar\nRea");
+
+	document.set_text("");
+	REQUIRE(document.empty());
+	REQUIRE(document.get_line_count() == 1);
+	REQUIRE(document.get_line_start(1) == 0);
+}
+
+TEST_CASE("Typing Extends Piece", "[TextDocument]") {
+	Text::TextDocument document("The quick fox");
+
+	const char* typed = "brown ";
+
+	for (uint32_t i = 0; typed[i]; ++i) {
+		document.insert(10 + i, {typed + i, 1});
+	}
+
+	std::string text;
+	document.get_text(text);
+	REQUIRE(text == "The quick brown fox");
+	REQUIRE(document.get_piece_count() == 3);
+}
+
+TEST_CASE("Move", "[TextDocument]") {
+	Text::TextDocument source("Hello\nWorld");
+	source.insert(5, ",");
+
+	auto document = std::move(source);
+	require_matches(document, "Hello,\nWorld");
+
+	// The moved-from document is empty and can be edited again
+	REQUIRE(source.empty());
+	REQUIRE(source.get_piece_count() == 0);
+	REQUIRE(source.get_line_count() == 1);
+	source.insert(0, "a\nb");
+	require_matches(source, "a\nb");
+
+	document = std::move(source);
+	require_matches(document, "a\nb");
+	REQUIRE(source.empty());
+	source.insert(0, "c");
+	require_matches(source, "c");
+}
+
+TEST_CASE("Notifications", "[TextDocument]") {
+	Text::TextDocument document("abc");
+	EditLog log{};
+	document.add_listener(on_document_changed, &log);
+
+	document.insert(1, "xy");
+	document.erase(0, 2);
+	document.replace(1, 1, "zzz");
+	document.erase(10, 5);
+	document.insert(2, "");
+
+	REQUIRE(log.edits.size() == 3);
+	REQUIRE((log.edits[0].start == 1 && log.edits[0].removedLength == 0 && log.edits[0].insertedLength == 2));
+	REQUIRE((log.edits[1].start == 0 && log.edits[1].removedLength == 2 && log.edits[1].insertedLength == 0));
+	REQUIRE((log.edits[2].start == 1 && log.edits[2].removedLength == 1 && log.edits[2].insertedLength == 3));
+	REQUIRE(log.lengthAfterLastEdit == document.get_length());
+
+	document.remove_listener(on_document_changed, &log);
+	document.insert(0, "q");
+	REQUIRE(log.edits.size() == 3);
+}
+
+TEST_CASE("Random Edits", "[TextDocument]") {
+	static constexpr const char* snippets[] = {"a", "bc", "\n", "def\nghi", "\r\n", "jklmnop", "\n\n"};
+
+	std::default_random_engine rng(1234);
+	std::uniform_int_distribution<size_t> distSnippet(0, std::size(snippets) - 1);
+	std::uniform_int_distribution<int> distOp(0, 2);
+
+	std::string expected = "first line\nsecond line\nthird";
+	Text::TextDocument document(expected);
+
+	for (int i = 0; i < 2000; ++i) {
+		std::uniform_int_distribution<uint32_t> distOffset(0, static_cast<uint32_t>(expected.size()));
+		auto offset = distOffset(rng);
+
+		switch (distOp(rng)) {
+			case 0:
+			{
+				std::string_view snippet = snippets[distSnippet(rng)];
+				document.insert(offset, snippet);
+				expected.insert(offset, snippet);
+			}
+				break;
+			case 1:
+			{
+				auto length = std::min<uint32_t>(distOffset(rng) % 8, static_cast<uint32_t>(expected.size())
+						- offset);
+				document.erase(offset, length);
+				expected.erase(offset, length);
+			}
+				break;
+			default:
+			{
+				std::string_view snippet = snippets[distSnippet(rng)];
+				auto length = std::min<uint32_t>(3, static_cast<uint32_t>(expected.size()) - offset);
+				document.replace(offset, length, snippet);
+				expected.replace(offset, length, snippet);
+			}
+				break;
+		}
+
+		if (i % 50 == 0) {
+			require_matches(document, expected);
+		}
+	}
+
+	require_matches(document, expected);
+}
+
+// Static Functions
+
+static void on_document_changed(const Text::TextDocument& document, const Text::SourceEdit& edit,
+		void* pUserData) {
+	auto& log = *static_cast<EditLog*>(pUserData);
+	log.edits.emplace_back(edit);
+	log.lengthAfterLastEdit = document.get_length();
+}
+
+static void require_matches(const Text::TextDocument& document, const std::string& expected) {
+	std::string text;
+	document.get_text(text);
+	REQUIRE(text == expected);
+	REQUIRE(document.get_length() == expected.size());
+
+	std::vector<std::string_view> chunks;
+	document.get_chunks(chunks);
+	REQUIRE(chunks.size() == document.get_piece_count());
+
+	std::string joined;
+
+	for (auto chunk : chunks) {
+		REQUIRE(!chunk.empty());
+		joined.append(chunk);
+	}
+
+	REQUIRE(joined == expected);
+
+	std::vector<uint32_t> lineStarts{0};
+
+	for (uint32_t i = 0; i < expected.size(); ++i) {
+		if (expected[i] == '\n') {
+			lineStarts.emplace_back(i + 1);
+		}
+	}
+
+	REQUIRE(document.get_line_count() == lineStarts.size());
+
+	for (uint32_t line = 0; line < lineStarts.size(); ++line) {
+		REQUIRE(document.get_line_start(line) == lineStarts[line]);
+	}
+
+	for (uint32_t offset = 0; offset <= expected.size(); ++offset) {
+		auto line = std::upper_bound(lineStarts.begin(), lineStarts.end(), offset) - lineStarts.begin() - 1;
+		REQUIRE(document.get_line_index(offset) == line);
+	}
+
+	// Partial ranges cut pieces at both ends
+	if (expected.size() > 4) {
+		document.get_text(2, static_cast<uint32_t>(expected.size() - 4), text);
+		REQUIRE(text == expected.substr(2, expected.size() - 4));
+	}
+}
+